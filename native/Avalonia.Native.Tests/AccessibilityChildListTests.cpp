@@ -0,0 +1,90 @@
+#include "TestFramework.h"
+#include "AccessibilityChildList.h"
+
+typedef AccessibilityChildList List;
+
+static std::vector<List::Key> Keys(std::initializer_list<size_t> values)
+{
+    std::vector<List::Key> keys;
+    for (auto value : values)
+        keys.push_back(reinterpret_cast<List::Key>(value * 16));
+    return keys;
+}
+
+TEST(FirstUpdateAddsEverything)
+{
+    List list;
+    CHECK(!list.IsLoaded());
+    auto changes = list.Update(Keys({ 1, 2, 3 }));
+    CHECK(list.IsLoaded());
+    CHECK_EQ(3u, changes.added.size());
+    CHECK(changes.removed.empty());
+}
+
+TEST(OnlyRealChangesAreReported)
+{
+    List list;
+    list.Update(Keys({ 1, 2, 3 }));
+    auto changes = list.Update(Keys({ 1, 4, 3 }));
+    CHECK_EQ(1u, changes.added.size());
+    CHECK_EQ(1u, changes.added[0]);
+    CHECK_EQ(1u, changes.removed.size());
+    CHECK(changes.removed[0] == Keys({ 2 })[0]);
+
+    // Reordering adds and removes nothing
+    changes = list.Update(Keys({ 3, 1, 4 }));
+    CHECK(changes.added.empty());
+    CHECK(changes.removed.empty());
+
+    changes = list.Update({});
+    CHECK_EQ(3u, changes.removed.size());
+}
+
+TEST(UnloadForgetsTheChildren)
+{
+    List list;
+    list.Update(Keys({ 1, 2 }));
+    list.Unload();
+    CHECK(!list.IsLoaded());
+    CHECK(list.GetKeys().empty());
+    CHECK_EQ(2u, list.Update(Keys({ 1, 2 })).added.size());
+}
+
+TEST(ClampWindow)
+{
+    size_t start, length;
+    CHECK(List::ClampWindow(10, 8, 5, start, length));
+    CHECK_EQ(8u, start);
+    CHECK_EQ(2u, length);
+    CHECK(!List::ClampWindow(10, 10, 5, start, length));
+    CHECK_EQ(0u, length);
+    CHECK(!List::ClampWindow(10, 3, 0, start, length));
+    CHECK(List::ClampWindow(10, 0, SIZE_MAX, start, length));
+    CHECK_EQ(10u, length);
+}
+
+BENCHMARK(DiffOfALargeList)
+{
+    // A list with one child removed from the middle and one appended, what a virtualized list scrolling by one
+    // row looks like
+    for (size_t count : { 1000u, 10000u, 200000u })
+    {
+        std::vector<List::Key> before;
+        for (size_t c = 0; c < count; c++)
+            before.push_back(reinterpret_cast<List::Key>((c + 1) * 16));
+        auto after = before;
+        after.erase(after.begin() + count / 2);
+        after.push_back(reinterpret_cast<List::Key>((count + 5) * 16));
+
+        List list;
+        auto load = MeasureNs(1, [&] { KeepAlive(list.Update(before)); });
+        bool scrolled = false;
+        auto diff = MeasureNs(BenchmarkIterations(1000), [&]
+        {
+            KeepAlive(list.Update(scrolled ? before : after));
+            scrolled = !scrolled;
+        });
+        ReportBenchmark((std::to_string(count) + " children, first load").c_str(), load / 1000, "us");
+        ReportBenchmark((std::to_string(count) + " children, diff after scrolling").c_str(), diff / 1000, "us");
+    }
+}
@@ -0,0 +1,144 @@
+#include "TestFramework.h"
+#include "AccessibilityNotificationQueue.h"
+#include <memory>
+
+typedef AccessibilityNotificationKind Kind;
+typedef std::shared_ptr<int> Element;
+
+TEST(RepeatedChangesAreMergedAndFocusComesLast)
+{
+    AccessibilityNotificationQueue<Element> queue(500);
+    auto a = std::make_shared<int>(1);
+    auto b = std::make_shared<int>(2);
+    uint64_t due = 0;
+
+    CHECK(queue.Queue(a.get(), a, Kind::Value, 0));
+    CHECK(!queue.Queue(b.get(), b, Kind::Focus, 0));
+    for (int c = 0; c < 100; c++)
+    {
+        queue.Queue(a.get(), a, Kind::Value, 0);
+        queue.Queue(a.get(), a, Kind::Bounds, 0);
+    }
+    queue.Queue(a.get(), a, Kind::Focus, 0);
+    queue.Queue(b.get(), b, Kind::Title, 0);
+    // Focus back on b, after everything before it
+    queue.Queue(b.get(), b, Kind::Focus, 0);
+
+    auto posted = queue.Flush(0, due);
+    CHECK_EQ(0u, due);
+    CHECK_EQ(5u, posted.size());
+    CHECK(posted[0].Kind == Kind::Value);
+    CHECK(posted[1].Kind == Kind::Bounds);
+    CHECK(posted[2].Kind == Kind::Focus && posted[2].Element == a);
+    CHECK(posted[3].Kind == Kind::Title);
+    CHECK(posted[4].Kind == Kind::Focus && posted[4].Element == b);
+    CHECK(queue.IsEmpty());
+
+    // The next change schedules a flush again
+    CHECK(queue.Queue(a.get(), a, Kind::Value, 0));
+}
+
+TEST(AnnouncementsAreRateLimitedPerElement)
+{
+    AccessibilityNotificationQueue<Element> queue(500);
+    auto a = std::make_shared<int>(1);
+    auto b = std::make_shared<int>(2);
+    uint64_t due = 0;
+
+    queue.Queue(a.get(), a, Kind::LiveRegion, 1000);
+    CHECK_EQ(1u, queue.Flush(1000, due).size());
+    CHECK_EQ(0u, due);
+
+    queue.Queue(a.get(), a, Kind::LiveRegion, 1100);
+    queue.Queue(a.get(), a, Kind::Value, 1100);
+    queue.Queue(a.get(), a, Kind::LiveRegion, 1200);
+    auto posted = queue.Flush(1200, due);
+    CHECK_EQ(1u, posted.size());
+    CHECK(posted[0].Kind == Kind::Value);
+    CHECK_EQ(1500u, due);
+    CHECK(!queue.IsEmpty());
+
+    // Flushing early, e.g. for the next frame, keeps the same due time
+    CHECK(queue.Flush(1400, due).empty());
+    CHECK_EQ(1500u, due);
+    posted = queue.Flush(1500, due);
+    CHECK_EQ(1u, posted.size());
+    CHECK(posted[0].Kind == Kind::LiveRegion);
+    CHECK_EQ(0u, due);
+
+    // Another element isn't held back by the first one
+    queue.Queue(b.get(), b, Kind::LiveRegion, 1600);
+    CHECK_EQ(1u, queue.Flush(1600, due).size());
+}
+
+TEST(RemovedElementsAreLetGo)
+{
+    AccessibilityNotificationQueue<Element> queue(500);
+    auto a = std::make_shared<int>(1);
+    auto b = std::make_shared<int>(2);
+    uint64_t due = 0;
+
+    queue.Queue(a.get(), a, Kind::Title, 0);
+    queue.Queue(b.get(), b, Kind::Title, 0);
+    queue.Queue(a.get(), a, Kind::LiveRegion, 0);
+    queue.Remove(a.get());
+
+    auto posted = queue.Flush(0, due);
+    CHECK_EQ(1u, posted.size());
+    CHECK(posted[0].Element == b);
+    posted.clear();
+    CHECK_EQ(1, static_cast<int>(a.use_count()));
+
+    // Queued again after being removed
+    queue.Queue(a.get(), a, Kind::Title, 10);
+    CHECK_EQ(1u, queue.Flush(10, due).size());
+}
+
+BENCHMARK(PropertyChangeStorm)
+{
+    // 200 elements changing value and bounds 60 times per frame, with an announcement every 20 changes and a
+    // focus change per frame, for 1000 frames
+    std::vector<Element> elements;
+    for (int c = 0; c < 200; c++)
+        elements.push_back(std::make_shared<int>(c));
+
+    AccessibilityNotificationQueue<Element> queue;
+    uint64_t now = 0;
+    uint64_t due = 0;
+    size_t queued = 0;
+    size_t posted = 0;
+    size_t flushes = 0;
+    size_t dueTimes = 0;
+    auto frames = BenchmarkIterations(1000);
+    auto elapsed = MeasureNs(frames, [&]
+    {
+        now += 16000;
+        for (int update = 0; update < 60; update++)
+            for (auto& element : elements)
+            {
+                if (queue.Queue(element.get(), element, Kind::Value, now))
+                    flushes++;
+                queue.Queue(element.get(), element, Kind::Bounds, now);
+                queued += 2;
+                if (update % 20 == 0)
+                {
+                    queue.Queue(element.get(), element, Kind::LiveRegion, now);
+                    queued++;
+                }
+            }
+        auto& focused = elements[now / 16000 % elements.size()];
+        queue.Queue(focused.get(), focused, Kind::Focus, now);
+        queued++;
+
+        posted += queue.Flush(now, due).size();
+        if (due != 0)
+            dueTimes++;
+    });
+
+    ReportBenchmark("notifications reported", static_cast<double>(queued), "notifications");
+    ReportBenchmark("notifications posted", static_cast<double>(posted), "notifications");
+    ReportBenchmark("flushes scheduled", static_cast<double>(flushes), "flushes");
+    ReportBenchmark("frames leaving an announcement delayed", static_cast<double>(dueTimes), "frames");
+    ReportBenchmark("queuing a notification", elapsed / static_cast<double>(queued) * static_cast<double>(frames),
+                    "ns");
+}
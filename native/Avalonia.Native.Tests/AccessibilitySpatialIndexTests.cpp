@@ -0,0 +1,245 @@
+#include "TestFramework.h"
+#include "AccessibilitySpatialIndex.h"
+#include <memory>
+#include <random>
+
+typedef AccessibilitySpatialIndex Index;
+
+static Index::Key Key(size_t value)
+{
+    return reinterpret_cast<Index::Key>(value * 16);
+}
+
+struct FlatTree
+{
+    Index index;
+    std::vector<AvnRect> bounds;
+
+    // A root covering everything with count - 1 random children
+    FlatTree(size_t count, std::mt19937& random)
+    {
+        std::uniform_real_distribution<double> position(0, 4000), size(1, 300);
+        index.Add(Key(1), nullptr, { 0, 0, 4300, 4300 }, true);
+        bounds.push_back({ 0, 0, 4300, 4300 });
+        for (size_t c = 2; c <= count; c++)
+        {
+            AvnRect rect { position(random), position(random), size(random), size(random) };
+            index.Add(Key(c), Key(1), rect, true);
+            bounds.push_back(rect);
+        }
+    }
+
+    // What walking the tree does
+    Index::Key BruteForceHitTest(double x, double y) const
+    {
+        size_t best = 1;
+        for (size_t c = 1; c < bounds.size(); c++)
+        {
+            auto& rect = bounds[c];
+            if (x >= rect.X && x < rect.X + rect.Width && y >= rect.Y && y < rect.Y + rect.Height)
+                best = c + 1;
+        }
+        return Key(best);
+    }
+};
+
+TEST(DeepestAndTopmostElementWins)
+{
+    Index index;
+    index.Add(Key(1), nullptr, { 0, 0, 800, 600 }, true);
+    index.Add(Key(2), Key(1), { 10, 10, 100, 100 }, false);
+    // Overlaps 2 and was added later, so it is on top
+    index.Add(Key(3), Key(1), { 50, 50, 100, 100 }, true);
+    index.Add(Key(4), Key(3), { 140, 140, 100, 100 }, true);
+
+    bool complete;
+    CHECK(index.HitTest(20, 20, &complete) == Key(2));
+    CHECK(!complete);
+    CHECK(index.HitTest(60, 60, &complete) == Key(3));
+    CHECK(complete);
+    CHECK(index.HitTest(145, 145) == Key(4));
+    CHECK(index.HitTest(900, 10) == nullptr);
+    CHECK(index.HitTest(900, 10, &complete) == nullptr);
+    CHECK(!complete);
+}
+
+TEST(ChildrenAreClippedToTheirParents)
+{
+    Index index;
+    index.Add(Key(1), nullptr, { 0, 0, 800, 600 }, true);
+    index.Add(Key(3), Key(1), { 50, 50, 100, 100 }, true);
+    index.Add(Key(4), Key(3), { 140, 140, 100, 100 }, true);
+    index.Add(Key(5), Key(1), { -50, -50, 10, 10 }, true);
+    index.Add(Key(6), Key(5), { -50, -50, 100, 100 }, true);
+
+    CHECK(index.HitTest(160, 160) == Key(1));
+    CHECK(index.HitTest(-45, -45) == nullptr);
+    // The child of an element that was clipped away entirely can't be hit either
+    CHECK(index.HitTest(20, 20) == Key(1));
+    CHECK(index.GetParent(Key(6)) == Key(5));
+    CHECK(index.GetParent(Key(99)) == nullptr);
+}
+
+TEST(OversizedElementsAreFound)
+{
+    Index index(128, 4);
+    index.Add(Key(1), nullptr, { 0, 0, 100000, 100000 }, true);
+    index.Add(Key(2), Key(1), { 1000, 0, 50, 50 }, true);
+    CHECK(index.HitTest(99999, 5) == Key(1));
+    CHECK(index.HitTest(1010, 5) == Key(2));
+
+    index.Clear();
+    CHECK_EQ(0u, index.GetCount());
+    CHECK(index.HitTest(5, 5) == nullptr);
+}
+
+TEST(MovedElementsAreUpdatedInPlace)
+{
+    Index index;
+    index.Add(Key(1), nullptr, { 0, 0, 800, 600 }, true);
+    index.Add(Key(2), Key(1), { 10, 10, 100, 100 }, true);
+    index.Add(Key(3), Key(2), { 20, 20, 10, 10 }, true);
+    index.Add(Key(4), Key(2), { 60, 60, 10, 10 }, true);
+
+    AvnRect bounds;
+    CHECK(index.MarkMoved(Key(2)));
+    CHECK(index.MarkMoved(Key(4)));
+    CHECK(!index.MarkMoved(Key(99)));
+    CHECK(index.HasMoved());
+    // Nothing is fetched until the next refresh, rebuilding an index can't reuse a stale entry
+    CHECK(!index.TryGetBounds(Key(2), bounds));
+    CHECK(index.TryGetBounds(Key(3), bounds));
+
+    int fetched = 0;
+    index.Refresh([&](Index::Key key) -> AvnRect
+    {
+        fetched++;
+        return key == Key(2) ? AvnRect { 300, 300, 100, 100 } : AvnRect { 390, 390, 10, 10 };
+    });
+    CHECK_EQ(2, fetched);
+    CHECK(!index.HasMoved());
+
+    // 3 moved along with its parent, 4 got its own bounds
+    CHECK(index.HitTest(25, 25) == Key(1));
+    CHECK(index.HitTest(315, 315) == Key(3));
+    CHECK(index.HitTest(395, 395) == Key(4));
+    CHECK(index.HitTest(350, 350) == Key(2));
+    CHECK(index.TryGetBounds(Key(3), bounds));
+    CHECK_EQ(310.0, bounds.X);
+    CHECK_EQ(310.0, bounds.Y);
+}
+
+TEST(RemovedElementsAreNotHit)
+{
+    Index index;
+    index.Add(Key(1), nullptr, { 0, 0, 800, 600 }, true);
+    index.Add(Key(2), Key(1), { 10, 10, 100, 100 }, true);
+    index.Add(Key(3), Key(2), { 20, 20, 10, 10 }, true);
+
+    index.MarkMoved(Key(2));
+    index.Remove(Key(2));
+    index.Remove(Key(99));
+    CHECK(!index.Contains(Key(2)));
+    int fetched = 0;
+    index.Refresh([&](Index::Key) { fetched++; return AvnRect {}; });
+    CHECK_EQ(0, fetched);
+    CHECK(index.HitTest(50, 50) == Key(1));
+    CHECK(index.HitTest(25, 25) == Key(3));
+    CHECK(index.GetParent(Key(3)) == nullptr);
+    CHECK(index.GetParent(Key(2)) == nullptr);
+}
+
+TEST(MatchesBruteForceAfterMoves)
+{
+    std::mt19937 random(2);
+    FlatTree tree(2000, random);
+    std::uniform_real_distribution<double> position(0, 4000), size(1, 300);
+    std::uniform_int_distribution<size_t> element(2, 2000);
+    for (int round = 0; round < 20; round++)
+    {
+        for (int c = 0; c < 50; c++)
+        {
+            auto moved = element(random);
+            tree.bounds[moved - 1] = { position(random), position(random), size(random), size(random) };
+            tree.index.MarkMoved(Key(moved));
+        }
+        tree.index.Refresh([&](Index::Key key) { return tree.bounds[reinterpret_cast<size_t>(key) / 16 - 1]; });
+
+        for (int c = 0; c < 250; c++)
+        {
+            auto x = position(random), y = position(random);
+            CHECK(tree.index.HitTest(x, y) == tree.BruteForceHitTest(x, y));
+        }
+    }
+}
+
+TEST(MatchesBruteForce)
+{
+    std::mt19937 random(1);
+    FlatTree tree(2000, random);
+    std::uniform_real_distribution<double> position(-100, 4400);
+    for (int c = 0; c < 5000; c++)
+    {
+        auto x = position(random), y = position(random);
+        auto expected = x >= 0 && x < 4300 && y >= 0 && y < 4300 ? tree.BruteForceHitTest(x, y) : nullptr;
+        CHECK(tree.index.HitTest(x, y) == expected);
+    }
+}
+
+BENCHMARK(HitTestAgainstBruteForce)
+{
+    for (size_t count : { 1000u, 10000u, 100000u })
+    {
+        std::mt19937 random(1);
+        std::unique_ptr<FlatTree> tree;
+        auto build = MeasureNs(1, [&] { tree.reset(new FlatTree(count, random)); });
+
+        std::uniform_real_distribution<double> position(0, 4000);
+        auto indexed = MeasureNs(BenchmarkIterations(100000), [&]
+        {
+            KeepAlive(tree->index.HitTest(position(random), position(random)));
+        });
+        auto bruteForce = MeasureNs(BenchmarkIterations(1000), [&]
+        {
+            KeepAlive(tree->BruteForceHitTest(position(random), position(random)));
+        });
+
+        auto prefix = std::to_string(count) + " elements, ";
+        ReportBenchmark((prefix + "building the tree and its index").c_str(), build / 1000, "us");
+        ReportBenchmark((prefix + "indexed hit test").c_str(), indexed / 1000, "us");
+        ReportBenchmark((prefix + "brute force hit test").c_str(), bruteForce / 1000, "us");
+    }
+}
+
+BENCHMARK(MoveAgainstRebuild)
+{
+    const size_t count = 10000;
+    std::mt19937 random(1);
+    FlatTree tree(count, random);
+    std::uniform_real_distribution<double> position(0, 4000);
+    std::uniform_int_distribution<size_t> element(2, count);
+
+    // One element animating, hit tested every frame
+    auto moved = MeasureNs(BenchmarkIterations(10000), [&]
+    {
+        auto key = Key(element(random));
+        tree.index.MarkMoved(key);
+        tree.index.Refresh([&](Index::Key) { return AvnRect { position(random), position(random), 50, 50 }; });
+        KeepAlive(tree.index.HitTest(position(random), position(random)));
+    });
+    auto rebuilt = MeasureNs(BenchmarkIterations(100), [&]
+    {
+        Index index;
+        index.Add(Key(1), nullptr, { 0, 0, 4300, 4300 }, true);
+        AvnRect bounds;
+        for (size_t c = 2; c <= count; c++)
+        {
+            tree.index.TryGetBounds(Key(c), bounds);
+            index.Add(Key(c), Key(1), bounds, true);
+        }
+        KeepAlive(index.HitTest(position(random), position(random)));
+    });
+
+    ReportBenchmark("10000 elements, move one and hit test", moved / 1000, "us");
+    ReportBenchmark("10000 elements, rebuild and hit test", rebuilt / 1000, "us");
+}
@@ -0,0 +1,104 @@
+#include "TestFramework.h"
+#include "AutomationPropertyCache.h"
+#include <vector>
+
+namespace
+{
+    struct FakePeer
+    {
+        int Calls = 0;
+        double Value = 1;
+
+        AvnAutomationPropertySnapshot GetPropertySnapshot()
+        {
+            Calls++;
+            AvnAutomationPropertySnapshot snapshot {};
+            snapshot.RangeValue = Value;
+            return snapshot;
+        }
+    };
+}
+
+TEST(SnapshotIsFetchedOncePerBurst)
+{
+    AutomationPropertyCache cache(100000);
+    FakePeer peer;
+    auto fetch = [&] { return peer.GetPropertySnapshot(); };
+
+    CHECK_EQ(1.0, cache.GetSnapshot(AutomationCachedIdentity, 1000, fetch).RangeValue);
+    CHECK_EQ(1, peer.Calls);
+    cache.GetSnapshot(AutomationCachedRangeValue | AutomationCachedBounds, 2000, fetch);
+    CHECK_EQ(1, peer.Calls);
+}
+
+TEST(NotificationsInvalidateTheirParts)
+{
+    AutomationPropertyCache cache(100000);
+    FakePeer peer;
+    auto fetch = [&] { return peer.GetPropertySnapshot(); };
+    cache.GetSnapshot(AutomationCachedSnapshot, 1000, fetch);
+
+    peer.Value = 2;
+    cache.Invalidate(RangeValueProvider_Value);
+    CHECK(cache.IsValid(AutomationCachedIdentity, 2000));
+    CHECK(!cache.IsValid(AutomationCachedRangeValue, 2000));
+    CHECK_EQ(2.0, cache.GetSnapshot(AutomationCachedRangeValue, 3000, fetch).RangeValue);
+    CHECK_EQ(2, peer.Calls);
+
+    cache.MarkValid(AutomationCachedName, 3000);
+    cache.Invalidate(AutomationPeer_Name);
+    CHECK(!cache.IsValid(AutomationCachedName, 3000));
+    CHECK(cache.IsValid(AutomationCachedBounds, 3000));
+}
+
+TEST(PartsExpire)
+{
+    AutomationPropertyCache cache(100000);
+    FakePeer peer;
+    cache.GetSnapshot(AutomationCachedSnapshot, 1000, [&] { return peer.GetPropertySnapshot(); });
+    CHECK(cache.IsValid(AutomationCachedSnapshot, 101000));
+    CHECK(!cache.IsValid(AutomationCachedSnapshot, 101001));
+    // A clock going backwards doesn't make anything valid
+    CHECK(!cache.IsValid(AutomationCachedSnapshot, 500));
+}
+
+TEST(StringsAreTrackedSeparately)
+{
+    AutomationPropertyCache cache;
+    CHECK(!cache.IsValid(AutomationCachedName, 1000));
+    cache.MarkValid(AutomationCachedName, 1000);
+    CHECK(cache.IsValid(AutomationCachedName, 1000));
+    CHECK(!cache.IsValid(AutomationCachedName | AutomationCachedValue, 1000));
+
+    // Time 0 still counts as fetched
+    cache.MarkValid(AutomationCachedValue, 0);
+    CHECK(cache.IsValid(AutomationCachedValue, 1));
+}
+
+TEST(UnknownPropertiesInvalidateEverything)
+{
+    auto parts = AutomationPropertyCache::PartsAffectedBy(static_cast<AvnAutomationProperty>(99));
+    CHECK_EQ(static_cast<uint32_t>(AutomationCachedSnapshot | AutomationCachedName | AutomationCachedValue), parts);
+    CHECK_EQ(0u, AutomationPropertyCache::PartsAffectedBy(AutomationPeer_AutomationId));
+}
+
+BENCHMARK(AttributeReadsOfALargeTree)
+{
+    // An accessibility client walking 10000 elements reads around 30 attributes of each within one burst
+    const size_t elements = BenchmarkIterations(10000);
+    const int reads = 30;
+    FakePeer cached;
+    std::vector<AutomationPropertyCache> caches(elements);
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < elements; c++)
+        for (int r = 0; r < reads; r++)
+            KeepAlive(caches[c].GetSnapshot(AutomationCachedIdentity | AutomationCachedRangeValue, 5000 + r,
+                                            [&] { return cached.GetPropertySnapshot(); }));
+    auto end = std::chrono::steady_clock::now();
+
+    ReportBenchmark("managed calls without the cache", static_cast<double>(elements * reads), "calls");
+    ReportBenchmark("managed calls with the cache", cached.Calls, "calls");
+    ReportBenchmark("cached attribute read",
+                    std::chrono::duration<double, std::nano>(end - start).count() / (elements * reads), "ns");
+}
@@ -0,0 +1,194 @@
+#include "TestFramework.h"
+#include "BookmarkBatch.h"
+#include <set>
+#include <thread>
+
+static BoundedParallelFor::Executor ThreadExecutor = [](std::function<void()> work) { std::thread(work).detach(); };
+
+// Stands in for URLByResolvingBookmarkData:, which mostly waits for the file system.
+// Bookmarks starting with "bad" don't resolve, ones starting with "old" are stale.
+struct FakeResolver
+{
+    std::atomic<int> Resolves { 0 };
+    std::atomic<int> Running { 0 };
+    std::atomic<int> Peak { 0 };
+    int LatencyUs = 200;
+
+    void operator()(const void* data, size_t length, BookmarkResult& result)
+    {
+        auto running = ++Running;
+        for (auto peak = Peak.load(); running > peak && !Peak.compare_exchange_weak(peak, running);)
+        {
+        }
+        Resolves++;
+        std::this_thread::sleep_for(std::chrono::microseconds(LatencyUs));
+
+        std::string name(static_cast<const char*>(data), length);
+        if (name.rfind("bad", 0) == 0)
+            result.Error = "gone";
+        else
+        {
+            result.Succeeded = true;
+            result.Value = "file:///" + name;
+            result.IsStale = name.rfind("old", 0) == 0;
+            result.Item = std::make_shared<std::string>(result.Value);
+        }
+        Running--;
+    }
+};
+
+static std::vector<BookmarkBytes> ToBytes(const std::vector<std::string>& names)
+{
+    std::vector<BookmarkBytes> bookmarks;
+    for (auto& name : names)
+        bookmarks.push_back({ name.data(), name.size() });
+    return bookmarks;
+}
+
+TEST(ParallelForRunsEveryIndexOnce)
+{
+    for (size_t count : { 0u, 1u, 2u, 7u, 100u })
+        for (size_t workers : { 1u, 3u, 8u })
+        {
+            std::vector<std::atomic<int>> hits(count);
+            BoundedParallelFor::Run(count, workers, ThreadExecutor, [&](size_t index) { hits[index]++; });
+            for (auto& hit : hits)
+                CHECK_EQ(1, hit.load());
+        }
+}
+
+TEST(BatchResolvesOnBoundedWorkers)
+{
+    std::vector<std::string> names;
+    for (int c = 0; c < 40; c++)
+        names.push_back((c % 10 == 3 ? "bad" : c % 10 == 5 ? "old" : "f") + std::to_string(c));
+
+    BookmarkCache cache;
+    FakeResolver resolver;
+    std::set<std::string> moved;
+    auto isCurrent = [&](const BookmarkResult& result) { return moved.count(result.Value) == 0; };
+    auto results = ResolveBookmarks(ToBytes(names), cache, 4, ThreadExecutor, std::ref(resolver), isCurrent);
+    CHECK_EQ(40, resolver.Resolves.load());
+    CHECK(resolver.Peak <= 4);
+
+    for (size_t c = 0; c < names.size(); c++)
+    {
+        if (names[c][0] == 'b')
+        {
+            CHECK(!results[c].Succeeded);
+            CHECK(results[c].Error == "gone");
+            CHECK(results[c].Item == nullptr);
+        }
+        else
+        {
+            CHECK(results[c].Succeeded);
+            CHECK(results[c].Value == "file:///" + names[c]);
+            CHECK_EQ(names[c][0] == 'o', results[c].IsStale);
+        }
+    }
+    // Failures aren't cached
+    CHECK_EQ(36u, cache.GetCount());
+
+    // Only the failures and the moved item are resolved again, the rest come with what they resolved to
+    moved.insert("file:///f0");
+    auto item = results[1].Item;
+    results = ResolveBookmarks(ToBytes(names), cache, 4, ThreadExecutor, std::ref(resolver), isCurrent);
+    CHECK_EQ(45, resolver.Resolves.load());
+    CHECK(results[1].Item == item);
+    CHECK(results[0].Item != nullptr);
+    CHECK(results[5].IsStale);
+    CHECK(results[3].Error == "gone");
+}
+
+TEST(CacheDropsTheLeastRecentlyUsed)
+{
+    BookmarkResult resolved;
+    resolved.Succeeded = true;
+    resolved.Value = "x";
+
+    BookmarkCache cache(2);
+    cache.Add("a", 1, resolved);
+    cache.Add("b", 1, resolved);
+    BookmarkResult result;
+    CHECK(cache.TryGet("a", 1, result));
+    cache.Add("c", 1, resolved);
+    CHECK(cache.TryGet("a", 1, result));
+    CHECK(!cache.TryGet("b", 1, result));
+    CHECK_EQ(2u, cache.GetCount());
+
+    // Bookmarks are binary
+    BookmarkCache binary;
+    binary.Add("a\0b", 3, resolved);
+    CHECK(binary.TryGet("a\0b", 3, result));
+    CHECK(!binary.TryGet("a", 1, result));
+
+    BookmarkCache disabled(0);
+    disabled.Add("a", 1, resolved);
+    CHECK_EQ(0u, disabled.GetCount());
+}
+
+TEST(ItemsLiveAsLongAsTheirBookmarks)
+{
+    auto resolved = [](const std::string& value)
+    {
+        BookmarkResult result;
+        result.Succeeded = true;
+        result.Value = value;
+        result.Item = std::make_shared<std::string>(value);
+        return result;
+    };
+
+    BookmarkCache cache(2);
+    auto a = resolved("file:///a");
+    std::weak_ptr<const void> aItem = a.Item;
+    cache.Add("a", 1, a);
+    a = BookmarkResult();
+    // Two bookmarks of the same item, the most recently used one is found
+    cache.Add("b", 1, resolved("file:///b"));
+    cache.Add("b2", 2, resolved("file:///b"));
+    CHECK(aItem.expired());
+    CHECK(cache.FindItem("file:///a") == nullptr);
+    CHECK(cache.FindItem("file:///b") != nullptr);
+
+    BookmarkResult result;
+    CHECK(cache.TryGet("b", 1, result));
+    CHECK(cache.FindItem("file:///b") == result.Item);
+
+    // A bookmark resolving somewhere else now
+    cache.Add("b", 1, resolved("file:///c"));
+    CHECK(cache.FindItem("file:///c") != nullptr);
+    CHECK(cache.FindItem("file:///b") != nullptr);
+
+    std::weak_ptr<const void> cItem = cache.FindItem("file:///c");
+    cache.Remove("file:///c");
+    CHECK(cItem.expired());
+    CHECK(cache.FindItem("file:///c") == nullptr);
+    CHECK(!cache.TryGet("b", 1, result));
+    CHECK_EQ(1u, cache.GetCount());
+
+    cache.Remove("file:///b");
+    CHECK(cache.FindItem("file:///b") == nullptr);
+    CHECK_EQ(0u, cache.GetCount());
+}
+
+BENCHMARK(RecentFilesOnLaunch)
+{
+    // 500 bookmarks taking 200 us each to resolve, then the same 500 again
+    std::vector<std::string> names;
+    for (size_t c = 0; c < BenchmarkIterations(500); c++)
+        names.push_back("doc" + std::to_string(c));
+    auto bookmarks = ToBytes(names);
+
+    for (size_t workers : { 1u, 4u, 8u })
+    {
+        BookmarkCache cache;
+        FakeResolver resolver;
+        auto always = [](const BookmarkResult&) { return true; };
+        auto cold = MeasureNs(1, [&] { ResolveBookmarks(bookmarks, cache, workers, ThreadExecutor, std::ref(resolver), always); });
+        auto warm = MeasureNs(1, [&] { ResolveBookmarks(bookmarks, cache, workers, ThreadExecutor, std::ref(resolver), always); });
+
+        auto prefix = std::to_string(workers) + " workers, ";
+        ReportBenchmark((prefix + "resolving").c_str(), cold / 1e6, "ms");
+        ReportBenchmark((prefix + "cached").c_str(), warm / 1e6, "ms");
+    }
+}
@@ -0,0 +1,101 @@
+#include "TestFramework.h"
+#include "ChunkedBytes.h"
+#include <cstdlib>
+#include <cstring>
+
+struct Producer
+{
+    std::vector<uint8_t> Payload;
+    size_t Position = 0;
+    int Calls = 0;
+
+    explicit Producer(size_t length) : Payload(length)
+    {
+        for (size_t c = 0; c < length; c++)
+            Payload[c] = static_cast<uint8_t>(c * 31);
+    }
+
+    int64_t operator()(void* chunk, size_t count)
+    {
+        Calls++;
+        auto available = std::min(count, Payload.size() - Position);
+        memcpy(chunk, Payload.data() + Position, available);
+        Position += available;
+        return static_cast<int64_t>(available);
+    }
+};
+
+TEST(PayloadArrivesInChunks)
+{
+    Producer producer(10007);
+    std::vector<uint8_t> destination(producer.Payload.size());
+    CHECK_EQ(10007, ReadChunked(destination.data(), destination.size(), producer, 1000));
+    CHECK(destination == producer.Payload);
+    CHECK_EQ(11, producer.Calls);
+}
+
+TEST(ShortProducerEndsThePayloadEarly)
+{
+    Producer producer(10007);
+    std::vector<uint8_t> destination(producer.Payload.size() + 500);
+    CHECK_EQ(10007, ReadChunked(destination.data(), destination.size(), producer, 4096));
+    CHECK(memcmp(destination.data(), producer.Payload.data(), producer.Payload.size()) == 0);
+}
+
+TEST(FailingProducer)
+{
+    std::vector<uint8_t> destination(100);
+    CHECK_EQ(-1, ReadChunked(destination.data(), destination.size(), [](void*, size_t) -> int64_t { return -1; }));
+}
+
+TEST(OverreportingProducerNeverOverruns)
+{
+    std::vector<uint8_t> destination(100);
+    auto read = ReadChunked(destination.data(), destination.size(),
+                            [](void*, size_t count) { return static_cast<int64_t>(count) * 10; }, 30);
+    CHECK_EQ(100, read);
+}
+
+TEST(EmptyAndMissingDestinations)
+{
+    Producer producer(10);
+    CHECK_EQ(0, ReadChunked(nullptr, 0, producer));
+    CHECK_EQ(-1, ReadChunked(nullptr, 5, producer));
+    CHECK_EQ(0, producer.Calls);
+}
+
+BENCHMARK(LargePayload)
+{
+    // What a 256 MB payload cost before: the managed side copied it into a staging buffer and the native side
+    // copied that into the buffer it kept
+    size_t length = std::max<size_t>(BenchmarkIterations(256u << 20), 1u << 20);
+    std::vector<uint8_t> payload(length, 7);
+
+    auto staged = MeasureNs(1, [&]
+    {
+        auto staging = static_cast<uint8_t*>(malloc(length));
+        memcpy(staging, payload.data(), length);
+        auto destination = static_cast<uint8_t*>(malloc(length));
+        memcpy(destination, staging, length);
+        free(staging);
+        KeepAlive(destination[length - 1]);
+        free(destination);
+    });
+
+    auto chunked = MeasureNs(1, [&]
+    {
+        auto destination = static_cast<uint8_t*>(malloc(length));
+        size_t position = 0;
+        ReadChunked(destination, length, [&](void* chunk, size_t count)
+        {
+            memcpy(chunk, payload.data() + position, count);
+            position += count;
+            return static_cast<int64_t>(count);
+        });
+        KeepAlive(destination[length - 1]);
+        free(destination);
+    });
+
+    ReportBenchmark("staged copy, two buffers of the payload's size", staged / 1e6, "ms");
+    ReportBenchmark("chunked into the final buffer", chunked / 1e6, "ms");
+}
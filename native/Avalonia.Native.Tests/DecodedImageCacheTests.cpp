@@ -0,0 +1,173 @@
+#include "TestFramework.h"
+#include "DecodedImageCache.h"
+#include <memory>
+#include <random>
+#include <set>
+
+struct FakeImage
+{
+    std::vector<uint8_t> Pixels;
+};
+
+typedef std::shared_ptr<const FakeImage> Image;
+typedef DecodedImageCache<Image> Cache;
+
+static std::vector<uint8_t> RandomBytes(std::mt19937& random, size_t length)
+{
+    std::vector<uint8_t> bytes(length);
+    for (auto& byte : bytes)
+        byte = static_cast<uint8_t>(random());
+    return bytes;
+}
+
+// Stands in for decoding a PNG into a size x size image, touches every pixel
+static Image Decode(const std::vector<uint8_t>& png, int size, size_t& cost, int& decodes)
+{
+    decodes++;
+    auto image = std::make_shared<FakeImage>();
+    image->Pixels.resize(static_cast<size_t>(size) * size * 4);
+    uint32_t state = 0;
+    for (size_t c = 0; c < image->Pixels.size(); c++)
+    {
+        state = state * 31 + png[c % png.size()];
+        image->Pixels[c] = static_cast<uint8_t>(state);
+    }
+    cost = image->Pixels.size();
+    return image;
+}
+
+TEST(HashTellsLengthsAndBitFlipsApart)
+{
+    std::mt19937 random(3);
+    auto bytes = RandomBytes(random, 64);
+    std::set<uint64_t> hashes;
+    for (size_t length = 0; length <= 64; length++)
+        hashes.insert(HashImageBytes(bytes.data(), length));
+    CHECK_EQ(65u, hashes.size());
+
+    for (size_t bit = 0; bit < 64 * 8; bit++)
+    {
+        auto flipped = bytes;
+        flipped[bit / 8] ^= 1 << (bit % 8);
+        CHECK(HashImageBytes(flipped.data(), 64) != HashImageBytes(bytes.data(), 64));
+    }
+}
+
+TEST(EachImageIsDecodedOnce)
+{
+    std::mt19937 random(3);
+    auto a = RandomBytes(random, 300), b = RandomBytes(random, 300);
+    Cache cache(1 << 20);
+    int decodes = 0;
+    auto get = [&](std::vector<uint8_t>& png, int height, uint32_t variant)
+    {
+        return cache.GetOrDecode(png.data(), png.size(), 0, height, variant,
+                                 [&](size_t& cost) { return Decode(png, 16, cost, decodes); });
+    };
+
+    CHECK(get(a, 16, 0) == get(a, 16, 0));
+    CHECK_EQ(1, decodes);
+    // Another size, variant or content is another image
+    get(a, 18, 0);
+    get(a, 16, 1);
+    get(b, 16, 0);
+    CHECK_EQ(4, decodes);
+    CHECK_EQ(4u, cache.GetCount());
+    CHECK_EQ(4u * (16 * 16 * 4 + 300), cache.GetBytes());
+
+    std::vector<uint8_t> empty;
+    auto first = cache.GetOrDecode(empty.data(), 0, 0, 1, 0, [](size_t& cost) { cost = 1; return std::make_shared<FakeImage>(); });
+    auto second = cache.GetOrDecode(empty.data(), 0, 0, 1, 0, [](size_t& cost) { cost = 1; return std::make_shared<FakeImage>(); });
+    CHECK(first == second);
+}
+
+TEST(FailedAndOversizedImagesAreNotKept)
+{
+    std::mt19937 random(3);
+    auto png = RandomBytes(random, 300);
+    Cache cache(1 << 20);
+    int decodes = 0;
+    auto fail = [&](size_t&) { decodes++; return Image(); };
+    CHECK(cache.GetOrDecode(png.data(), png.size(), 0, 99, 0, fail) == nullptr);
+    cache.GetOrDecode(png.data(), png.size(), 0, 99, 0, fail);
+    CHECK_EQ(2, decodes);
+
+    // Handed out, but not kept
+    auto huge = cache.GetOrDecode(png.data(), png.size(), 0, 77, 0,
+                                  [](size_t& cost) { cost = 2 << 20; return std::make_shared<FakeImage>(); });
+    CHECK(huge != nullptr);
+    CHECK_EQ(0u, cache.GetCount());
+}
+
+TEST(LeastRecentlyUsedImagesAreDropped)
+{
+    std::mt19937 random(3);
+    std::vector<std::vector<uint8_t>> pngs;
+    for (int c = 0; c < 12; c++)
+        pngs.push_back(RandomBytes(random, 300));
+
+    // Room for 10 images
+    Cache cache(10 * (64 * 64 * 4 + 300));
+    int decodes = 0;
+    auto get = [&](int index)
+    {
+        cache.GetOrDecode(pngs[index].data(), 300, 0, 0, 0,
+                          [&](size_t& cost) { return Decode(pngs[index], 64, cost, decodes); });
+    };
+
+    for (int c = 0; c < 10; c++)
+        get(c);
+    CHECK_EQ(10, decodes);
+    get(0);
+    get(10);
+    CHECK_EQ(11, decodes);
+    CHECK_EQ(10u, cache.GetCount());
+    get(0);
+    CHECK_EQ(11, decodes);
+    // 1 was the least recently used one
+    get(1);
+    CHECK_EQ(12, decodes);
+}
+
+BENCHMARK(RepeatedIcons)
+{
+    // An app setting the same 20 menu icons (32x32 at 2x, 2 KB PNGs) again and again
+    std::mt19937 random(3);
+    std::vector<std::vector<uint8_t>> icons;
+    for (int c = 0; c < 20; c++)
+        icons.push_back(RandomBytes(random, 2048));
+
+    int decodes = 0;
+    size_t index = 0;
+    auto uncached = MeasureNs(BenchmarkIterations(2000), [&]
+    {
+        size_t cost;
+        KeepAlive(Decode(icons[index++ % icons.size()], 64, cost, decodes));
+    });
+
+    Cache cache(32 << 20);
+    decodes = 0;
+    auto cached = MeasureNs(BenchmarkIterations(2000), [&]
+    {
+        auto& png = icons[index++ % icons.size()];
+        KeepAlive(cache.GetOrDecode(png.data(), png.size(), 0, 16, 0,
+                                    [&](size_t& cost) { return Decode(png, 64, cost, decodes); }));
+    });
+
+    Cache misses(1 << 20);
+    auto missed = MeasureNs(BenchmarkIterations(2000), [&]
+    {
+        auto& png = icons[index++ % icons.size()];
+        png[0]++;
+        KeepAlive(misses.GetOrDecode(png.data(), png.size(), 0, 16, 0,
+                                     [&](size_t& cost) { return Decode(png, 64, cost, decodes); }));
+    });
+
+    std::vector<uint8_t> large(1 << 20);
+    auto hash = MeasureNs(BenchmarkIterations(100), [&] { KeepAlive(HashImageBytes(large.data(), large.size())); });
+
+    ReportBenchmark("decoding every time, per icon", uncached / 1000, "us");
+    ReportBenchmark("cached, per icon", cached / 1000, "us");
+    ReportBenchmark("cache misses only, per icon", missed / 1000, "us");
+    ReportBenchmark("hashing", (1 << 20) / hash, "GB/s");
+}
@@ -0,0 +1,122 @@
+#include "TestFramework.h"
+#include "DragSession.h"
+
+struct TraceEvent
+{
+    uint64_t TimeUs;
+    DragSessionInput Input;
+};
+
+// Shaped like what AppKit sends: 2 s of pointer movement at 120 Hz, 3 s of periodic updates every 50 ms while
+// the pointer rests and a modifier pressed at the end
+static std::vector<TraceEvent> RecordedTrace()
+{
+    std::vector<TraceEvent> trace;
+    uint64_t time = 1000000;
+    auto add = [&](double x, AvnInputModifiers modifiers, uint64_t step)
+    {
+        trace.push_back({ time, { { x, 200 }, modifiers, static_cast<AvnDragDropEffects>(7) } });
+        time += step;
+    };
+
+    for (int c = 0; c < 240; c++)
+        add(100.0 + c * 2, static_cast<AvnInputModifiers>(0), 8333);
+    for (int c = 0; c < 60; c++)
+        add(578, static_cast<AvnInputModifiers>(0), 50000);
+    for (int c = 0; c < 10; c++)
+        add(578, c < 5 ? static_cast<AvnInputModifiers>(0) : Shift, 50000);
+    return trace;
+}
+
+// The drop target only accepts the left part of the view, and only without a modifier
+static AvnDragDropEffects DropTarget(const DragSessionInput& input)
+{
+    return input.Position.X < 500 && input.Modifiers == 0 ? AvnDragDropEffects::Copy : AvnDragDropEffects::None;
+}
+
+struct ReplayResult
+{
+    int Dispatched;
+    AvnDragDropEffects Last;
+};
+
+static ReplayResult Replay(DragSession& session, const std::vector<TraceEvent>& trace)
+{
+    session.Begin(1);
+    ReplayResult result { 1, DropTarget(trace[0].Input) };
+    session.SetResult(trace[0].Input, trace[0].TimeUs, result.Last);
+
+    for (size_t c = 1; c < trace.size(); c++)
+    {
+        if (session.TryReuseOver(trace[c].Input, trace[c].TimeUs, result.Last))
+            continue;
+        result.Last = DropTarget(trace[c].Input);
+        session.SetResult(trace[c].Input, trace[c].TimeUs, result.Last);
+        result.Dispatched++;
+    }
+    session.End();
+    return result;
+}
+
+TEST(SequencesIdentifySessions)
+{
+    DragSession session;
+    CHECK(!session.IsActive());
+    session.Begin(42);
+    CHECK(session.IsSequence(42));
+    CHECK(!session.IsSequence(43));
+    session.End();
+    CHECK(!session.IsSequence(42));
+}
+
+TEST(ChangedInputIsDispatchedOncePerFrame)
+{
+    DragSession session;
+    session.Begin(1);
+    DragSessionInput input { { 1, 1 }, static_cast<AvnInputModifiers>(0), AvnDragDropEffects::Copy };
+    AvnDragDropEffects result;
+    CHECK(!session.TryReuseOver(input, 10, result));
+    session.SetResult(input, 10, AvnDragDropEffects::Move);
+
+    auto moved = input;
+    moved.Position.X = 2;
+    CHECK(session.TryReuseOver(moved, 10 + 16000, result));
+    CHECK(result == AvnDragDropEffects::Move);
+    CHECK(!session.TryReuseOver(moved, 10 + 16667, result));
+}
+
+TEST(UnchangedInputIsReusedForAWhile)
+{
+    DragSession session;
+    session.Begin(1);
+    DragSessionInput input { { 1, 1 }, static_cast<AvnInputModifiers>(0), AvnDragDropEffects::Copy };
+    AvnDragDropEffects result;
+    session.SetResult(input, 10, AvnDragDropEffects::Move);
+    CHECK(session.TryReuseOver(input, 100000, result));
+    CHECK(!session.TryReuseOver(input, 10 + 250000, result));
+    // A clock going backwards never reuses
+    CHECK(!session.TryReuseOver(input, 5, result));
+
+    session.End();
+    CHECK(!session.TryReuseOver(input, 20, result));
+}
+
+TEST(RecordedTraceEndsWithTheLatestAnswer)
+{
+    auto trace = RecordedTrace();
+    DragSession session;
+    auto replayed = Replay(session, trace);
+    CHECK(replayed.Last == AvnDragDropEffects::None);
+    CHECK(replayed.Dispatched < static_cast<int>(trace.size()) / 2);
+    CHECK(!session.IsActive());
+}
+
+BENCHMARK(DispatchedOverEvents)
+{
+    auto trace = RecordedTrace();
+    DragSession throttled;
+    DragSession unthrottled(0, 0);
+    ReportBenchmark("draggingUpdated: calls in the trace", static_cast<double>(trace.size()), "events");
+    ReportBenchmark("dispatched without the session", Replay(unthrottled, trace).Dispatched, "events");
+    ReportBenchmark("dispatched with the session", Replay(throttled, trace).Dispatched, "events");
+}
@@ -0,0 +1,41 @@
+#!/usr/bin/env python3
+# Writes the enums and structs declared in avn.idl as a C++ header for the native tests. The real
+# avalonia-native.h is generated by the MicroCom code generator (nukebuild GenerateCppHeaders), the portable
+# headers under test only need the plain types from it and not the COM interfaces.
+
+import re
+import sys
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: GenerateIdlTypes.py <avn.idl> <avalonia-native.h>")
+
+    with open(sys.argv[1], encoding="utf-8") as f:
+        idl = f.read()
+
+    lines = [
+        "// Generated from avn.idl by GenerateIdlTypes.py, do not edit.",
+        "#pragma once",
+        "#include \"com.h\"",
+        "#include <cstddef>",
+        "#include <cstdint>",
+        "",
+        "// MicroCom spells unsigned char this way",
+        "typedef unsigned char byte;",
+        "",
+    ]
+
+    for match in re.finditer(r"\n(\[class-enum\]\s*)?(enum|struct) (\w+)\s*\{[^}]*\}", idl):
+        declaration = match.group(0).strip()
+        if match.group(1):
+            declaration = declaration.replace("[class-enum]", "", 1).strip().replace("enum ", "enum class ", 1)
+        lines.append(declaration + ";")
+        lines.append("")
+
+    with open(sys.argv[2], "w", encoding="utf-8") as f:
+        f.write("\n".join(lines))
+
+
+if __name__ == "__main__":
+    main()
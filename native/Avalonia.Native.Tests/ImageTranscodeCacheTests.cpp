@@ -0,0 +1,88 @@
+#include "TestFramework.h"
+#include "ImageTranscodeCache.h"
+#include <chrono>
+#include <thread>
+
+// A decode and encode takes around 20 ms for a screenshot sized image
+static ImageTranscodeCache::Result Transcode(int value, int milliseconds = 20)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+    auto image = TranscodedImage::CreatePixels(64, 64);
+    image->Bytes[0] = static_cast<uint8_t>(value);
+    return ImageTranscodeCache::Result(std::move(image));
+}
+
+TEST(PixelBufferSizes)
+{
+    CHECK(TranscodedImage::CreatePixels(0, 5) == nullptr);
+    CHECK(TranscodedImage::CreatePixels(70000, 70000) == nullptr);
+    auto image = TranscodedImage::CreatePixels(3, 2);
+    CHECK_EQ(12, image->RowBytes);
+    CHECK_EQ(24u, image->Bytes.size());
+    CHECK(image->IsPixels());
+}
+
+TEST(RepeatedRequestsTranscodeOnce)
+{
+    ImageTranscodeCache cache;
+    int calls = 0;
+    for (int c = 0; c < 8; c++)
+    {
+        auto image = cache.Get({ 1, 0, "public.png", true }, [&] { calls++; return Transcode(5, 0); });
+        CHECK(image != nullptr && image->Bytes[0] == 5);
+    }
+    CHECK_EQ(1, calls);
+
+    ImageTranscodeCache::Result cached;
+    CHECK(cache.TryGet({ 1, 0, "public.png", true }, cached));
+    CHECK(cached != nullptr && cached->Bytes[0] == 5);
+    CHECK(!cache.TryGet({ 1, 0, "public.png", false }, cached));
+    CHECK(!cache.TryGet({ 2, 0, "public.png", true }, cached));
+}
+
+TEST(FailuresAreCached)
+{
+    ImageTranscodeCache cache;
+    int calls = 0;
+    CHECK(cache.Get({ 1, 1, "x", false }, [&] { calls++; return ImageTranscodeCache::Result(); }) == nullptr);
+    CHECK(cache.Get({ 1, 2, "x", false }, [&]() -> ImageTranscodeCache::Result { calls++; throw 1; }) == nullptr);
+    CHECK(cache.Get({ 1, 1, "x", false }, [&] { calls++; return ImageTranscodeCache::Result(); }) == nullptr);
+    CHECK(cache.Get({ 1, 2, "x", false }, [&] { calls++; return ImageTranscodeCache::Result(); }) == nullptr);
+    CHECK_EQ(2, calls);
+}
+
+TEST(NewChangeCountDropsEverything)
+{
+    ImageTranscodeCache cache(4);
+    cache.Get({ 1, 0, "public.png", true }, [] { return Transcode(1, 0); });
+    cache.Get({ 2, 0, "public.png", true }, [] { return Transcode(2, 0); });
+    CHECK_EQ(1u, cache.GetCount());
+
+    ImageTranscodeCache::Result cached;
+    CHECK(!cache.TryGet({ 1, 0, "public.png", true }, cached));
+
+    for (int c = 0; c < 10; c++)
+        cache.Get({ 2, c + 1, "public.png", false }, [c] { return Transcode(c, 0); });
+    CHECK(cache.GetCount() <= 4);
+}
+
+BENCHMARK(RepeatedRequests)
+{
+    // 10 rounds of requests for the same 4 images, a paste handler asking for every format of every item
+    auto run = [&](bool cached)
+    {
+        ImageTranscodeCache cache;
+        return MeasureNs(1, [&]
+        {
+            for (int round = 0; round < 10; round++)
+                for (int c = 0; c < 4; c++)
+                {
+                    ImageTranscodeKey key { cached ? 1 : round + 1, c, "public.png", false };
+                    KeepAlive(cache.Get(key, [c] { return Transcode(c); }));
+                }
+        });
+    };
+
+    ReportBenchmark("40 requests, transcoded every time", run(false) / 1e6, "ms");
+    ReportBenchmark("40 requests, cached", run(true) / 1e6, "ms");
+}
@@ -0,0 +1,270 @@
+#include "TestFramework.h"
+#include "ImportCache.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+
+namespace
+{
+    struct Key
+    {
+        uint32_t Surface;
+        int Format;
+
+        bool operator==(const Key& other) const
+        {
+            return Surface == other.Surface && Format == other.Format;
+        }
+    };
+
+    std::atomic<int> s_textures { 0 };
+
+    // Stands in for a texture wrapping an IOSurface, the backing store is what creating one costs
+    struct Texture
+    {
+        uint32_t Surface;
+        std::vector<char> Descriptor;
+
+        explicit Texture(uint32_t surface) : Surface(surface), Descriptor(256)
+        {
+            s_textures++;
+        }
+
+        ~Texture()
+        {
+            s_textures--;
+        }
+    };
+
+    typedef std::shared_ptr<Texture> TexturePtr;
+
+    struct FakeDevice
+    {
+        ImportCache<Key, TexturePtr> Cache;
+        std::atomic<int> Imports { 0 };
+
+        explicit FakeDevice(size_t capacity = 4, uint64_t maxIdleUs = 1000) : Cache(capacity, maxIdleUs)
+        {
+        }
+
+        TexturePtr Import(uint32_t surface, int format, uint64_t nowUs)
+        {
+            TexturePtr texture;
+            if (Cache.TryGet(Key { surface, format }, nowUs, [](const TexturePtr&) { return true; }, texture))
+                return texture;
+
+            Imports++;
+            texture = std::make_shared<Texture>(surface);
+            Cache.Add(Key { surface, format }, texture, nowUs);
+            return texture;
+        }
+    };
+
+    bool Alive(int)
+    {
+        return true;
+    }
+}
+
+TEST(ARingOfSurfacesIsImportedOnce)
+{
+    FakeDevice device;
+    uint64_t now = 0;
+    // A video player cycling through 3 surfaces for 300 frames
+    for (int frame = 0; frame < 300; frame++)
+    {
+        now += 16;
+        auto texture = device.Import(static_cast<uint32_t>(frame % 3 + 1), 0, now);
+        CHECK_EQ(static_cast<uint32_t>(frame % 3 + 1), texture->Surface);
+    }
+
+    auto stats = device.Cache.GetStats();
+    CHECK_EQ(3, device.Imports.load());
+    CHECK_EQ(297u, stats.Hits);
+    CHECK_EQ(3u, stats.Misses);
+    CHECK_EQ(3u, stats.Count);
+    CHECK_EQ(3, s_textures.load());
+
+    // Another pixel format is another import
+    device.Import(1, 1, now);
+    CHECK_EQ(4, device.Imports.load());
+    device.Cache.Clear();
+    CHECK_EQ(0, s_textures.load());
+}
+
+TEST(ImportsDisposedEveryFrameStayCached)
+{
+    // What the managed side does: each frame imports the next surface of the ring and disposes the import of the
+    // previous frame, while the device's timer trims the cache once a second
+    FakeDevice device(16, 2000000);
+    uint64_t now = 0, nextTrimUs = 1000000;
+    TexturePtr previous;
+    for (int frame = 0; frame < 600; frame++)
+    {
+        now += 16667;
+        auto texture = device.Import(static_cast<uint32_t>(frame % 3 + 1), 0, now);
+        previous = std::move(texture);
+        if (now >= nextTrimUs)
+        {
+            CHECK_EQ(0u, device.Cache.Trim(now));
+            nextTrimUs += 1000000;
+        }
+    }
+
+    CHECK_EQ(3, device.Imports.load());
+    CHECK_EQ(597u, device.Cache.GetStats().Hits);
+
+    // Playback stopped, the last frame's import is disposed and the idle surfaces go with the next trims
+    previous = nullptr;
+    CHECK_EQ(3, s_textures.load());
+    CHECK_EQ(3u, device.Cache.Trim(now + 2000001));
+    CHECK_EQ(0, s_textures.load());
+}
+
+TEST(TheOneUsedLongestAgoMakesRoom)
+{
+    FakeDevice device;
+    device.Import(1, 0, 10);
+    device.Import(2, 0, 20);
+    device.Import(3, 0, 30);
+    device.Import(4, 0, 40);
+    device.Import(1, 0, 50);
+
+    device.Import(5, 0, 60);
+    auto stats = device.Cache.GetStats();
+    CHECK_EQ(4u, stats.Count);
+    CHECK_EQ(1u, stats.Evictions);
+
+    // Surface 2 was dropped, surface 1 wasn't
+    device.Import(1, 0, 70);
+    CHECK_EQ(5, device.Imports.load());
+    device.Import(2, 0, 80);
+    CHECK_EQ(6, device.Imports.load());
+    device.Cache.Clear();
+}
+
+TEST(IdleImportsAreTrimmed)
+{
+    FakeDevice device;
+    device.Import(1, 0, 0);
+    device.Import(2, 0, 900);
+    // Trimming is what the timer does when no import comes
+    CHECK_EQ(0u, device.Cache.Trim(1000));
+    CHECK_EQ(1u, device.Cache.Trim(1500));
+    CHECK_EQ(1, s_textures.load());
+
+    // An import trims on its own as well
+    device.Import(3, 0, 5000);
+    CHECK_EQ(1u, device.Cache.GetStats().Count);
+    // A clock that went backwards doesn't trim anything
+    CHECK_EQ(0u, device.Cache.Trim(10));
+    device.Cache.Clear();
+}
+
+TEST(EvictingASurfaceKeepsTheOthers)
+{
+    FakeDevice device;
+    device.Import(1, 0, 0);
+    device.Import(1, 1, 0);
+    device.Import(2, 0, 0);
+    CHECK_EQ(2u, device.Cache.EvictIf([](const Key& key, const TexturePtr&) { return key.Surface == 1; }));
+    CHECK_EQ(1, s_textures.load());
+    CHECK_EQ(0u, device.Cache.EvictIf([](const Key& key, const TexturePtr&) { return key.Surface == 7; }));
+    CHECK_EQ(1u, device.Cache.Clear());
+    CHECK_EQ(0, s_textures.load());
+
+    // Textures still in use outlive their eviction
+    auto texture = device.Import(3, 0, 0);
+    device.Cache.Clear();
+    CHECK_EQ(1, s_textures.load());
+    texture = nullptr;
+    CHECK_EQ(0, s_textures.load());
+}
+
+TEST(ImportsThatNoLongerBelongToTheirKeyAreReplaced)
+{
+    // An event at an address that was freed and taken by a new one
+    ImportCache<int, int> cache(4, 1000000);
+    int value = 0;
+    cache.Add(7, 70, 0);
+    CHECK(cache.TryGet(7, 1, Alive, value));
+    CHECK_EQ(70, value);
+    CHECK(!cache.TryGet(7, 2, [](int) { return false; }, value));
+    CHECK_EQ(0u, cache.GetStats().Count);
+
+    cache.Add(7, 71, 3);
+    cache.Add(7, 72, 4);
+    CHECK(cache.TryGet(7, 5, Alive, value));
+    CHECK_EQ(72, value);
+    CHECK_EQ(1u, cache.GetStats().Count);
+
+    // A capacity of 0 turns the cache off
+    ImportCache<int, int> off(0);
+    off.Add(1, 1, 0);
+    CHECK(!off.TryGet(1, 0, Alive, value));
+}
+
+TEST(ConcurrentImportsAndTrims)
+{
+    FakeDevice device(8, 50);
+    std::atomic<bool> running { true };
+    std::atomic<uint64_t> now { 0 };
+    std::thread trimmer([&]
+    {
+        while (running)
+            device.Cache.Trim(now);
+    });
+
+    std::atomic<int> mismatches { 0 };
+    std::vector<std::thread> importers;
+    for (int t = 0; t < 4; t++)
+        importers.emplace_back([&, t]
+        {
+            for (int c = 0; c < 20000; c++)
+            {
+                auto surface = static_cast<uint32_t>((c + t) % 12);
+                if (device.Import(surface, 0, now++)->Surface != surface)
+                    mismatches++;
+            }
+        });
+    for (auto& importer : importers)
+        importer.join();
+    running = false;
+    trimmer.join();
+
+    CHECK_EQ(0, mismatches.load());
+    auto stats = device.Cache.GetStats();
+    CHECK_EQ(80000u, stats.Hits + stats.Misses);
+    CHECK(stats.Count <= 8u);
+    device.Cache.Clear();
+    CHECK_EQ(0, s_textures.load());
+}
+
+BENCHMARK(ImportingAVideoRing)
+{
+    // A ring of 3 surfaces imported once per frame, creating a texture every time against the cache
+    auto frames = BenchmarkIterations(1000000);
+    uint32_t frame = 0;
+    auto uncached = MeasureNs(frames, [&]
+    {
+        KeepAlive(std::make_shared<Texture>(frame++ % 3));
+    });
+
+    FakeDevice device(16, 2000000);
+    uint64_t now = 0;
+    frame = 0;
+    auto cached = MeasureNs(frames, [&]
+    {
+        now += 16;
+        KeepAlive(device.Import(frame++ % 3, 0, now));
+    });
+
+    auto trim = MeasureNs(BenchmarkIterations(1000000), [&] { KeepAlive(device.Cache.Trim(now)); });
+
+    ReportBenchmark("creating a texture every frame", uncached, "ns");
+    ReportBenchmark("importing through the cache", cached, "ns");
+    ReportBenchmark("textures created without the cache", static_cast<double>(frames), "textures");
+    ReportBenchmark("textures created with the cache", static_cast<double>(device.Imports.load()), "textures");
+    ReportBenchmark("timer trim of a warm cache", trim, "ns");
+    device.Cache.Clear();
+}
@@ -0,0 +1,166 @@
+#include "TestFramework.h"
+#include "InputLatencyTracer.h"
+
+static int s_surfaceA;
+static int s_surfaceB;
+
+TEST(DisabledTracerIgnoresInput)
+{
+    InputLatencyTracer tracer;
+    CHECK_EQ(0u, tracer.InputReceived(&s_surfaceA, AvnInputLatencyEventKindKey, 100));
+    CHECK_EQ(0u, tracer.FrameBegan(&s_surfaceA, 200));
+    CHECK_EQ(0, tracer.GetStats(AvnInputLatencyEventKindKey).SampleCount);
+}
+
+TEST(FrameReflectsInputsDispatchedBeforeIt)
+{
+    InputLatencyTracer tracer;
+    tracer.SetEnabled(true);
+    auto first = tracer.InputReceived(&s_surfaceA, AvnInputLatencyEventKindKey, 1000);
+    auto second = tracer.InputReceived(&s_surfaceA, AvnInputLatencyEventKindKey, 1000);
+    tracer.InputDispatched(first, 1500);
+    tracer.InputDispatched(second, 1500);
+
+    // Began before the handlers returned, it can't show them
+    CHECK_EQ(0u, tracer.FrameBegan(&s_surfaceA, 1400));
+
+    auto frame = tracer.FrameBegan(&s_surfaceA, 3000);
+    CHECK(frame != 0);
+    tracer.FramePresented(frame, 5000);
+
+    auto stats = tracer.GetStats(AvnInputLatencyEventKindKey);
+    CHECK_EQ(2, stats.SampleCount);
+    CHECK_EQ(4000u, stats.P50Us);
+    CHECK_EQ(500u, stats.DispatchP50Us);
+    CHECK_EQ(2000u, stats.RenderP50Us);
+}
+
+TEST(AbandonedFrameHandsInputsToTheNextOne)
+{
+    InputLatencyTracer tracer;
+    tracer.SetEnabled(true);
+    auto input = tracer.InputReceived(&s_surfaceA, AvnInputLatencyEventKindMouseButton, 1000);
+    tracer.InputDispatched(input, 1100);
+
+    auto dropped = tracer.FrameBegan(&s_surfaceA, 2000);
+    tracer.FrameAbandoned(dropped);
+    tracer.FramePresented(dropped, 2500);
+    CHECK_EQ(0, tracer.GetStats(AvnInputLatencyEventKindMouseButton).SampleCount);
+
+    auto frame = tracer.FrameBegan(&s_surfaceA, 3000);
+    tracer.FramePresented(frame, 4000);
+    auto stats = tracer.GetStats(AvnInputLatencyEventKindMouseButton);
+    CHECK_EQ(1, stats.SampleCount);
+    CHECK_EQ(3000u, stats.P50Us);
+}
+
+TEST(SurfacesAreAttributedSeparately)
+{
+    InputLatencyTracer tracer;
+    tracer.SetEnabled(true);
+    auto a = tracer.InputReceived(&s_surfaceA, AvnInputLatencyEventKindKey, 1000);
+    auto b = tracer.InputReceived(&s_surfaceB, AvnInputLatencyEventKindKey, 1000);
+    tracer.InputDispatched(a, 1100);
+    tracer.InputDispatched(b, 1100);
+
+    tracer.FramePresented(tracer.FrameBegan(&s_surfaceA, 2000), 3000);
+    CHECK_EQ(1, tracer.GetStats(AvnInputLatencyEventKindKey).SampleCount);
+
+    tracer.FramePresented(tracer.FrameBegan(&s_surfaceB, 5000), 9000);
+    auto stats = tracer.GetStats(AvnInputLatencyEventKindKey);
+    CHECK_EQ(2, stats.SampleCount);
+    CHECK_EQ(8000u, stats.MaxUs);
+}
+
+TEST(SyntheticTimelinePercentiles)
+{
+    InputLatencyTracer tracer;
+    tracer.SetEnabled(true);
+    // 100 moves, the k-th one takes k * 100us to render after a 200us head start
+    for (uint64_t k = 1; k <= 100; k++)
+    {
+        auto input = tracer.InputReceived(&s_surfaceA, AvnInputLatencyEventKindMouseMove, k * 10000);
+        tracer.InputDispatched(input, k * 10000 + 100);
+        auto frame = tracer.FrameBegan(&s_surfaceA, k * 10000 + 200);
+        tracer.FramePresented(frame, k * 10000 + 200 + k * 100);
+    }
+
+    auto stats = tracer.GetStats(AvnInputLatencyEventKindMouseMove);
+    CHECK_EQ(100, stats.SampleCount);
+    CHECK_EQ(200u + 5000, stats.P50Us);
+    CHECK_EQ(200u + 9000, stats.P90Us);
+    CHECK_EQ(200u + 9900, stats.P99Us);
+    CHECK_EQ(10200u, stats.MaxUs);
+    CHECK_EQ(100u, stats.DispatchP50Us);
+
+    tracer.Reset();
+    CHECK_EQ(0, tracer.GetStats(AvnInputLatencyEventKindMouseMove).SampleCount);
+}
+
+TEST(PendingInputsAndSamplesAreBounded)
+{
+    InputLatencyTracer tracer(8, 4);
+    tracer.SetEnabled(true);
+    std::vector<uint64_t> tokens;
+    for (int c = 0; c < 10; c++)
+        tokens.push_back(tracer.InputReceived(&s_surfaceA, AvnInputLatencyEventKindKey, 100));
+    for (auto token : tokens)
+        tracer.InputDispatched(token, 200);
+    tracer.FramePresented(tracer.FrameBegan(&s_surfaceA, 300), 400);
+    // Only the newest four were still pending
+    CHECK_EQ(4, tracer.GetStats(AvnInputLatencyEventKindKey).SampleCount);
+
+    for (int c = 0; c < 20; c++)
+    {
+        auto token = tracer.InputReceived(&s_surfaceA, AvnInputLatencyEventKindKey, 1000);
+        tracer.InputDispatched(token, 1100);
+        tracer.FramePresented(tracer.FrameBegan(&s_surfaceA, 1200), 1300);
+    }
+    CHECK_EQ(8, tracer.GetStats(AvnInputLatencyEventKindKey).SampleCount);
+}
+
+TEST(DisablingDropsPendingWork)
+{
+    InputLatencyTracer tracer;
+    tracer.SetEnabled(true);
+    auto input = tracer.InputReceived(&s_surfaceA, AvnInputLatencyEventKindKey, 100);
+    tracer.InputDispatched(input, 200);
+    tracer.SetEnabled(false);
+    tracer.SetEnabled(true);
+    CHECK_EQ(0u, tracer.FrameBegan(&s_surfaceA, 300));
+}
+
+TEST(NearestRankPercentile)
+{
+    std::vector<uint64_t> empty;
+    CHECK_EQ(0u, InputLatencyTracer::Percentile(empty, 50));
+    std::vector<uint64_t> values { 5, 1, 4, 2, 3 };
+    CHECK_EQ(3u, InputLatencyTracer::Percentile(values, 50));
+    CHECK_EQ(5u, InputLatencyTracer::Percentile(values, 99));
+    CHECK_EQ(1u, InputLatencyTracer::Percentile(values, 0));
+}
+
+BENCHMARK(CostPerTracedInput)
+{
+    InputLatencyTracer tracer;
+    auto iterations = BenchmarkIterations(2000000);
+    uint64_t now = 0;
+
+    auto disabled = MeasureNs(iterations, [&]
+    {
+        auto input = tracer.InputReceived(&s_surfaceA, AvnInputLatencyEventKindMouseMove, ++now);
+        tracer.InputDispatched(input, ++now);
+    });
+
+    tracer.SetEnabled(true);
+    auto enabled = MeasureNs(iterations, [&]
+    {
+        auto input = tracer.InputReceived(&s_surfaceA, AvnInputLatencyEventKindMouseMove, ++now);
+        tracer.InputDispatched(input, ++now);
+        auto frame = tracer.FrameBegan(&s_surfaceA, ++now);
+        tracer.FramePresented(frame, ++now);
+    });
+
+    ReportBenchmark("tracing disabled, per input", disabled, "ns");
+    ReportBenchmark("tracing enabled, per input and frame", enabled, "ns");
+}
@@ -0,0 +1,114 @@
+#include "TestFramework.h"
+#include "KeyTransformTables.h"
+#include <unordered_map>
+
+// What the tables replaced: searching the source arrays
+static AvnPhysicalKey FindPhysicalKey(uint16_t scanCode)
+{
+    for (auto& keyInfo : keyInfos)
+        if (keyInfo.scanCode == scanCode)
+            return keyInfo.physicalKey;
+    return AvnPhysicalKeyNone;
+}
+
+static AvnKey FindVirtualKey(uint16_t character)
+{
+    for (auto& charKeyInfo : charKeyInfos)
+        if (charKeyInfo.character == character)
+            return charKeyInfo.key;
+    return AvnKeyNone;
+}
+
+TEST(KnownKeys)
+{
+    CHECK_EQ(AvnPhysicalKeyA, LookupPhysicalKeyFromScanCode(0x00));
+    CHECK_EQ(AvnKeyEnter, LookupQwertyVirtualKey(AvnPhysicalKeyNumPadEnter));
+    CHECK_EQ(0x0D, LookupMenuCharFromVirtualKey(AvnKeyEnter));
+    CHECK_EQ(AvnKeyQ, LookupVirtualKeyFromChar('q'));
+    CHECK_EQ(AvnKeyHelp, LookupVirtualKeyFromChar(AvnFunctionKeyHelp));
+    CHECK_EQ(AvnKeyF24, LookupVirtualKeyFromChar(AvnFunctionKeyF(24)));
+}
+
+TEST(UnmappedAndOutOfRangeValues)
+{
+    CHECK_EQ(AvnPhysicalKeyNone, LookupPhysicalKeyFromScanCode(0x7F));
+    CHECK_EQ(AvnPhysicalKeyNone, LookupPhysicalKeyFromScanCode(0xFFFF));
+    CHECK_EQ(AvnKeyNone, LookupQwertyVirtualKey(static_cast<AvnPhysicalKey>(PhysicalKeyTableSize + 10)));
+    CHECK_EQ(0, LookupMenuCharFromVirtualKey(AvnKeyFnDownArrow));
+    CHECK_EQ(0, LookupMenuCharFromVirtualKey(static_cast<AvnKey>(MenuCharTableSize + 10)));
+    CHECK_EQ(AvnKeyNone, LookupVirtualKeyFromChar(0x00E9));
+    CHECK_EQ(AvnKeyNone, LookupVirtualKeyFromChar(FunctionKeyCharLast + 1));
+}
+
+TEST(EveryScanCodeMatchesKeyInfos)
+{
+    for (uint32_t scanCode = 0; scanCode <= 0xFFFF; scanCode++)
+        CHECK_EQ(FindPhysicalKey(static_cast<uint16_t>(scanCode)),
+                 LookupPhysicalKeyFromScanCode(static_cast<uint16_t>(scanCode)));
+}
+
+TEST(EveryCharacterMatchesCharKeyInfos)
+{
+    for (uint32_t character = 0; character <= 0xFFFF; character++)
+        CHECK_EQ(FindVirtualKey(static_cast<uint16_t>(character)),
+                 LookupVirtualKeyFromChar(static_cast<uint16_t>(character)));
+}
+
+TEST(MenuCharsFollowTheLastKeyInfo)
+{
+    for (auto& keyInfo : keyInfos)
+    {
+        uint16_t expected = 0;
+        for (auto& other : keyInfos)
+            if (other.qwertyKey == keyInfo.qwertyKey && other.menuChar != 0)
+                expected = other.menuChar;
+        CHECK_EQ(expected, LookupMenuCharFromVirtualKey(keyInfo.qwertyKey));
+    }
+}
+
+BENCHMARK(LookupAgainstHashMaps)
+{
+    // The unordered_maps KeyTransform.mm used to build at load time
+    std::unordered_map<int, AvnPhysicalKey> physicalKeys;
+    std::unordered_map<int, AvnKey> virtualKeys;
+    for (auto& keyInfo : keyInfos)
+        physicalKeys[keyInfo.scanCode] = keyInfo.physicalKey;
+    for (auto& charKeyInfo : charKeyInfos)
+        virtualKeys[charKeyInfo.character] = charKeyInfo.key;
+
+    auto iterations = BenchmarkIterations(20000000);
+    uint32_t input = 0;
+    uint32_t sum = 0;
+    auto dense = MeasureNs(iterations, [&]
+    {
+        input = input * 1103515245 + 12345;
+        sum += LookupPhysicalKeyFromScanCode((input >> 16) & 0x7F);
+        sum += LookupVirtualKeyFromChar((input >> 8) & 0x7F);
+    });
+    auto hashed = MeasureNs(iterations, [&]
+    {
+        input = input * 1103515245 + 12345;
+        auto physicalKey = physicalKeys.find((input >> 16) & 0x7F);
+        sum += physicalKey != physicalKeys.end() ? physicalKey->second : 0;
+        auto virtualKey = virtualKeys.find((input >> 8) & 0x7F);
+        sum += virtualKey != virtualKeys.end() ? virtualKey->second : 0;
+    });
+    KeepAlive(sum);
+
+    // What every process paid at load time before the first key was pressed
+    auto building = MeasureNs(BenchmarkIterations(20000), [&]
+    {
+        std::unordered_map<int, AvnPhysicalKey> physicalKeys;
+        std::unordered_map<int, AvnKey> virtualKeys;
+        for (auto& keyInfo : keyInfos)
+            physicalKeys[keyInfo.scanCode] = keyInfo.physicalKey;
+        for (auto& charKeyInfo : charKeyInfos)
+            virtualKeys[charKeyInfo.character] = charKeyInfo.key;
+        KeepAlive(physicalKeys);
+        KeepAlive(virtualKeys);
+    });
+
+    ReportBenchmark("building the hash maps at load time", building, "ns");
+    ReportBenchmark("constexpr tables, scan code + char lookup", dense, "ns");
+    ReportBenchmark("unordered_map, scan code + char lookup", hashed, "ns");
+}
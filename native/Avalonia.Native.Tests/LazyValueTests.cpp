@@ -0,0 +1,140 @@
+#include "TestFramework.h"
+#include "LazyValue.h"
+#include "StartupTracer.h"
+#include <memory>
+#include <thread>
+
+namespace
+{
+    std::atomic<int> s_alive { 0 };
+
+    // Stands in for a cursor, a menu or anything else the platform used to create up front
+    struct Resource
+    {
+        std::string Data;
+
+        Resource() : Data(64, 'x')
+        {
+            s_alive++;
+        }
+
+        ~Resource()
+        {
+            s_alive--;
+        }
+    };
+
+    uint64_t s_now = 0;
+
+    uint64_t FakeClock()
+    {
+        return s_now;
+    }
+
+    uint64_t SteadyClock()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+}
+
+TEST(CreatedOnceOnFirstUse)
+{
+    {
+        LazyValue<std::unique_ptr<Resource>> value;
+        CHECK(!value.IsCreated());
+
+        std::vector<std::thread> threads;
+        std::atomic<Resource*> seen[8];
+        for (int t = 0; t < 8; t++)
+            threads.emplace_back([&, t] { seen[t] = value.Get([] { return std::make_unique<Resource>(); }).get(); });
+        for (auto& thread : threads)
+            thread.join();
+
+        CHECK(value.IsCreated());
+        CHECK_EQ(1, s_alive.load());
+        for (int t = 1; t < 8; t++)
+            CHECK(seen[t].load() == seen[0].load());
+    }
+    CHECK_EQ(0, s_alive.load());
+
+    // Never used, never created
+    {
+        LazyValue<Resource> unused;
+    }
+    CHECK_EQ(0, s_alive.load());
+}
+
+TEST(TracerRecordsStepsUntilTheFirstFrame)
+{
+    s_now = 0;
+    StartupTracer tracer(FakeClock);
+    {
+        // Not recording yet
+        StartupTraceScope scope(tracer, "Before");
+    }
+    s_now = 100;
+    tracer.Begin();
+    // Beginning again keeps the first start
+    s_now = 150;
+    tracer.Begin();
+    {
+        s_now = 200;
+        StartupTraceScope scope(tracer, "Initialize");
+        s_now = 1200;
+    }
+    tracer.AddStep("Cursor \"x\"", 1300, 1350);
+    s_now = 5000;
+    tracer.Complete("FirstPaint", 4000, 5000);
+
+    // Nothing is recorded after the first frame
+    tracer.AddStep("Late", 6000, 7000);
+    tracer.Complete("Again", 7000, 8000);
+
+    auto steps = tracer.GetSteps();
+    CHECK_EQ(3u, steps.size());
+    CHECK_EQ(100u, steps[0].StartUs);
+    CHECK_EQ(1000u, steps[0].DurationUs);
+    CHECK_EQ(3900u, steps[2].StartUs);
+    CHECK_EQ(4900u, tracer.GetTotalUs());
+    CHECK(tracer.IsComplete());
+
+    auto trace = tracer.ExportTrace();
+    CHECK(trace.find("Cursor \\\"x\\\"") != std::string::npos);
+    CHECK(trace.find("Before") == std::string::npos);
+}
+
+BENCHMARK(EagerAgainstLazyCreation)
+{
+    // 16 platform objects created up front, of which a typical application uses 3
+    auto iterations = BenchmarkIterations(20000);
+    auto eager = MeasureNs(iterations, [&]
+    {
+        std::vector<std::unique_ptr<Resource>> resources;
+        for (int c = 0; c < 16; c++)
+            resources.push_back(std::make_unique<Resource>());
+        KeepAlive(resources);
+    });
+    auto lazy = MeasureNs(iterations, [&]
+    {
+        LazyValue<std::unique_ptr<Resource>> resources[16];
+        for (int c = 0; c < 3; c++)
+            KeepAlive(resources[c].Get([] { return std::make_unique<Resource>(); }));
+    });
+
+    LazyValue<int> created;
+    created.Get([] { return 1; });
+    int sum = 0;
+    auto get = MeasureNs(BenchmarkIterations(10000000), [&] { sum += created.Get([] { return 1; }); });
+    KeepAlive(sum);
+
+    StartupTracer tracer(SteadyClock);
+    tracer.Begin();
+    tracer.Complete("FirstPaint", 0, 0);
+    auto scope = MeasureNs(BenchmarkIterations(10000000), [&] { StartupTraceScope step(tracer, "Step"); });
+
+    ReportBenchmark("creating all 16 up front", eager, "ns");
+    ReportBenchmark("creating the 3 used on first use", lazy, "ns");
+    ReportBenchmark("getting a created value", get, "ns");
+    ReportBenchmark("trace scope after startup", scope, "ns");
+}
@@ -0,0 +1,125 @@
+#include "TestFramework.h"
+#include "LiveResizeCoordinator.h"
+#include <random>
+
+static AvnPixelSize Pixels(int width, int height)
+{
+    return AvnPixelSize { width, height };
+}
+
+static AvnSize Points(double width, double height)
+{
+    AvnSize size;
+    size.Width = width;
+    size.Height = height;
+    return size;
+}
+
+TEST(ChangesOutsideOfALiveResizeAreCommittedRightAway)
+{
+    LiveResizeCoordinator coordinator;
+    LiveResizeCommit commit;
+    CHECK(coordinator.OnSizeChanged(Pixels(200, 100), Points(100, 50), ResizeApplication, false, commit)
+          == LiveResizeAction::Commit);
+    CHECK_EQ(200, commit.PixelSize.Width);
+    CHECK(commit.Reason == ResizeApplication);
+
+    // The same size in pixels again
+    CHECK(coordinator.OnSizeChanged(Pixels(200, 100), Points(100, 50), ResizeApplication, false, commit)
+          == LiveResizeAction::None);
+}
+
+TEST(ChangesDuringALiveResizeWaitForTheDraw)
+{
+    LiveResizeCoordinator coordinator;
+    LiveResizeCommit commit;
+    CHECK(coordinator.OnSizeChanged(Pixels(300, 200), Points(150, 100), ResizeUser, true, commit)
+          == LiveResizeAction::ScheduleFlush);
+    // The flush is scheduled once per frame
+    CHECK(coordinator.OnSizeChanged(Pixels(310, 200), Points(155, 100), ResizeUser, true, commit)
+          == LiveResizeAction::Wait);
+    CHECK(coordinator.HasPending());
+
+    CHECK(coordinator.Flush(commit));
+    CHECK_EQ(310, commit.PixelSize.Width);
+    CHECK_EQ(155.0, commit.Size.Width);
+    CHECK_EQ(310, coordinator.GetCommittedPixelSize().Width);
+    // The fallback flush after the draw finds nothing left
+    CHECK(!coordinator.Flush(commit));
+}
+
+TEST(DraggingBackToTheCommittedSizeCancelsThePendingChange)
+{
+    LiveResizeCoordinator coordinator;
+    LiveResizeCommit commit;
+    auto committed = coordinator.GetCommittedPixelSize();
+    coordinator.OnSizeChanged(Pixels(committed.Width + 5, committed.Height), Points(0, 0), ResizeUser, true, commit);
+    CHECK(coordinator.OnSizeChanged(committed, Points(0, 0), ResizeUser, true, commit) == LiveResizeAction::None);
+    CHECK(!coordinator.Flush(commit));
+
+    // The render target was resized to the pending size on its own
+    coordinator.OnSizeChanged(Pixels(10, 10), Points(5, 5), ResizeUser, true, commit);
+    coordinator.SetCommittedPixelSize(Pixels(10, 10));
+    CHECK(!coordinator.Flush(commit));
+}
+
+TEST(EveryFramePresentsTheLastSize)
+{
+    // A drag of 1000 frames with 4 size changes per refresh
+    LiveResizeCoordinator coordinator;
+    LiveResizeCommit commit;
+    std::mt19937 random(1);
+    int width = 200;
+    int height = 100;
+    for (int frame = 0; frame < 1000; frame++)
+    {
+        for (int change = 0; change < 4; change++)
+        {
+            width += static_cast<int>(random() % 5) - 2;
+            height += static_cast<int>(random() % 3) - 1;
+            CHECK(coordinator.OnSizeChanged(Pixels(width, height), Points(width / 2., height / 2.), ResizeUser,
+                                            true, commit) != LiveResizeAction::Commit);
+        }
+
+        if (coordinator.Flush(commit))
+        {
+            CHECK_EQ(width, commit.PixelSize.Width);
+            CHECK_EQ(height, commit.PixelSize.Height);
+        }
+        CHECK_EQ(width, coordinator.GetCommittedPixelSize().Width);
+        CHECK_EQ(height, coordinator.GetCommittedPixelSize().Height);
+    }
+
+    CHECK_EQ(4000u, coordinator.GetChangeCount());
+    CHECK(coordinator.GetCommitCount() <= 1000u);
+}
+
+BENCHMARK(LiveResizeDrag)
+{
+    // Render target resizes and layouts for a drag of 1000 frames with 4 size changes per refresh, committing
+    // every change against committing once per frame
+    std::mt19937 random(1);
+    LiveResizeCoordinator coordinator;
+    LiveResizeCommit commit;
+    int width = 200;
+    int height = 100;
+    uint64_t perChange = 0;
+    AvnPixelSize last = coordinator.GetCommittedPixelSize();
+    auto elapsed = MeasureNs(1000, [&]
+    {
+        for (int change = 0; change < 4; change++)
+        {
+            width += static_cast<int>(random() % 5) - 2;
+            height += static_cast<int>(random() % 3) - 1;
+            if (width != last.Width || height != last.Height)
+                perChange++;
+            last = Pixels(width, height);
+            coordinator.OnSizeChanged(last, Points(width / 2., height / 2.), ResizeUser, true, commit);
+        }
+        coordinator.Flush(commit);
+    });
+
+    ReportBenchmark("commits, every change", static_cast<double>(perChange), "commits");
+    ReportBenchmark("commits, once per frame", static_cast<double>(coordinator.GetCommitCount()), "commits");
+    ReportBenchmark("coordinating a frame of changes", elapsed, "ns");
+}
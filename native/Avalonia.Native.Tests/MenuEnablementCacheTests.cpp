@@ -0,0 +1,149 @@
+#include "TestFramework.h"
+#include "MenuEnablementCache.h"
+
+static bool CanExecute(uint64_t id)
+{
+    return id % 3 != 0;
+}
+
+// Stands in for the managed menu: counts the transitions and evaluates CanExecute
+struct FakeMenu
+{
+    std::vector<uint64_t> Ids;
+    int Transitions = 0;
+    bool ZeroedBitmaps = true;
+
+    explicit FakeMenu(size_t count)
+    {
+        for (uint64_t id = 1; id <= count; id++)
+            Ids.push_back(id);
+    }
+
+    bool IsEnabled(MenuEnablementCache& cache, uint64_t id)
+    {
+        return cache.IsEnabled(id, [this] { return Ids; }, [this](const uint64_t* ids, size_t count, uint8_t* bitmap)
+        {
+            Transitions++;
+            for (size_t i = 0; i < count; i++)
+            {
+                if (MenuEnablementCache::GetBit(bitmap, i))
+                    ZeroedBitmaps = false;
+                if (CanExecute(ids[i]))
+                    bitmap[i / 8] |= 1 << (i % 8);
+            }
+        });
+    }
+};
+
+TEST(OpeningAMenuMakesOneBatch)
+{
+    FakeMenu menu(40);
+    MenuEnablementCache cache;
+    cache.Open();
+    for (auto id : menu.Ids)
+        CHECK_EQ(CanExecute(id), menu.IsEnabled(cache, id));
+    for (auto id : menu.Ids)
+        menu.IsEnabled(cache, id);
+    CHECK_EQ(1, menu.Transitions);
+    CHECK(menu.ZeroedBitmaps);
+    CHECK(!cache.NeedsEndPass());
+
+    // An id that isn't one of the menu's is evaluated alone
+    CHECK_EQ(CanExecute(1000), menu.IsEnabled(cache, 1000));
+    CHECK_EQ(2, menu.Transitions);
+}
+
+TEST(InvalidationAsksForOneRefresh)
+{
+    FakeMenu menu(40);
+    MenuEnablementCache cache;
+    cache.Open();
+    menu.IsEnabled(cache, 1);
+    CHECK(cache.Invalidate());
+    CHECK(!cache.Invalidate());
+    cache.Refreshed();
+    for (auto id : menu.Ids)
+        menu.IsEnabled(cache, id);
+    CHECK_EQ(2, menu.Transitions);
+
+    cache.Close();
+    CHECK(!cache.IsOpen());
+    CHECK(!cache.Invalidate());
+}
+
+TEST(KeyEquivalentBatchLivesForOnePass)
+{
+    FakeMenu menu(40);
+    MenuEnablementCache cache;
+    menu.IsEnabled(cache, 5);
+    CHECK(cache.NeedsEndPass());
+    CHECK(!cache.NeedsEndPass());
+    menu.IsEnabled(cache, 6);
+    CHECK_EQ(1, menu.Transitions);
+
+    cache.EndPass();
+    menu.IsEnabled(cache, 5);
+    CHECK_EQ(2, menu.Transitions);
+
+    // Validated right before the menu reports it opened, the batch is kept for the open menu
+    CHECK(cache.NeedsEndPass());
+    cache.Open();
+    cache.EndPass();
+    for (auto id : menu.Ids)
+        menu.IsEnabled(cache, id);
+    CHECK_EQ(2, menu.Transitions);
+}
+
+TEST(EmptyMenuAndBitmapLengths)
+{
+    FakeMenu menu(0);
+    MenuEnablementCache cache;
+    CHECK(!menu.IsEnabled(cache, 3));
+    CHECK(menu.IsEnabled(cache, 4));
+    CHECK_EQ(0u, MenuEnablementCache::GetBitmapLength(0));
+    CHECK_EQ(1u, MenuEnablementCache::GetBitmapLength(8));
+    CHECK_EQ(2u, MenuEnablementCache::GetBitmapLength(9));
+}
+
+BENCHMARK(OpeningAMenu)
+{
+    // A managed transition and a CanExecute take around 1.5 us together
+    auto transition = []
+    {
+        auto start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < std::chrono::nanoseconds(1500))
+        {
+        }
+    };
+
+    for (size_t count : { 10u, 50u, 200u, 1000u })
+    {
+        FakeMenu menu(count);
+        auto perItem = MeasureNs(BenchmarkIterations(100), [&]
+        {
+            for (auto id : menu.Ids)
+            {
+                transition();
+                KeepAlive(CanExecute(id));
+            }
+        });
+
+        auto batched = MeasureNs(BenchmarkIterations(100), [&]
+        {
+            MenuEnablementCache cache;
+            cache.Open();
+            for (auto id : menu.Ids)
+                cache.IsEnabled(id, [&] { return menu.Ids; }, [&](const uint64_t* ids, size_t length, uint8_t* bitmap)
+                {
+                    transition();
+                    for (size_t i = 0; i < length; i++)
+                        if (CanExecute(ids[i]))
+                            bitmap[i / 8] |= 1 << (i % 8);
+                });
+        });
+
+        auto prefix = std::to_string(count) + " items, ";
+        ReportBenchmark((prefix + "one transition per item").c_str(), perItem / 1000, "us");
+        ReportBenchmark((prefix + "one batch").c_str(), batched / 1000, "us");
+    }
+}
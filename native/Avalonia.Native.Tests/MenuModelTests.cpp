@@ -0,0 +1,214 @@
+#include "TestFramework.h"
+#include "MenuModel.h"
+#include <random>
+
+static MenuModelItem Item(uint64_t id, const char* title)
+{
+    MenuModelItem item;
+    item.Id = id;
+    item.Title = title;
+    item.Flags = MenuModelVisible;
+    return item;
+}
+
+static std::vector<uint8_t> Serialize(const std::vector<MenuModelItem>& items)
+{
+    std::vector<uint8_t> bytes;
+    MenuModelWriter::Write(items, bytes);
+    return bytes;
+}
+
+// What NativeMenu does with the operations
+static std::vector<uint64_t> Apply(std::vector<uint64_t> menu, const std::vector<MenuModelOperation>& operations,
+                                   int& moved)
+{
+    moved = 0;
+    for (auto& operation : operations)
+    {
+        if (operation.Kind == MenuModelOperation::Remove)
+            menu.erase(std::find(menu.begin(), menu.end(), operation.Id));
+        else
+        {
+            menu.insert(menu.begin() + std::min(operation.Index, menu.size()), operation.Id);
+            if (operation.Existing)
+                moved++;
+        }
+    }
+    return menu;
+}
+
+static std::vector<MenuModelItem> SampleMenu()
+{
+    std::vector<MenuModelItem> menu { Item(1, "File"), Item(2, ""), Item(3, "Edit") };
+    menu[0].Flags |= MenuModelHasSubMenu;
+    menu[0].SubMenu = { Item(10, "Open"), Item(11, "Recent") };
+    menu[0].SubMenu[0].Key = 5;
+    menu[0].SubMenu[0].Modifiers = 8;
+    menu[0].SubMenu[0].ToolTip = "tip";
+    menu[1].Kind = MenuModelItemKind::Separator;
+    menu[2].Flags |= MenuModelHasIcon;
+    menu[2].Icon = { 1, 2, 3 };
+    return menu;
+}
+
+TEST(RoundTrip)
+{
+    auto bytes = Serialize(SampleMenu());
+    std::vector<MenuModelItem> read;
+    CHECK(MenuModelReader::Read(bytes.data(), bytes.size(), read));
+    CHECK_EQ(3u, read.size());
+    CHECK_EQ(2u, read[0].SubMenu.size());
+    CHECK(read[0].SubMenu[0].ToolTip == "tip");
+    CHECK_EQ(5, read[0].SubMenu[0].Key);
+    CHECK_EQ(8, read[0].SubMenu[0].Modifiers);
+    CHECK(read[1].Kind == MenuModelItemKind::Separator);
+    CHECK_EQ(3u, read[2].Icon.size());
+
+    uint8_t empty[] = { 0, 0, 0, 0 };
+    CHECK(MenuModelReader::Read(empty, 4, read));
+    CHECK(read.empty());
+}
+
+TEST(MalformedModelsAreRejected)
+{
+    auto bytes = Serialize(SampleMenu());
+    std::vector<MenuModelItem> read;
+    for (size_t length = 0; length < bytes.size(); length++)
+        CHECK(!MenuModelReader::Read(bytes.data(), length, read));
+    bytes.push_back(0);
+    CHECK(!MenuModelReader::Read(bytes.data(), bytes.size(), read));
+
+    bytes = Serialize({ Item(1, "a"), Item(1, "b") });
+    CHECK(!MenuModelReader::Read(bytes.data(), bytes.size(), read));
+
+    uint8_t hugeCount[] = { 0xff, 0xff, 0xff, 0xff };
+    CHECK(!MenuModelReader::Read(hugeCount, 4, read));
+    CHECK(!MenuModelReader::Read(nullptr, 4, read));
+
+    bytes = Serialize({ Item(1, "a") });
+    bytes[12] = 7;
+    CHECK(!MenuModelReader::Read(bytes.data(), bytes.size(), read));
+
+    auto deep = Item(1, "x");
+    for (int c = 0; c < 100; c++)
+    {
+        auto parent = Item(1, "x");
+        parent.Flags |= MenuModelHasSubMenu;
+        parent.SubMenu = { deep };
+        deep = parent;
+    }
+    bytes = Serialize({ deep });
+    CHECK(!MenuModelReader::Read(bytes.data(), bytes.size(), read));
+}
+
+TEST(RandomBytesNeverCrashTheReader)
+{
+    std::mt19937 random(3);
+    auto valid = Serialize(SampleMenu());
+    std::vector<MenuModelItem> read;
+    for (int c = 0; c < 20000; c++)
+    {
+        auto bytes = valid;
+        for (int flips = 1 + random() % 4; flips > 0; flips--)
+            bytes[random() % bytes.size()] = static_cast<uint8_t>(random());
+        MenuModelReader::Read(bytes.data(), bytes.size(), read);
+    }
+}
+
+TEST(PropertyChanges)
+{
+    auto old = Item(1, "a"), now = old;
+    CHECK_EQ(0u, MenuModelChanges(old, now));
+    now.Title = "b";
+    CHECK_EQ(static_cast<uint32_t>(MenuModelPropertyTitle), MenuModelChanges(old, now));
+
+    now = old;
+    now.ToggleType = 1;
+    CHECK_EQ(static_cast<uint32_t>(MenuModelPropertyToggleType | MenuModelPropertyChecked), MenuModelChanges(old, now));
+
+    old.Flags |= MenuModelHasIcon;
+    now = old;
+    now.Flags |= MenuModelIconUnchanged;
+    CHECK_EQ(0u, MenuModelChanges(old, now));
+    now.Flags &= ~MenuModelIconUnchanged;
+    CHECK_EQ(static_cast<uint32_t>(MenuModelPropertyIcon), MenuModelChanges(old, now));
+}
+
+TEST(DiffMovesAsLittleAsPossible)
+{
+    int moved;
+    CHECK(DiffMenuModel({ 1, 2, 3 }, { 1, 2, 3 }).empty());
+    Apply({ 1, 2, 3, 4 }, DiffMenuModel({ 1, 2, 3, 4 }, { 2, 3, 4, 1 }), moved);
+    CHECK_EQ(1, moved);
+    Apply({ 1, 2, 3, 4 }, DiffMenuModel({ 1, 2, 3, 4 }, { 4, 1, 2, 3 }), moved);
+    CHECK_EQ(1, moved);
+
+    auto operations = DiffMenuModel({ 1, 2, 3 }, { 0, 1, 2, 3 });
+    CHECK_EQ(1u, operations.size());
+    CHECK(operations[0].Kind == MenuModelOperation::Insert);
+    CHECK(!operations[0].Existing);
+}
+
+TEST(DiffOfRandomEdits)
+{
+    std::mt19937 random(1);
+    int moved;
+    for (int c = 0; c < 2000; c++)
+    {
+        std::vector<uint64_t> old(random() % 40);
+        for (size_t i = 0; i < old.size(); i++)
+            old[i] = i + 1;
+
+        std::vector<uint64_t> now;
+        for (auto id : old)
+            if (random() % 4 != 0)
+                now.push_back(id);
+        std::shuffle(now.begin(), now.end(), random);
+        if (random() % 2 != 0)
+            std::sort(now.begin(), now.end());
+        for (int added = random() % 5; added > 0; added--)
+            now.insert(now.begin() + random() % (now.size() + 1), 1000 + c * 10 + added);
+
+        CHECK(Apply(old, DiffMenuModel(old, now), moved) == now);
+    }
+}
+
+BENCHMARK(RecentFilesMenu)
+{
+    // A recent files menu: a new file on top, the oldest drops off. Before the model, every item of the menu
+    // was rebuilt through about 9 calls (title, tool tip, gesture, toggle, icon, ...).
+    for (size_t count : { 10u, 100u, 1000u, 5000u })
+    {
+        std::vector<MenuModelItem> items;
+        for (size_t c = 0; c < count; c++)
+        {
+            auto item = Item(c + 1, "Recent file with a fairly long name.txt");
+            item.ToolTip = "/Users/someone/Documents/file.txt";
+            item.Key = static_cast<int32_t>(c % 30);
+            items.push_back(item);
+        }
+        auto bytes = Serialize(items);
+
+        std::vector<MenuModelItem> read;
+        auto parse = MeasureNs(BenchmarkIterations(100), [&]
+        {
+            MenuModelReader::Read(bytes.data(), bytes.size(), read);
+        });
+
+        std::vector<uint64_t> old, now;
+        for (auto& item : items)
+            old.push_back(item.Id);
+        now = old;
+        now.pop_back();
+        now.insert(now.begin(), count + 1);
+        size_t operations = 0;
+        auto diff = MeasureNs(BenchmarkIterations(100), [&] { operations = DiffMenuModel(old, now).size(); });
+
+        auto prefix = std::to_string(count) + " items, ";
+        ReportBenchmark((prefix + "model size").c_str(), static_cast<double>(bytes.size()), "bytes");
+        ReportBenchmark((prefix + "parse").c_str(), parse / 1000, "us");
+        ReportBenchmark((prefix + "diff").c_str(), diff / 1000, "us");
+        ReportBenchmark((prefix + "operations applied").c_str(), static_cast<double>(operations), "ops");
+        ReportBenchmark((prefix + "calls rebuilding the menu").c_str(), static_cast<double>(count * 9), "calls");
+    }
+}
@@ -0,0 +1,144 @@
+#include "TestFramework.h"
+#include "NativeControlLayoutBatch.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+
+static NativeControlLayout Layout(bool visible, float x, float y, float width, float height)
+{
+    NativeControlLayout layout;
+    layout.Visible = visible;
+    layout.X = x;
+    layout.Y = y;
+    layout.Width = width;
+    layout.Height = height;
+    return layout;
+}
+
+TEST(OnlyTheLastLayoutOfEachControlIsKept)
+{
+    NativeControlLayoutBatch<int, std::shared_ptr<int>> batch;
+    auto first = std::make_shared<int>(1);
+    auto second = std::make_shared<int>(2);
+    auto third = std::make_shared<int>(3);
+
+    // A scroll moving two controls 10 times in one frame
+    CHECK(batch.Set(1, first, Layout(true, 0, 0, 10, 10)));
+    for (int c = 0; c < 10; c++)
+    {
+        CHECK(!batch.Set(2, second, Layout(true, 0, static_cast<float>(c), 5, 5)));
+        CHECK(!batch.Set(1, first, Layout(true, static_cast<float>(c), 0, 10, 10)));
+    }
+    CHECK(!batch.Set(3, third, Layout(false, 0, 0, 1, 1)));
+
+    // Laid out right away, the batch lets go of it
+    batch.Remove(3);
+    batch.Remove(42);
+    CHECK_EQ(1, static_cast<int>(third.use_count()));
+    CHECK_EQ(2, static_cast<int>(first.use_count()));
+
+    auto entries = batch.Take();
+    CHECK_EQ(2u, entries.size());
+    CHECK_EQ(1, entries[0].Key);
+    CHECK_EQ(9.f, entries[0].Layout.X);
+    CHECK_EQ(2, entries[1].Key);
+    CHECK_EQ(9.f, entries[1].Layout.Y);
+    CHECK(batch.IsEmpty());
+}
+
+TEST(TheFirstChangeAfterAFlushSchedulesTheNext)
+{
+    NativeControlLayoutBatch<int, std::shared_ptr<int>> batch;
+    auto handle = std::make_shared<int>(1);
+    CHECK(batch.Set(2, handle, Layout(false, 0, 0, 5, 5)));
+    batch.Remove(2);
+    CHECK(batch.IsEmpty());
+    // The flush scheduled before is still coming
+    CHECK(!batch.Set(1, handle, Layout(true, 0, 0, 1, 1)));
+    batch.Take();
+    CHECK(batch.Set(1, handle, Layout(true, 0, 0, 1, 1)));
+}
+
+TEST(RemovingKeepsTheOrderOfTheOthers)
+{
+    NativeControlLayoutBatch<int, int> batch;
+    batch.Set(1, 0, Layout(true, 1, 1, 1, 1));
+    batch.Set(2, 0, Layout(true, 2, 2, 2, 2));
+    batch.Set(3, 0, Layout(true, 3, 3, 3, 3));
+    batch.Remove(2);
+    batch.Set(3, 0, Layout(true, 4, 4, 4, 4));
+    batch.Set(1, 0, Layout(true, 5, 5, 5, 5));
+
+    auto entries = batch.Take();
+    CHECK_EQ(2u, entries.size());
+    CHECK_EQ(1, entries[0].Key);
+    CHECK_EQ(5.f, entries[0].Layout.X);
+    CHECK_EQ(3, entries[1].Key);
+    CHECK_EQ(4.f, entries[1].Layout.X);
+}
+
+TEST(HiddenControlsIgnoreTheirPosition)
+{
+    CHECK(Layout(false, 1, 2, 3, 4) == Layout(false, 9, 9, 3, 4));
+    CHECK(Layout(true, 1, 2, 3, 4) != Layout(true, 9, 9, 3, 4));
+    CHECK(Layout(false, 1, 2, 3, 4) != Layout(false, 1, 2, 5, 4));
+}
+
+TEST(ConcurrentSetsAndTakes)
+{
+    NativeControlLayoutBatch<int, int> batch;
+    std::atomic<int> scheduled { 0 };
+    std::thread setter([&]
+    {
+        for (int c = 0; c < 100000; c++)
+            if (batch.Set(c % 7, 0, Layout(true, static_cast<float>(c), 0, 1, 1)))
+                scheduled++;
+    });
+
+    size_t taken = 0;
+    size_t flushes = 0;
+    for (int c = 0; c < 1000; c++)
+    {
+        auto entries = batch.Take();
+        taken += entries.size();
+        flushes++;
+        CHECK(entries.size() <= 7u);
+    }
+    setter.join();
+    auto last = batch.Take();
+    taken += last.size();
+    flushes++;
+
+    // Every scheduled flush found something, at most 7 controls each
+    CHECK(taken >= static_cast<size_t>(scheduled.load()));
+    CHECK(taken <= flushes * 7);
+    for (auto& entry : last)
+        CHECK(entry.Layout.X >= 99993.f);
+}
+
+BENCHMARK(ScrollingEmbeddedControls)
+{
+    // 8 embedded controls moved 10 times per frame by a scroll, one deferred block per change against one flush
+    // per frame
+    NativeControlLayoutBatch<int, int> batch;
+    size_t perChange = 0;
+    size_t perFrame = 0;
+    size_t applied = 0;
+    auto frames = BenchmarkIterations(100000);
+    auto elapsed = MeasureNs(frames, [&]
+    {
+        for (int change = 0; change < 10; change++)
+            for (int control = 0; control < 8; control++)
+            {
+                perChange++;
+                if (batch.Set(control, 0, Layout(true, 0, static_cast<float>(change), 100, 20)))
+                    perFrame++;
+            }
+        applied += batch.Take().size();
+    });
+
+    ReportBenchmark("blocks queued, one per change", static_cast<double>(perChange), "blocks");
+    ReportBenchmark("flushes, one per frame", static_cast<double>(perFrame), "flushes");
+    ReportBenchmark("layouts applied", static_cast<double>(applied), "layouts");
+    ReportBenchmark("batching a frame of changes", elapsed, "ns");
+}
@@ -0,0 +1,78 @@
+#include "TestFramework.h"
+#include "PasteboardSnapshot.h"
+
+TEST(PngIsOfferedForConvertibleImages)
+{
+    PasteboardSnapshot snapshot(5, true, { "public.tiff", "public.utf8-plain-text" },
+                                { { "public.jpeg" }, { "public.png", "public.tiff" }, {} });
+    CHECK_EQ(5, snapshot.GetChangeCount());
+    CHECK_EQ(3u, snapshot.GetFormats()->size());
+    CHECK(snapshot.GetFormats()->back() == "public.png");
+
+    CHECK_EQ(3u, snapshot.GetItemCount());
+    CHECK_EQ(2u, snapshot.GetItemFormats(0)->size());
+    // Already has PNG
+    CHECK_EQ(2u, snapshot.GetItemFormats(1)->size());
+    CHECK(snapshot.GetItemFormats(2)->empty());
+    CHECK(snapshot.GetItemFormats(3) == nullptr);
+}
+
+TEST(NoTypesIsNotTheSameAsNoFormats)
+{
+    PasteboardSnapshot none(1, false, {}, {});
+    CHECK(none.GetFormats() == nullptr);
+    PasteboardSnapshot empty(1, true, {}, {});
+    CHECK(empty.GetFormats() != nullptr);
+    CHECK(empty.GetFormats()->empty());
+}
+
+TEST(FormatLookupsAreComputedOnce)
+{
+    PasteboardFormatCache cache(4);
+    int calls = 0;
+    for (int c = 0; c < 10; c++)
+        CHECK(cache.IsText("public.text", [&] { calls++; return true; }));
+    CHECK_EQ(1, calls);
+
+    // Formats that can't be converted are remembered as well
+    CHECK(cache.GetUti("x", [&] { calls++; return std::string(); }) == "");
+    CHECK(cache.GetUti("x", [&] { calls++; return std::string("bad"); }) == "");
+    CHECK_EQ(2, calls);
+
+    cache.Clear();
+    CHECK(cache.GetUti("x", [&] { calls++; return std::string("good"); }) == "good");
+    CHECK_EQ(3, calls);
+}
+
+TEST(CacheIsBounded)
+{
+    PasteboardFormatCache cache(4);
+    int calls = 0;
+    for (int c = 0; c < 10; c++)
+        cache.GetUti(std::to_string(c), [&] { calls++; return std::string("u"); });
+    CHECK_EQ(10, calls);
+    // Overflowing cleared the cache, the most recent format stays
+    cache.GetUti("9", [&] { calls++; return std::string("u"); });
+    CHECK_EQ(10, calls);
+    cache.GetUti("0", [&] { calls++; return std::string("u"); });
+    CHECK_EQ(11, calls);
+}
+
+BENCHMARK(CachedFormatLookup)
+{
+    PasteboardFormatCache cache;
+    auto lookup = MeasureNs(BenchmarkIterations(1000000), [&]
+    {
+        KeepAlive(cache.IsText("public.utf8-plain-text", [] { return true; }));
+    });
+
+    auto snapshot = MeasureNs(BenchmarkIterations(100000), [&]
+    {
+        PasteboardSnapshot snapshot(5, true, { "public.tiff", "public.utf8-plain-text", "public.html" },
+                                    { { "public.tiff" }, { "public.utf8-plain-text", "public.html" } });
+        KeepAlive(snapshot.GetItemCount());
+    });
+
+    ReportBenchmark("cached UTI lookup", lookup, "ns");
+    ReportBenchmark("taking a snapshot of 3 formats and 2 items", snapshot, "ns");
+}
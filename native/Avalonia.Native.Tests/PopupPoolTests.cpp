@@ -0,0 +1,169 @@
+#include "TestFramework.h"
+#include "PopupPool.h"
+#include <cstring>
+#include <memory>
+
+namespace
+{
+    // Stands in for a popup window, the backing store is what creating one costs
+    struct FakePopup
+    {
+        int Id;
+        bool Shown = false;
+        int Resets = 0;
+        std::vector<char> Backing;
+
+        explicit FakePopup(int id) : Id(id), Backing(256 * 1024)
+        {
+            memset(Backing.data(), 1, Backing.size());
+        }
+    };
+
+    typedef std::shared_ptr<FakePopup> Popup;
+
+    struct PopupFactory
+    {
+        int Created = 0;
+        std::shared_ptr<int> Destroyed = std::make_shared<int>(0);
+
+        Popup Create()
+        {
+            auto destroyed = Destroyed;
+            return Popup(new FakePopup(++Created), [destroyed](FakePopup* popup)
+            {
+                (*destroyed)++;
+                delete popup;
+            });
+        }
+    };
+
+    Popup Open(PopupPool<Popup>& pool, PopupFactory& factory)
+    {
+        Popup popup;
+        if (!pool.TryAcquire(popup))
+            popup = factory.Create();
+        popup->Shown = true;
+        return popup;
+    }
+
+    void Close(PopupPool<Popup>& pool, Popup popup, PopupRecycleState state = {})
+    {
+        if (!pool.CanAccept(state))
+            return;
+
+        popup->Shown = false;
+        popup->Resets++;
+        pool.Add(std::move(popup));
+    }
+}
+
+TEST(ClosedPopupsAreReusedLastClosedFirst)
+{
+    PopupFactory factory;
+    PopupPool<Popup> pool(2);
+    auto a = Open(pool, factory);
+    auto b = Open(pool, factory);
+    auto c = Open(pool, factory);
+    CHECK_EQ(3, factory.Created);
+    CHECK_EQ(3u, pool.GetMisses());
+
+    Close(pool, std::move(a));
+    Close(pool, std::move(b));
+    Close(pool, std::move(c));
+    CHECK_EQ(2u, pool.GetCount());
+    CHECK_EQ(1, *factory.Destroyed);
+
+    auto d = Open(pool, factory);
+    CHECK_EQ(2, d->Id);
+    CHECK_EQ(1, d->Resets);
+    CHECK_EQ(1u, pool.GetHits());
+    CHECK_EQ(3, factory.Created);
+}
+
+TEST(PopupsLeftWithSomethingAreNotKept)
+{
+    PopupFactory factory;
+    PopupPool<Popup> pool(2);
+    PopupRecycleState state;
+    state.HasChildren = true;
+    Close(pool, Open(pool, factory), state);
+    CHECK_EQ(0u, pool.GetCount());
+
+    state = PopupRecycleState();
+    state.HasHostedViews = true;
+    CHECK(!pool.CanAccept(state));
+    state = PopupRecycleState();
+    state.IsTornDown = true;
+    CHECK(!pool.CanAccept(state));
+    CHECK(pool.CanAccept(PopupRecycleState()));
+}
+
+TEST(PopupsStillHeldByTheirOwnerAreSkipped)
+{
+    PopupFactory factory;
+    PopupPool<Popup> pool(4);
+    auto first = Open(pool, factory);
+    auto second = Open(pool, factory);
+    Close(pool, first);
+    // The previous owner of the second one hasn't let go of it yet
+    Close(pool, second);
+    first = nullptr;
+
+    auto isIdle = [](const Popup& popup) { return popup.use_count() == 1; };
+    Popup popup;
+    CHECK(pool.TryAcquire(popup, isIdle));
+    CHECK_EQ(1, popup->Id);
+    CHECK(!pool.TryAcquire(popup, isIdle));
+    CHECK_EQ(3u, pool.GetMisses());
+
+    second = nullptr;
+    CHECK(pool.TryAcquire(popup, isIdle));
+    CHECK_EQ(2, popup->Id);
+}
+
+TEST(WarmUpAndTrimming)
+{
+    PopupFactory factory;
+    PopupPool<Popup> pool(2);
+    Close(pool, Open(pool, factory));
+
+    CHECK(pool.Configure(4, 3).empty());
+    CHECK_EQ(2u, pool.GetWarmUpDeficit());
+    for (auto c = pool.GetWarmUpDeficit(); c > 0; c--)
+        pool.Add(factory.Create());
+    CHECK_EQ(3u, pool.GetCount());
+    CHECK_EQ(0u, pool.GetWarmUpDeficit());
+
+    // The ones closed longest ago are trimmed, the warm up never goes past the capacity
+    auto trimmed = pool.Configure(1, 5);
+    CHECK_EQ(2u, trimmed.size());
+    CHECK_EQ(1, trimmed[0]->Id);
+    CHECK_EQ(1u, pool.GetCount());
+    CHECK_EQ(0u, pool.GetWarmUpDeficit());
+
+    // Turning pooling off, what shutting down does
+    trimmed = pool.Configure(0, 3);
+    CHECK_EQ(1u, trimmed.size());
+    CHECK_EQ(0u, pool.GetWarmUpDeficit());
+    CHECK(!pool.CanAccept(PopupRecycleState()));
+    trimmed.clear();
+    CHECK_EQ(factory.Created, *factory.Destroyed);
+}
+
+BENCHMARK(OpeningTooltips)
+{
+    auto iterations = BenchmarkIterations(20000);
+
+    PopupFactory unpooledFactory;
+    PopupPool<Popup> unpooled(0);
+    auto withoutPool = MeasureNs(iterations, [&] { Close(unpooled, Open(unpooled, unpooledFactory)); });
+
+    PopupFactory pooledFactory;
+    PopupPool<Popup> pooled(4);
+    auto withPool = MeasureNs(iterations, [&] { Close(pooled, Open(pooled, pooledFactory)); });
+
+    ReportBenchmark("open and close without the pool", withoutPool, "ns");
+    ReportBenchmark("open and close with the pool", withPool, "ns");
+    ReportBenchmark("popups created without the pool", unpooledFactory.Created, "popups");
+    ReportBenchmark("popups created with the pool", pooledFactory.Created, "popups");
+}
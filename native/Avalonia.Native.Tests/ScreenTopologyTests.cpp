@@ -0,0 +1,201 @@
+#include "TestFramework.h"
+#include "ScreenTopology.h"
+#include <map>
+
+static ScreenTopologyEntry Screen(uint32_t id, double x, double y, double width, double height)
+{
+    ScreenTopologyEntry entry;
+    entry.Id = id;
+    entry.Frame = { x, y, width, height };
+    // A 25 point menu bar at the top
+    entry.VisibleFrame = { x, y, width, height - 25 };
+    return entry;
+}
+
+// The main loop as far as screen changes go: the debouncer's flushes run on timers, the cache is read in between
+struct DisplayEvents
+{
+    ScreenReconfigurationDebouncer Debouncer;
+    ScreenTopologyCache Cache;
+    std::multimap<uint64_t, int> Timers;
+    std::vector<ScreenTopologyEntry> Screens;
+    int Changes = 0;
+    int Builds = 0;
+    uint64_t Now = 0;
+
+    void Reconfiguration(uint64_t time, uint32_t display, bool isBegin)
+    {
+        RunUntil(time);
+        if (Debouncer.OnReconfiguration(display, isBegin, Now))
+            Timers.emplace(Now + Debouncer.GetQuietUs(), 0);
+        Cache.Invalidate(Debouncer.IsReconfiguring());
+    }
+
+    void ParametersChanged(uint64_t time)
+    {
+        RunUntil(time);
+        if (Debouncer.OnParametersChanged(Now))
+            Timers.emplace(Now + Debouncer.GetQuietUs(), 0);
+        Cache.Invalidate(Debouncer.IsReconfiguring());
+    }
+
+    void RunUntil(uint64_t time)
+    {
+        while (!Timers.empty() && Timers.begin()->first <= time)
+        {
+            Now = Timers.begin()->first;
+            Timers.erase(Timers.begin());
+            uint64_t retry;
+            if (Debouncer.Flush(Now, retry))
+            {
+                Cache.Settled();
+                Changes++;
+            }
+            else if (retry != 0)
+                Timers.emplace(Now + retry, 0);
+        }
+        Now = time;
+    }
+
+    ScreenTopologyCache::Snapshot Get()
+    {
+        return Cache.Get([this] { Builds++; return Screens; });
+    }
+};
+
+TEST(Orientation)
+{
+    CHECK(GetScreenOrientation(0, 600, 340) == AvnScreenOrientation::Landscape);
+    CHECK(GetScreenOrientation(90, 600, 340) == AvnScreenOrientation::Portrait);
+    CHECK(GetScreenOrientation(180, 600, 340) == AvnScreenOrientation::LandscapeFlipped);
+    CHECK(GetScreenOrientation(270, 600, 340) == AvnScreenOrientation::PortraitFlipped);
+    CHECK(GetScreenOrientation(-90, 600, 340) == AvnScreenOrientation::PortraitFlipped);
+    CHECK(GetScreenOrientation(450, 340, 600) == AvnScreenOrientation::Landscape);
+}
+
+TEST(FlippedCoordinates)
+{
+    // A 1440x900 primary screen with a 1920x1080 one above it
+    ScreenTopology topology({ Screen(1, 0, 0, 1440, 900), Screen(2, 0, 900, 1920, 1080) });
+    CHECK_EQ(900.0, topology.GetPrimaryHeight());
+    CHECK_EQ(1920.0, topology.Find(2)->Frame.Width);
+    CHECK(topology.Find(3) == nullptr);
+
+    auto above = topology.ToAvnScreen(*topology.Find(2));
+    CHECK_EQ(-1080.0, above.Bounds.Y);
+    CHECK_EQ(1080.0, above.Bounds.Height);
+    auto primary = topology.ToAvnScreen(*topology.Find(1));
+    CHECK_EQ(0.0, primary.Bounds.Y);
+    CHECK_EQ(25.0, primary.WorkingArea.Y);
+    CHECK_EQ(875.0, primary.WorkingArea.Height);
+
+    CHECK_EQ(0.0, ScreenTopology({}).GetPrimaryHeight());
+}
+
+TEST(PointsOnTheEdgesBelongToTheScreen)
+{
+    // A 1440x900 primary screen with a 1920x1080 one to its right
+    auto right = Screen(2, 1440, 0, 1920, 1080);
+    right.Scaling = 2;
+    ScreenTopology topology({ Screen(1, 0, 0, 1440, 900), right });
+
+    // The top left corner of a window at the top left of the primary screen, in Cocoa coordinates
+    CHECK_EQ(1u, topology.FindContaining(0, 900)->Id);
+    CHECK_EQ(2u, topology.FindContaining(3360, 1080)->Id);
+    CHECK_EQ(2.0, topology.FindContaining(2000, 500)->Scaling);
+    // The shared edge goes to the first screen
+    CHECK_EQ(1u, topology.FindContaining(1440, 100)->Id);
+    CHECK(topology.FindContaining(100, 901) == nullptr);
+    CHECK(topology.FindContaining(-0.5, 100) == nullptr);
+}
+
+TEST(PluggingInADisplayReportsOnce)
+{
+    DisplayEvents events;
+    events.Screens = { Screen(1, 0, 0, 1440, 900) };
+    for (int c = 0; c < 100; c++)
+        events.Get();
+    CHECK_EQ(1, events.Builds);
+
+    // A begin for the two existing displays, an end for all three, spread over 30 ms
+    events.Reconfiguration(1000, 1, true);
+    events.Reconfiguration(1100, 2, true);
+    // Nothing is kept while displays are being reconfigured
+    events.Get();
+    events.Get();
+    CHECK_EQ(3, events.Builds);
+
+    events.Screens = { Screen(1, 0, 0, 1440, 900), Screen(2, 1440, 0, 1920, 1080), Screen(3, -800, 0, 800, 600) };
+    events.Reconfiguration(20000, 1, false);
+    events.Reconfiguration(25000, 2, false);
+    events.Reconfiguration(31000, 3, false);
+    events.Get();
+    events.Get();
+    CHECK_EQ(4, events.Builds);
+
+    events.RunUntil(1000000);
+    CHECK_EQ(1, events.Changes);
+    CHECK_EQ(3u, events.Get()->GetEntries().size());
+    CHECK_EQ(4, events.Builds);
+}
+
+TEST(MissingEndStillReports)
+{
+    DisplayEvents events;
+    events.Reconfiguration(2000000, 9, true);
+    events.RunUntil(3000000);
+    CHECK_EQ(0, events.Changes);
+    events.RunUntil(4100000);
+    CHECK_EQ(1, events.Changes);
+    CHECK(!events.Debouncer.IsReconfiguring());
+
+    events.Get();
+    auto builds = events.Builds;
+    events.Get();
+    CHECK_EQ(builds, events.Builds);
+}
+
+TEST(ParameterChangesAndSeparateReconfigurations)
+{
+    DisplayEvents events;
+    // The dock being resized
+    events.ParametersChanged(5000000);
+    events.ParametersChanged(5010000);
+    events.RunUntil(6000000);
+    CHECK_EQ(1, events.Changes);
+
+    events.Reconfiguration(7000000, 1, true);
+    events.Reconfiguration(7001000, 1, false);
+    events.Reconfiguration(9000000, 1, true);
+    events.Reconfiguration(9001000, 1, false);
+    events.RunUntil(10000000);
+    CHECK_EQ(3, events.Changes);
+
+    uint64_t retry;
+    CHECK(!events.Debouncer.Flush(11000000, retry));
+    CHECK_EQ(0u, retry);
+}
+
+BENCHMARK(CachedScreenLookup)
+{
+    std::vector<ScreenTopologyEntry> screens;
+    for (uint32_t c = 0; c < 6; c++)
+        screens.push_back(Screen(100 + c, c * 1000.0, 0, 1000, 800));
+
+    ScreenTopologyCache cache;
+    uint32_t next = 0;
+    auto cached = MeasureNs(BenchmarkIterations(1000000), [&]
+    {
+        auto topology = cache.Get([&] { return screens; });
+        KeepAlive(topology->Find(100 + next++ % 6)->Frame.X + topology->GetPrimaryHeight());
+    });
+
+    auto rebuilt = MeasureNs(BenchmarkIterations(100000), [&]
+    {
+        ScreenTopology topology(screens);
+        KeepAlive(topology.Find(100 + next++ % 6)->Frame.X + topology.GetPrimaryHeight());
+    });
+
+    ReportBenchmark("cached screen lookup and primary height", cached, "ns");
+    ReportBenchmark("building the topology for every lookup", rebuilt, "ns");
+}
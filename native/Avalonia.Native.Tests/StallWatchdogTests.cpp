@@ -0,0 +1,215 @@
+#include "TestFramework.h"
+#include "StallWatchdog.h"
+#include <functional>
+#include <queue>
+
+// A clock and a main thread the tests drive themselves
+static uint64_t s_now = 1000;
+static int s_posted = 0;
+
+static uint64_t FakeClock()
+{
+    return s_now;
+}
+
+static void CountPost(StallWatchdog*)
+{
+    s_posted++;
+}
+
+// A main loop running on a thread of its own, for the watchdog thread to watch
+class FakeMainLoop
+{
+public:
+    FakeMainLoop() : _thread([this] { Run(); })
+    {
+    }
+
+    ~FakeMainLoop()
+    {
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            _quit = true;
+        }
+        _wake.notify_one();
+        _thread.join();
+    }
+
+    void Post(std::function<void()> work)
+    {
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            _queue.push(std::move(work));
+        }
+        _wake.notify_one();
+    }
+
+private:
+    void Run()
+    {
+        for (;;)
+        {
+            std::function<void()> work;
+            {
+                std::unique_lock<std::mutex> lock(_lock);
+                _wake.wait(lock, [this] { return _quit || !_queue.empty(); });
+                if (_queue.empty())
+                    return;
+                work = std::move(_queue.front());
+                _queue.pop();
+            }
+            work();
+        }
+    }
+
+    std::mutex _lock;
+    std::condition_variable _wake;
+    std::queue<std::function<void()>> _queue;
+    bool _quit = false;
+    std::thread _thread;
+};
+
+static FakeMainLoop* s_mainLoop;
+
+static uint64_t SteadyClock()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void PostToMainLoop(StallWatchdog* watchdog)
+{
+    s_mainLoop->Post([watchdog] { watchdog->Beat(); });
+}
+
+TEST(WaitSitesAreRegisteredOnce)
+{
+    StallWatchdog watchdog(FakeClock, CountPost);
+    auto site = watchdog.RegisterWaitSite("Gpu.Wait");
+    CHECK_EQ(site, watchdog.RegisterWaitSite("Gpu.Wait"));
+    CHECK(site != watchdog.RegisterWaitSite("RenderTarget.Lock"));
+}
+
+TEST(StallsAreAttributedToTheWaitTheyStartedIn)
+{
+    s_now = 1000;
+    s_posted = 0;
+    StallWatchdog watchdog(FakeClock, CountPost);
+    auto site = watchdog.RegisterWaitSite("Gpu.Wait");
+
+    // Answered in time
+    watchdog.Beat();
+    watchdog.Poll();
+    CHECK_EQ(1, s_posted);
+    s_now += 100;
+    watchdog.Beat();
+    s_now += 10;
+    watchdog.Poll();
+    CHECK_EQ(2, s_posted);
+
+    {
+        StallWaitScope wait(watchdog, site);
+        s_now += 300000;
+        watchdog.Poll();
+        s_now += 200000;
+    }
+    watchdog.Beat();
+    watchdog.Poll();
+
+    auto stats = watchdog.GetStats();
+    CHECK_EQ(1u, stats.StallCount);
+    CHECK_EQ(1u, stats.AttributedCount);
+    auto stalls = watchdog.GetStalls();
+    CHECK_EQ(site, stalls[0].Site);
+    CHECK_EQ(500000u, stalls[0].DurationUs);
+    auto siteStats = watchdog.GetSiteStats(site);
+    CHECK_EQ(1u, siteStats.Count);
+    CHECK_EQ(500000u, siteStats.TotalUs);
+    CHECK_EQ(1u, siteStats.StallCount);
+
+    // Outside of any known wait
+    s_now += 400000;
+    watchdog.Poll();
+    watchdog.Beat();
+    watchdog.Poll();
+    stats = watchdog.GetStats();
+    CHECK_EQ(2u, stats.StallCount);
+    CHECK_EQ(1u, stats.AttributedCount);
+    CHECK_EQ(-1, watchdog.GetStalls()[1].Site);
+
+    watchdog.Reset();
+    CHECK_EQ(0u, watchdog.GetStats().StallCount);
+    CHECK_EQ(0u, watchdog.GetSiteStats(site).Count);
+}
+
+TEST(TraceNamesStallsAfterTheirSite)
+{
+    s_now = 1000;
+    StallWatchdog watchdog(FakeClock, CountPost);
+    auto site = watchdog.RegisterWaitSite("Lock \"x\"");
+    watchdog.Beat();
+    watchdog.Poll();
+    {
+        StallWaitScope wait(watchdog, site);
+        s_now += 600000;
+        watchdog.Poll();
+    }
+    watchdog.Beat();
+    watchdog.Poll();
+
+    auto trace = watchdog.ExportTrace();
+    CHECK(trace.find("\"name\":\"Lock \\\"x\\\"\"") != std::string::npos);
+    CHECK(trace.find("\"dur\":600000") != std::string::npos);
+    CHECK(trace.find("\"ts\":1000") != std::string::npos);
+}
+
+TEST(WatchdogThreadCatchesRealStalls)
+{
+    FakeMainLoop mainLoop;
+    s_mainLoop = &mainLoop;
+    StallWatchdog watchdog(SteadyClock, PostToMainLoop);
+    auto site = watchdog.RegisterWaitSite("Gpu.Wait");
+    mainLoop.Post([&] { watchdog.Beat(); });
+    watchdog.Start(20000);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    mainLoop.Post([&]
+    {
+        StallWaitScope wait(watchdog, site);
+        std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    mainLoop.Post([] { std::this_thread::sleep_for(std::chrono::milliseconds(100)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+
+    // Waits on other threads are counted but never attributed
+    {
+        StallWaitScope wait(watchdog, site);
+    }
+    watchdog.Stop();
+
+    auto stats = watchdog.GetStats();
+    CHECK_EQ(2u, stats.StallCount);
+    CHECK_EQ(1u, stats.AttributedCount);
+    CHECK(stats.MaxUs >= 100000);
+    CHECK_EQ(2u, watchdog.GetSiteStats(site).Count);
+}
+
+BENCHMARK(CostOfAWaitScope)
+{
+    // What wrapping a blocking call costs on the main thread and on any other thread
+    StallWatchdog watchdog(SteadyClock, CountPost);
+    auto site = watchdog.RegisterWaitSite("Gpu.Wait");
+    watchdog.Beat();
+    auto iterations = BenchmarkIterations(5000000);
+    auto mainThread = MeasureNs(iterations, [&] { StallWaitScope wait(watchdog, site); });
+
+    double otherThread = 0;
+    std::thread([&] { otherThread = MeasureNs(iterations, [&] { StallWaitScope wait(watchdog, site); }); }).join();
+
+    auto beat = MeasureNs(iterations, [&] { watchdog.Beat(); });
+
+    ReportBenchmark("wait scope on the main thread", mainThread, "ns");
+    ReportBenchmark("wait scope on another thread", otherThread, "ns");
+    ReportBenchmark("beat", beat, "ns");
+}
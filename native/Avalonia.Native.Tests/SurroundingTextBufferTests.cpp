@@ -0,0 +1,107 @@
+#include "TestFramework.h"
+#include "SurroundingTextBuffer.h"
+
+typedef SurroundingTextBuffer Buffer;
+
+static std::u16string WindowText(const Buffer& buffer)
+{
+    auto range = buffer.IntersectWindow({ buffer.GetWindowStart(), buffer.GetWindowLength() });
+    if (range.location == Buffer::NotFound)
+        return u"";
+    return std::u16string(buffer.GetText(range), range.length);
+}
+
+TEST(WholeDocumentWindow)
+{
+    Buffer buffer;
+    std::u16string text = u"hello world";
+    buffer.SetWindow(text.data(), text.size(), 0, text.size());
+    CHECK_EQ(text.size(), buffer.GetDocumentLength());
+    CHECK(WindowText(buffer) == text);
+
+    // Reversed and out of range selections are normalized and clamped
+    buffer.SetSelection(20, -3);
+    CHECK_EQ(0u, buffer.GetSelection().location);
+    CHECK_EQ(11u, buffer.GetSelection().length);
+}
+
+TEST(ClampRangeNeverLeavesTheDocument)
+{
+    Buffer buffer;
+    std::u16string text = u"hello world";
+    buffer.SetWindow(text.data(), text.size(), 0, text.size());
+
+    CHECK_EQ(6u, buffer.ClampRange({ 5, SIZE_MAX }).length);
+    CHECK_EQ(11u, buffer.ClampRange({ 50, 1 }).location);
+    CHECK_EQ(0u, buffer.ClampRange({ 50, 1 }).length);
+    CHECK_EQ(Buffer::NotFound, buffer.ClampRange({ Buffer::NotFound, 3 }).location);
+}
+
+TEST(WindowInTheMiddleOfTheDocument)
+{
+    Buffer buffer;
+    std::u16string window = u"0123456789";
+    buffer.SetWindow(window.data(), window.size(), 100, 1000);
+    buffer.SetSelection(105, 105);
+    CHECK_EQ(1000u, buffer.GetDocumentLength());
+    CHECK_EQ(105u, buffer.GetSelection().location);
+
+    auto range = buffer.IntersectWindow({ 90, 20 });
+    CHECK_EQ(100u, range.location);
+    CHECK_EQ(10u, range.length);
+
+    CHECK_EQ(Buffer::NotFound, buffer.IntersectWindow({ 0, 100 }).location);
+    CHECK_EQ(Buffer::NotFound, buffer.IntersectWindow({ 110, 5 }).location);
+    CHECK_EQ(Buffer::NotFound, buffer.IntersectWindow({ Buffer::NotFound, 5 }).location);
+
+    range = buffer.IntersectWindow({ 103, SIZE_MAX });
+    CHECK_EQ(103u, range.location);
+    CHECK_EQ(7u, range.length);
+    CHECK(*buffer.GetText(range) == u'3');
+}
+
+TEST(DocumentIsAtLeastAsLongAsTheWindow)
+{
+    Buffer buffer;
+    std::u16string window = u"abcdef";
+    buffer.SetWindow(window.data(), window.size(), 10, 12);
+    CHECK_EQ(16u, buffer.GetDocumentLength());
+    buffer.SetWindow(nullptr, 5, 0, 0);
+    CHECK_EQ(0u, buffer.GetWindowLength());
+}
+
+TEST(ShrinkingTheDocumentClampsTheSelection)
+{
+    Buffer buffer;
+    std::u16string text(100, u'a');
+    buffer.SetWindow(text.data(), text.size(), 0, text.size());
+    buffer.SetSelection(80, 90);
+    buffer.SetWindow(text.data(), 50, 0, 50);
+    CHECK_EQ(50u, buffer.GetSelection().location);
+    CHECK_EQ(0u, buffer.GetSelection().length);
+}
+
+BENCHMARK(KeystrokeInALargeDocument)
+{
+    // What a keystroke in an 8M character document costs the native side: the 2048 units on either side of
+    // the caret the managed side sends, against the whole document it used to send
+    std::u16string document(8u << 20, u'a');
+    auto iterations = BenchmarkIterations(100000);
+    size_t caret = 4000000;
+    Buffer buffer;
+    auto window = MeasureNs(iterations, [&]
+    {
+        caret++;
+        buffer.SetWindow(document.data() + caret - 2048, 4096, caret - 2048, document.size());
+        buffer.SetSelection(static_cast<int>(caret), static_cast<int>(caret));
+    });
+
+    Buffer whole;
+    auto full = MeasureNs(BenchmarkIterations(100), [&]
+    {
+        whole.SetWindow(document.data(), document.size(), 0, document.size());
+    });
+
+    ReportBenchmark("4096 unit window around the caret", window / 1000, "us");
+    ReportBenchmark("whole 8M unit document", full / 1000, "us");
+}
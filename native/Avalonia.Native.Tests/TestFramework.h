@@ -0,0 +1,108 @@
+#ifndef TestFramework_h
+#define TestFramework_h
+
+// Just enough of a test runner for the portable headers of the macOS backend. Every test file is an executable
+// of its own: TEST cases run by default, BENCHMARK cases only with --benchmark, --quick shrinks the benchmarks
+// to a smoke run so CTest can keep them building and working.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct TestCase
+{
+    const char* Name;
+    void (*Run)();
+    bool IsBenchmark;
+};
+
+inline std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+struct TestFailure
+{
+    std::string Message;
+};
+
+struct TestRegistration
+{
+    TestRegistration(const char* name, void (*run)(), bool isBenchmark)
+    {
+        GetTestCases().push_back(TestCase { name, run, isBenchmark });
+    }
+};
+
+inline void FailTest(const char* file, int line, const std::string& message)
+{
+    throw TestFailure { std::string(file) + ":" + std::to_string(line) + ": " + message };
+}
+
+// Benchmarks multiply their iteration counts by this, 1 for a real run
+inline double& BenchmarkScale()
+{
+    static double scale = 1;
+    return scale;
+}
+
+inline size_t BenchmarkIterations(size_t iterations)
+{
+    auto scaled = static_cast<size_t>(static_cast<double>(iterations) * BenchmarkScale());
+    return scaled != 0 ? scaled : 1;
+}
+
+// Average nanoseconds per call of what runs iterations times
+inline double MeasureNs(size_t iterations, const std::function<void()>& run)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (size_t c = 0; c < iterations; c++)
+        run();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / static_cast<double>(iterations);
+}
+
+inline void ReportBenchmark(const char* name, double value, const char* unit)
+{
+    printf("  %-56s %12.2f %s\n", name, value, unit);
+}
+
+// Keeps the optimizer from dropping a result
+template <typename T>
+inline void KeepAlive(const T& value)
+{
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+#define TEST_CONCAT2(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT2(a, b)
+
+#define TEST(name) \
+    static void name(); \
+    static TestRegistration TEST_CONCAT(name, _registration)(#name, name, false); \
+    static void name()
+
+#define BENCHMARK(name) \
+    static void name(); \
+    static TestRegistration TEST_CONCAT(name, _registration)(#name, name, true); \
+    static void name()
+
+#define CHECK(condition) \
+    do \
+    { \
+        if (!(condition)) \
+            FailTest(__FILE__, __LINE__, "CHECK(" #condition ") failed"); \
+    } while (0)
+
+#define CHECK_EQ(expected, actual) \
+    do \
+    { \
+        if (!((expected) == (actual))) \
+            FailTest(__FILE__, __LINE__, "CHECK_EQ(" #expected ", " #actual ") failed"); \
+    } while (0)
+
+#endif /* TestFramework_h */
@@ -0,0 +1,41 @@
+#include "TestFramework.h"
+#include <cstring>
+
+int main(int argc, char** argv)
+{
+    bool benchmarks = false;
+    const char* filter = nullptr;
+    for (int c = 1; c < argc; c++)
+    {
+        if (strcmp(argv[c], "--benchmark") == 0)
+            benchmarks = true;
+        else if (strcmp(argv[c], "--quick") == 0)
+            BenchmarkScale() = 0.01;
+        else
+            filter = argv[c];
+    }
+
+    int failed = 0;
+    int run = 0;
+    for (auto& test : GetTestCases())
+    {
+        if (test.IsBenchmark != benchmarks || (filter != nullptr && strstr(test.Name, filter) == nullptr))
+            continue;
+
+        run++;
+        printf("%s\n", test.Name);
+        fflush(stdout);
+        try
+        {
+            test.Run();
+        }
+        catch (const TestFailure& failure)
+        {
+            failed++;
+            printf("  FAILED %s\n", failure.Message.c_str());
+        }
+    }
+
+    printf("%d %s, %d failed\n", run, benchmarks ? "benchmarks" : "tests", failed);
+    return failed == 0 ? 0 : 1;
+}
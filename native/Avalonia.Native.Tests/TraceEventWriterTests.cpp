@@ -0,0 +1,21 @@
+#include "TestFramework.h"
+#include "TraceEventWriter.h"
+
+TEST(EmptyTrace)
+{
+    TraceEventWriter trace;
+    CHECK(trace.Finish() == "{\"traceEvents\":[],\"displayTimeUnit\":\"ms\"}");
+}
+
+TEST(CompleteEventsAreEscaped)
+{
+    TraceEventWriter trace;
+    trace.AddComplete("Lock \"x\"", "stall", 1000, 600000);
+    trace.AddComplete("C:\\path", "startup", 18446744073709551615ull, 0);
+    CHECK(trace.Finish() ==
+          "{\"traceEvents\":["
+          "{\"name\":\"Lock \\\"x\\\"\",\"cat\":\"stall\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":1000,\"dur\":600000},"
+          "{\"name\":\"C:\\\\path\",\"cat\":\"startup\",\"ph\":\"X\",\"pid\":0,\"tid\":0,"
+          "\"ts\":18446744073709551615,\"dur\":0}"
+          "],\"displayTimeUnit\":\"ms\"}");
+}
@@ -0,0 +1,286 @@
+#include "TestFramework.h"
+#include "Utf8Transcoder.h"
+#include <random>
+#include <string>
+
+namespace
+{
+    // A byte at a time reference, written from the standard independently of the transcoder
+    bool ReferenceDecode(const std::string& input, std::u16string& output)
+    {
+        static const uint32_t minimum[] = { 0, 0, 0x80, 0x800, 0x10000 };
+        output.clear();
+        size_t c = 0;
+        while (c < input.size())
+        {
+            auto lead = static_cast<uint8_t>(input[c]);
+            uint32_t codePoint;
+            size_t count;
+            if (lead < 0x80)
+            {
+                codePoint = lead;
+                count = 1;
+            }
+            else if ((lead & 0xE0) == 0xC0)
+            {
+                codePoint = lead & 0x1F;
+                count = 2;
+            }
+            else if ((lead & 0xF0) == 0xE0)
+            {
+                codePoint = lead & 0x0F;
+                count = 3;
+            }
+            else if ((lead & 0xF8) == 0xF0)
+            {
+                codePoint = lead & 0x07;
+                count = 4;
+            }
+            else
+                return false;
+
+            if (c + count > input.size())
+                return false;
+            for (size_t k = 1; k < count; k++)
+            {
+                auto continuation = static_cast<uint8_t>(input[c + k]);
+                if ((continuation & 0xC0) != 0x80)
+                    return false;
+                codePoint = (codePoint << 6) | (continuation & 0x3F);
+            }
+            if (codePoint < minimum[count] || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+                return false;
+
+            if (codePoint >= 0x10000)
+            {
+                codePoint -= 0x10000;
+                output += static_cast<char16_t>(0xD800 + (codePoint >> 10));
+                output += static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+            }
+            else
+                output += static_cast<char16_t>(codePoint);
+            c += count;
+        }
+        return true;
+    }
+
+    void ReferenceEncode(uint32_t codePoint, std::string& output)
+    {
+        if (codePoint < 0x80)
+            output += static_cast<char>(codePoint);
+        else if (codePoint < 0x800)
+        {
+            output += static_cast<char>(0xC0 | (codePoint >> 6));
+            output += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            output += static_cast<char>(0xE0 | (codePoint >> 12));
+            output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            output += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            output += static_cast<char>(0xF0 | (codePoint >> 18));
+            output += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            output += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    // Lone surrogates become U+FFFD
+    std::string ReferenceEncode(const std::u16string& input)
+    {
+        std::string output;
+        for (size_t c = 0; c < input.size(); c++)
+        {
+            uint32_t unit = input[c];
+            if (unit >= 0xD800 && unit <= 0xDBFF && c + 1 < input.size() && input[c + 1] >= 0xDC00
+                && input[c + 1] <= 0xDFFF)
+            {
+                ReferenceEncode(0x10000 + ((unit - 0xD800) << 10) + (input[c + 1] - 0xDC00), output);
+                c++;
+            }
+            else if (unit >= 0xD800 && unit <= 0xDFFF)
+                ReferenceEncode(0xFFFD, output);
+            else
+                ReferenceEncode(unit, output);
+        }
+        return output;
+    }
+
+    // asciiPercent of the code points are ASCII, the others are spread over the 2, 3 and 4 byte forms
+    uint32_t RandomCodePoint(std::mt19937& random, uint32_t asciiPercent)
+    {
+        if (random() % 100 < asciiPercent)
+            return random() % 0x80;
+        for (;;)
+        {
+            uint32_t codePoint;
+            switch (random() % 3)
+            {
+                case 0:
+                    codePoint = 0x80 + random() % 0x780;
+                    break;
+                case 1:
+                    codePoint = 0x800 + random() % 0xF800;
+                    break;
+                default:
+                    codePoint = 0x10000 + random() % 0x100000;
+                    break;
+            }
+            if (codePoint < 0xD800 || codePoint > 0xDFFF)
+                return codePoint;
+        }
+    }
+
+    std::string RandomUtf8(std::mt19937& random, size_t minimumLength, size_t maximumCodePoints,
+                           uint32_t asciiPercent)
+    {
+        std::string text;
+        auto count = maximumCodePoints == 0 ? 0 : random() % maximumCodePoints;
+        for (size_t c = 0; c < count || text.size() < minimumLength; c++)
+            ReferenceEncode(RandomCodePoint(random, asciiPercent), text);
+        return text;
+    }
+
+    std::u16string Decode(const std::string& text, bool& valid)
+    {
+        std::u16string output(text.size() + 1, u'\0');
+        size_t written = 0;
+        valid = Utf8ToUtf16(text.data(), text.size(), &output[0], written);
+        output.resize(valid ? written : 0);
+        return output;
+    }
+
+    std::string Encode(const std::u16string& text)
+    {
+        std::string output(text.size() * 3 + 1, '\0');
+        output.resize(Utf16ToUtf8(text.data(), text.size(), &output[0]));
+        return output;
+    }
+}
+
+TEST(ValidTextRoundTrips)
+{
+    std::mt19937 random(1234);
+    for (int c = 0; c < 20000; c++)
+    {
+        auto text = RandomUtf8(random, 0, 80, random() % 101);
+        std::u16string expected;
+        CHECK(ReferenceDecode(text, expected));
+
+        bool valid;
+        auto decoded = Decode(text, valid);
+        CHECK(valid);
+        CHECK(decoded == expected);
+        CHECK(IsValidUtf8(text.data(), text.size()));
+        CHECK_EQ(expected.size() == text.size(), IsAscii(text.data(), text.size()));
+        CHECK(Encode(decoded) == text);
+    }
+}
+
+TEST(MutatedBytesAgreeWithTheReference)
+{
+    std::mt19937 random(5678);
+    for (int c = 0; c < 20000; c++)
+    {
+        auto text = RandomUtf8(random, 0, 80, random() % 101);
+        auto mutations = 1 + random() % 3;
+        for (size_t m = 0; m < mutations && !text.empty(); m++)
+        {
+            switch (random() % 3)
+            {
+                case 0:
+                    text[random() % text.size()] = static_cast<char>(random());
+                    break;
+                case 1:
+                    text.erase(random() % text.size(), 1);
+                    break;
+                default:
+                    text.insert(text.begin() + random() % (text.size() + 1), static_cast<char>(0x80 + random() % 0x80));
+                    break;
+            }
+        }
+
+        std::u16string expected;
+        auto expectedValid = ReferenceDecode(text, expected);
+        bool valid;
+        auto decoded = Decode(text, valid);
+        CHECK_EQ(expectedValid, valid);
+        CHECK_EQ(expectedValid, IsValidUtf8(text.data(), text.size()));
+        if (valid)
+            CHECK(decoded == expected);
+    }
+}
+
+TEST(LoneSurrogatesAreReplaced)
+{
+    std::mt19937 random(91011);
+    for (int c = 0; c < 20000; c++)
+    {
+        // Half ASCII, a fifth surrogates of either half, the rest anything
+        std::u16string text;
+        auto length = random() % 80;
+        for (size_t k = 0; k < length; k++)
+        {
+            auto kind = random() % 10;
+            text += kind < 5 ? static_cast<char16_t>(random() % 0x80)
+                : kind < 7 ? static_cast<char16_t>(0xD800 + random() % 0x800)
+                : static_cast<char16_t>(random());
+        }
+        CHECK(Encode(text) == ReferenceEncode(text));
+    }
+}
+
+TEST(EdgeCasesFromTheStandard)
+{
+    // Overlong, surrogates, above U+10FFFF, five byte forms, lone continuation bytes and truncated sequences
+    const std::string invalid[] = { "\xC0\x80", "\xC1\xBF", "\xE0\x80\x80", "\xE0\x9F\xBF", "\xED\xA0\x80",
+                                    "\xED\xBF\xBF", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80", "\xF5\x80\x80\x80",
+                                    "\xF8\x88\x80\x80\x80", "\x80", "\xBF", "\xE2\x82", "\xF0\x9F\x98" };
+    for (auto& text : invalid)
+        CHECK(!IsValidUtf8(text.data(), text.size()));
+
+    const std::string valid[] = { "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xED\x9F\xBF", "\xEE\x80\x80",
+                                  "\xEF\xBF\xBF", "\xF0\x90\x80\x80", "\xF4\x8F\xBF\xBF" };
+    for (auto& text : valid)
+        CHECK(IsValidUtf8(text.data(), text.size()));
+
+    // Invalid bytes right after a block of ASCII long enough for the vector paths
+    std::string text(40, 'a');
+    text += "\xC0\x80";
+    CHECK(!IsValidUtf8(text.data(), text.size()));
+    CHECK(!IsAscii(text.data(), text.size()));
+    CHECK(IsAscii(text.data(), 40));
+    CHECK(IsValidUtf8("", 0));
+}
+
+BENCHMARK(TranscodingThroughput)
+{
+    // 1 MB of text per mix, against the byte at a time reference
+    std::mt19937 random(1);
+    const std::pair<const char*, uint32_t> mixes[] = { { "ascii", 100 }, { "latin", 90 }, { "mixed", 30 },
+                                                       { "cjk", 0 } };
+    auto repeats = BenchmarkIterations(200);
+    for (auto& mix : mixes)
+    {
+        auto text = RandomUtf8(random, 1 << 20, 0, mix.second);
+        std::u16string decoded(text.size(), u'\0');
+        size_t written = 0;
+        auto toUtf16 = MeasureNs(repeats, [&] { KeepAlive(Utf8ToUtf16(text.data(), text.size(), &decoded[0], written)); });
+        decoded.resize(written);
+
+        std::u16string reference;
+        auto referenceToUtf16 = MeasureNs(repeats, [&] { KeepAlive(ReferenceDecode(text, reference)); });
+
+        std::string encoded(decoded.size() * 3, '\0');
+        auto toUtf8 = MeasureNs(repeats, [&] { KeepAlive(Utf16ToUtf8(decoded.data(), decoded.size(), &encoded[0])); });
+
+        auto bytes = static_cast<double>(text.size());
+        ReportBenchmark((std::string(mix.first) + ": utf8 -> utf16").c_str(), bytes / toUtf16, "GB/s");
+        ReportBenchmark((std::string(mix.first) + ": utf8 -> utf16, reference").c_str(), bytes / referenceToUtf16,
+                        "GB/s");
+        ReportBenchmark((std::string(mix.first) + ": utf16 -> utf8").c_str(), bytes / toUtf8, "GB/s");
+    }
+}
@@ -0,0 +1,114 @@
+#include "TestFramework.h"
+#include "WindowUpdateBatch.h"
+
+TEST(OnlyTheOutermostCommitHandsOverTheChanges)
+{
+    WindowUpdateBatch batch;
+    WindowUpdateSet set;
+    CHECK(!batch.IsOpen());
+    CHECK(!batch.Commit(set));
+
+    batch.Begin();
+    batch.Begin();
+    batch.SetSize({ 100, 100 }, ResizeLayout);
+    batch.SetPosition({ 10, 20 });
+    CHECK(!batch.Commit(set));
+    CHECK(batch.IsOpen());
+    CHECK(batch.GetPending().Has(WindowUpdateSize));
+    CHECK(!batch.GetPending().Has(WindowUpdateTopMost));
+
+    CHECK(batch.Commit(set));
+    CHECK(!batch.IsOpen());
+    CHECK_EQ(static_cast<uint32_t>(WindowUpdateSize | WindowUpdatePosition), set.Changed);
+    CHECK_EQ(static_cast<uint32_t>(WindowUpdateNone), batch.GetPending().Changed);
+
+    // Nothing set, nothing to apply
+    batch.Begin();
+    CHECK(!batch.Commit(set));
+}
+
+TEST(LastValueOfEachPropertyWins)
+{
+    WindowUpdateBatch batch;
+    WindowUpdateSet set;
+    batch.Begin();
+    batch.SetSize({ 100, 100 }, ResizeLayout);
+    batch.SetSize({ 300, 200 }, ResizeApplication);
+    batch.SetTitle("a");
+    batch.SetTitle(nullptr);
+    batch.SetTitle("Title");
+    batch.SetMinMaxSize({ 50, 50 }, { 250, 1000 });
+    batch.SetDecorations(SystemDecorationsNone);
+    CHECK(batch.Commit(set));
+
+    CHECK_EQ(300.0, set.Size.Width);
+    CHECK(set.ResizeReason == ResizeApplication);
+    CHECK(set.Title == "Title");
+    CHECK(set.Has(WindowUpdateDecorations));
+    CHECK(set.Decorations == SystemDecorationsNone);
+    CHECK(!set.Has(WindowUpdatePosition));
+}
+
+TEST(TakeKeepsTheUpdateOpen)
+{
+    WindowUpdateBatch batch;
+    WindowUpdateSet set;
+    batch.Begin();
+    batch.SetTopMost(true);
+    CHECK(batch.Take(set));
+    CHECK(batch.IsOpen());
+    CHECK(set.TopMost);
+    CHECK(!batch.Take(set));
+
+    batch.SetThemeVariant(AvnPlatformThemeVariant::Dark);
+    CHECK(batch.Commit(set));
+    CHECK_EQ(static_cast<uint32_t>(WindowUpdateThemeVariant), set.Changed);
+}
+
+TEST(SizeIsClampedToTheLimits)
+{
+    auto size = WindowUpdateBatch::ClampSize({ 300, 200 }, { 50, 50 }, { 250, 1000 });
+    CHECK_EQ(250.0, size.Width);
+    CHECK_EQ(200.0, size.Height);
+
+    // A maximum below the minimum wins
+    size = WindowUpdateBatch::ClampSize({ 10, 10 }, { 100, 100 }, { 50, 50 });
+    CHECK_EQ(50.0, size.Width);
+}
+
+BENCHMARK(WindowSetup)
+{
+    // What a window restoring its state sets before it is first shown. Every setter reaching the NSWindow is a
+    // layout pass, size and position setters are a frame change each.
+    const int setters = 8;
+    const int frameSetters = 4;
+    WindowUpdateSet set;
+    WindowUpdateBatch batch;
+    auto recorded = MeasureNs(BenchmarkIterations(1000000), [&]
+    {
+        batch.Begin();
+        batch.SetMinMaxSize({ 200, 150 }, { 4000, 3000 });
+        batch.SetSize({ 800, 600 }, ResizeApplication);
+        batch.SetPosition({ 100, 100 });
+        batch.SetTitle("Document");
+        batch.SetSize({ 1024, 768 }, ResizeApplication);
+        batch.SetPosition({ 120, 80 });
+        batch.SetTopMost(false);
+        batch.SetDecorations(SystemDecorationsFull);
+        batch.Commit(set);
+        KeepAlive(set.Size.Width);
+    });
+
+    // Size and position are applied as one frame change
+    int applied = 0;
+    for (uint32_t flags = set.Changed; flags != 0; flags &= flags - 1)
+        applied++;
+    if (set.Has(WindowUpdateSize) && set.Has(WindowUpdatePosition))
+        applied--;
+
+    ReportBenchmark("changes applied one at a time", setters, "changes");
+    ReportBenchmark("changes applied by the commit", applied, "changes");
+    ReportBenchmark("frame changes one at a time", frameSetters, "changes");
+    ReportBenchmark("frame changes by the commit", set.Has(WindowUpdateSize) ? 1 : 0, "changes");
+    ReportBenchmark("recording and committing the setup", recorded, "ns");
+}
@@ -12,3 +12,4 @@ public:
 extern void ReleaseNSObject(void* obj);
 extern void RetainNSObject(void* obj);
 extern uint64_t GetRetainCountForNSObject(void* obj);
+extern void ReleaseNSObjects(void* const* objs, size_t count);
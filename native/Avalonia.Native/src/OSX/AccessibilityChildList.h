@@ -0,0 +1,99 @@
+#ifndef AccessibilityChildList_h
+#define AccessibilityChildList_h
+
+// Keeps track of the identity of an accessibility element's children, so that a children changed notification
+// can report only the children that were really added or removed. Plain C++, a key is whatever identifies a
+// child (the automation peer's pointer).
+
+#include <algorithm>
+#include <cstddef>
+#include <unordered_set>
+#include <vector>
+
+class AccessibilityChildList
+{
+public:
+    typedef const void* Key;
+
+    struct Changes
+    {
+        // Indices into the new children
+        std::vector<size_t> added;
+        std::vector<Key> removed;
+    };
+
+    bool IsLoaded() const
+    {
+        return _loaded;
+    }
+
+    const std::vector<Key>& GetKeys() const
+    {
+        return _keys;
+    }
+
+    // Forgets the children, e.g. when nobody asked for them since they last changed
+    void Unload()
+    {
+        _keys.clear();
+        _keys.shrink_to_fit();
+        _loaded = false;
+    }
+
+    // Replaces the children, an unloaded list counts as empty. Linear in the number of old and new children.
+    Changes Update(std::vector<Key> keys)
+    {
+        Changes changes;
+
+        // Changes are usually local, only the part between the common prefix and suffix needs hashing
+        size_t prefix = 0;
+        while (prefix < _keys.size() && prefix < keys.size() && _keys[prefix] == keys[prefix])
+            prefix++;
+
+        size_t suffix = 0;
+        while (suffix < _keys.size() - prefix && suffix < keys.size() - prefix &&
+               _keys[_keys.size() - 1 - suffix] == keys[keys.size() - 1 - suffix])
+            suffix++;
+
+        std::unordered_set<Key> oldKeys(_keys.begin() + prefix, _keys.end() - suffix);
+        std::unordered_set<Key> newKeys(keys.begin() + prefix, keys.end() - suffix);
+
+        for (size_t i = prefix; i < keys.size() - suffix; i++)
+        {
+            if (oldKeys.find(keys[i]) == oldKeys.end())
+                changes.added.push_back(i);
+        }
+
+        for (size_t i = prefix; i < _keys.size() - suffix; i++)
+        {
+            if (newKeys.find(_keys[i]) == newKeys.end())
+                changes.removed.push_back(_keys[i]);
+        }
+
+        _keys.swap(keys);
+        _loaded = true;
+        return changes;
+    }
+
+    // Narrows a request for maxCount children starting at index down to the count children there are.
+    // Returns false if there is nothing to return.
+    static bool ClampWindow(size_t count, size_t index, size_t maxCount, size_t& start, size_t& length)
+    {
+        if (index >= count || maxCount == 0)
+        {
+            start = std::min(index, count);
+            length = 0;
+            return false;
+        }
+
+        start = index;
+        length = std::min(maxCount, count - index);
+        return true;
+    }
+
+private:
+    std::vector<Key> _keys;
+    bool _loaded = false;
+};
+
+#endif /* AccessibilityChildList_h */
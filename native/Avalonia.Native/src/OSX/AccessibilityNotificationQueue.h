@@ -0,0 +1,187 @@
+#ifndef AccessibilityNotificationQueue_h
+#define AccessibilityNotificationQueue_h
+
+// Accessibility notifications collected and posted once per frame. Managed code reports every property change
+// as it happens, during an animation or while a list scrolls that is the same few notifications for the same
+// elements many times a frame, each one a round trip for the accessibility server. Queued notifications are
+// merged per element and kind: a change posted again keeps its place, a focus change moves to where it was
+// posted last so it still comes after what happened before it. Live region announcements of an element are
+// posted at most once per interval, one posted in between is delayed until the interval is over instead of
+// being dropped so the last text is always announced.
+// Plain C++, TElement keeps an element alive while it has notifications queued, posting them is up to the
+// caller. Timestamps are monotonic microseconds from the caller. Main thread only.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+enum class AccessibilityNotificationKind : uint8_t
+{
+    Title,
+    Value,
+    // Moved and resized
+    Bounds,
+    SelectedChildren,
+    // The value and whether the row is expanded, read when it is posted
+    ExpandCollapse,
+    // The text to announce is read when it is posted
+    LiveRegion,
+    Focus,
+};
+
+template <typename TElement>
+class AccessibilityNotificationQueue
+{
+public:
+    struct Notification
+    {
+        TElement Element;
+        AccessibilityNotificationKind Kind;
+    };
+
+    explicit AccessibilityNotificationQueue(uint64_t liveRegionIntervalUs = 500000)
+        : _liveRegionIntervalUs(liveRegionIntervalUs)
+    {
+    }
+
+    // key identifies the element. Returns true if a flush has to be scheduled.
+    bool Queue(const void* key, TElement element, AccessibilityNotificationKind kind, uint64_t nowUs)
+    {
+        auto it = _index.find(Key { key, kind });
+        if (it != _index.end())
+        {
+            if (kind != AccessibilityNotificationKind::Focus)
+                return false;
+
+            _pending[it->second].Removed = true;
+            _index.erase(it);
+        }
+
+        Entry entry { std::move(element), kind, 0, false };
+        if (kind == AccessibilityNotificationKind::LiveRegion)
+        {
+            auto last = _lastAnnouncedUs.find(key);
+            if (last != _lastAnnouncedUs.end() && nowUs - last->second < _liveRegionIntervalUs)
+                entry.DueUs = last->second + _liveRegionIntervalUs;
+        }
+
+        _index.emplace(Key { key, kind }, _pending.size());
+        _keys.push_back(key);
+        _pending.push_back(std::move(entry));
+
+        if (_flushScheduled)
+            return false;
+
+        _flushScheduled = true;
+        return true;
+    }
+
+    // Drops everything queued for an element that is going away
+    void Remove(const void* key)
+    {
+        for (size_t c = 0; c < _pending.size(); c++)
+        {
+            if (_keys[c] != key || _pending[c].Removed)
+                continue;
+
+            _pending[c].Removed = true;
+            _index.erase(Key { key, _pending[c].Kind });
+        }
+        _lastAnnouncedUs.erase(key);
+    }
+
+    // The notifications to post now, in order. Delayed announcements stay queued, nextDueUs is when the next
+    // one is due (0 if there is none), the caller schedules a flush for then.
+    std::vector<Notification> Flush(uint64_t nowUs, uint64_t& nextDueUs)
+    {
+        std::vector<Notification> ready;
+        std::vector<Entry> delayed;
+        std::vector<const void*> delayedKeys;
+        nextDueUs = 0;
+
+        for (size_t c = 0; c < _pending.size(); c++)
+        {
+            auto& entry = _pending[c];
+            if (entry.Removed)
+                continue;
+
+            if (entry.DueUs > nowUs)
+            {
+                nextDueUs = nextDueUs == 0 ? entry.DueUs : std::min(nextDueUs, entry.DueUs);
+                delayedKeys.push_back(_keys[c]);
+                delayed.push_back(std::move(entry));
+                continue;
+            }
+
+            if (entry.Kind == AccessibilityNotificationKind::LiveRegion)
+                _lastAnnouncedUs[_keys[c]] = nowUs;
+
+            ready.push_back(Notification { std::move(entry.Element), entry.Kind });
+        }
+
+        _pending.swap(delayed);
+        _keys.swap(delayedKeys);
+        _index.clear();
+        for (size_t c = 0; c < _pending.size(); c++)
+            _index.emplace(Key { _keys[c], _pending[c].Kind }, c);
+
+        // Announcements long enough ago don't hold anything back anymore
+        for (auto it = _lastAnnouncedUs.begin(); it != _lastAnnouncedUs.end();)
+        {
+            if (nowUs - it->second >= _liveRegionIntervalUs)
+                it = _lastAnnouncedUs.erase(it);
+            else
+                ++it;
+        }
+
+        _flushScheduled = false;
+        return ready;
+    }
+
+    bool IsEmpty() const
+    {
+        return _index.empty();
+    }
+
+private:
+    struct Key
+    {
+        const void* Element;
+        AccessibilityNotificationKind Kind;
+
+        bool operator==(const Key& other) const
+        {
+            return Element == other.Element && Kind == other.Kind;
+        }
+    };
+
+    struct KeyHash
+    {
+        size_t operator()(const Key& key) const
+        {
+            return std::hash<const void*>()(key.Element) * 31 + static_cast<size_t>(key.Kind);
+        }
+    };
+
+    struct Entry
+    {
+        TElement Element;
+        AccessibilityNotificationKind Kind;
+        // Not to be posted before, 0 for right away
+        uint64_t DueUs;
+        bool Removed;
+    };
+
+    uint64_t _liveRegionIntervalUs;
+    std::vector<Entry> _pending;
+    std::vector<const void*> _keys;
+    std::unordered_map<Key, size_t, KeyHash> _index;
+    std::unordered_map<const void*, uint64_t> _lastAnnouncedUs;
+    bool _flushScheduled = false;
+};
+
+#endif /* AccessibilityNotificationQueue_h */
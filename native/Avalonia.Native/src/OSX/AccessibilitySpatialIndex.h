@@ -0,0 +1,305 @@
+#ifndef AccessibilitySpatialIndex_h
+#define AccessibilitySpatialIndex_h
+
+// A uniform grid over the bounds of accessibility elements, so that hit tests can be answered without
+// walking the visual tree in managed code. It is built in one go from a snapshot of the element tree and
+// rebuilt once the tree itself changes. An element that moved is only marked, its entry and the ones of its
+// descendants (which move along with it) are updated in place by the next Refresh.
+// Plain C++, a key is whatever identifies an element (the AvnAccessibilityElement's pointer).
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "avalonia-native.h"
+
+class AccessibilitySpatialIndex
+{
+public:
+    typedef const void* Key;
+
+    explicit AccessibilitySpatialIndex(double cellSize = 128, size_t maxCellsPerEntry = 1024)
+        : _cellSize(cellSize), _maxCellsPerEntry(maxCellsPerEntry)
+    {
+    }
+
+    size_t GetCount() const
+    {
+        return _entries.size();
+    }
+
+    void Clear()
+    {
+        _entries.clear();
+        _indices.clear();
+        _cells.clear();
+        _oversized.clear();
+        _moved.clear();
+    }
+
+    bool Contains(Key key) const
+    {
+        return _indices.find(key) != _indices.end();
+    }
+
+    // The bounds passed to Add or Refresh, false if the element isn't in the index or moved since
+    bool TryGetBounds(Key key, AvnRect& bounds) const
+    {
+        auto index = _indices.find(key);
+        if (index == _indices.end() || _entries[index->second].moved)
+            return false;
+
+        auto& entry = _entries[index->second];
+        bounds = AvnRect { entry.x, entry.y, entry.width, entry.height };
+        return true;
+    }
+
+    // Marks an element whose bounds changed, returns false if it isn't in the index
+    bool MarkMoved(Key key)
+    {
+        auto index = _indices.find(key);
+        if (index == _indices.end())
+            return false;
+
+        auto& entry = _entries[index->second];
+        if (!entry.moved)
+        {
+            entry.moved = true;
+            _moved.push_back(index->second);
+        }
+        return true;
+    }
+
+    bool HasMoved() const
+    {
+        return !_moved.empty();
+    }
+
+    // Updates the elements marked as moved with the bounds getBounds(key) returns for them. Descendants move by
+    // as much as their ancestor did, unless they are marked themselves.
+    template <typename TGetBounds>
+    void Refresh(TGetBounds&& getBounds)
+    {
+        // Ancestors come before their descendants, they have to be done first
+        std::sort(_moved.begin(), _moved.end());
+        for (auto index : _moved)
+        {
+            auto& entry = _entries[index];
+            if (!entry.moved)
+                continue;
+
+            entry.moved = false;
+            AvnRect bounds = getBounds(entry.key);
+            auto dx = bounds.X - entry.x;
+            auto dy = bounds.Y - entry.y;
+            entry.x = bounds.X;
+            entry.y = bounds.Y;
+            entry.width = bounds.Width;
+            entry.height = bounds.Height;
+
+            auto end = SubtreeEnd(index);
+            for (auto descendant = index + 1; descendant < end; descendant++)
+            {
+                _entries[descendant].x += dx;
+                _entries[descendant].y += dy;
+            }
+            for (auto updated = index; updated < end; updated++)
+                Place(updated, true);
+        }
+        _moved.clear();
+    }
+
+    // Drops an element that is going away, its descendants stay and can still be hit
+    void Remove(Key key)
+    {
+        auto index = _indices.find(key);
+        if (index == _indices.end())
+            return;
+
+        Unplace(index->second);
+        _entries[index->second].key = nullptr;
+        _entries[index->second].moved = false;
+        _indices.erase(index);
+    }
+
+    // Adds an element, its bounds are clipped to the ones of its parent as the parent clips its content.
+    // Parents have to be added before their children, and children in z-order.
+    // complete tells whether all of the element's children are in the index too.
+    void Add(Key key, Key parent, AvnRect bounds, bool complete)
+    {
+        Entry entry;
+        entry.key = key;
+        entry.parent = parent;
+        entry.parentIndex = NoParent;
+        entry.x = bounds.X;
+        entry.y = bounds.Y;
+        entry.width = bounds.Width;
+        entry.height = bounds.Height;
+        entry.depth = 0;
+        entry.complete = complete;
+        entry.moved = false;
+
+        auto parentIndex = _indices.find(parent);
+        if (parent != nullptr && parentIndex != _indices.end())
+        {
+            entry.parentIndex = parentIndex->second;
+            entry.depth = _entries[parentIndex->second].depth + 1;
+        }
+
+        auto index = static_cast<uint32_t>(_entries.size());
+        _entries.push_back(entry);
+        _indices[key] = index;
+        Place(index, false);
+    }
+
+    // The deepest element containing the point, the last added one among elements of the same depth.
+    // Returns nullptr if there is none, complete is set to the one passed to Add.
+    Key HitTest(double x, double y, bool* complete = nullptr) const
+    {
+        const Entry* best = nullptr;
+        uint32_t bestIndex = 0;
+
+        auto consider = [&](uint32_t index)
+        {
+            auto& entry = _entries[index];
+            if (x < entry.left || x >= entry.right || y < entry.top || y >= entry.bottom)
+                return;
+            if (best == nullptr || entry.depth > best->depth || (entry.depth == best->depth && index > bestIndex))
+            {
+                best = &entry;
+                bestIndex = index;
+            }
+        };
+
+        auto cell = _cells.find(CellKey(CellIndex(x), CellIndex(y)));
+        if (cell != _cells.end())
+            for (auto index : cell->second)
+                consider(index);
+
+        for (auto index : _oversized)
+            consider(index);
+
+        if (complete != nullptr)
+            *complete = best != nullptr && best->complete;
+
+        return best != nullptr ? best->key : nullptr;
+    }
+
+    // The parent passed to Add, nullptr for elements that aren't in the index or whose parent was removed
+    Key GetParent(Key key) const
+    {
+        auto index = _indices.find(key);
+        if (index == _indices.end())
+            return nullptr;
+
+        auto& entry = _entries[index->second];
+        return entry.parentIndex != NoParent ? _entries[entry.parentIndex].key : entry.parent;
+    }
+
+private:
+    static constexpr uint32_t NoParent = UINT32_MAX;
+
+    struct Entry
+    {
+        Key key;
+        Key parent;
+        uint32_t parentIndex;
+        // As passed in
+        double x, y, width, height;
+        // Clipped to the parent
+        double left, top, right, bottom;
+        int depth;
+        bool complete;
+        bool moved;
+    };
+
+    // One past the last descendant of an entry, they all follow it
+    uint32_t SubtreeEnd(uint32_t index) const
+    {
+        auto end = index + 1;
+        while (end < _entries.size() && _entries[end].depth > _entries[index].depth)
+            end++;
+        return end;
+    }
+
+    // Clips an entry to its parent and adds it to the cells it covers, taking it out of the old ones first
+    void Place(uint32_t index, bool placed)
+    {
+        if (placed)
+            Unplace(index);
+
+        auto& entry = _entries[index];
+        if (entry.key == nullptr)
+            return;
+
+        entry.left = entry.x;
+        entry.top = entry.y;
+        entry.right = entry.x + std::max(0.0, entry.width);
+        entry.bottom = entry.y + std::max(0.0, entry.height);
+        if (entry.parentIndex != NoParent)
+        {
+            auto& parentEntry = _entries[entry.parentIndex];
+            entry.left = std::max(entry.left, parentEntry.left);
+            entry.top = std::max(entry.top, parentEntry.top);
+            entry.right = std::min(entry.right, parentEntry.right);
+            entry.bottom = std::min(entry.bottom, parentEntry.bottom);
+        }
+
+        ForEachCell(entry, [&](std::vector<uint32_t>& cell) { cell.push_back(index); });
+    }
+
+    void Unplace(uint32_t index)
+    {
+        ForEachCell(_entries[index], [&](std::vector<uint32_t>& cell)
+        {
+            auto it = std::find(cell.begin(), cell.end(), index);
+            if (it != cell.end())
+                cell.erase(it);
+        });
+    }
+
+    template <typename TVisit>
+    void ForEachCell(const Entry& entry, TVisit&& visit)
+    {
+        // Clipped away entirely, it can still be the parent of something but never be hit
+        if (!(entry.left < entry.right && entry.top < entry.bottom))
+            return;
+
+        auto firstX = CellIndex(entry.left), lastX = CellIndex(entry.right);
+        auto firstY = CellIndex(entry.top), lastY = CellIndex(entry.bottom);
+        auto cells = static_cast<double>(lastX - firstX + 1) * static_cast<double>(lastY - firstY + 1);
+
+        if (cells > static_cast<double>(_maxCellsPerEntry))
+        {
+            visit(_oversized);
+            return;
+        }
+
+        for (auto y = firstY; y <= lastY; y++)
+            for (auto x = firstX; x <= lastX; x++)
+                visit(_cells[CellKey(x, y)]);
+    }
+
+    int32_t CellIndex(double coordinate) const
+    {
+        auto cell = std::floor(coordinate / _cellSize);
+        return static_cast<int32_t>(std::max(-1e9, std::min(1e9, cell)));
+    }
+
+    static uint64_t CellKey(int32_t x, int32_t y)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+
+    double _cellSize;
+    size_t _maxCellsPerEntry;
+    std::vector<Entry> _entries;
+    std::unordered_map<Key, uint32_t> _indices;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> _cells;
+    std::vector<uint32_t> _oversized;
+    std::vector<uint32_t> _moved;
+};
+
+#endif /* AccessibilitySpatialIndex_h */
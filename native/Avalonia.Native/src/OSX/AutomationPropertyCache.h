@@ -0,0 +1,128 @@
+#ifndef AutomationPropertyCache_h
+#define AutomationPropertyCache_h
+
+// Caches the property snapshot of an automation peer, and the strings read next to it, so that the dozens of
+// attributes an accessibility client reads per element don't each need a call into managed code.
+// Property change notifications invalidate the parts they affect right away. Not every change is notified
+// (bounds move with a scrolled parent, IsEnabled has no notification at all), so every part also expires
+// after a short time that covers one burst of attribute reads.
+// Plain C++, timestamps are monotonic microseconds supplied by the caller.
+
+#include <cstdint>
+#include "avalonia-native.h"
+
+enum AutomationCachedPart : uint32_t
+{
+    // ControlType, LandmarkType, LiveSetting, HeadingLevel and Providers
+    AutomationCachedIdentity = 1 << 0,
+    // States and the range limits
+    AutomationCachedStates = 1 << 1,
+    AutomationCachedBounds = 1 << 2,
+    AutomationCachedRangeValue = 1 << 3,
+    AutomationCachedToggleState = 1 << 4,
+    // Strings, fetched separately from the snapshot
+    AutomationCachedName = 1 << 5,
+    AutomationCachedValue = 1 << 6,
+
+    AutomationCachedSnapshot = AutomationCachedIdentity | AutomationCachedStates | AutomationCachedBounds |
+                               AutomationCachedRangeValue | AutomationCachedToggleState,
+};
+
+class AutomationPropertyCache
+{
+public:
+    explicit AutomationPropertyCache(uint64_t maxAgeUs = 100000) : _maxAgeUs(maxAgeUs)
+    {
+    }
+
+    // Returns the snapshot, fetching a new one first if any of the requested parts is stale
+    template <typename TFetch>
+    const AvnAutomationPropertySnapshot& GetSnapshot(uint32_t parts, uint64_t nowUs, TFetch&& fetch)
+    {
+        if (!IsValid(parts, nowUs))
+        {
+            _snapshot = fetch();
+            MarkValid(AutomationCachedSnapshot, nowUs);
+        }
+
+        return _snapshot;
+    }
+
+    bool IsValid(uint32_t parts, uint64_t nowUs) const
+    {
+        for (int i = 0; i < PartCount; i++)
+        {
+            if ((parts & (1u << i)) == 0)
+                continue;
+
+            if (_fetchedAtUs[i] == 0 || nowUs < _fetchedAtUs[i] || nowUs - _fetchedAtUs[i] > _maxAgeUs)
+                return false;
+        }
+
+        return true;
+    }
+
+    void MarkValid(uint32_t parts, uint64_t nowUs)
+    {
+        // 0 marks a part as never fetched
+        if (nowUs == 0)
+            nowUs = 1;
+
+        for (int i = 0; i < PartCount; i++)
+        {
+            if ((parts & (1u << i)) != 0)
+                _fetchedAtUs[i] = nowUs;
+        }
+    }
+
+    void Invalidate(uint32_t parts)
+    {
+        for (int i = 0; i < PartCount; i++)
+        {
+            if ((parts & (1u << i)) != 0)
+                _fetchedAtUs[i] = 0;
+        }
+    }
+
+    void Invalidate(AvnAutomationProperty property)
+    {
+        Invalidate(PartsAffectedBy(property));
+    }
+
+    static uint32_t PartsAffectedBy(AvnAutomationProperty property)
+    {
+        switch (property)
+        {
+            case AutomationPeer_AutomationId:
+                return 0;
+            case AutomationPeer_BoundingRectangle:
+                return AutomationCachedBounds;
+            case AutomationPeer_ClassName:
+                return AutomationCachedIdentity;
+            case AutomationPeer_Name:
+                return AutomationCachedName;
+            case RangeValueProvider_Value:
+                return AutomationCachedRangeValue;
+            case ValueProvider_Value:
+                return AutomationCachedValue;
+            case ToggleProvider_ToggleState:
+                return AutomationCachedToggleState;
+            case ExpandCollapseProvider_ExpandCollapseState:
+            case SelectionItemProvider_IsSelected:
+            case SelectionProvider_Selection:
+                return AutomationCachedStates;
+        }
+
+        // Unknown to us, so assume everything changed
+        return AutomationCachedSnapshot | AutomationCachedName | AutomationCachedValue;
+    }
+
+private:
+    static constexpr int PartCount = 7;
+
+    const uint64_t _maxAgeUs;
+    uint64_t _fetchedAtUs[PartCount] = {};
+    AvnAutomationPropertySnapshot _snapshot {};
+};
+
+#endif /* AutomationPropertyCache_h */
@@ -1,6 +1,7 @@
 #pragma once
 #import <Cocoa/Cocoa.h>
 #import "avalonia-native.h"
+#include "AccessibilityNotificationQueue.h"
 
 // Defines the interface between AvnAutomationNode and objects which implement
 // NSAccessibility such as AvnAccessibilityElement or AvnWindow.
@@ -9,4 +10,10 @@
 - (void) raiseChildrenChanged;
 - (void) raiseFocusChanged;
 - (void) raisePropertyChanged:(AvnAutomationProperty)property;
+// Posts a notification queued with QueueAccessibilityNotification
+- (void) postAccessibilityNotification:(AccessibilityNotificationKind)kind;
 @end
+
+// Notifications are posted together once the main thread is done with what it is doing, merged per element
+void QueueAccessibilityNotification(id<AvnAccessibility> element, AccessibilityNotificationKind kind);
+void CancelAccessibilityNotifications(id<AvnAccessibility> element);
@@ -9,7 +9,12 @@ public:
     FORWARD_IUNKNOWN()
     AvnAutomationNode(id <AvnAccessibility> owner) { _owner = owner; }
     AvnAccessibilityElement* GetOwner() { return _owner; }
-    virtual void Dispose() override { _owner = nil; }
+    virtual void Dispose() override
+    {
+        if (_owner != nil)
+            CancelAccessibilityNotifications(_owner);
+        _owner = nil;
+    }
     virtual void ChildrenChanged () override { [_owner raiseChildrenChanged]; }
     virtual void PropertyChanged (AvnAutomationProperty property) override { [_owner raisePropertyChanged:property]; }
     virtual void FocusChanged () override { [_owner raiseFocusChanged]; }
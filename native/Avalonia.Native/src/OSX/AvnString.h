@@ -14,7 +14,9 @@ extern IAvnStringArray* CreateAvnStringArray(NSArray<NSString*>* array);
 extern IAvnStringArray* CreateAvnStringArray(NSArray<NSURL*>* array);
 extern IAvnStringArray* CreateAvnStringArray(NSString* string);
 extern IAvnString* CreateByteArray(void* data, int len);
+extern IAvnBuffer* CreateAvnBuffer(NSData* data);
 extern NSString* GetNSStringAndRelease(IAvnString* s);
 extern NSString* GetNSStringWithoutRelease(IAvnString* s);
+extern NSString* CreateNSStringFromUtf8(const char* p, size_t length);
 extern NSArray<NSString*>* GetNSArrayOfStringsAndRelease(IAvnStringArray* array);
 #endif /* AvnString_h */
@@ -7,6 +7,7 @@
 //
 
 #include "common.h"
+#include "Utf8Transcoder.h"
 #include <vector>
 
 class AvnStringImpl : public virtual ComSingleObject<IAvnString, &IID_IAvnString>
@@ -20,13 +21,43 @@ public:
     
     AvnStringImpl(NSString* string)
     { 
-        auto cstring = [string cStringUsingEncoding:NSUTF8StringEncoding];
-        _length = (int)[string lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+        auto cfstring = (__bridge CFStringRef)string;
+        auto length = string != nil ? (size_t)CFStringGetLength(cfstring) : 0;
         
-        _cstring = (const char*)malloc(_length + 5);
+        // ASCII strings are usually stored as such, they are copied as they are
+        auto ascii = string != nil ? CFStringGetCStringPtr(cfstring, kCFStringEncodingASCII) : nullptr;
+        if (ascii != nullptr)
+        {
+            _length = (int)length;
+            _cstring = (const char*)malloc(length + 5);
+            memcpy((void*)_cstring, ascii, length);
+            memset((void*)(_cstring + length), 0, 5);
+            return;
+        }
+        
+        std::vector<char16_t> buffer;
+        auto chars = length != 0 ? (const char16_t*)CFStringGetCharactersPtr(cfstring) : nullptr;
+        if (chars == nullptr && length != 0)
+        {
+            buffer.resize(length);
+            CFStringGetCharacters(cfstring, CFRangeMake(0, (CFIndex)length), (UniChar*)buffer.data());
+            chars = buffer.data();
+        }
+        
+        // Converted in one pass into room for the worst case, what isn't needed is given back afterwards
+        auto capacity = length * 3;
+        auto cstring = (char*)malloc(capacity + 5);
+        auto written = chars != nullptr ? Utf16ToUtf8(chars, length, cstring) : 0;
+        memset(cstring + written, 0, 5);
+        if (written + 5 < capacity / 2)
+        {
+            auto shrunk = (char*)realloc(cstring, written + 5);
+            if (shrunk != nullptr)
+                cstring = shrunk;
+        }
         
-        memset((void*)_cstring, 0, _length + 5);
-        memcpy((void*)_cstring, (void*)cstring, _length);
+        _length = (int)written;
+        _cstring = cstring;
     }
     
     AvnStringImpl(void*ptr, int len)
@@ -76,6 +107,52 @@ public:
     }
 };
 
+class AvnBufferImpl : public virtual ComSingleObject<IAvnBuffer, &IID_IAvnBuffer>
+{
+private:
+    // Owns the bytes, they stay in place for as long as the buffer is alive
+    NSData* _data;
+    
+public:
+    FORWARD_IUNKNOWN()
+    
+    AvnBufferImpl(NSData* data)
+    {
+        _data = data != nil ? data : [NSData data];
+    }
+    
+    virtual HRESULT Pointer(void**retOut) override
+    {
+        START_COM_CALL;
+        
+        if(retOut == nullptr)
+        {
+            return E_POINTER;
+        }
+        
+        // An empty NSData has no bytes at all, callers still get a valid pointer
+        static uint8_t empty = 0;
+        auto bytes = [_data bytes];
+        *retOut = bytes != nullptr ? (void*)bytes : (void*)&empty;
+        
+        return S_OK;
+    }
+    
+    virtual HRESULT Length(long*retOut) override
+    {
+        START_COM_CALL;
+        
+        if(retOut == nullptr)
+        {
+            return E_POINTER;
+        }
+        
+        *retOut = (long)[_data length];
+        
+        return S_OK;
+    }
+};
+
 class AvnStringArrayImpl : public virtual ComSingleObject<IAvnStringArray, &IID_IAvnStringArray>
 {
 private:
@@ -149,31 +226,55 @@ IAvnString* CreateByteArray(void* data, int len)
     return new AvnStringImpl(data, len);
 }
 
-NSString* GetNSStringAndRelease(IAvnString* s)
+IAvnBuffer* CreateAvnBuffer(NSData* data)
+{
+    return new AvnBufferImpl(data);
+}
+
+NSString* CreateNSStringFromUtf8(const char* p, size_t length)
+{
+    if (p == nullptr)
+        return nil;
+    
+    // Kept in 8 bits per character by CoreFoundation
+    if (IsAscii(p, length))
+        return [[NSString alloc] initWithBytes:p length:length encoding:NSASCIIStringEncoding];
+    
+    auto chars = (char16_t*)malloc(length * sizeof(char16_t));
+    size_t written;
+    if (chars == nullptr || !Utf8ToUtf16(p, length, chars, written))
+    {
+        free(chars);
+        return nil;
+    }
+    
+    return [[NSString alloc] initWithCharactersNoCopy:(unichar*)chars length:written freeWhenDone:YES];
+}
+
+NSString* GetNSStringWithoutRelease(IAvnString* s)
 {
     NSString* result = nil;
     
     if (s != nullptr)
     {
         char* p;
-        if (s->Pointer((void**)&p) == S_OK && p != nullptr)
-            result = [NSString stringWithUTF8String:p];
-        
-        s->Release();
+        int length;
+        // The length is known, there is no need to look for the terminator
+        if (s->Pointer((void**)&p) == S_OK && p != nullptr && s->Length(&length) == S_OK && length >= 0)
+            result = CreateNSStringFromUtf8(p, (size_t)length);
     }
     
     return result;
 }
 
-NSString* GetNSStringWithoutRelease(IAvnString* s)
+NSString* GetNSStringAndRelease(IAvnString* s)
 {
     NSString* result = nil;
     
     if (s != nullptr)
     {
-        char* p;
-        if (s->Pointer((void**)&p) == S_OK && p != nullptr)
-            result = [NSString stringWithUTF8String:p];
+        result = GetNSStringWithoutRelease(s);
+        s->Release();
     }
     
     return result;
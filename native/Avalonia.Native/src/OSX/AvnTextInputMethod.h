@@ -42,6 +42,8 @@ public:
     
     virtual void SetSelectionInSurroundingText (int start, int end) override;
     
+    virtual void SetSurroundingTextWindow (char* text, int windowStart, int documentLength, int start, int end) override;
+    
 public:
     ComPtr<IAvnTextInputMethodClient> Client;
 };
@@ -7,6 +7,7 @@
 //
 
 #include "AvnTextInputMethod.h"
+#include "AvnString.h"
 
 AvnTextInputMethod::~AvnTextInputMethod() {
     Client = nullptr;
@@ -32,11 +33,17 @@ void AvnTextInputMethod::Reset() {
     [_inputMethodDelegate resetInputMethod];
 }
 
+// CreateNSStringFromUtf8 returns nil for a null pointer and for invalid UTF-8.
+static NSString* SurroundingTextFromUtf8(char* text) {
+    NSString* surroundingText = text != nullptr ? CreateNSStringFromUtf8(text, strlen(text)) : nil;
+    
+    return surroundingText != nil ? surroundingText : @"";
+}
+
 void AvnTextInputMethod::SetSurroundingText(char* text, int start, int end) {
-    // stringWithUTF8String: throws on a null pointer and returns nil for invalid UTF-8.
-    NSString* surroundingText = text != nullptr ? [NSString stringWithUTF8String:text] : nil;
+    NSString* surroundingText = SurroundingTextFromUtf8(text);
 
-    [_inputMethodDelegate setText:surroundingText != nil ? surroundingText : @""];
+    [_inputMethodDelegate setText:surroundingText windowStart:0 documentLength:(int)[surroundingText length]];
     [_inputMethodDelegate setSelection: start:end];
 }
 
@@ -47,3 +54,8 @@ void AvnTextInputMethod::SetCursorRect(AvnRect rect) {
 void AvnTextInputMethod::SetSelectionInSurroundingText(int start, int end) {
     [_inputMethodDelegate setSelection: start:end];
 }
+
+void AvnTextInputMethod::SetSurroundingTextWindow(char* text, int windowStart, int documentLength, int start, int end) {
+    [_inputMethodDelegate setText:SurroundingTextFromUtf8(text) windowStart:windowStart documentLength:documentLength];
+    [_inputMethodDelegate setSelection: start:end];
+}
@@ -11,7 +11,7 @@
 
 @protocol AvnTextInputMethodDelegate
 @required
--(void) setText:(NSString* _Nonnull) text;
+-(void) setText:(NSString* _Nonnull) text windowStart: (int) windowStart documentLength: (int) documentLength;
 -(void) setCursorRect:(AvnRect) cursorRect;
 -(void) setSelection: (int) start : (int) end;
 -(void) resetInputMethod;
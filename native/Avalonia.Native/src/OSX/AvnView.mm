@@ -7,6 +7,12 @@
 #import <Carbon/Carbon.h> /* For the TIS functions used to classify the keyboard input source. */
 #include "AvnView.h"
 #include "automation.h"
+#include "InputLatencyTracer.h"
+#include "SurroundingTextBuffer.h"
+#include "AccessibilitySpatialIndex.h"
+#include "DragSession.h"
+#include "LiveResizeCoordinator.h"
+#include "StartupTracer.h"
 #import "WindowInterfaces.h"
 #import "WindowImpl.h"
 
@@ -16,16 +22,23 @@
     NSTrackingArea* _area;
     AvnInputModifiers _modifierState;
     NSEvent* _lastMouseDownEvent;
-    AvnPixelSize _lastPixelSize;
+    LiveResizeCoordinator _resize;
     NSObject<IRenderTarget>* _currentRenderTarget;
     AvnPlatformResizeReason _resizeReason;
     NSRect _cursorRect;
-    NSMutableAttributedString* _text;
-    NSRange _selectedRange;
+    SurroundingTextBuffer _surroundingText;
     NSRange _markedRange;
-    NSMutableArray* _accessibilityChildren;
+    AvnAccessibilityChildren* _accessibilityChildren;
+    AccessibilitySpatialIndex _accessibilityIndex;
+    // Changes whenever accessibility children were loaded or changed within the view
+    uint64_t _accessibilityLayoutGeneration;
+    uint64_t _accessibilityIndexGeneration;
+    uint64_t _accessibilityIndexMissGeneration;
+    int _accessibilityIndexMisses;
     NSString* _keyboardInputSourceId;
     bool _keyboardInputSourceComposes;
+    DragSession _dragSession;
+    ComPtr<IAvnClipboard> _dragClipboard;
 }
 
 - (void)onClosed
@@ -36,6 +49,28 @@
     }
 }
 
+// Leaves the view the way a new one starts out, a pooled popup must not show or report anything of its last owner
+- (void)resetForReuse
+{
+    if ([self layer])
+        [self layer].delegate = nil;
+    _currentRenderTarget = nil;
+
+    _surroundingText = SurroundingTextBuffer();
+    _markedRange = NSMakeRange(0, 0);
+
+    _accessibilityChildren = nil;
+    _accessibilityIndex.Clear();
+    _accessibilityLayoutGeneration = 1;
+    _accessibilityIndexGeneration = 0;
+    _accessibilityIndexMissGeneration = 0;
+    _accessibilityIndexMisses = 0;
+
+    [self endDragSession];
+    _modifierState = AvnInputModifiersNone;
+    _lastMouseDownEvent = nil;
+}
+
 - (NSEvent*) lastMouseDownEvent
 {
     return _lastMouseDownEvent;
@@ -44,7 +79,8 @@
 - (void) updateRenderTarget
 {
     if(_currentRenderTarget) {
-        AvnPixelSize size { MAX(_lastPixelSize.Width, 1), MAX(_lastPixelSize.Height, 1) };
+        auto committed = _resize.GetCommittedPixelSize();
+        AvnPixelSize size { MAX(committed.Width, 1), MAX(committed.Height, 1) };
         [_currentRenderTarget resize:size withScale:static_cast<float>([[self window] backingScaleFactor])];
         [self setNeedsDisplayInRect:[self frame]];
     }
@@ -81,15 +117,12 @@
 
     _parent = parent;
     _area = nullptr;
-    _lastPixelSize.Height = 100;
-    _lastPixelSize.Width = 100;
+    _accessibilityLayoutGeneration = 1;
     [self registerForDraggedTypes: @[@"public.data", GetAvnCustomDataType()]];
 
     _modifierState = AvnInputModifiersNone;
     
-    _text = [[NSMutableAttributedString alloc] initWithString:@""];
     _markedRange = NSMakeRange(0, 0);
-    _selectedRange = NSMakeRange(0, 0);
     
     return self;
 }
@@ -128,41 +161,80 @@
 {
     [super setFrameSize:newSize];
 
-    if(_area != nullptr)
-    {
-        [self removeTrackingArea:_area];
-        _area = nullptr;
-    }
+    [self invalidateAccessibilityIndex];
 
     auto parent = _parent.tryGet();
     if (parent == nullptr)
     {
+        if(_area != nullptr)
+        {
+            [self removeTrackingArea:_area];
+            _area = nullptr;
+        }
+
         return;
     }
 
-    NSRect rect = NSZeroRect;
-    rect.size = newSize;
-
-    NSTrackingAreaOptions options = NSTrackingActiveAlways | NSTrackingMouseMoved | NSTrackingMouseEnteredAndExited | NSTrackingEnabledDuringMouseDrag;
-    _area = [[NSTrackingArea alloc] initWithRect:rect options:options owner:self userInfo:nullptr];
-    [self addTrackingArea:_area];
+    // Follows the visible rect by itself, there is no need to replace it on every resize
+    if(_area == nullptr)
+    {
+        NSTrackingAreaOptions options = NSTrackingActiveAlways | NSTrackingMouseMoved | NSTrackingMouseEnteredAndExited | NSTrackingEnabledDuringMouseDrag | NSTrackingInVisibleRect;
+        _area = [[NSTrackingArea alloc] initWithRect:NSZeroRect options:options owner:self userInfo:nullptr];
+        [self addTrackingArea:_area];
+    }
 
     parent->UpdateCursor();
 
     auto fsize = [self convertSizeToBacking: [self frame].size];
+    AvnPixelSize pixelSize { (int)fsize.width, (int)fsize.height };
+    bool inLiveResize = [self inLiveResize];
+    auto reason = inLiveResize ? ResizeUser : _resizeReason;
 
-    if(_lastPixelSize.Width != (int)fsize.width || _lastPixelSize.Height != (int)fsize.height)
+    LiveResizeCommit commit;
+    switch (_resize.OnSizeChanged(pixelSize, FromNSSize(newSize), reason, inLiveResize, commit))
     {
-        _lastPixelSize.Width = (int)fsize.width;
-        _lastPixelSize.Height = (int)fsize.height;
-        [self updateRenderTarget];
+        case LiveResizeAction::Commit:
+            [self commitResize:commit];
+            break;
+        case LiveResizeAction::ScheduleFlush:
+            // Committed by updateLayer right before the view is drawn, the fallback covers a view that has
+            // nothing to draw into yet
+            [self setNeedsDisplay:YES];
+            dispatch_async(dispatch_get_main_queue(), ^{
+                [self flushResize];
+            });
+            break;
+        default:
+            break;
+    }
+}
+
+- (void)commitResize:(const LiveResizeCommit&)commit
+{
+    [self updateRenderTarget];
 
-        auto reason = [self inLiveResize] ? ResizeUser : _resizeReason;
+    auto parent = _parent.tryGet();
+    if (parent != nullptr)
+    {
+        parent->TopLevelEvents->Resized(commit.Size, commit.Reason);
+    }
+}
 
-        parent->TopLevelEvents->Resized(FromNSSize(newSize), reason);
+- (void)flushResize
+{
+    LiveResizeCommit commit;
+    if (_resize.Flush(commit))
+    {
+        [self commitResize:commit];
     }
 }
 
+- (void)viewDidEndLiveResize
+{
+    [super viewDidEndLiveResize];
+    [self flushResize];
+}
+
 - (void)updateLayer
 {
     AvnInsidePotentialDeadlock deadlock;
@@ -172,6 +244,18 @@
         return;
     }
 
+    // The size of a live resize is committed here so layout, the render target and the frame drawn agree on it
+    if (_resize.HasPending())
+    {
+        [self flushResize];
+
+        parent = _parent.tryGet();
+        if (parent == nullptr)
+        {
+            return;
+        }
+    }
+
     parent->TopLevelEvents->RunRenderPriorityJobs();
 
     parent = _parent.tryGet();
@@ -180,7 +264,16 @@
         return;
     }
 
+    auto& startup = GetStartupTracer();
+    auto paintStartUs = startup.IsRecording() ? AvnMonotonicMicroseconds() : 0;
+
     parent->TopLevelEvents->Paint();
+
+    // Embedded controls moved by the paint go into the same transaction as the frame
+    FlushNativeControlLayouts(self);
+
+    if (paintStartUs != 0)
+        startup.Complete("FirstPaint", paintStartUs, AvnMonotonicMicroseconds());
 }
 
 - (void)drawRect:(NSRect)dirtyRect
@@ -197,8 +290,7 @@
 - (void) viewDidChangeBackingProperties
 {
     auto fsize = [self convertSizeToBacking: [self frame].size];
-    _lastPixelSize.Width = (int)fsize.width;
-    _lastPixelSize.Height = (int)fsize.height;
+    _resize.SetCommittedPixelSize(AvnPixelSize { (int)fsize.width, (int)fsize.height });
     [self updateRenderTarget];
 
     auto parent = _parent.tryGet();
@@ -249,6 +341,38 @@ static void ConvertTilt(NSPoint tilt, float* xTilt, float* yTilt)
     *yTilt = -tilt.y * 90;
 }
 
+static AvnInputLatencyEventKind InputLatencyKindFromMouseEventType(AvnRawMouseEventType type)
+{
+    switch (type)
+    {
+        case Move:
+        case LeaveWindow:
+            return AvnInputLatencyEventKindMouseMove;
+        case Wheel:
+        case Magnify:
+        case Rotate:
+        case Swipe:
+            return AvnInputLatencyEventKindWheel;
+        default:
+            return AvnInputLatencyEventKindMouseButton;
+    }
+}
+
+- (uint64_t) beginInputTrace: (AvnInputLatencyEventKind) kind withTimestamp: (uint64_t) timestampUs
+{
+    auto& tracer = GetInputLatencyTracer();
+    if(!tracer.IsEnabled())
+        return 0;
+
+    return tracer.InputReceived((__bridge void*)[self layer], kind, timestampUs);
+}
+
+- (void) endInputTrace: (uint64_t) token
+{
+    if(token != 0)
+        GetInputLatencyTracer().InputDispatched(token, AvnMonotonicMicroseconds());
+}
+
 - (void)mouseEvent:(NSEvent *)event withType:(AvnRawMouseEventType) type
 {
     bool triggerInputWhenDisabled = type != Move && type != LeaveWindow;
@@ -349,7 +473,8 @@ static void ConvertTilt(NSPoint tilt, float* xTilt, float* yTilt)
             break;
     }
 
-    uint64_t timestamp = static_cast<uint64_t>([event timestamp] * 1000);
+    auto timestampUs = AvnEventTimestampMicroseconds(event);
+    uint64_t timestamp = timestampUs / 1000;
     auto modifiers = [self getModifiers:[event modifierFlags]];
 
     if(type != Move ||
@@ -389,7 +514,9 @@ static void ConvertTilt(NSPoint tilt, float* xTilt, float* yTilt)
     auto parent = _parent.tryGet();
     if(parent != nullptr)
     {
+        auto traceToken = [self beginInputTrace:InputLatencyKindFromMouseEventType(type) withTimestamp:timestampUs];
         parent->TopLevelEvents->RawMouseEvent(type, pointerType, timestamp, modifiers, point, delta, pressure, xTilt, yTilt);
+        [self endInputTrace:traceToken];
     }
 
     [super mouseMoved:event];
@@ -584,10 +711,13 @@ static void ConvertTilt(NSPoint tilt, float* xTilt, float* yTilt)
     auto keySymbol = KeySymbolFromScanCode(scanCode, [event modifierFlags]);
     auto keySymbolUtf8 = keySymbol == nullptr ? nullptr : [keySymbol UTF8String];
     
-    auto timestamp = static_cast<uint64_t>([event timestamp] * 1000);
+    auto timestampUs = AvnEventTimestampMicroseconds(event);
+    auto timestamp = timestampUs / 1000;
     auto modifiers = [self getModifiers:[event modifierFlags]];
 
+    auto traceToken = [self beginInputTrace:AvnInputLatencyEventKindKey withTimestamp:timestampUs];
     parent->TopLevelEvents->RawKeyEvent(type, timestamp, modifiers, key, physicalKey, keySymbolUtf8);
+    [self endInputTrace:traceToken];
 }
 
 - (void)setModifiers:(NSEventModifierFlags)modifierFlags
@@ -755,7 +885,8 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
         return;
     }
 
-    auto timestamp = static_cast<uint64_t>([event timestamp] * 1000);
+    auto timestampUs = AvnEventTimestampMicroseconds(event);
+    auto timestamp = timestampUs / 1000;
 
     auto scanCode = [event keyCode];
     auto physicalKey = PhysicalKeyFromScanCode(scanCode);
@@ -788,7 +919,9 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
     // A KeyDown is always raised before the input context sees the event, otherwise the
     // input context silently consumes printable keys (space, letters, digits) and user code
     // never gets a chance to react to them.
+    auto traceToken = [self beginInputTrace:AvnInputLatencyEventKindKey withTimestamp:timestampUs];
     auto handled = parent->TopLevelEvents->RawKeyEvent(KeyDown, timestamp, modifiers, key, physicalKey, keySymbolUtf8);
+    [self endInputTrace:traceToken];
 
     if(handled)
     {
@@ -803,7 +936,9 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
     }
     else if(keySymbol != nullptr && key != AvnKeyEnter)
     {
+        traceToken = [self beginInputTrace:AvnInputLatencyEventKindTextInput withTimestamp:timestampUs];
         parent->TopLevelEvents->RawTextInputEvent(timestamp, keySymbolUtf8);
+        [self endInputTrace:traceToken];
     }
 }
 
@@ -848,20 +983,21 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
     return (AvnInputModifiers)rv;
 }
 
-// Clamps a range so that it can never be used to index outside of _text.
-// Ranges reaching us from AppKit or from the managed side are not guaranteed to be valid.
-- (NSRange)clampRangeToText:(NSRange)range
+static SurroundingTextRange ToSurroundingTextRange(NSRange range)
 {
-    if (range.location == NSNotFound)
-        return NSMakeRange(NSNotFound, 0);
-
-    NSUInteger length = _text.length;
+    return { range.location == NSNotFound ? SurroundingTextBuffer::NotFound : range.location, range.length };
+}
 
-    if (range.location > length)
-        return NSMakeRange(length, 0);
+static NSRange ToNSRange(SurroundingTextRange range)
+{
+    return NSMakeRange(range.location == SurroundingTextBuffer::NotFound ? NSNotFound : range.location, range.length);
+}
 
-    // Avoids the overflow of location + length that a plain bounds check would have.
-    return NSMakeRange(range.location, MIN(range.length, length - range.location));
+// Clamps a range so that it can never be used to index outside of the surrounding text.
+// Ranges reaching us from AppKit or from the managed side are not guaranteed to be valid.
+- (NSRange)clampRangeToText:(NSRange)range
+{
+    return ToNSRange(_surroundingText.ClampRange(ToSurroundingTextRange(range)));
 }
 
 - (BOOL)hasMarkedText
@@ -878,12 +1014,12 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
     // The preedit isn't necessarily part of the surrounding text we got from the managed side,
     // so only the location is clamped here. An overlong length is handled by
     // attributedSubstringForProposedRange:actualRange:, as the docs require.
-    return NSMakeRange(MIN(_markedRange.location, _text.length), _markedRange.length);
+    return NSMakeRange(MIN(_markedRange.location, _surroundingText.GetDocumentLength()), _markedRange.length);
 }
 
 - (NSRange)selectedRange
 {
-    return [self clampRangeToText:_selectedRange];
+    return ToNSRange(_surroundingText.GetSelection());
 }
 
 - (void)setMarkedText:(id)string selectedRange:(NSRange)selectedRange replacementRange:(NSRange)replacementRange
@@ -912,7 +1048,7 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
     if (finalReplacementRange.location != NSNotFound && parent != nullptr && parent->InputMethod->IsActive())
     {
         parent->InputMethod->Client->SelectInSurroundingText((int)finalReplacementRange.location, (int)(finalReplacementRange.location + finalReplacementRange.length));
-        uint64_t timestamp = static_cast<uint64_t>([NSDate timeIntervalSinceReferenceDate] * 1000);
+        uint64_t timestamp = AvnMonotonicMicroseconds() / 1000;
         parent->TopLevelEvents->RawKeyEvent(KeyDown, timestamp, AvnInputModifiersNone, AvnKeyBack, AvnPhysicalKeyNone, "\b");
         parent->TopLevelEvents->RawKeyEvent(KeyUp, timestamp, AvnInputModifiersNone, AvnKeyBack, AvnPhysicalKeyNone, "\b");
     }
@@ -955,10 +1091,10 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
     // In this case, you should return the intersection of the document's range and aRange.
     // If the location of aRange is completely outside of the document's range, return nil.
     // actualRange is an out parameter: it is uninitialized on entry and must only be written to.
-    NSRange docRange = NSMakeRange(0, _text.length);
-    NSRange finalRange = NSIntersectionRange(range, docRange);
+    // Only a window of the document around the caret is kept, so the range is further narrowed down to it.
+    auto finalRange = _surroundingText.IntersectWindow(ToSurroundingTextRange(range));
 
-    if (finalRange.length == 0)
+    if (finalRange.location == SurroundingTextBuffer::NotFound)
     {
         if (actualRange) {
             *actualRange = NSMakeRange(NSNotFound, 0);
@@ -968,10 +1104,12 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
     }
 
     if (actualRange) {
-        *actualRange = finalRange;
+        *actualRange = ToNSRange(finalRange);
     }
 
-    return [_text attributedSubstringFromRange:finalRange];
+    auto text = [NSString stringWithCharacters:(const unichar*)_surroundingText.GetText(finalRange) length:finalRange.length];
+
+    return [[NSAttributedString alloc] initWithString:text];
 }
 
 - (void)insertText:(id)string replacementRange:(NSRange)replacementRange
@@ -1008,11 +1146,14 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
 
     [self unmarkText];
 
-    uint64_t timestamp = static_cast<uint64_t>([NSDate timeIntervalSinceReferenceDate] * 1000);
+    auto timestampUs = AvnMonotonicMicroseconds();
+    uint64_t timestamp = timestampUs / 1000;
 
     const char* utf8Text = [text UTF8String];
 
+    auto traceToken = [self beginInputTrace:AvnInputLatencyEventKindTextInput withTimestamp:timestampUs];
     parent->TopLevelEvents->RawTextInputEvent(timestamp, utf8Text != nullptr ? utf8Text : "");
+    [self endInputTrace:traceToken];
 }
 
 - (NSUInteger)characterIndexForPoint:(NSPoint)point
@@ -1037,27 +1178,56 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
 }
 
 - (NSDragOperation)triggerAvnDragEvent: (AvnDragEventType) type info: (id <NSDraggingInfo>)info
+{
+    return [self triggerAvnDragEvent:type info:info allowReuse:type == AvnDragEventType::Over];
+}
+
+- (NSDragOperation)triggerAvnDragEvent: (AvnDragEventType) type info: (id <NSDraggingInfo>)info allowReuse: (bool)allowReuse
 {
     NSPoint eventLocation = [info draggingLocation];
     auto viewLocation = [self convertPoint:NSMakePoint(0, 0) toView:nil];
     auto localPoint = NSMakePoint(eventLocation.x - viewLocation.x, viewLocation.y - eventLocation.y);
     auto point = ToAvnPoint(localPoint);
-    auto modifiers = [self getModifiers:[[NSApp currentEvent] modifierFlags]];
+    auto modifiers = [self getModifiers:[NSEvent modifierFlags]];
     NSDragOperation nsop = [info draggingSourceOperationMask];
 
     auto effects = ConvertDragDropEffects(nsop);
-    auto parent = _parent.tryGet();
-    if (!parent)
-      return NSDragOperationNone;
-    int reffects = (int)parent->TopLevelEvents
-            ->DragEvent(type, point, modifiers, effects,
-                    CreateClipboard([info draggingPasteboard]),
+    DragSessionInput input { point, modifiers, effects };
+    auto now = AvnMonotonicMicroseconds();
+
+    // One clipboard for the whole drag, its pasteboard snapshot then serves every event
+    auto sequence = (int64_t)[info draggingSequenceNumber];
+    if (type == AvnDragEventType::Enter || !_dragSession.IsSequence(sequence))
+    {
+        _dragSession.Begin(sequence);
+        _dragClipboard.setNoAddRef(CreateClipboard([info draggingPasteboard]));
+    }
+
+    AvnDragDropEffects result = AvnDragDropEffects::None;
+    if (!allowReuse || !_dragSession.TryReuseOver(input, now, result))
+    {
+        auto parent = _parent.tryGet();
+        if (!parent)
+        {
+            [self endDragSession];
+            return NSDragOperationNone;
+        }
+
+        result = parent->TopLevelEvents->DragEvent(type, point, modifiers, effects,
+                    _dragClipboard,
                     GetAvnDataObjectHandleFromDraggingInfo(info));
 
+        if (type == AvnDragEventType::Enter || type == AvnDragEventType::Over)
+            _dragSession.SetResult(input, now, result);
+    }
+
+    if (type == AvnDragEventType::Leave || type == AvnDragEventType::Drop)
+        [self endDragSession];
+
     NSDragOperation ret = static_cast<NSDragOperation>(0);
 
     // Ensure that the managed part didn't add any new effects
-    reffects = (int)effects & reffects;
+    int reffects = (int)effects & (int)result;
 
     // OSX requires exactly one operation
     if((reffects & (int)AvnDragDropEffects::Copy) != 0)
@@ -1071,6 +1241,12 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
     return ret;
 }
 
+- (void)endDragSession
+{
+    _dragSession.End();
+    _dragClipboard = nullptr;
+}
+
 - (NSDragOperation)draggingEntered:(id <NSDraggingInfo>)sender
 {
     return [self triggerAvnDragEvent: AvnDragEventType::Enter info:sender];
@@ -1088,7 +1264,8 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
 
 - (BOOL)prepareForDragOperation:(id <NSDraggingInfo>)sender
 {
-    return [self triggerAvnDragEvent: AvnDragEventType::Over info:sender] != NSDragOperationNone;
+    // Whether the drop happens depends on this answer, so it always comes from the managed side
+    return [self triggerAvnDragEvent: AvnDragEventType::Over info:sender allowReuse:false] != NSDragOperationNone;
 }
 
 - (BOOL)performDragOperation:(id <NSDraggingInfo>)sender
@@ -1098,7 +1275,7 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
 
 - (void)concludeDragOperation:(nullable id <NSDraggingInfo>)sender
 {
-
+    [self endDragSession];
 }
 
 - (AvnPlatformResizeReason)getResizeReason
@@ -1111,11 +1288,46 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
     _resizeReason = reason;
 }
 
+// The accessibility children of the Window are exposed as children of the AvnView.
+- (IAvnAutomationPeer*)accessibilityRootPeer
+{
+    if (![[self window] isKindOfClass:[AvnWindow class]])
+        return nullptr;
+
+    return [(AvnWindow*)[self window] automationPeer];
+}
+
 - (NSArray *)accessibilityChildren
 {
+    auto peer = [self accessibilityRootPeer];
+    if (peer == nullptr)
+        return @[];
+
+    if (_accessibilityChildren == nil)
+        _accessibilityChildren = [[AvnAccessibilityChildren alloc] initWithOwner:self];
+    return [_accessibilityChildren children:peer];
+}
+
+- (NSUInteger)accessibilityArrayAttributeCount:(NSAccessibilityAttributeName)attribute
+{
+    auto peer = [self accessibilityRootPeer];
+    if (peer == nullptr || ![attribute isEqualToString:NSAccessibilityChildrenAttribute])
+        return [super accessibilityArrayAttributeCount:attribute];
+
+    if (_accessibilityChildren == nil)
+        _accessibilityChildren = [[AvnAccessibilityChildren alloc] initWithOwner:self];
+    return [_accessibilityChildren count:peer];
+}
+
+- (NSArray *)accessibilityArrayAttributeValues:(NSAccessibilityAttributeName)attribute index:(NSUInteger)index maxCount:(NSUInteger)maxCount
+{
+    auto peer = [self accessibilityRootPeer];
+    if (peer == nullptr || ![attribute isEqualToString:NSAccessibilityChildrenAttribute])
+        return [super accessibilityArrayAttributeValues:attribute index:index maxCount:maxCount];
+
     if (_accessibilityChildren == nil)
-        [self recalculateAccessibiltyChildren];
-    return _accessibilityChildren;
+        _accessibilityChildren = [[AvnAccessibilityChildren alloc] initWithOwner:self];
+    return [_accessibilityChildren children:peer fromIndex:index maxCount:maxCount];
 }
 
 - (id _Nullable) accessibilityHitTest:(NSPoint)point
@@ -1131,86 +1343,173 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
 
     auto clientPoint = [window convertPointFromScreen:point];
     auto localPoint = [self translateLocalPoint:ToAvnPoint(clientPoint)];
+
+    id indexed = [self hitTestAccessibilityIndex:localPoint];
+    if (indexed != nil)
+        return indexed;
+
     auto hit = peer->RootProvider_GetPeerFromPoint(localPoint);
     return [AvnAccessibilityElement acquire:hit];
 }
 
-- (void)raiseAccessibilityChildrenChanged
-{
-    auto changed = _accessibilityChildren ? [NSMutableSet setWithArray:_accessibilityChildren] : [NSMutableSet set];
+// Hit tests keep coming in while the pointer moves, building the index only pays off once several of them
+// arrived for the same layout.
+static const int AccessibilityIndexBuildThreshold = 4;
+
+// Views that built a hit test index, main thread only
+static NSHashTable<AvnView*>* s_accessibilityIndexedViews;
 
-    [self recalculateAccessibiltyChildren];
+void InvalidateAccessibilityLayout(id owner)
+{
+    if ([owner isKindOfClass:[AvnView class]])
+    {
+        [(AvnView*)owner invalidateAccessibilityIndex];
+        return;
+    }
 
-    if (_accessibilityChildren)
-        [changed addObjectsFromArray:_accessibilityChildren];
+    auto key = (__bridge const void*)owner;
+    for (AvnView* view in s_accessibilityIndexedViews)
+        if (view->_accessibilityIndex.Contains(key))
+            [view invalidateAccessibilityIndex];
+}
 
-    NSAccessibilityPostNotificationWithUserInfo(
-        self,
-        NSAccessibilityLayoutChangedNotification,
-        @{ NSAccessibilityUIElementsKey: [changed allObjects]});
+void AccessibilityElementMoved(id element)
+{
+    auto key = (__bridge const void*)element;
+    for (AvnView* view in s_accessibilityIndexedViews)
+        view->_accessibilityIndex.MarkMoved(key);
 }
 
-- (void)recalculateAccessibiltyChildren
+void AccessibilityElementReleased(const void* element)
 {
-    _accessibilityChildren = [[NSMutableArray alloc] init];
+    for (AvnView* view in s_accessibilityIndexedViews)
+        view->_accessibilityIndex.Remove(element);
+}
 
-    if (![[self window] isKindOfClass:[AvnWindow class]])
+static bool AreAllAccessibilityElements(NSArray* elements)
+{
+    for (id element in elements)
     {
-        return;
+        if (![element isKindOfClass:[AvnAccessibilityElement class]])
+            return false;
     }
 
-    // The accessibility children of the Window are exposed as children
-    // of the AvnView.
-    auto window = (AvnWindow*)[self window];
-    auto peer = [window automationPeer];
-    if (peer == nullptr)
+    return true;
+}
+
+// Elements that were in the previous index keep the bounds they had there, only new ones are asked for theirs
+static void AddToAccessibilityIndex(AccessibilitySpatialIndex& index, const AccessibilitySpatialIndex& previous,
+                                    NSArray* elements, const void* parent)
+{
+    for (id child in elements)
     {
-        return;
+        if (![child isKindOfClass:[AvnAccessibilityElement class]])
+            continue;
+
+        auto element = (AvnAccessibilityElement*)child;
+        auto key = (__bridge const void*)element;
+        auto children = [element loadedAccessibilityChildren];
+
+        AvnRect bounds;
+        if (!previous.TryGetBounds(key, bounds))
+            bounds = [element accessibilityBounds];
+
+        // Only elements whose children are all known can be the final answer of a hit test.
+        auto complete = children != nil && AreAllAccessibilityElements(children);
+        index.Add(key, parent, bounds, complete);
+
+        if (children != nil)
+            AddToAccessibilityIndex(index, previous, children, key);
     }
-    auto childPeers = peer->GetChildren();
-    auto childCount = childPeers != nullptr ? childPeers->GetCount() : 0;
+}
+
+- (void)invalidateAccessibilityIndex
+{
+    ++_accessibilityLayoutGeneration;
+}
+
+// Answers a hit test from the bounds of the elements that were already loaded, nil if that isn't possible.
+- (id _Nullable)hitTestAccessibilityIndex:(AvnPoint)point
+{
+    auto generation = _accessibilityLayoutGeneration;
 
-    if (childCount > 0)
+    if (_accessibilityIndexGeneration != generation)
     {
-        for (int i = 0; i < childCount; ++i)
+        if (_accessibilityIndexMissGeneration != generation)
         {
-            IAvnAutomationPeer* child;
-
-            if (childPeers->Get(i, &child) == S_OK)
-            {
-                id element = [AvnAccessibilityElement acquire:child];
-                [_accessibilityChildren addObject:element];
-            }
+            _accessibilityIndexMissGeneration = generation;
+            _accessibilityIndexMisses = 0;
         }
+
+        if (++_accessibilityIndexMisses < AccessibilityIndexBuildThreshold)
+            return nil;
+
+        AccessibilitySpatialIndex rebuilt;
+        auto children = [_accessibilityChildren loadedChildren];
+        if (children != nil)
+            AddToAccessibilityIndex(rebuilt, _accessibilityIndex, children, nullptr);
+        _accessibilityIndex = std::move(rebuilt);
+
+        if (s_accessibilityIndexedViews == nil)
+            s_accessibilityIndexedViews = [NSHashTable weakObjectsHashTable];
+        [s_accessibilityIndexedViews addObject:self];
+        _accessibilityIndexGeneration = generation;
     }
-}
 
-- (void) setText:(NSString *)text{
-    [[_text mutableString] setString:text != nil ? text : @""];
+    // Elements that moved since, the bounds are the ones the moved notification has them read anyway
+    if (_accessibilityIndex.HasMoved())
+        _accessibilityIndex.Refresh([](const void* key) {
+            return [(__bridge AvnAccessibilityElement*)key accessibilityBounds];
+        });
 
-    // The document changed, so the stored ranges can now point outside of it.
-    _selectedRange = [self clampRangeToText:_selectedRange];
+    bool complete;
+    auto key = _accessibilityIndex.HitTest(point.X, point.Y, &complete);
+    if (key == nullptr || !complete)
+        return nil;
 
-    if (_markedRange.location != NSNotFound)
+    // The OSX accessibility APIs expect non-ignored elements when hit-testing.
+    for (; key != nullptr; key = _accessibilityIndex.GetParent(key))
     {
-        _markedRange = NSMakeRange(MIN(_markedRange.location, _text.length), _markedRange.length);
+        auto element = (__bridge AvnAccessibilityElement*)key;
+        if ([element isAccessibilityElement])
+            return element;
     }
+
+    return nil;
 }
 
-- (void) setSelection:(int)start :(int)end{
-    if (end < start)
-    {
-        auto temp = start;
-        start = end;
-        end = temp;
-    }
+- (void)raiseAccessibilityChildrenChanged
+{
+    [self invalidateAccessibilityIndex];
+
+    auto peer = [self accessibilityRootPeer];
+
+    // Nobody has looked at the children yet, so there is nothing to tell which of them changed.
+    NSArray* changed = nil;
+    if (peer != nullptr && _accessibilityChildren != nil)
+        changed = [_accessibilityChildren update:peer];
+    else
+        _accessibilityChildren = nil;
 
-    auto length = (int)_text.length;
+    if (changed == nil)
+        NSAccessibilityPostNotification(self, NSAccessibilityLayoutChangedNotification);
+    else if ([changed count] > 0)
+        NSAccessibilityPostNotificationWithUserInfo(
+            self,
+            NSAccessibilityLayoutChangedNotification,
+            @{ NSAccessibilityUIElementsKey: changed });
+}
+
+- (void) setText:(NSString *)text windowStart:(int)windowStart documentLength:(int)documentLength{
+    auto buffer = ToUtf16(text);
 
-    start = MAX(0, MIN(start, length));
-    end = MAX(start, MIN(end, length));
+    _surroundingText.SetWindow(buffer.data(), buffer.size(), (size_t)MAX(0, windowStart), (size_t)MAX(0, documentLength));
 
-    _selectedRange = NSMakeRange((NSUInteger)start, (NSUInteger)(end - start));
+    [self clampMarkedRangeToText];
+}
+
+- (void) setSelection:(int)start :(int)end{
+    _surroundingText.SetSelection(start, end);
 }
 
 - (void) resetInputMethod{
@@ -1220,7 +1519,7 @@ static bool KeyboardInputSourceComposes(NSString* sourceId)
         parent->InputMethod->Client->SetPreeditText(nullptr);
     }
 
-    _markedRange = NSMakeRange(_selectedRange.location, 0);
+    _markedRange = NSMakeRange([self selectedRange].location, 0);
 
     if([self inputContext]) {
         [[self inputContext] discardMarkedText];
@@ -645,6 +645,12 @@
     return _automationPeer;
 }
 
+- (void)resetAutomationPeer
+{
+    _automationPeer = nullptr;
+    _automationNode = nullptr;
+}
+
 - (void)raiseChildrenChanged
 {
     auto parent = _parent.tryGet();
@@ -654,8 +660,7 @@
 
 - (void)raiseFocusChanged
 {
-    id focused = [self accessibilityFocusedUIElement];
-    NSAccessibilityPostNotification(focused, NSAccessibilityFocusedUIElementChangedNotification);
+    QueueAccessibilityNotification(self, AccessibilityNotificationKind::Focus);
 }
 
 - (void)raisePropertyChanged:(AvnAutomationProperty)property
@@ -663,9 +668,32 @@
     switch (property)
     {
         case AutomationPeer_Name:
-            NSAccessibilityPostNotification(self, NSAccessibilityTitleChangedNotification);
+            QueueAccessibilityNotification(self, AccessibilityNotificationKind::Title);
             break;
         case AutomationPeer_BoundingRectangle:
+            // Moving the window doesn't move anything within its view, a resize is seen by the view
+            QueueAccessibilityNotification(self, AccessibilityNotificationKind::Bounds);
+            break;
+        default:
+            break;
+    }
+}
+
+- (void)postAccessibilityNotification:(AccessibilityNotificationKind)kind
+{
+    switch (kind)
+    {
+        case AccessibilityNotificationKind::Focus:
+        {
+            // Whatever has the focus by now
+            id focused = [self accessibilityFocusedUIElement];
+            NSAccessibilityPostNotification(focused, NSAccessibilityFocusedUIElementChangedNotification);
+            break;
+        }
+        case AccessibilityNotificationKind::Title:
+            NSAccessibilityPostNotification(self, NSAccessibilityTitleChangedNotification);
+            break;
+        case AccessibilityNotificationKind::Bounds:
             NSAccessibilityPostNotification(self, NSAccessibilityMovedNotification);
             NSAccessibilityPostNotification(self, NSAccessibilityResizedNotification);
             break;
@@ -0,0 +1,245 @@
+#ifndef BookmarkBatch_h
+#define BookmarkBatch_h
+
+// Resolving or creating many security-scoped bookmarks in one call. Each of them may hit the file system, so the
+// items are spread over a few workers instead of being handled one after the other on the calling thread.
+// Resolved bookmarks are cached by their bytes, resolving the same bookmark again (e.g. the recent files list on
+// every launch of a window) only checks that the item is still where it was.
+// Plain C++, the executor decides where a worker runs (a global dispatch queue on macOS).
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct BookmarkResult
+{
+    bool Succeeded = false;
+    // The URI a bookmark resolved to, or the bytes of a created bookmark
+    std::string Value;
+    // Why the item failed, may be empty even then
+    std::string Error;
+    // The bookmark resolved but should be created again
+    bool IsStale = false;
+    // What the bookmark resolved to, cached along with the URI (the security-scoped NSURL on macOS, access to the
+    // item can only be started on that object)
+    std::shared_ptr<const void> Item;
+};
+
+// Runs body(index) for every index in [0, count) on at most maxWorkers workers and returns once all are done
+class BoundedParallelFor
+{
+public:
+    typedef std::function<void(std::function<void()>)> Executor;
+
+    template <typename TBody>
+    static void Run(size_t count, size_t maxWorkers, const Executor& executor, TBody body)
+    {
+        if (count == 0)
+            return;
+
+        auto workers = std::max<size_t>(1, std::min(count, maxWorkers));
+        if (workers == 1)
+        {
+            for (size_t i = 0; i < count; i++)
+                body(i);
+            return;
+        }
+
+        struct State
+        {
+            std::atomic<size_t> Next { 0 };
+            std::mutex Lock;
+            std::condition_variable Done;
+            size_t Running = 0;
+        } state;
+        state.Running = workers;
+
+        auto work = [&state, &body, count]()
+        {
+            for (auto i = state.Next++; i < count; i = state.Next++)
+                body(i);
+
+            std::lock_guard<std::mutex> guard(state.Lock);
+            if (--state.Running == 0)
+                state.Done.notify_all();
+        };
+
+        // The calling thread is one of the workers
+        for (size_t i = 1; i < workers; i++)
+            executor(work);
+        work();
+
+        std::unique_lock<std::mutex> lock(state.Lock);
+        state.Done.wait(lock, [&state] { return state.Running == 0; });
+    }
+};
+
+// Resolved bookmarks by their bytes, least recently used ones are dropped past maxEntries. Failures aren't kept,
+// the item may become available later. The item of the most recently used entry for a URI can be looked up too,
+// so whatever keeps an item alive is bounded along with the cache. Thread safe.
+class BookmarkCache
+{
+public:
+    explicit BookmarkCache(size_t maxEntries = 1024) : _maxEntries(maxEntries)
+    {
+    }
+
+    bool TryGet(const void* data, size_t length, BookmarkResult& result)
+    {
+        std::string key(static_cast<const char*>(data), length);
+
+        std::lock_guard<std::mutex> guard(_lock);
+        auto it = _index.find(key);
+        if (it == _index.end())
+            return false;
+
+        _entries.splice(_entries.begin(), _entries, it->second);
+        _byValue[it->second->second.Value].Latest = it->second;
+        result = it->second->second;
+        return true;
+    }
+
+    // The item of the most recently used bookmark that resolved to value
+    std::shared_ptr<const void> FindItem(const std::string& value)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        auto it = _byValue.find(value);
+        return it != _byValue.end() ? it->second.Latest->second.Item : nullptr;
+    }
+
+    // Drops every bookmark that resolved to value
+    void Remove(const std::string& value)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        for (auto it = _entries.begin(); it != _entries.end();)
+        {
+            if (it->second.Value == value)
+                it = Erase(it);
+            else
+                ++it;
+        }
+    }
+
+    void Add(const void* data, size_t length, const BookmarkResult& result)
+    {
+        if (!result.Succeeded || _maxEntries == 0)
+            return;
+
+        std::string key(static_cast<const char*>(data), length);
+
+        std::lock_guard<std::mutex> guard(_lock);
+        auto it = _index.find(key);
+        if (it != _index.end())
+        {
+            UnindexValue(it->second);
+            it->second->second = result;
+            _entries.splice(_entries.begin(), _entries, it->second);
+            IndexValue(it->second);
+            return;
+        }
+
+        _entries.emplace_front(key, result);
+        _index.emplace(std::move(key), _entries.begin());
+        IndexValue(_entries.begin());
+
+        if (_entries.size() > _maxEntries)
+            Erase(std::prev(_entries.end()));
+    }
+
+    size_t GetCount()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _entries.size();
+    }
+
+private:
+    typedef std::list<std::pair<std::string, BookmarkResult>> EntryList;
+
+    struct ValueEntries
+    {
+        EntryList::iterator Latest;
+        size_t Count = 0;
+    };
+
+    void IndexValue(EntryList::iterator entry)
+    {
+        auto& value = _byValue[entry->second.Value];
+        value.Latest = entry;
+        value.Count++;
+    }
+
+    void UnindexValue(EntryList::iterator entry)
+    {
+        auto it = _byValue.find(entry->second.Value);
+        if (--it->second.Count == 0)
+        {
+            _byValue.erase(it);
+            return;
+        }
+
+        // Several bookmarks of the same item are rare, finding the next most recently used one can take a while
+        if (it->second.Latest == entry)
+            it->second.Latest = std::find_if(_entries.begin(), _entries.end(), [&](const EntryList::value_type& other)
+            {
+                return &other != &*entry && other.second.Value == entry->second.Value;
+            });
+    }
+
+    EntryList::iterator Erase(EntryList::iterator entry)
+    {
+        UnindexValue(entry);
+        _index.erase(entry->first);
+        return _entries.erase(entry);
+    }
+
+    const size_t _maxEntries;
+    std::mutex _lock;
+    // Most recently used first
+    EntryList _entries;
+    std::unordered_map<std::string, EntryList::iterator> _index;
+    std::unordered_map<std::string, ValueEntries> _byValue;
+};
+
+struct BookmarkBytes
+{
+    const void* Data;
+    size_t Length;
+};
+
+// Resolves every bookmark with resolve(data, length, result) on the workers. Cached results are used instead if
+// isCurrent(result) still holds for them, a bookmark follows its item when that is moved and the cache doesn't.
+// Both are called concurrently and must not throw.
+template <typename TResolve, typename TIsCurrent>
+std::vector<BookmarkResult> ResolveBookmarks(const std::vector<BookmarkBytes>& bookmarks, BookmarkCache& cache,
+                                             size_t maxWorkers, const BoundedParallelFor::Executor& executor,
+                                             TResolve resolve, TIsCurrent isCurrent)
+{
+    std::vector<BookmarkResult> results(bookmarks.size());
+
+    BoundedParallelFor::Run(bookmarks.size(), maxWorkers, executor, [&](size_t index)
+    {
+        auto& bookmark = bookmarks[index];
+        auto& result = results[index];
+
+        if (cache.TryGet(bookmark.Data, bookmark.Length, result) && isCurrent(result))
+            return;
+
+        result = BookmarkResult();
+        resolve(bookmark.Data, bookmark.Length, result);
+        cache.Add(bookmark.Data, bookmark.Length, result);
+    });
+
+    return results;
+}
+
+#endif /* BookmarkBatch_h */
@@ -0,0 +1,43 @@
+#ifndef ChunkedBytes_h
+#define ChunkedBytes_h
+
+// Moves a payload produced on the managed side into native memory a chunk at a time, straight into its final
+// location. Neither side needs a second buffer of the payload's size, and a producer that can't deliver as much
+// as it announced ends the payload early instead of leaving uninitialized bytes in it.
+// Plain C++, read(void* chunk, size_t count) returns the number of bytes written to chunk, 0 once the payload
+// is over and a negative value on failure.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+static constexpr size_t DefaultByteChunkSize = 1024 * 1024;
+
+// Returns the number of bytes read into destination, at most length, or -1 if read failed
+template <typename TRead>
+int64_t ReadChunked(void* destination, size_t length, TRead&& read, size_t chunkSize = DefaultByteChunkSize)
+{
+    if (length != 0 && destination == nullptr)
+        return -1;
+
+    auto bytes = static_cast<uint8_t*>(destination);
+    size_t total = 0;
+
+    while (total < length)
+    {
+        auto count = std::min(chunkSize, length - total);
+        auto produced = read(static_cast<void*>(bytes + total), count);
+
+        if (produced < 0)
+            return -1;
+        if (produced == 0)
+            break;
+
+        // Never trust the producer to stay within the chunk it was given
+        total += std::min(static_cast<size_t>(produced), count);
+    }
+
+    return static_cast<int64_t>(total);
+}
+
+#endif /* ChunkedBytes_h */
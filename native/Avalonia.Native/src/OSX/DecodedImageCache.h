@@ -0,0 +1,173 @@
+#ifndef DecodedImageCache_h
+#define DecodedImageCache_h
+
+// Images decoded from bytes handed over by the managed side (menu and tray icons, custom cursors), keyed by the
+// content of the bytes and what the image is prepared for. Menus are rebuilt and tray icons or cursors animated
+// with the same few PNGs over and over, each of them is decoded once and the same immutable image is handed out
+// from then on. The least recently used images are dropped once the budget is exceeded.
+// Plain C++, the decoder and the image type are supplied by the caller (NSImage on macOS).
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// 64-bit MurmurHash2 (MurmurHash64A), eight bytes per step
+static inline uint64_t HashImageBytes(const void* data, size_t length)
+{
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+
+    auto bytes = static_cast<const uint8_t*>(data);
+    uint64_t h = 0x9e3779b97f4a7c15ULL ^ (length * m);
+
+    for (auto end = bytes + (length & ~static_cast<size_t>(7)); bytes != end; bytes += 8)
+    {
+        uint64_t k;
+        memcpy(&k, bytes, sizeof(k));
+
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+
+        h ^= k;
+        h *= m;
+    }
+
+    switch (length & 7)
+    {
+        case 7: h ^= static_cast<uint64_t>(bytes[6]) << 48; // fallthrough
+        case 6: h ^= static_cast<uint64_t>(bytes[5]) << 40; // fallthrough
+        case 5: h ^= static_cast<uint64_t>(bytes[4]) << 32; // fallthrough
+        case 4: h ^= static_cast<uint64_t>(bytes[3]) << 24; // fallthrough
+        case 3: h ^= static_cast<uint64_t>(bytes[2]) << 16; // fallthrough
+        case 2: h ^= static_cast<uint64_t>(bytes[1]) << 8; // fallthrough
+        case 1: h ^= static_cast<uint64_t>(bytes[0]);
+                h *= m;
+    }
+
+    h ^= h >> r;
+    h *= m;
+    h ^= h >> r;
+    return h;
+}
+
+struct DecodedImageKey
+{
+    uint64_t Hash;
+    size_t Length;
+    // Size the image is prepared for, 0 keeps the natural size
+    int Width;
+    int Height;
+    // Anything else the decoder applies to the image (e.g. being a template image)
+    uint32_t Variant;
+
+    bool operator==(const DecodedImageKey& other) const
+    {
+        return Hash == other.Hash && Length == other.Length && Width == other.Width && Height == other.Height &&
+               Variant == other.Variant;
+    }
+};
+
+struct DecodedImageKeyHash
+{
+    size_t operator()(const DecodedImageKey& key) const
+    {
+        auto hash = key.Hash;
+        hash ^= (static_cast<uint64_t>(key.Width) << 32 | static_cast<uint32_t>(key.Height)) * 0x9e3779b97f4a7c15ULL;
+        hash ^= static_cast<uint64_t>(key.Variant) * 0xc6a4a7935bd1e995ULL;
+        return static_cast<size_t>(hash);
+    }
+};
+
+template <typename TImage>
+class DecodedImageCache
+{
+public:
+    explicit DecodedImageCache(size_t byteBudget) : _byteBudget(byteBudget)
+    {
+    }
+
+    // Returns the image for the bytes, calling decode(size_t& cost) if there is none yet. decode returns the image,
+    // or an empty one if the bytes can't be decoded, and sets cost to the bytes the decoded image takes up.
+    // The bytes are kept to rule out hash collisions, they count towards the budget as well.
+    template <typename TDecode>
+    TImage GetOrDecode(const void* data, size_t length, int width, int height, uint32_t variant, TDecode decode)
+    {
+        DecodedImageKey key { HashImageBytes(data, length), length, width, height, variant };
+
+        std::lock_guard<std::mutex> guard(_lock);
+
+        auto it = _index.find(key);
+        if (it != _index.end() && (length == 0 || memcmp(it->second->Source.data(), data, length) == 0))
+        {
+            _entries.splice(_entries.begin(), _entries, it->second);
+            return it->second->Image;
+        }
+
+        size_t cost = 0;
+        TImage image = decode(cost);
+        if (!image)
+            return image;
+
+        cost += length;
+        if (cost > _byteBudget)
+            return image;
+
+        // Same key but different bytes, the newer one wins
+        if (it != _index.end())
+            Remove(it->second);
+
+        auto bytes = static_cast<const uint8_t*>(data);
+        _entries.push_front(Entry { key, std::vector<uint8_t>(bytes, bytes + length), image, cost });
+        _index.emplace(key, _entries.begin());
+        _bytes += cost;
+
+        while (_bytes > _byteBudget)
+            Remove(std::prev(_entries.end()));
+
+        return image;
+    }
+
+    size_t GetCount()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _entries.size();
+    }
+
+    size_t GetBytes()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _bytes;
+    }
+
+private:
+    struct Entry
+    {
+        DecodedImageKey Key;
+        std::vector<uint8_t> Source;
+        TImage Image;
+        size_t Cost;
+    };
+
+    typedef typename std::list<Entry>::iterator EntryIterator;
+
+    void Remove(EntryIterator entry)
+    {
+        _bytes -= entry->Cost;
+        _index.erase(entry->Key);
+        _entries.erase(entry);
+    }
+
+    const size_t _byteBudget;
+    std::mutex _lock;
+    size_t _bytes = 0;
+    // Most recently used first
+    std::list<Entry> _entries;
+    std::unordered_map<DecodedImageKey, EntryIterator, DecodedImageKeyHash> _index;
+};
+
+#endif /* DecodedImageCache_h */
@@ -0,0 +1,52 @@
+#include "common.h"
+#include "DecodedImageCache.h"
+
+// Enough for a few hundred menu icons and the frames of an animated tray icon or cursor
+static const size_t DecodedImageBudget = 32 * 1024 * 1024;
+
+static DecodedImageCache<NSImage*>& GetDecodedImageCache()
+{
+    static DecodedImageCache<NSImage*> cache(DecodedImageBudget);
+    return cache;
+}
+
+static size_t GetDecodedImageCost(NSImage* image)
+{
+    size_t cost = 0;
+    for (NSImageRep* rep in [image representations])
+        cost += (size_t)MAX([rep pixelsWide], 1) * (size_t)MAX([rep pixelsHigh], 1) * 4;
+    return cost;
+}
+
+// The returned image is shared, it must not be changed. A height of 0 keeps the natural size,
+// otherwise the image is scaled to that height keeping its aspect ratio.
+NSImage* GetDecodedImage(const void* data, size_t length, CGFloat height, bool isTemplate)
+{
+    if (data == nullptr)
+        return nil;
+
+    return GetDecodedImageCache().GetOrDecode(data, length, 0, (int)height, isTemplate ? 1 : 0, [&](size_t& cost) -> NSImage*
+    {
+        NSImage* image = [[NSImage alloc] initWithData:[NSData dataWithBytes:data length:length]];
+        if (image == nil)
+            return nil;
+
+        if (height > 0)
+        {
+            NSSize originalSize = [image size];
+
+            NSSize size;
+            size.height = height;
+
+            auto scaleFactor = size.height / originalSize.height;
+            size.width = floor(originalSize.width * scaleFactor);
+
+            [image setSize: size];
+        }
+
+        [image setTemplate: isTemplate];
+
+        cost = GetDecodedImageCost(image);
+        return image;
+    });
+}
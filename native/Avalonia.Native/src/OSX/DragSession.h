@@ -0,0 +1,99 @@
+#ifndef DragSession_h
+#define DragSession_h
+
+// State of one drag over a view, from draggingEntered: to draggingExited: or the drop. AppKit sends
+// draggingUpdated: at pointer rate and periodically while the pointer rests, most of those carry nothing new
+// for the managed side. An Over event is only dispatched when the input changed and the last dispatch is at
+// least a frame ago, otherwise the last result is answered again. Nothing is lost: AppKit keeps sending updates,
+// the next one past the interval carries the latest input.
+// Plain C++, timestamps are monotonic microseconds supplied by the caller.
+
+#include <cstdint>
+#include "avalonia-native.h"
+
+struct DragSessionInput
+{
+    AvnPoint Position;
+    AvnInputModifiers Modifiers;
+    AvnDragDropEffects Effects;
+
+    bool operator==(const DragSessionInput& other) const
+    {
+        return Position.X == other.Position.X && Position.Y == other.Position.Y &&
+               Modifiers == other.Modifiers && Effects == other.Effects;
+    }
+
+    bool operator!=(const DragSessionInput& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+class DragSession
+{
+public:
+    // The managed side can change its answer without the input changing (e.g. after hovering for a while),
+    // so an unchanged input is only answered from the cache for maxReuseUs
+    explicit DragSession(uint64_t minOverIntervalUs = 16667, uint64_t maxReuseUs = 250000)
+        : _minOverIntervalUs(minOverIntervalUs), _maxReuseUs(maxReuseUs)
+    {
+    }
+
+    bool IsActive() const
+    {
+        return _active;
+    }
+
+    bool IsSequence(int64_t sequence) const
+    {
+        return _active && _sequence == sequence;
+    }
+
+    void Begin(int64_t sequence)
+    {
+        _active = true;
+        _sequence = sequence;
+        _hasResult = false;
+    }
+
+    void End()
+    {
+        _active = false;
+        _hasResult = false;
+    }
+
+    // True if the Over event can be answered with result instead of being dispatched
+    bool TryReuseOver(const DragSessionInput& input, uint64_t nowUs, AvnDragDropEffects& result) const
+    {
+        if (!_active || !_hasResult || nowUs < _dispatchedAtUs)
+            return false;
+
+        auto elapsed = nowUs - _dispatchedAtUs;
+        auto reusable = input == _input ? elapsed < _maxReuseUs : elapsed < _minOverIntervalUs;
+
+        if (reusable)
+            result = _result;
+        return reusable;
+    }
+
+    // Records what the managed side answered to a dispatched Enter or Over
+    void SetResult(const DragSessionInput& input, uint64_t nowUs, AvnDragDropEffects result)
+    {
+        _input = input;
+        _dispatchedAtUs = nowUs;
+        _result = result;
+        _hasResult = true;
+    }
+
+private:
+    const uint64_t _minOverIntervalUs;
+    const uint64_t _maxReuseUs;
+    bool _active = false;
+    bool _hasResult = false;
+    int64_t _sequence = 0;
+    DragSessionInput _input {};
+    uint64_t _dispatchedAtUs = 0;
+    AvnDragDropEffects _result = AvnDragDropEffects::None;
+};
+
+#endif /* DragSession_h */
@@ -0,0 +1,135 @@
+#ifndef ImageTranscodeCache_h
+#define ImageTranscodeCache_h
+
+// Clipboard images that have to be converted (TIFF or JPEG offered as PNG, or any image handed out as raw
+// pixels) are transcoded once and the result is kept for as long as the pasteboard doesn't change.
+// Keys only carry the change count, a cache must not be shared between pasteboards.
+// Plain C++, not thread safe: like the clipboard that owns it, a cache is only used from one thread.
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+struct TranscodedImage
+{
+    // Encoded image data, or premultiplied BGRA pixels when Width is set
+    std::vector<uint8_t> Bytes;
+    int Width = 0;
+    int Height = 0;
+    int RowBytes = 0;
+
+    bool IsPixels() const
+    {
+        return Width > 0;
+    }
+
+    // nullptr if the image is empty or too large to be addressed with an int stride and a single buffer
+    static std::unique_ptr<TranscodedImage> CreatePixels(int width, int height)
+    {
+        static constexpr int64_t MaxBytes = INT32_MAX;
+
+        if (width <= 0 || height <= 0)
+            return nullptr;
+
+        auto rowBytes = static_cast<int64_t>(width) * 4;
+        if (rowBytes > MaxBytes || rowBytes * height > MaxBytes)
+            return nullptr;
+
+        std::unique_ptr<TranscodedImage> image(new TranscodedImage());
+        image->Width = width;
+        image->Height = height;
+        image->RowBytes = static_cast<int>(rowBytes);
+        image->Bytes.resize(static_cast<size_t>(rowBytes * height));
+        return image;
+    }
+};
+
+struct ImageTranscodeKey
+{
+    int64_t ChangeCount;
+    int Item;
+    std::string Format;
+    bool Pixels;
+
+    bool operator<(const ImageTranscodeKey& other) const
+    {
+        return std::tie(ChangeCount, Item, Format, Pixels) <
+               std::tie(other.ChangeCount, other.Item, other.Format, other.Pixels);
+    }
+};
+
+class ImageTranscodeCache
+{
+public:
+    // nullptr when the image couldn't be transcoded
+    typedef std::shared_ptr<const TranscodedImage> Result;
+
+    explicit ImageTranscodeCache(size_t maxEntries = 16)
+        : _maxEntries(maxEntries)
+    {
+    }
+
+    // Returns the cached result for key, running transcode() on the calling thread if there is none.
+    // Results of other change counts are dropped, they can never be asked for again.
+    template <typename TTranscode>
+    Result Get(const ImageTranscodeKey& key, TTranscode&& transcode)
+    {
+        if (key.ChangeCount != _changeCount)
+        {
+            _entries.clear();
+            _changeCount = key.ChangeCount;
+        }
+
+        auto it = _entries.find(key);
+        if (it != _entries.end())
+            return it->second;
+
+        Result result;
+        try
+        {
+            result = transcode();
+        }
+        catch (...)
+        {
+            result = nullptr;
+        }
+
+        // Keeping everything would pin a lot of memory for pasteboards with many images
+        if (_entries.size() >= _maxEntries)
+            _entries.clear();
+
+        _entries.emplace(key, result);
+        return result;
+    }
+
+    // Lets callers skip gathering the source data of an image that is already transcoded.
+    // Returns false if the image was never requested.
+    bool TryGet(const ImageTranscodeKey& key, Result& result) const
+    {
+        if (key.ChangeCount != _changeCount)
+            return false;
+
+        auto it = _entries.find(key);
+        if (it == _entries.end())
+            return false;
+
+        result = it->second;
+        return true;
+    }
+
+    size_t GetCount() const
+    {
+        return _entries.size();
+    }
+
+private:
+    const size_t _maxEntries;
+    int64_t _changeCount = INT64_MIN;
+    std::map<ImageTranscodeKey, Result> _entries;
+};
+
+#endif /* ImageTranscodeCache_h */
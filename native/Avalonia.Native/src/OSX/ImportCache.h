@@ -0,0 +1,156 @@
+#ifndef ImportCache_h
+#define ImportCache_h
+
+// Imports of external GPU objects (IOSurfaces, shared events) kept to be handed out again. Video players and
+// interop code import the same few surfaces every frame, wrapping them anew each time allocates a texture
+// object per frame. An import is kept while it is in use: it is dropped once it hasn't been asked for in
+// maxIdleUs, when the cache is full and it is the one used longest ago, or when it is evicted explicitly.
+// Imports can hold on to what they wrap, the caller checks a cached import still belongs to the key
+// (isAlive) where that isn't a given.
+// Plain C++, a handful of entries searched linearly, timestamps are monotonic microseconds from the caller.
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+template <typename TKey, typename TValue>
+class ImportCache
+{
+public:
+    struct Stats
+    {
+        uint64_t Hits = 0;
+        uint64_t Misses = 0;
+        uint64_t Evictions = 0;
+        size_t Count = 0;
+    };
+
+    explicit ImportCache(size_t capacity = 16, uint64_t maxIdleUs = 2000000)
+        : _capacity(capacity), _maxIdleUs(maxIdleUs)
+    {
+    }
+
+    template <typename TIsAlive>
+    bool TryGet(const TKey& key, uint64_t nowUs, TIsAlive&& isAlive, TValue& value)
+    {
+        std::vector<Entry> dropped;
+        std::lock_guard<std::mutex> guard(_lock);
+        TrimIdle(nowUs, dropped);
+
+        for (size_t c = 0; c < _entries.size(); c++)
+        {
+            if (!(_entries[c].Key == key))
+                continue;
+
+            if (!isAlive(_entries[c].Value))
+            {
+                Drop(c, dropped);
+                break;
+            }
+
+            _entries[c].LastUsedUs = nowUs;
+            value = _entries[c].Value;
+            _stats.Hits++;
+            return true;
+        }
+
+        _stats.Misses++;
+        return false;
+    }
+
+    // Keeps a new import, replacing the one for the same key
+    void Add(const TKey& key, TValue value, uint64_t nowUs)
+    {
+        if (_capacity == 0)
+            return;
+
+        std::vector<Entry> dropped;
+        std::lock_guard<std::mutex> guard(_lock);
+        for (size_t c = 0; c < _entries.size(); c++)
+        {
+            if (_entries[c].Key == key)
+            {
+                Drop(c, dropped);
+                break;
+            }
+        }
+
+        if (_entries.size() == _capacity)
+        {
+            size_t oldest = 0;
+            for (size_t c = 1; c < _entries.size(); c++)
+                if (_entries[c].LastUsedUs < _entries[oldest].LastUsedUs)
+                    oldest = c;
+            Drop(oldest, dropped);
+        }
+
+        _entries.push_back(Entry { key, std::move(value), nowUs });
+    }
+
+    // Drops the imports match returns true for, e.g. everything imported from one surface. Returns how many.
+    template <typename TMatch>
+    size_t EvictIf(TMatch&& match)
+    {
+        std::vector<Entry> dropped;
+        std::lock_guard<std::mutex> guard(_lock);
+        for (size_t c = _entries.size(); c-- > 0;)
+            if (match(_entries[c].Key, _entries[c].Value))
+                Drop(c, dropped);
+        return dropped.size();
+    }
+
+    size_t Clear()
+    {
+        return EvictIf([](const TKey&, const TValue&) { return true; });
+    }
+
+    // Drops what hasn't been used for a while without an import asking for it
+    size_t Trim(uint64_t nowUs)
+    {
+        std::vector<Entry> dropped;
+        std::lock_guard<std::mutex> guard(_lock);
+        TrimIdle(nowUs, dropped);
+        return dropped.size();
+    }
+
+    Stats GetStats()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        auto stats = _stats;
+        stats.Count = _entries.size();
+        return stats;
+    }
+
+private:
+    struct Entry
+    {
+        TKey Key;
+        TValue Value;
+        uint64_t LastUsedUs;
+    };
+
+    // Dropped entries are released by the caller once the lock is released
+    void Drop(size_t index, std::vector<Entry>& dropped)
+    {
+        dropped.push_back(std::move(_entries[index]));
+        _entries.erase(_entries.begin() + static_cast<std::ptrdiff_t>(index));
+        _stats.Evictions++;
+    }
+
+    void TrimIdle(uint64_t nowUs, std::vector<Entry>& dropped)
+    {
+        for (size_t c = _entries.size(); c-- > 0;)
+            if (nowUs > _entries[c].LastUsedUs && nowUs - _entries[c].LastUsedUs > _maxIdleUs)
+                Drop(c, dropped);
+    }
+
+    size_t _capacity;
+    uint64_t _maxIdleUs;
+    std::mutex _lock;
+    std::vector<Entry> _entries;
+    Stats _stats;
+};
+
+#endif /* ImportCache_h */
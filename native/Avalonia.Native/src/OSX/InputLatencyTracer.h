@@ -0,0 +1,248 @@
+#ifndef InputLatencyTracer_h
+#define InputLatencyTracer_h
+
+// Correlates input events with the frames that reflect them and collects per event type latency samples.
+// Plain C++, all timestamps are monotonic microseconds supplied by the caller.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "avalonia-native.h"
+
+class InputLatencyTracer
+{
+public:
+    // Identifies the surface an input was delivered to and a frame is presented on (the view's layer)
+    typedef const void* SurfaceKey;
+
+    explicit InputLatencyTracer(size_t maxSamplesPerKind = 4096, size_t maxPendingInputs = 256)
+        : _maxSamplesPerKind(maxSamplesPerKind), _maxPendingInputs(maxPendingInputs)
+    {
+    }
+
+    bool IsEnabled() const
+    {
+        return _enabled.load(std::memory_order_relaxed);
+    }
+
+    void SetEnabled(bool enabled)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _enabled.store(enabled, std::memory_order_relaxed);
+        if (!enabled)
+        {
+            _pendingInputs.clear();
+            _frames.clear();
+        }
+    }
+
+    // Returns a token for InputDispatched, 0 if tracing is disabled
+    uint64_t InputReceived(SurfaceKey surface, AvnInputLatencyEventKind kind, uint64_t eventTimeUs)
+    {
+        if (!IsEnabled() || surface == nullptr || kind < 0 || kind >= AvnInputLatencyEventKindCount)
+            return 0;
+
+        std::lock_guard<std::mutex> guard(_lock);
+        PendingInput input;
+        input.token = ++_lastToken;
+        input.surface = surface;
+        input.kind = kind;
+        input.eventTimeUs = eventTimeUs;
+        input.dispatchedTimeUs = 0;
+        _pendingInputs.push_back(input);
+
+        // Inputs to a surface that never presents must not accumulate forever
+        while (_pendingInputs.size() > _maxPendingInputs)
+            _pendingInputs.pop_front();
+
+        return input.token;
+    }
+
+    // Called once the managed handler for the input has returned
+    void InputDispatched(uint64_t token, uint64_t timeUs)
+    {
+        if (token == 0 || !IsEnabled())
+            return;
+
+        std::lock_guard<std::mutex> guard(_lock);
+        for (auto it = _pendingInputs.rbegin(); it != _pendingInputs.rend(); ++it)
+        {
+            if (it->token == token)
+            {
+                it->dispatchedTimeUs = timeUs;
+                break;
+            }
+        }
+    }
+
+    // A frame started rendering. Every input dispatched to the surface before this point is attributed to it.
+    // Returns a token for FramePresented/FrameAbandoned, 0 if there is nothing to attribute.
+    uint64_t FrameBegan(SurfaceKey surface, uint64_t timeUs)
+    {
+        if (!IsEnabled() || surface == nullptr)
+            return 0;
+
+        std::lock_guard<std::mutex> guard(_lock);
+        Frame frame;
+        frame.beginTimeUs = timeUs;
+
+        for (auto it = _pendingInputs.begin(); it != _pendingInputs.end();)
+        {
+            if (it->surface == surface && it->dispatchedTimeUs != 0 && it->dispatchedTimeUs <= timeUs)
+            {
+                frame.inputs.push_back(*it);
+                it = _pendingInputs.erase(it);
+            }
+            else
+                ++it;
+        }
+
+        if (frame.inputs.empty())
+            return 0;
+
+        auto token = ++_lastToken;
+        _frames.emplace(token, std::move(frame));
+        return token;
+    }
+
+    // The frame reached the screen, record a sample for every input it reflects
+    void FramePresented(uint64_t frameToken, uint64_t timeUs)
+    {
+        if (frameToken == 0)
+            return;
+
+        std::lock_guard<std::mutex> guard(_lock);
+        auto it = _frames.find(frameToken);
+        if (it == _frames.end())
+            return;
+
+        for (auto& input : it->second.inputs)
+        {
+            Sample sample;
+            sample.totalUs = Elapsed(input.eventTimeUs, timeUs);
+            sample.dispatchUs = Elapsed(input.eventTimeUs, input.dispatchedTimeUs);
+            sample.renderUs = Elapsed(it->second.beginTimeUs, timeUs);
+            AddSample(input.kind, sample);
+        }
+
+        _frames.erase(it);
+    }
+
+    // The frame was dropped (e.g. no drawable available), its inputs go to the next frame
+    void FrameAbandoned(uint64_t frameToken)
+    {
+        if (frameToken == 0)
+            return;
+
+        std::lock_guard<std::mutex> guard(_lock);
+        auto it = _frames.find(frameToken);
+        if (it == _frames.end())
+            return;
+
+        _pendingInputs.insert(_pendingInputs.begin(), it->second.inputs.begin(), it->second.inputs.end());
+        _frames.erase(it);
+    }
+
+    AvnInputLatencyStats GetStats(AvnInputLatencyEventKind kind)
+    {
+        AvnInputLatencyStats stats {};
+        if (kind < 0 || kind >= AvnInputLatencyEventKindCount)
+            return stats;
+
+        std::lock_guard<std::mutex> guard(_lock);
+        auto& samples = _samples[kind];
+        if (samples.empty())
+            return stats;
+
+        std::vector<uint64_t> total, dispatch, render;
+        total.reserve(samples.size());
+        dispatch.reserve(samples.size());
+        render.reserve(samples.size());
+        for (auto& sample : samples)
+        {
+            total.push_back(sample.totalUs);
+            dispatch.push_back(sample.dispatchUs);
+            render.push_back(sample.renderUs);
+        }
+
+        stats.SampleCount = static_cast<int>(samples.size());
+        stats.P50Us = Percentile(total, 50);
+        stats.P90Us = Percentile(total, 90);
+        stats.P99Us = Percentile(total, 99);
+        stats.MaxUs = *std::max_element(total.begin(), total.end());
+        stats.DispatchP50Us = Percentile(dispatch, 50);
+        stats.RenderP50Us = Percentile(render, 50);
+        return stats;
+    }
+
+    void Reset()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        for (auto& samples : _samples)
+            samples.clear();
+    }
+
+    // Nearest-rank percentile, reorders the values
+    static uint64_t Percentile(std::vector<uint64_t>& values, int percentile)
+    {
+        if (values.empty())
+            return 0;
+
+        auto rank = (values.size() * static_cast<size_t>(percentile) + 99) / 100;
+        auto index = rank == 0 ? 0 : rank - 1;
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+private:
+    struct PendingInput
+    {
+        uint64_t token;
+        SurfaceKey surface;
+        AvnInputLatencyEventKind kind;
+        uint64_t eventTimeUs;
+        uint64_t dispatchedTimeUs;
+    };
+
+    struct Frame
+    {
+        uint64_t beginTimeUs;
+        std::vector<PendingInput> inputs;
+    };
+
+    struct Sample
+    {
+        uint64_t totalUs;
+        uint64_t dispatchUs;
+        uint64_t renderUs;
+    };
+
+    static uint64_t Elapsed(uint64_t from, uint64_t to)
+    {
+        return to > from ? to - from : 0;
+    }
+
+    void AddSample(AvnInputLatencyEventKind kind, const Sample& sample)
+    {
+        auto& samples = _samples[kind];
+        samples.push_back(sample);
+        if (samples.size() > _maxSamplesPerKind)
+            samples.pop_front();
+    }
+
+    const size_t _maxSamplesPerKind;
+    const size_t _maxPendingInputs;
+    std::atomic<bool> _enabled { false };
+    std::mutex _lock;
+    uint64_t _lastToken = 0;
+    std::deque<PendingInput> _pendingInputs;
+    std::unordered_map<uint64_t, Frame> _frames;
+    std::deque<Sample> _samples[AvnInputLatencyEventKindCount];
+};
+
+#endif /* InputLatencyTracer_h */
@@ -0,0 +1,548 @@
+#ifndef keytransformtables_h
+#define keytransformtables_h
+
+// Compile-time key mapping tables used by KeyTransform.mm.
+// This header is plain C++ (no AppKit/Carbon), so the tables can be built and checked on any platform.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "avalonia-native.h"
+
+// Character codes, same values as Carbon's k*CharCode constants
+constexpr uint16_t AvnCharCodeBackspace = 0x08;
+constexpr uint16_t AvnCharCodeTab = 0x09;
+constexpr uint16_t AvnCharCodeReturn = 0x0D;
+constexpr uint16_t AvnCharCodeEscape = 0x1B;
+constexpr uint16_t AvnCharCodeClear = 0x1B;
+constexpr uint16_t AvnCharCodeSpace = 0x20;
+constexpr uint16_t AvnCharCodeDelete = 0x7F;
+
+// Function key unicode values, same values as AppKit's NS*FunctionKey constants
+// https://developer.apple.com/documentation/appkit/1535851-function-key_unicode_values
+constexpr uint16_t AvnFunctionKeyUpArrow = 0xF700;
+constexpr uint16_t AvnFunctionKeyDownArrow = 0xF701;
+constexpr uint16_t AvnFunctionKeyLeftArrow = 0xF702;
+constexpr uint16_t AvnFunctionKeyRightArrow = 0xF703;
+constexpr uint16_t AvnFunctionKeyF1 = 0xF704;
+constexpr uint16_t AvnFunctionKeyInsert = 0xF727;
+constexpr uint16_t AvnFunctionKeyDelete = 0xF728;
+constexpr uint16_t AvnFunctionKeyHome = 0xF729;
+constexpr uint16_t AvnFunctionKeyEnd = 0xF72B;
+constexpr uint16_t AvnFunctionKeyPageUp = 0xF72C;
+constexpr uint16_t AvnFunctionKeyPageDown = 0xF72D;
+constexpr uint16_t AvnFunctionKeyPrintScreen = 0xF72E;
+constexpr uint16_t AvnFunctionKeyScrollLock = 0xF72F;
+constexpr uint16_t AvnFunctionKeyPause = 0xF730;
+constexpr uint16_t AvnFunctionKeyMenu = 0xF735;
+constexpr uint16_t AvnFunctionKeyPrint = 0xF738;
+constexpr uint16_t AvnFunctionKeyClearLine = 0xF739;
+constexpr uint16_t AvnFunctionKeyExecute = 0xF742;
+constexpr uint16_t AvnFunctionKeyHelp = 0xF746;
+
+constexpr uint16_t AvnFunctionKeyF(int n)
+{
+    return static_cast<uint16_t>(AvnFunctionKeyF1 + n - 1);
+}
+
+struct KeyInfo
+{
+    uint16_t scanCode;
+    AvnPhysicalKey physicalKey;
+    AvnKey qwertyKey;
+    uint16_t menuChar;
+};
+
+// ScanCode - PhysicalKey - Key mapping (the virtual key is mapped as in a standard QWERTY keyboard)
+// https://github.com/chromium/chromium/blob/main/ui/events/keycodes/dom/dom_code_data.inc
+// This list has the same order as the PhysicalKey enum.
+constexpr KeyInfo keyInfos[] =
+{
+    // Writing System Keys
+    { 0x32, AvnPhysicalKeyBackquote, AvnKeyOem3, '`' },
+    { 0x2A, AvnPhysicalKeyBackslash, AvnKeyOem5, '\\' },
+    { 0x21, AvnPhysicalKeyBracketLeft,AvnKeyOem4, '[' },
+    { 0x1E, AvnPhysicalKeyBracketRight, AvnKeyOem6, ']' },
+    { 0x2B, AvnPhysicalKeyComma, AvnKeyOemComma, ',' },
+    { 0x1D, AvnPhysicalKeyDigit0, AvnKeyD0, '0' },
+    { 0x12, AvnPhysicalKeyDigit1, AvnKeyD1, '1' },
+    { 0x13, AvnPhysicalKeyDigit2, AvnKeyD2, '2' },
+    { 0x14, AvnPhysicalKeyDigit3, AvnKeyD3, '3' },
+    { 0x15, AvnPhysicalKeyDigit4, AvnKeyD4, '4' },
+    { 0x17, AvnPhysicalKeyDigit5, AvnKeyD5, '5' },
+    { 0x16, AvnPhysicalKeyDigit6, AvnKeyD6, '6' },
+    { 0x1A, AvnPhysicalKeyDigit7, AvnKeyD7, '7' },
+    { 0x1C, AvnPhysicalKeyDigit8, AvnKeyD8, '8' },
+    { 0x19, AvnPhysicalKeyDigit9, AvnKeyD9, '9' },
+    { 0x18, AvnPhysicalKeyEqual, AvnKeyOemPlus, '=' },
+    { 0x0A, AvnPhysicalKeyIntlBackslash, AvnKeyOem102, 0 },
+    { 0x5E, AvnPhysicalKeyIntlRo, AvnKeyOem102, 0 },
+    { 0x5D, AvnPhysicalKeyIntlYen, AvnKeyOem5, 0 },
+    { 0x00, AvnPhysicalKeyA, AvnKeyA, 'a' },
+    { 0x0B, AvnPhysicalKeyB, AvnKeyB, 'b' },
+    { 0x08, AvnPhysicalKeyC, AvnKeyC, 'c' },
+    { 0x02, AvnPhysicalKeyD, AvnKeyD, 'd' },
+    { 0x0E, AvnPhysicalKeyE, AvnKeyE, 'e' },
+    { 0x03, AvnPhysicalKeyF, AvnKeyF, 'f' },
+    { 0x05, AvnPhysicalKeyG, AvnKeyG, 'g' },
+    { 0x04, AvnPhysicalKeyH, AvnKeyH, 'h' },
+    { 0x22, AvnPhysicalKeyI, AvnKeyI, 'i' },
+    { 0x26, AvnPhysicalKeyJ, AvnKeyJ, 'j' },
+    { 0x28, AvnPhysicalKeyK, AvnKeyK, 'k' },
+    { 0x25, AvnPhysicalKeyL, AvnKeyL, 'l' },
+    { 0x2E, AvnPhysicalKeyM, AvnKeyM, 'm' },
+    { 0x2D, AvnPhysicalKeyN, AvnKeyN, 'n' },
+    { 0x1F, AvnPhysicalKeyO, AvnKeyO, 'o' },
+    { 0x23, AvnPhysicalKeyP, AvnKeyP, 'p' },
+    { 0x0C, AvnPhysicalKeyQ, AvnKeyQ, 'q' },
+    { 0x0F, AvnPhysicalKeyR, AvnKeyR, 'r' },
+    { 0x01, AvnPhysicalKeyS, AvnKeyS, 's' },
+    { 0x11, AvnPhysicalKeyT, AvnKeyT, 't' },
+    { 0x20, AvnPhysicalKeyU, AvnKeyU, 'u' },
+    { 0x09, AvnPhysicalKeyV, AvnKeyV, 'v' },
+    { 0x0D, AvnPhysicalKeyW, AvnKeyW, 'w' },
+    { 0x07, AvnPhysicalKeyX, AvnKeyX, 'x' },
+    { 0x10, AvnPhysicalKeyY, AvnKeyY, 'y' },
+    { 0x06, AvnPhysicalKeyZ, AvnKeyZ, 'z' },
+    { 0x1B, AvnPhysicalKeyMinus, AvnKeyOemMinus, '-' },
+    { 0x2F, AvnPhysicalKeyPeriod, AvnKeyOemPeriod, '.' },
+    { 0x27, AvnPhysicalKeyQuote, AvnKeyOem7, '\'' },
+    { 0x29, AvnPhysicalKeySemicolon, AvnKeyOem1, ';' },
+    { 0x2C, AvnPhysicalKeySlash, AvnKeyOem2, '/' },
+
+    // Functional Keys
+    { 0x3A, AvnPhysicalKeyAltLeft, AvnKeyLeftAlt, 0 },
+    { 0x3D, AvnPhysicalKeyAltRight, AvnKeyRightAlt, 0 },
+    { 0x33, AvnPhysicalKeyBackspace, AvnKeyBack, AvnCharCodeBackspace },
+    { 0x39, AvnPhysicalKeyCapsLock, AvnKeyCapsLock, 0 },
+    { 0x6E, AvnPhysicalKeyContextMenu, AvnKeyApps, 0 },
+    { 0x3B, AvnPhysicalKeyControlLeft, AvnKeyLeftCtrl, 0 },
+    { 0x3E, AvnPhysicalKeyControlRight, AvnKeyRightCtrl, 0 },
+    { 0x24, AvnPhysicalKeyEnter, AvnKeyEnter, AvnCharCodeReturn },
+    { 0x37, AvnPhysicalKeyMetaLeft, AvnKeyLWin, 0 },
+    { 0x36, AvnPhysicalKeyMetaRight, AvnKeyRWin, 0 },
+    { 0x38, AvnPhysicalKeyShiftLeft, AvnKeyLeftShift, 0 },
+    { 0x3C, AvnPhysicalKeyShiftRight, AvnKeyRightShift, 0 },
+    { 0x31, AvnPhysicalKeySpace, AvnKeySpace, AvnCharCodeSpace },
+    { 0x30, AvnPhysicalKeyTab, AvnKeyTab, AvnCharCodeTab },
+    //{   , AvnPhysicalKeyConvert, 0 },
+    //{   , AvnPhysicalKeyKanaMode, 0 },
+    { 0x68, AvnPhysicalKeyLang1, AvnKeyKanaMode, 0 },
+    { 0x66, AvnPhysicalKeyLang2, AvnKeyHanjaMode, 0 },
+    //{   , AvnPhysicalKeyLang3, 0 },
+    //{   , AvnPhysicalKeyLang4, 0 },
+    //{   , AvnPhysicalKeyLang5, 0 },
+    //{   , AvnPhysicalKeyNonConvert, 0 },
+
+    // Control Pad Section
+    { 0x75, AvnPhysicalKeyDelete, AvnKeyDelete, AvnFunctionKeyDelete },
+    { 0x77, AvnPhysicalKeyEnd, AvnKeyEnd, AvnFunctionKeyEnd },
+    //{   , AvnPhysicalKeyHelp, 0 },
+    { 0x73, AvnPhysicalKeyHome, AvnKeyHome, AvnFunctionKeyHome },
+    { 0x72, AvnPhysicalKeyInsert, AvnKeyInsert, AvnFunctionKeyInsert },
+    { 0x79, AvnPhysicalKeyPageDown, AvnKeyPageDown, AvnFunctionKeyPageDown },
+    { 0x74, AvnPhysicalKeyPageUp, AvnKeyPageUp, AvnFunctionKeyPageUp },
+
+    // Arrow Pad Section
+    { 0x7D, AvnPhysicalKeyArrowDown, AvnKeyDown, AvnFunctionKeyDownArrow },
+    { 0x7B, AvnPhysicalKeyArrowLeft, AvnKeyLeft, AvnFunctionKeyLeftArrow },
+    { 0x7C, AvnPhysicalKeyArrowRight, AvnKeyRight, AvnFunctionKeyRightArrow },
+    { 0x7E, AvnPhysicalKeyArrowUp, AvnKeyUp, AvnFunctionKeyUpArrow },
+
+    // Numpad Section
+    { 0x47, AvnPhysicalKeyNumLock, AvnKeyClear, AvnCharCodeClear },
+    { 0x52, AvnPhysicalKeyNumPad0, AvnKeyNumPad0, '0' },
+    { 0x53, AvnPhysicalKeyNumPad1, AvnKeyNumPad1, '1' },
+    { 0x54, AvnPhysicalKeyNumPad2, AvnKeyNumPad2, '2' },
+    { 0x55, AvnPhysicalKeyNumPad3, AvnKeyNumPad3, '3' },
+    { 0x56, AvnPhysicalKeyNumPad4, AvnKeyNumPad4, '4' },
+    { 0x57, AvnPhysicalKeyNumPad5, AvnKeyNumPad5, '5' },
+    { 0x58, AvnPhysicalKeyNumPad6, AvnKeyNumPad6, '6' },
+    { 0x59, AvnPhysicalKeyNumPad7, AvnKeyNumPad7, '7' },
+    { 0x5B, AvnPhysicalKeyNumPad8, AvnKeyNumPad8, '8' },
+    { 0x5C, AvnPhysicalKeyNumPad9, AvnKeyNumPad9, '9' },
+    { 0x45, AvnPhysicalKeyNumPadAdd, AvnKeyAdd, '+' },
+    //{   , AvnPhysicalKeyNumPadClear, 0 },
+    { 0x5F, AvnPhysicalKeyNumPadComma, AvnKeyAbntC2, 0 },
+    { 0x41, AvnPhysicalKeyNumPadDecimal, AvnKeyDecimal, '.' },
+    { 0x4B, AvnPhysicalKeyNumPadDivide, AvnKeyDivide, '/' },
+    { 0x4C, AvnPhysicalKeyNumPadEnter, AvnKeyEnter, AvnCharCodeReturn },
+    { 0x51, AvnPhysicalKeyNumPadEqual, AvnKeyOemPlus, '=' },
+    { 0x43, AvnPhysicalKeyNumPadMultiply, AvnKeyMultiply, '*' },
+    //{   , AvnPhysicalKeyNumPadParenLeft, 0 },
+    //{   , AvnPhysicalKeyNumPadParenRight, 0 },
+    { 0x4E, AvnPhysicalKeyNumPadSubtract, AvnKeySubtract, '-' },
+
+    // Function Section
+    { 0x35, AvnPhysicalKeyEscape, AvnKeyEscape, AvnCharCodeEscape },
+    { 0x7A, AvnPhysicalKeyF1, AvnKeyF1, AvnFunctionKeyF(1) },
+    { 0x78, AvnPhysicalKeyF2, AvnKeyF2, AvnFunctionKeyF(2) },
+    { 0x63, AvnPhysicalKeyF3, AvnKeyF3, AvnFunctionKeyF(3) },
+    { 0x76, AvnPhysicalKeyF4, AvnKeyF4, AvnFunctionKeyF(4) },
+    { 0x60, AvnPhysicalKeyF5, AvnKeyF5, AvnFunctionKeyF(5) },
+    { 0x61, AvnPhysicalKeyF6, AvnKeyF6, AvnFunctionKeyF(6) },
+    { 0x62, AvnPhysicalKeyF7, AvnKeyF7, AvnFunctionKeyF(7) },
+    { 0x64, AvnPhysicalKeyF8, AvnKeyF8, AvnFunctionKeyF(8) },
+    { 0x65, AvnPhysicalKeyF9, AvnKeyF9, AvnFunctionKeyF(9) },
+    { 0x6D, AvnPhysicalKeyF10, AvnKeyF10, AvnFunctionKeyF(10) },
+    { 0x67, AvnPhysicalKeyF11, AvnKeyF11, AvnFunctionKeyF(11) },
+    { 0x6F, AvnPhysicalKeyF12, AvnKeyF12, AvnFunctionKeyF(12) },
+    { 0x69, AvnPhysicalKeyF13, AvnKeyF13, AvnFunctionKeyF(13) },
+    { 0x6B, AvnPhysicalKeyF14, AvnKeyF14, AvnFunctionKeyF(14) },
+    { 0x71, AvnPhysicalKeyF15, AvnKeyF15, AvnFunctionKeyF(15) },
+    { 0x6A, AvnPhysicalKeyF16, AvnKeyF16, AvnFunctionKeyF(16) },
+    { 0x40, AvnPhysicalKeyF17, AvnKeyF17, AvnFunctionKeyF(17) },
+    { 0x4F, AvnPhysicalKeyF18, AvnKeyF18, AvnFunctionKeyF(18) },
+    { 0x50, AvnPhysicalKeyF19, AvnKeyF19, AvnFunctionKeyF(19) },
+    { 0x5A, AvnPhysicalKeyF20, AvnKeyF20, AvnFunctionKeyF(20) },
+    //{   , AvnPhysicalKeyF21, 0 },
+    //{   , AvnPhysicalKeyF22, 0 },
+    //{   , AvnPhysicalKeyF23, 0 },
+    //{   , AvnPhysicalKeyF24, 0 },
+    //{   , AvnPhysicalKeyPrintScreen, 0 },
+    //{   , AvnPhysicalKeyScrollLock, 0 },
+    //{   , AvnPhysicalKeyPause, 0 },
+
+    // Media Keys
+    //{   , AvnPhysicalKeyBrowserBack, 0 },
+    //{   , AvnPhysicalKeyBrowserFavorites, 0 },
+    //{   , AvnPhysicalKeyBrowserForward, 0 },
+    //{   , AvnPhysicalKeyBrowserHome, 0 },
+    //{   , AvnPhysicalKeyBrowserRefresh, 0 },
+    //{   , AvnPhysicalKeyBrowserSearch, 0 },
+    //{   , AvnPhysicalKeyBrowserStop, 0 },
+    //{   , AvnPhysicalKeyEject, 0 },
+    //{   , AvnPhysicalKeyLaunchApp1, 0 },
+    //{   , AvnPhysicalKeyLaunchApp2, 0 },
+    //{   , AvnPhysicalKeyLaunchMail, 0 },
+    //{   , AvnPhysicalKeyMediaPlayPause, 0 },
+    //{   , AvnPhysicalKeyMediaSelect, 0 },
+    //{   , AvnPhysicalKeyMediaStop, 0 },
+    //{   , AvnPhysicalKeyMediaTrackNext, 0 },
+    //{   , AvnPhysicalKeyMediaTrackPrevious, 0 },
+    //{   , AvnPhysicalKeyPower, 0 },
+    //{   , AvnPhysicalKeySleep, 0 },
+    { 0x49, AvnPhysicalKeyAudioVolumeDown, AvnKeyVolumeDown, 0 },
+    { 0x4A, AvnPhysicalKeyAudioVolumeMute, AvnKeyVolumeMute, 0 },
+    { 0x48, AvnPhysicalKeyAudioVolumeUp, AvnKeyVolumeUp, 0 },
+    //{   , AvnPhysicalKeyWakeUp, 0 },
+
+    // Legacy Keys
+    //{   , AvnPhysicalKeyAgain, 0 },
+    //{   , AvnPhysicalKeyCopy, 0 },
+    //{   , AvnPhysicalKeyCut, 0 },
+    //{   , AvnPhysicalKeyFind, 0 },
+    //{   , AvnPhysicalKeyOpen, 0 },
+    //{   , AvnPhysicalKeyPaste, 0 },
+    //{   , AvnPhysicalKeyProps, 0 },
+    //{   , AvnPhysicalKeySelect, 0 },
+    //{   , AvnPhysicalKeyUndo, 0 }
+};
+
+struct CharKeyInfo
+{
+    uint16_t character;
+    AvnKey key;
+};
+
+// Character - Key mapping used when the current keyboard layout produces a character for a key
+constexpr CharKeyInfo charKeyInfos[] =
+{
+    // Alphabetic keys
+    { 'A', AvnKeyA },
+    { 'B', AvnKeyB },
+    { 'C', AvnKeyC },
+    { 'D', AvnKeyD },
+    { 'E', AvnKeyE },
+    { 'F', AvnKeyF },
+    { 'G', AvnKeyG },
+    { 'H', AvnKeyH },
+    { 'I', AvnKeyI },
+    { 'J', AvnKeyJ },
+    { 'K', AvnKeyK },
+    { 'L', AvnKeyL },
+    { 'M', AvnKeyM },
+    { 'N', AvnKeyN },
+    { 'O', AvnKeyO },
+    { 'P', AvnKeyP },
+    { 'Q', AvnKeyQ },
+    { 'R', AvnKeyR },
+    { 'S', AvnKeyS },
+    { 'T', AvnKeyT },
+    { 'U', AvnKeyU },
+    { 'V', AvnKeyV },
+    { 'W', AvnKeyW },
+    { 'X', AvnKeyX },
+    { 'Y', AvnKeyY },
+    { 'Z', AvnKeyZ },
+    { 'a', AvnKeyA },
+    { 'b', AvnKeyB },
+    { 'c', AvnKeyC },
+    { 'd', AvnKeyD },
+    { 'e', AvnKeyE },
+    { 'f', AvnKeyF },
+    { 'g', AvnKeyG },
+    { 'h', AvnKeyH },
+    { 'i', AvnKeyI },
+    { 'j', AvnKeyJ },
+    { 'k', AvnKeyK },
+    { 'l', AvnKeyL },
+    { 'm', AvnKeyM },
+    { 'n', AvnKeyN },
+    { 'o', AvnKeyO },
+    { 'p', AvnKeyP },
+    { 'q', AvnKeyQ },
+    { 'r', AvnKeyR },
+    { 's', AvnKeyS },
+    { 't', AvnKeyT },
+    { 'u', AvnKeyU },
+    { 'v', AvnKeyV },
+    { 'w', AvnKeyW },
+    { 'x', AvnKeyX },
+    { 'y', AvnKeyY },
+    { 'z', AvnKeyZ },
+
+    // Punctuation: US specific mappings (same as Chromium)
+    { ';', AvnKeyOem1 },
+    { ':', AvnKeyOem1 },
+    { '=', AvnKeyOemPlus },
+    { '+', AvnKeyOemPlus },
+    { ',', AvnKeyOemComma },
+    { '<', AvnKeyOemComma },
+    { '-', AvnKeyOemMinus },
+    { '_', AvnKeyOemMinus },
+    { '.', AvnKeyOemPeriod },
+    { '>', AvnKeyOemPeriod },
+    { '/', AvnKeyOem2 },
+    { '?', AvnKeyOem2 },
+    { '`', AvnKeyOem3 },
+    { '~', AvnKeyOem3 },
+    { '[', AvnKeyOem4 },
+    { '{', AvnKeyOem4 },
+    { '\\', AvnKeyOem5 },
+    { '|', AvnKeyOem5 },
+    { ']', AvnKeyOem6 },
+    { '}', AvnKeyOem6 },
+    { '\'', AvnKeyOem7 },
+    { '"', AvnKeyOem7 },
+
+    // Apple function keys
+    { AvnFunctionKeyDelete, AvnKeyDelete },
+    { AvnFunctionKeyUpArrow, AvnKeyUp },
+    { AvnFunctionKeyLeftArrow, AvnKeyLeft },
+    { AvnFunctionKeyRightArrow, AvnKeyRight },
+    { AvnFunctionKeyPageUp, AvnKeyPageUp },
+    { AvnFunctionKeyPageDown, AvnKeyPageDown },
+    { AvnFunctionKeyHome, AvnKeyHome },
+    { AvnFunctionKeyEnd, AvnKeyEnd },
+    { AvnFunctionKeyClearLine, AvnKeyClear },
+    { AvnFunctionKeyExecute, AvnKeyExecute },
+    { AvnFunctionKeyHelp, AvnKeyHelp },
+    { AvnFunctionKeyInsert, AvnKeyInsert },
+    { AvnFunctionKeyMenu, AvnKeyApps },
+    { AvnFunctionKeyPause, AvnKeyPause },
+    { AvnFunctionKeyPrint, AvnKeyPrint },
+    { AvnFunctionKeyPrintScreen, AvnKeyPrintScreen },
+    { AvnFunctionKeyScrollLock, AvnKeyScroll },
+    { AvnFunctionKeyF(1), AvnKeyF1 },
+    { AvnFunctionKeyF(2), AvnKeyF2 },
+    { AvnFunctionKeyF(3), AvnKeyF3 },
+    { AvnFunctionKeyF(4), AvnKeyF4 },
+    { AvnFunctionKeyF(5), AvnKeyF5 },
+    { AvnFunctionKeyF(6), AvnKeyF6 },
+    { AvnFunctionKeyF(7), AvnKeyF7 },
+    { AvnFunctionKeyF(8), AvnKeyF8 },
+    { AvnFunctionKeyF(9), AvnKeyF9 },
+    { AvnFunctionKeyF(10), AvnKeyF10 },
+    { AvnFunctionKeyF(11), AvnKeyF11 },
+    { AvnFunctionKeyF(12), AvnKeyF12 },
+    { AvnFunctionKeyF(13), AvnKeyF13 },
+    { AvnFunctionKeyF(14), AvnKeyF14 },
+    { AvnFunctionKeyF(15), AvnKeyF15 },
+    { AvnFunctionKeyF(16), AvnKeyF16 },
+    { AvnFunctionKeyF(17), AvnKeyF17 },
+    { AvnFunctionKeyF(18), AvnKeyF18 },
+    { AvnFunctionKeyF(19), AvnKeyF19 },
+    { AvnFunctionKeyF(20), AvnKeyF20 },
+    { AvnFunctionKeyF(21), AvnKeyF21 },
+    { AvnFunctionKeyF(22), AvnKeyF22 },
+    { AvnFunctionKeyF(23), AvnKeyF23 },
+    { AvnFunctionKeyF(24), AvnKeyF24 }
+};
+
+// All tables below are dense arrays indexed directly by the lookup key.
+// A value of AvnPhysicalKeyNone / AvnKeyNone / 0 means "no mapping".
+
+constexpr size_t ScanCodeTableSize = 0x80;
+constexpr size_t PhysicalKeyTableSize = AvnPhysicalKeyUndo + 1;
+constexpr size_t MenuCharTableSize = AvnKeyDeadCharProcessed + 1;
+constexpr size_t AsciiCharTableSize = 0x80;
+constexpr uint16_t FunctionKeyCharFirst = AvnFunctionKeyUpArrow;
+constexpr size_t FunctionKeyCharTableSize = 0x50;
+constexpr uint16_t FunctionKeyCharLast = FunctionKeyCharFirst + FunctionKeyCharTableSize - 1;
+
+typedef std::array<AvnPhysicalKey, ScanCodeTableSize> PhysicalKeyArray;
+typedef std::array<AvnKey, PhysicalKeyTableSize> QwertyKeyArray;
+typedef std::array<uint16_t, MenuCharTableSize> MenuCharArray;
+typedef std::array<AvnKey, AsciiCharTableSize> AsciiCharKeyArray;
+typedef std::array<AvnKey, FunctionKeyCharTableSize> FunctionCharKeyArray;
+
+constexpr PhysicalKeyArray BuildPhysicalKeyFromScanCode()
+{
+    PhysicalKeyArray result {};
+
+    for (auto& keyInfo : keyInfos)
+        result[keyInfo.scanCode] = keyInfo.physicalKey;
+
+    return result;
+}
+
+constexpr QwertyKeyArray BuildQwertyVirtualKeyFromPhysicalKey()
+{
+    QwertyKeyArray result {};
+
+    for (auto& keyInfo : keyInfos)
+        result[keyInfo.physicalKey] = keyInfo.qwertyKey;
+
+    return result;
+}
+
+constexpr MenuCharArray BuildMenuCharFromVirtualKey()
+{
+    MenuCharArray result {};
+
+    // Later entries win, e.g. NumPadEnter overrides Enter for AvnKeyEnter (both map to the same char)
+    for (auto& keyInfo : keyInfos)
+    {
+        if (keyInfo.menuChar != 0)
+            result[keyInfo.qwertyKey] = keyInfo.menuChar;
+    }
+
+    return result;
+}
+
+constexpr AsciiCharKeyArray BuildVirtualKeyFromAsciiChar()
+{
+    AsciiCharKeyArray result {};
+
+    for (auto& charKeyInfo : charKeyInfos)
+    {
+        if (charKeyInfo.character < AsciiCharTableSize)
+            result[charKeyInfo.character] = charKeyInfo.key;
+    }
+
+    return result;
+}
+
+constexpr FunctionCharKeyArray BuildVirtualKeyFromFunctionChar()
+{
+    FunctionCharKeyArray result {};
+
+    for (auto& charKeyInfo : charKeyInfos)
+    {
+        if (charKeyInfo.character >= FunctionKeyCharFirst)
+            result[charKeyInfo.character - FunctionKeyCharFirst] = charKeyInfo.key;
+    }
+
+    return result;
+}
+
+constexpr PhysicalKeyArray physicalKeyFromScanCode = BuildPhysicalKeyFromScanCode();
+constexpr QwertyKeyArray qwertyVirtualKeyFromPhysicalKey = BuildQwertyVirtualKeyFromPhysicalKey();
+constexpr MenuCharArray menuCharFromVirtualKey = BuildMenuCharFromVirtualKey();
+constexpr AsciiCharKeyArray virtualKeyFromAsciiChar = BuildVirtualKeyFromAsciiChar();
+constexpr FunctionCharKeyArray virtualKeyFromFunctionChar = BuildVirtualKeyFromFunctionChar();
+
+constexpr AvnPhysicalKey LookupPhysicalKeyFromScanCode(uint16_t scanCode)
+{
+    return scanCode < physicalKeyFromScanCode.size() ? physicalKeyFromScanCode[scanCode] : AvnPhysicalKeyNone;
+}
+
+constexpr AvnKey LookupQwertyVirtualKey(AvnPhysicalKey physicalKey)
+{
+    return static_cast<size_t>(physicalKey) < qwertyVirtualKeyFromPhysicalKey.size()
+        ? qwertyVirtualKeyFromPhysicalKey[physicalKey]
+        : AvnKeyNone;
+}
+
+constexpr uint16_t LookupMenuCharFromVirtualKey(AvnKey key)
+{
+    return static_cast<size_t>(key) < menuCharFromVirtualKey.size() ? menuCharFromVirtualKey[key] : 0;
+}
+
+constexpr AvnKey LookupVirtualKeyFromChar(uint16_t c)
+{
+    if (c < AsciiCharTableSize)
+        return virtualKeyFromAsciiChar[c];
+
+    if (c >= FunctionKeyCharFirst && c <= FunctionKeyCharLast)
+        return virtualKeyFromFunctionChar[c - FunctionKeyCharFirst];
+
+    return AvnKeyNone;
+}
+
+// Consistency checks against keyInfos / charKeyInfos
+
+constexpr bool ValidateKeyInfos()
+{
+    AvnPhysicalKey previous = AvnPhysicalKeyNone;
+
+    for (auto& keyInfo : keyInfos)
+    {
+        // Fits in the dense tables
+        if (keyInfo.scanCode >= ScanCodeTableSize
+            || static_cast<size_t>(keyInfo.physicalKey) >= PhysicalKeyTableSize
+            || static_cast<size_t>(keyInfo.qwertyKey) >= MenuCharTableSize)
+            return false;
+
+        // Same order as the PhysicalKey enum, which also guarantees unique physical keys
+        if (keyInfo.physicalKey <= previous)
+            return false;
+        previous = keyInfo.physicalKey;
+
+        // Unique scan codes, all of them round-trip through the tables
+        if (LookupPhysicalKeyFromScanCode(keyInfo.scanCode) != keyInfo.physicalKey)
+            return false;
+        if (LookupQwertyVirtualKey(keyInfo.physicalKey) != keyInfo.qwertyKey)
+            return false;
+
+        // Keys sharing a virtual key must agree on the menu char
+        if (keyInfo.menuChar != 0 && LookupMenuCharFromVirtualKey(keyInfo.qwertyKey) != keyInfo.menuChar)
+            return false;
+    }
+
+    return true;
+}
+
+constexpr bool ValidateCharKeyInfos()
+{
+    for (size_t i = 0; i < sizeof(charKeyInfos) / sizeof(charKeyInfos[0]); i++)
+    {
+        auto& charKeyInfo = charKeyInfos[i];
+
+        // Either ASCII or an Apple function key, never unmapped
+        if (charKeyInfo.key == AvnKeyNone)
+            return false;
+        if (charKeyInfo.character >= AsciiCharTableSize
+            && (charKeyInfo.character < FunctionKeyCharFirst
+                || charKeyInfo.character > FunctionKeyCharLast))
+            return false;
+
+        // No duplicate characters
+        for (size_t j = 0; j < i; j++)
+        {
+            if (charKeyInfos[j].character == charKeyInfo.character)
+                return false;
+        }
+
+        if (LookupVirtualKeyFromChar(charKeyInfo.character) != charKeyInfo.key)
+            return false;
+    }
+
+    return true;
+}
+
+static_assert(ValidateKeyInfos(), "keyInfos is inconsistent with the generated lookup tables");
+static_assert(ValidateCharKeyInfos(), "charKeyInfos is inconsistent with the generated lookup tables");
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef LazyValue_h
+#define LazyValue_h
+
+// A value created by the first Get instead of up front, for state that costs something to create and may never be
+// used (standard cursors, displays, ...). Creation runs once even if several threads get the value at the same
+// time, after that Get is a single acquire load. For process-wide singletons a function-local static does the
+// same, this is for members.
+// Plain C++.
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <utility>
+
+template <typename T>
+class LazyValue
+{
+public:
+    LazyValue() = default;
+
+    ~LazyValue()
+    {
+        if (IsCreated())
+            Value().~T();
+    }
+
+    LazyValue(const LazyValue&) = delete;
+    LazyValue& operator=(const LazyValue&) = delete;
+
+    bool IsCreated() const
+    {
+        return _created.load(std::memory_order_acquire);
+    }
+
+    // factory returns the value, it runs once, other threads getting the value meanwhile wait for it
+    template <typename TFactory>
+    T& Get(TFactory&& factory)
+    {
+        if (!_created.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            if (!_created.load(std::memory_order_relaxed))
+            {
+                new (&_storage) T(std::forward<TFactory>(factory)());
+                _created.store(true, std::memory_order_release);
+            }
+        }
+
+        return Value();
+    }
+
+private:
+    T& Value()
+    {
+        return *std::launder(reinterpret_cast<T*>(&_storage));
+    }
+
+    alignas(T) unsigned char _storage[sizeof(T)];
+    std::atomic<bool> _created {false};
+    std::mutex _lock;
+};
+
+#endif /* LazyValue_h */
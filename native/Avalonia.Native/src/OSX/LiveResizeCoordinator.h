@@ -0,0 +1,135 @@
+#ifndef LiveResizeCoordinator_h
+#define LiveResizeCoordinator_h
+
+// Size changes of a view, committed to the render target and the managed side together. While the user drags a
+// window edge AppKit resizes the view several times per display refresh, committing each of them resizes the
+// render target and lays out for sizes that never reach the screen. During a live resize changes are collected
+// instead and the last one is committed right before the view is drawn, so layout, render target and the frame
+// presented all have the same size. Outside of a live resize every change is committed right away.
+// Changes that don't change the size in pixels aren't committed at all.
+// Plain C++, committing and scheduling the flush are up to the caller. Main thread only.
+
+#include <cstdint>
+#include "avalonia-native.h"
+
+enum class LiveResizeAction
+{
+    // Nothing to commit
+    None,
+    // Commit the size handed back now
+    Commit,
+    // A flush has to be scheduled, the view is going to be drawn with the new size
+    ScheduleFlush,
+    // A flush is scheduled already
+    Wait,
+};
+
+struct LiveResizeCommit
+{
+    AvnPixelSize PixelSize {};
+    AvnSize Size {};
+    AvnPlatformResizeReason Reason = ResizeUnspecified;
+};
+
+class LiveResizeCoordinator
+{
+public:
+    explicit LiveResizeCoordinator(AvnPixelSize committed = AvnPixelSize { 100, 100 }) : _committed(committed)
+    {
+    }
+
+    AvnPixelSize GetCommittedPixelSize() const
+    {
+        return _committed;
+    }
+
+    bool HasPending() const
+    {
+        return _hasPending;
+    }
+
+    LiveResizeAction OnSizeChanged(AvnPixelSize pixelSize, AvnSize size, AvnPlatformResizeReason reason,
+                                   bool inLiveResize, LiveResizeCommit& commit)
+    {
+        _changes++;
+
+        if (IsSame(pixelSize, _committed))
+        {
+            // Dragged back to the size the view already has
+            _hasPending = false;
+            return LiveResizeAction::None;
+        }
+
+        if (!inLiveResize)
+        {
+            _hasPending = false;
+            commit = LiveResizeCommit { pixelSize, size, reason };
+            Committed(commit);
+            return LiveResizeAction::Commit;
+        }
+
+        _pending = LiveResizeCommit { pixelSize, size, reason };
+        _hasPending = true;
+
+        if (_flushScheduled)
+            return LiveResizeAction::Wait;
+
+        _flushScheduled = true;
+        return LiveResizeAction::ScheduleFlush;
+    }
+
+    // Returns true if there is a size to commit, called before the view is drawn, when the scheduled flush runs
+    // and when the live resize ends
+    bool Flush(LiveResizeCommit& commit)
+    {
+        _flushScheduled = false;
+
+        if (!_hasPending)
+            return false;
+
+        _hasPending = false;
+        commit = _pending;
+        Committed(commit);
+        return true;
+    }
+
+    // The render target was resized by something else, e.g. the backing scale factor changing
+    void SetCommittedPixelSize(AvnPixelSize pixelSize)
+    {
+        _committed = pixelSize;
+
+        if (_hasPending && IsSame(_pending.PixelSize, _committed))
+            _hasPending = false;
+    }
+
+    uint64_t GetChangeCount() const
+    {
+        return _changes;
+    }
+
+    uint64_t GetCommitCount() const
+    {
+        return _commits;
+    }
+
+private:
+    static bool IsSame(AvnPixelSize a, AvnPixelSize b)
+    {
+        return a.Width == b.Width && a.Height == b.Height;
+    }
+
+    void Committed(const LiveResizeCommit& commit)
+    {
+        _committed = commit.PixelSize;
+        _commits++;
+    }
+
+    AvnPixelSize _committed;
+    LiveResizeCommit _pending;
+    bool _hasPending = false;
+    bool _flushScheduled = false;
+    uint64_t _changes = 0;
+    uint64_t _commits = 0;
+};
+
+#endif /* LiveResizeCoordinator_h */
@@ -0,0 +1,114 @@
+#ifndef MenuEnablementCache_h
+#define MenuEnablementCache_h
+
+// Enabled state of the items of one menu. AppKit validates every item of a menu when it opens and the matching
+// one on a key equivalent, asking the managed side item by item would make one transition per item. Instead the
+// first item validated asks for all items of the menu in one batch, the rest are answered from that batch.
+// Results are kept while the menu is open and dropped when it closes or when the managed side says an item's
+// enabled state changed. A batch made while the menu is closed only lives until the end of the validation pass
+// (AppKit may validate right before the menu reports it opens, such a batch is kept for the opened menu).
+// Plain C++, the batch is evaluated by the caller into a bitmap with one bit per id.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class MenuEnablementCache
+{
+public:
+    static size_t GetBitmapLength(size_t count)
+    {
+        return (count + 7) / 8;
+    }
+
+    static bool GetBit(const uint8_t* bitmap, size_t index)
+    {
+        return (bitmap[index / 8] & (1 << (index % 8))) != 0;
+    }
+
+    bool IsOpen() const
+    {
+        return _open;
+    }
+
+    void Open()
+    {
+        _open = true;
+    }
+
+    void Close()
+    {
+        _open = false;
+        Invalidate();
+    }
+
+    // Returns true if the menu is open and has to be validated again, only once until Refreshed
+    bool Invalidate()
+    {
+        _enabled.clear();
+
+        if (!_open || _refreshPending)
+            return false;
+
+        _refreshPending = true;
+        return true;
+    }
+
+    void Refreshed()
+    {
+        _refreshPending = false;
+    }
+
+    // Returns true if a batch was made while the menu is closed, only once until EndPass.
+    // The caller has to call EndPass once the current validation pass is over.
+    bool NeedsEndPass()
+    {
+        if (_open || _enabled.empty() || _endPassPending)
+            return false;
+
+        _endPassPending = true;
+        return true;
+    }
+
+    void EndPass()
+    {
+        _endPassPending = false;
+
+        if (!_open)
+            _enabled.clear();
+    }
+
+    // Whether id is enabled. If it isn't known every id of getIds() (only id if it isn't one of them) is evaluated.
+    // evaluate(const uint64_t* ids, size_t count, uint8_t* bitmap) gets a zeroed bitmap of GetBitmapLength(count).
+    template <typename TGetIds, typename TEvaluate>
+    bool IsEnabled(uint64_t id, TGetIds getIds, TEvaluate evaluate)
+    {
+        auto it = _enabled.find(id);
+        if (it != _enabled.end())
+            return it->second;
+
+        std::vector<uint64_t> batch = getIds();
+        if (std::find(batch.begin(), batch.end(), id) == batch.end())
+            batch.assign(1, id);
+
+        _bitmap.assign(GetBitmapLength(batch.size()), 0);
+        evaluate(batch.data(), batch.size(), _bitmap.data());
+
+        _enabled.reserve(batch.size());
+        for (size_t i = 0; i < batch.size(); i++)
+            _enabled[batch[i]] = GetBit(_bitmap.data(), i);
+
+        return _enabled[id];
+    }
+
+private:
+    bool _open = false;
+    bool _refreshPending = false;
+    bool _endPassPending = false;
+    std::unordered_map<uint64_t, bool> _enabled;
+    std::vector<uint8_t> _bitmap;
+};
+
+#endif /* MenuEnablementCache_h */
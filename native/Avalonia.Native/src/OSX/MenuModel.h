@@ -0,0 +1,347 @@
+#ifndef MenuModel_h
+#define MenuModel_h
+
+// A whole menu tree as sent by the managed side in a single IAvnMenu::ApplyModel call, and the diff that turns
+// the items a menu currently has into the ones of a new model. Items are keyed by an id that is stable for the
+// lifetime of the managed item, so an unchanged item is never touched and a moved one is moved, not recreated.
+// Plain C++, the layout is the one written by NativeMenuModel.cs:
+//
+//   menu   := u32 count, item[count]
+//   item   := u64 id, u8 kind, u16 flags, then for anything but a separator:
+//             string title, string toolTip, i32 key, i32 modifiers, u8 toggleType,
+//             [u32 length, bytes icon]   if flags has MenuModelHasIcon but not MenuModelIconUnchanged
+//             menu subMenu               if flags has MenuModelHasSubMenu
+//   string := u32 length, UTF-8 bytes
+//
+// Integers are little endian.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class MenuModelItemKind : uint8_t
+{
+    Item = 0,
+    Separator = 1,
+};
+
+enum MenuModelItemFlags : uint16_t
+{
+    MenuModelChecked = 1 << 0,
+    MenuModelVisible = 1 << 1,
+    MenuModelHasSubMenu = 1 << 2,
+    MenuModelServicesMenu = 1 << 3,
+    MenuModelHasIcon = 1 << 4,
+    // The icon is the one sent last time, its bytes are left out
+    MenuModelIconUnchanged = 1 << 5,
+};
+
+// What MenuModelChanges reports as different between two versions of an item
+enum MenuModelProperty : uint32_t
+{
+    MenuModelPropertyTitle = 1 << 0,
+    MenuModelPropertyToolTip = 1 << 1,
+    MenuModelPropertyGesture = 1 << 2,
+    MenuModelPropertyToggleType = 1 << 3,
+    MenuModelPropertyChecked = 1 << 4,
+    MenuModelPropertyVisible = 1 << 5,
+    MenuModelPropertyIcon = 1 << 6,
+    MenuModelPropertySubMenu = 1 << 7,
+    MenuModelPropertyServicesMenu = 1 << 8,
+};
+
+struct MenuModelItem
+{
+    uint64_t Id = 0;
+    MenuModelItemKind Kind = MenuModelItemKind::Item;
+    uint16_t Flags = 0;
+    std::string Title;
+    std::string ToolTip;
+    int32_t Key = 0;
+    int32_t Modifiers = 0;
+    uint8_t ToggleType = 0;
+    std::vector<uint8_t> Icon;
+    std::vector<MenuModelItem> SubMenu;
+
+    bool HasFlag(MenuModelItemFlags flag) const
+    {
+        return (Flags & flag) != 0;
+    }
+};
+
+class MenuModelReader
+{
+public:
+    // Returns false if the data is malformed, nests too deep or has the same id twice in one menu
+    static bool Read(const void* data, size_t length, std::vector<MenuModelItem>& items)
+    {
+        MenuModelReader reader(static_cast<const uint8_t*>(data), length);
+        items.clear();
+        return reader.ReadMenu(items, 0) && reader._position == reader._length;
+    }
+
+private:
+    static constexpr int MaxDepth = 64;
+
+    MenuModelReader(const uint8_t* data, size_t length) : _data(data), _length(data != nullptr ? length : 0)
+    {
+    }
+
+    bool ReadMenu(std::vector<MenuModelItem>& items, int depth)
+    {
+        uint32_t count;
+        if (depth > MaxDepth || !ReadValue(count))
+            return false;
+
+        // Every item takes at least 11 bytes, don't let a bogus count allocate
+        if (count > (_length - _position) / 11)
+            return false;
+
+        items.resize(count);
+        std::unordered_map<uint64_t, size_t> ids;
+        ids.reserve(count);
+
+        for (auto& item : items)
+        {
+            if (!ReadItem(item, depth) || !ids.emplace(item.Id, 0).second)
+                return false;
+        }
+
+        return true;
+    }
+
+    bool ReadItem(MenuModelItem& item, int depth)
+    {
+        uint8_t kind;
+        if (!ReadValue(item.Id) || !ReadValue(kind) || !ReadValue(item.Flags))
+            return false;
+
+        if (kind > static_cast<uint8_t>(MenuModelItemKind::Separator))
+            return false;
+
+        item.Kind = static_cast<MenuModelItemKind>(kind);
+        if (item.Kind == MenuModelItemKind::Separator)
+            return true;
+
+        if (!ReadString(item.Title) || !ReadString(item.ToolTip) || !ReadValue(item.Key) ||
+            !ReadValue(item.Modifiers) || !ReadValue(item.ToggleType))
+            return false;
+
+        if (item.HasFlag(MenuModelHasIcon) && !item.HasFlag(MenuModelIconUnchanged))
+        {
+            uint32_t iconLength;
+            if (!ReadValue(iconLength) || iconLength > _length - _position)
+                return false;
+            item.Icon.assign(_data + _position, _data + _position + iconLength);
+            _position += iconLength;
+        }
+
+        if (item.HasFlag(MenuModelHasSubMenu))
+            return ReadMenu(item.SubMenu, depth + 1);
+
+        return true;
+    }
+
+    bool ReadString(std::string& value)
+    {
+        uint32_t length;
+        if (!ReadValue(length) || length > _length - _position)
+            return false;
+
+        value.assign(reinterpret_cast<const char*>(_data + _position), length);
+        _position += length;
+        return true;
+    }
+
+    template <typename T>
+    bool ReadValue(T& value)
+    {
+        if (sizeof(T) > _length - _position)
+            return false;
+
+        // Little endian, like every platform we run on
+        memcpy(&value, _data + _position, sizeof(T));
+        _position += sizeof(T);
+        return true;
+    }
+
+    const uint8_t* _data;
+    size_t _length;
+    size_t _position = 0;
+};
+
+class MenuModelWriter
+{
+public:
+    static void Write(const std::vector<MenuModelItem>& items, std::vector<uint8_t>& output)
+    {
+        WriteValue(output, static_cast<uint32_t>(items.size()));
+
+        for (auto& item : items)
+        {
+            WriteValue(output, item.Id);
+            WriteValue(output, static_cast<uint8_t>(item.Kind));
+            WriteValue(output, item.Flags);
+
+            if (item.Kind == MenuModelItemKind::Separator)
+                continue;
+
+            WriteString(output, item.Title);
+            WriteString(output, item.ToolTip);
+            WriteValue(output, item.Key);
+            WriteValue(output, item.Modifiers);
+            WriteValue(output, item.ToggleType);
+
+            if (item.HasFlag(MenuModelHasIcon) && !item.HasFlag(MenuModelIconUnchanged))
+            {
+                WriteValue(output, static_cast<uint32_t>(item.Icon.size()));
+                output.insert(output.end(), item.Icon.begin(), item.Icon.end());
+            }
+
+            if (item.HasFlag(MenuModelHasSubMenu))
+                Write(item.SubMenu, output);
+        }
+    }
+
+private:
+    static void WriteString(std::vector<uint8_t>& output, const std::string& value)
+    {
+        WriteValue(output, static_cast<uint32_t>(value.size()));
+        output.insert(output.end(), value.begin(), value.end());
+    }
+
+    template <typename T>
+    static void WriteValue(std::vector<uint8_t>& output, T value)
+    {
+        auto bytes = reinterpret_cast<const uint8_t*>(&value);
+        output.insert(output.end(), bytes, bytes + sizeof(T));
+    }
+};
+
+// The properties of now that have to be applied to an item that currently looks like old.
+// The submenu's own items are diffed separately.
+static inline uint32_t MenuModelChanges(const MenuModelItem& old, const MenuModelItem& now)
+{
+    uint32_t changes = 0;
+
+    if (old.Title != now.Title)
+        changes |= MenuModelPropertyTitle;
+    if (old.ToolTip != now.ToolTip)
+        changes |= MenuModelPropertyToolTip;
+    if (old.Key != now.Key || old.Modifiers != now.Modifiers)
+        changes |= MenuModelPropertyGesture;
+    // Whether an item shows as checked depends on its toggle type
+    if (old.ToggleType != now.ToggleType)
+        changes |= MenuModelPropertyToggleType | MenuModelPropertyChecked;
+    if (old.HasFlag(MenuModelChecked) != now.HasFlag(MenuModelChecked))
+        changes |= MenuModelPropertyChecked;
+    if (old.HasFlag(MenuModelVisible) != now.HasFlag(MenuModelVisible))
+        changes |= MenuModelPropertyVisible;
+    if (old.HasFlag(MenuModelHasIcon) != now.HasFlag(MenuModelHasIcon) ||
+        (now.HasFlag(MenuModelHasIcon) && !now.HasFlag(MenuModelIconUnchanged)))
+        changes |= MenuModelPropertyIcon;
+    if (old.HasFlag(MenuModelHasSubMenu) != now.HasFlag(MenuModelHasSubMenu))
+        changes |= MenuModelPropertySubMenu;
+    if (old.HasFlag(MenuModelServicesMenu) != now.HasFlag(MenuModelServicesMenu))
+        changes |= MenuModelPropertyServicesMenu;
+
+    return changes;
+}
+
+struct MenuModelOperation
+{
+    enum OperationKind
+    {
+        // Takes the item out of the menu, it is only destroyed if it isn't inserted again
+        Remove,
+        // Puts an item at Index, a new one unless Existing
+        Insert,
+    };
+
+    OperationKind Kind;
+    uint64_t Id;
+    size_t Index;
+    bool Existing;
+};
+
+// Operations that turn a menu with oldIds into one with newIds when applied in order. Ids have to be unique.
+// Removals come first, then insertions by ascending index. Items along the longest increasing subsequence of
+// their old positions stay where they are, so the number of moved items is minimal.
+static inline std::vector<MenuModelOperation> DiffMenuModel(const std::vector<uint64_t>& oldIds,
+                                                            const std::vector<uint64_t>& newIds)
+{
+    std::vector<MenuModelOperation> operations;
+
+    std::unordered_map<uint64_t, size_t> oldPositions;
+    oldPositions.reserve(oldIds.size());
+    for (size_t i = 0; i < oldIds.size(); i++)
+        oldPositions.emplace(oldIds[i], i);
+
+    // Old position of every new item, SIZE_MAX for new ones
+    std::vector<size_t> positions(newIds.size(), SIZE_MAX);
+    std::vector<bool> retained(oldIds.size(), false);
+    for (size_t i = 0; i < newIds.size(); i++)
+    {
+        auto it = oldPositions.find(newIds[i]);
+        if (it != oldPositions.end())
+        {
+            positions[i] = it->second;
+            retained[it->second] = true;
+        }
+    }
+
+    // Longest increasing subsequence of the old positions, O(n log n)
+    std::vector<size_t> tails, tailIndices, previous(newIds.size(), SIZE_MAX);
+    for (size_t i = 0; i < newIds.size(); i++)
+    {
+        if (positions[i] == SIZE_MAX)
+            continue;
+
+        auto it = std::lower_bound(tails.begin(), tails.end(), positions[i]);
+        auto length = static_cast<size_t>(it - tails.begin());
+        if (length > 0)
+            previous[i] = tailIndices[length - 1];
+
+        if (it == tails.end())
+        {
+            tails.push_back(positions[i]);
+            tailIndices.push_back(i);
+        }
+        else
+        {
+            *it = positions[i];
+            tailIndices[length] = i;
+        }
+    }
+
+    std::vector<bool> stable(newIds.size(), false);
+    for (auto i = tailIndices.empty() ? SIZE_MAX : tailIndices.back(); i != SIZE_MAX; i = previous[i])
+        stable[i] = true;
+
+    for (size_t i = 0; i < oldIds.size(); i++)
+    {
+        if (!retained[i])
+            operations.push_back({ MenuModelOperation::Remove, oldIds[i], i, false });
+    }
+
+    for (size_t i = 0; i < newIds.size(); i++)
+    {
+        if (positions[i] != SIZE_MAX && !stable[i])
+            operations.push_back({ MenuModelOperation::Remove, newIds[i], positions[i], true });
+    }
+
+    // What is left are the stable items in their new relative order, everything else slots in between
+    for (size_t i = 0; i < newIds.size(); i++)
+    {
+        if (!stable[i])
+            operations.push_back({ MenuModelOperation::Insert, newIds[i], i, positions[i] != SIZE_MAX });
+    }
+
+    return operations;
+}
+
+#endif /* MenuModel_h */
@@ -0,0 +1,113 @@
+#ifndef NativeControlLayoutBatch_h
+#define NativeControlLayoutBatch_h
+
+// Bounds and visibility of the native controls embedded into a top level, collected while it paints. Native
+// views can't be moved from within the paint, deferring every change on its own queues a block per control per
+// frame and lets the views trail behind the content. Only the last layout of each control is kept and all of
+// them are applied together once the paint is over, the first change after a flush tells the caller to schedule
+// the next one.
+// Plain C++, TKey identifies a control, THandle keeps it alive while its layout is pending. Applying is up to
+// the caller.
+
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct NativeControlLayout
+{
+    bool Visible = false;
+    // Frame of the control, the position only counts while it is visible
+    float X = 0;
+    float Y = 0;
+    float Width = 0;
+    float Height = 0;
+
+    bool operator==(const NativeControlLayout& other) const
+    {
+        return Visible == other.Visible && Width == other.Width && Height == other.Height
+            && (!Visible || (X == other.X && Y == other.Y));
+    }
+
+    bool operator!=(const NativeControlLayout& other) const
+    {
+        return !(*this == other);
+    }
+};
+
+template <typename TKey, typename THandle>
+class NativeControlLayoutBatch
+{
+public:
+    struct Entry
+    {
+        TKey Key;
+        THandle Handle;
+        NativeControlLayout Layout;
+    };
+
+    // Returns true if a flush has to be scheduled
+    bool Set(TKey key, THandle handle, const NativeControlLayout& layout)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        auto it = _index.find(key);
+        if (it != _index.end())
+            _pending[it->second].Layout = layout;
+        else
+        {
+            _index.emplace(key, _pending.size());
+            _pending.push_back(Entry { key, std::move(handle), layout });
+        }
+
+        if (_flushScheduled)
+            return false;
+
+        _flushScheduled = true;
+        return true;
+    }
+
+    // Drops the pending layout of a control, e.g. because it is laid out right away
+    void Remove(TKey key)
+    {
+        // Let go of the control only once the lock is released, it may be the last reference
+        THandle handle {};
+        std::lock_guard<std::mutex> guard(_lock);
+        auto it = _index.find(key);
+        if (it == _index.end())
+            return;
+
+        auto removed = it->second;
+        _index.erase(it);
+        std::swap(handle, _pending[removed].Handle);
+        _pending.erase(_pending.begin() + static_cast<std::ptrdiff_t>(removed));
+        for (auto& index : _index)
+            if (index.second > removed)
+                index.second--;
+    }
+
+    bool IsEmpty()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _pending.empty();
+    }
+
+    // The layouts to apply, in the order the controls first changed. The next change schedules a flush again.
+    std::vector<Entry> Take()
+    {
+        std::vector<Entry> entries;
+        std::lock_guard<std::mutex> guard(_lock);
+        entries.swap(_pending);
+        _index.clear();
+        _flushScheduled = false;
+        return entries;
+    }
+
+private:
+    std::mutex _lock;
+    std::vector<Entry> _pending;
+    std::unordered_map<TKey, size_t> _index;
+    bool _flushScheduled = false;
+};
+
+#endif /* NativeControlLayoutBatch_h */
@@ -0,0 +1,148 @@
+#ifndef PasteboardSnapshot_h
+#define PasteboardSnapshot_h
+
+// Pasteboard queries are IPC to the pasteboard server. PasteboardSnapshot holds the formats of the pasteboard and
+// of its items as reported to the managed side, captured once per change count and shared by all readers until
+// the pasteboard changes. PasteboardFormatCache remembers the results of UTI lookups for the whole process.
+// Plain C++ so the format logic can be exercised without a pasteboard.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class PasteboardSnapshot
+{
+public:
+    // NSPasteboardTypePNG, NSPasteboardTypeTIFF and the JPEG UTI
+    static constexpr const char* PngType = "public.png";
+    static constexpr const char* TiffType = "public.tiff";
+    static constexpr const char* JpegType = "public.jpeg";
+
+    // hasFormats is false when the pasteboard reported no types at all (nil rather than an empty array)
+    PasteboardSnapshot(int64_t changeCount, bool hasFormats, std::vector<std::string> formats,
+                       std::vector<std::vector<std::string>> itemFormats)
+        : _changeCount(changeCount), _hasFormats(hasFormats)
+    {
+        _formats = AddConvertibleFormats(std::move(formats));
+        _itemFormats.reserve(itemFormats.size());
+        for (auto& item : itemFormats)
+            _itemFormats.push_back(AddConvertibleFormats(std::move(item)));
+    }
+
+    int64_t GetChangeCount() const
+    {
+        return _changeCount;
+    }
+
+    // nullptr when the pasteboard reported no types
+    const std::vector<std::string>* GetFormats() const
+    {
+        return _hasFormats ? &_formats : nullptr;
+    }
+
+    size_t GetItemCount() const
+    {
+        return _itemFormats.size();
+    }
+
+    // nullptr when there is no such item
+    const std::vector<std::string>* GetItemFormats(size_t index) const
+    {
+        return index < _itemFormats.size() ? &_itemFormats[index] : nullptr;
+    }
+
+    // PNG is offered for anything we can convert into PNG (TIFF and JPEG), see Clipboard::GetItemValueAsBytes
+    static std::vector<std::string> AddConvertibleFormats(std::vector<std::string> formats)
+    {
+        bool hasPng = false, hasConvertible = false;
+
+        for (auto& format : formats)
+        {
+            if (format == PngType)
+                hasPng = true;
+            else if (format == TiffType || format == JpegType)
+                hasConvertible = true;
+        }
+
+        if (!hasPng && hasConvertible)
+            formats.emplace_back(PngType);
+
+        return formats;
+    }
+
+private:
+    int64_t _changeCount;
+    bool _hasFormats;
+    std::vector<std::string> _formats;
+    std::vector<std::vector<std::string>> _itemFormats;
+};
+
+class PasteboardFormatCache
+{
+public:
+    // An identifier of "" means that the format couldn't be converted
+    typedef std::string Uti;
+
+    static PasteboardFormatCache& Shared()
+    {
+        static PasteboardFormatCache cache;
+        return cache;
+    }
+
+    explicit PasteboardFormatCache(size_t maxEntries = 1024) : _maxEntries(maxEntries)
+    {
+    }
+
+    template <typename TCompute>
+    bool IsText(const std::string& format, TCompute&& compute)
+    {
+        return GetOrAdd(_isText, format, compute);
+    }
+
+    template <typename TCompute>
+    Uti GetUti(const std::string& format, TCompute&& compute)
+    {
+        return GetOrAdd(_utis, format, compute);
+    }
+
+    void Clear()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _isText.clear();
+        _utis.clear();
+    }
+
+private:
+    template <typename TValue, typename TCompute>
+    TValue GetOrAdd(std::unordered_map<std::string, TValue>& map, const std::string& format, TCompute& compute)
+    {
+        {
+            std::lock_guard<std::mutex> guard(_lock);
+            auto it = map.find(format);
+            if (it != map.end())
+                return it->second;
+        }
+
+        // Not under the lock, the lookup can take a while. Computing a value twice is harmless.
+        TValue value = compute();
+
+        std::lock_guard<std::mutex> guard(_lock);
+        // Formats are mostly a handful of well known types, arbitrary ones shouldn't make this grow forever
+        if (map.size() >= _maxEntries)
+            map.clear();
+        map.emplace(format, value);
+        return value;
+    }
+
+    const size_t _maxEntries;
+    std::mutex _lock;
+    std::unordered_map<std::string, bool> _isText;
+    std::unordered_map<std::string, Uti> _utis;
+};
+
+#endif /* PasteboardSnapshot_h */
@@ -9,10 +9,51 @@
 #include "automation.h"
 #include "menu.h"
 #include "common.h"
+#include "PopupPool.h"
 #import "WindowBaseImpl.h"
 #import "WindowProtocol.h"
 #import <AppKit/AppKit.h>
 
+class PopupImpl;
+
+static PopupPool<ComPtr<PopupImpl>>& GetPopupPool();
+
+// What a pooled popup reports to while nobody owns it
+class PooledPopupEvents : public ComSingleObject<IAvnWindowEvents, &IID_IAvnWindowEvents>
+{
+public:
+    FORWARD_IUNKNOWN()
+
+    virtual void Closed() override {}
+    virtual HRESULT Paint() override { return S_OK; }
+    virtual void Resized(const AvnSize& size, AvnPlatformResizeReason reason) override {}
+    virtual void RawMouseEvent(AvnRawMouseEventType type, AvnPointerDeviceType deviceType, u_int64_t timeStamp,
+                               AvnInputModifiers modifiers, AvnPoint point, AvnVector delta, float pressure,
+                               float xTilt, float yTilt) override {}
+    virtual bool RawKeyEvent(AvnRawKeyEventType type, u_int64_t timeStamp, AvnInputModifiers modifiers, AvnKey key,
+                             AvnPhysicalKey physicalKey, const char* keySymbol) override { return false; }
+    virtual bool RawTextInputEvent(u_int64_t timeStamp, const char* text) override { return false; }
+    virtual void ScalingChanged(double scaling) override {}
+    virtual void RunRenderPriorityJobs() override {}
+    virtual void LostFocus() override {}
+    virtual IAvnAutomationPeer* GetAutomationPeer() override { return nullptr; }
+    virtual AvnDragDropEffects DragEvent(AvnDragEventType type, AvnPoint position, AvnInputModifiers modifiers,
+                                         AvnDragDropEffects effects, IAvnClipboard* clipboard,
+                                         void* dataTransferHandle) override { return AvnDragDropEffects::None; }
+    virtual void Activated() override {}
+    virtual void Deactivated() override {}
+    virtual void PositionChanged(AvnPoint position) override {}
+    virtual bool Closing() override { return true; }
+    virtual void WindowStateChanged(AvnWindowState state) override {}
+    virtual void GotInputWhenDisabled() override {}
+};
+
+static IAvnWindowEvents* GetPooledPopupEvents()
+{
+    static ComPtr<IAvnWindowEvents> events(new PooledPopupEvents(), true);
+    return events.getRaw();
+}
+
 class PopupImpl : public virtual WindowBaseImpl, public IAvnPopup
 {
 private:
@@ -22,20 +63,102 @@ private:
     END_INTERFACE_MAP()
     virtual ~PopupImpl(){}
     ComPtr<IAvnWindowEvents> WindowEvents;
+    bool _recycling = false;
+    // In the pool, calls from the previous owner that still holds it must not bring it back on screen
+    bool _pooled = false;
     PopupImpl(IAvnWindowEvents* events) : TopLevelImpl(events), WindowBaseImpl(events)
     {
         WindowEvents = events;
         [Window setLevel:NSPopUpMenuWindowLevel];
     }
+
+    void Attach(IAvnWindowEvents* events)
+    {
+        TopLevelEvents = events;
+        BaseEvents = events;
+        WindowEvents = events;
+    }
+
+    // Nobody but the pool holds it, its previous owner let go and can't call in anymore
+    bool IsIdle()
+    {
+        ComObject::AddRef();
+        return ComObject::Release() == 1;
+    }
+
+    // Hands a pooled popup to whoever opens the next one. It is reset again, the previous owner could still
+    // change it after it was closed.
+    void Reuse(IAvnWindowEvents* events)
+    {
+        ResetForReuse();
+        Attach(events);
+        _pooled = false;
+    }
+
+    PopupRecycleState GetRecycleState()
+    {
+        PopupRecycleState state;
+        state.HasChildren = !_children.empty();
+        state.HasHostedViews = View != nullptr && [[View subviews] count] != 0;
+        state.IsTornDown = Window == nullptr;
+        return state;
+    }
+
 protected:
+    virtual void ResetForReuse() override
+    {
+        WindowBaseImpl::ResetForReuse();
+
+        [Window setLevel:NSPopUpMenuWindowLevel];
+        [Window setIgnoresMouseEvents:NO];
+        [GetWindowProtocol() setEnabled:true];
+    }
+
     virtual NSWindowStyleMask CalculateStyleMask() override
     {
         return NSWindowStyleMaskBorderless;
     }
 
 public:
+    // A closed popup goes back to the pool if there is room, it is hidden instead of being closed then
+    virtual HRESULT Close() override
+    {
+        START_COM_CALL;
+
+        @autoreleasepool
+        {
+            // Closed raised below makes the managed side close again, so does its Dispose once it is pooled
+            if (_recycling || _pooled)
+                return S_OK;
+
+            auto& pool = GetPopupPool();
+            if (!pool.CanAccept(GetRecycleState()))
+                return WindowBaseImpl::Close();
+
+            _recycling = true;
+
+            ComPtr<IAvnWindowEvents> events = WindowEvents;
+
+            [Window orderOut:Window];
+            ResetForReuse();
+            Attach(GetPooledPopupEvents());
+
+            // The same as a closed window from the managed side's view
+            events->Closed();
+
+            _recycling = false;
+            _pooled = true;
+
+            pool.Add(ComPtr<PopupImpl>(this));
+            return S_OK;
+        }
+    }
+
     virtual HRESULT Show(bool activate, bool isDialog) override
     {
+        if (_pooled)
+            return S_OK;
+
         auto windowProtocol = GetWindowProtocol();
         
         [windowProtocol setEnabled:true];
@@ -66,11 +189,45 @@ public:
 };
 
 
+static PopupPool<ComPtr<PopupImpl>>& GetPopupPool()
+{
+    // Off until the platform options are applied
+    static PopupPool<ComPtr<PopupImpl>> pool(0);
+    return pool;
+}
+
 extern IAvnPopup* CreateAvnPopup(IAvnWindowEvents*events)
 {
     @autoreleasepool
     {
+        ComPtr<PopupImpl> pooled;
+        if (GetPopupPool().TryAcquire(pooled, [](const ComPtr<PopupImpl>& popup) { return popup->IsIdle(); }))
+        {
+            pooled->Reuse(events);
+            return dynamic_cast<IAvnPopup*>(pooled.getRetainedReference());
+        }
+
         IAvnPopup* ptr = dynamic_cast<IAvnPopup*>(new PopupImpl(events));
         return ptr;
     }
 }
+
+// Closes the pooled popups and turns pooling off, they would outlive the platform otherwise
+extern void ShutdownPopupPool()
+{
+    ConfigurePopupPool(0, 0);
+}
+
+extern void ConfigurePopupPool(int capacity, int warmUp)
+{
+    @autoreleasepool
+    {
+        auto& pool = GetPopupPool();
+
+        for (auto& popup : pool.Configure(std::max(capacity, 0), std::max(warmUp, 0)))
+            popup->WindowBaseImpl::Close();
+
+        for (auto i = pool.GetWarmUpDeficit(); i > 0; i--)
+            pool.Add(ComPtr<PopupImpl>(new PopupImpl(GetPooledPopupEvents()), true));
+    }
+}
@@ -0,0 +1,140 @@
+#ifndef PopupPool_h
+#define PopupPool_h
+
+// Closed popups kept hidden to be handed out again. Tooltips, context menus and dropdowns open and close all the
+// time, creating the window, its views and the backing window server object each time costs more than showing
+// a window that is already there. A closed popup is reset and kept as long as there is room, the next popup
+// opened takes the one closed last. Up to warmUp popups can be created ahead of the first one being opened.
+// Plain C++, the popup type is a handle owning the popup (ComPtr on macOS), the caller creates, resets and
+// destroys them. Main thread only.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+// What a closed popup is left with, a popup is only reused if none of it applies
+struct PopupRecycleState
+{
+    // Popups still attached to it, whoever gets it next would end up owning them
+    bool HasChildren = false;
+    // Views hosted through NativeControlHost, they belong to the closed popup
+    bool HasHostedViews = false;
+    // The window is gone already
+    bool IsTornDown = false;
+};
+
+template <typename TPopup>
+class PopupPool
+{
+public:
+    explicit PopupPool(size_t capacity = 4, size_t warmUp = 0) : _capacity(capacity), _warmUp(warmUp)
+    {
+    }
+
+    static bool CanRecycle(const PopupRecycleState& state)
+    {
+        return !state.HasChildren && !state.HasHostedViews && !state.IsTornDown;
+    }
+
+    // A capacity of 0 turns pooling off. Returns the popups that don't fit anymore, the caller destroys them.
+    std::vector<TPopup> Configure(size_t capacity, size_t warmUp)
+    {
+        _capacity = capacity;
+        _warmUp = warmUp;
+
+        std::vector<TPopup> trimmed;
+        while (_popups.size() > _capacity)
+        {
+            // The ones closed longest ago go first
+            trimmed.push_back(std::move(_popups.front()));
+            _popups.erase(_popups.begin());
+        }
+
+        return trimmed;
+    }
+
+    size_t GetCapacity() const
+    {
+        return _capacity;
+    }
+
+    size_t GetCount() const
+    {
+        return _popups.size();
+    }
+
+    // How many popups have to be created to have warmUp of them ready
+    size_t GetWarmUpDeficit() const
+    {
+        auto target = std::min(_warmUp, _capacity);
+        return _popups.size() < target ? target - _popups.size() : 0;
+    }
+
+    // Takes the popup closed last. Returns false if there is none, the caller creates one then.
+    bool TryAcquire(TPopup& popup)
+    {
+        return TryAcquire(popup, [](const TPopup&) { return true; });
+    }
+
+    // Takes the popup closed last of those isIdle is true for. A closed popup can still be referenced by its
+    // previous owner for a while, handing it out before it let go of it would have both of them drive it.
+    template <typename TIsIdle>
+    bool TryAcquire(TPopup& popup, TIsIdle&& isIdle)
+    {
+        for (auto it = _popups.rbegin(); it != _popups.rend(); ++it)
+        {
+            if (!isIdle(*it))
+                continue;
+
+            popup = std::move(*it);
+            _popups.erase(std::next(it).base());
+            _hits++;
+            return true;
+        }
+
+        _misses++;
+        return false;
+    }
+
+    // Whether a popup closed with state is kept. If so the caller resets it and calls Add, otherwise destroys it.
+    bool CanAccept(const PopupRecycleState& state) const
+    {
+        return CanRecycle(state) && _popups.size() < _capacity;
+    }
+
+    // Keeps a reset or warmed up popup, the caller has to make sure there is room for it with CanAccept
+    // or GetWarmUpDeficit
+    void Add(TPopup popup)
+    {
+        _popups.push_back(std::move(popup));
+    }
+
+    std::vector<TPopup> TakeAll()
+    {
+        std::vector<TPopup> popups;
+        popups.swap(_popups);
+        return popups;
+    }
+
+    uint64_t GetHits() const
+    {
+        return _hits;
+    }
+
+    uint64_t GetMisses() const
+    {
+        return _misses;
+    }
+
+private:
+    size_t _capacity;
+    size_t _warmUp;
+    // Closed last at the back
+    std::vector<TPopup> _popups;
+    uint64_t _hits = 0;
+    uint64_t _misses = 0;
+};
+
+#endif /* PopupPool_h */
@@ -0,0 +1,266 @@
+#ifndef ScreenTopology_h
+#define ScreenTopology_h
+
+// The displays as they are after the last reconfiguration. Looking up a screen by id and converting between
+// Cocoa's bottom-up and Avalonia's top-down coordinates used to go to NSScreen every time, which walks all screens
+// and recomputes their orientation. A snapshot is built once per reconfiguration and is never changed after.
+// AppKit reports a reconfiguration as a begin and an end callback per display, ScreenReconfigurationDebouncer
+// turns those into a single change notification once the displays settled.
+// Plain C++, screens are read by the caller, timestamps are monotonic microseconds supplied by the caller.
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "avalonia-native.h"
+
+// Orientation of a display rotated by rotation degrees, relative to its natural one
+static inline AvnScreenOrientation GetScreenOrientation(double rotation, double naturalWidth, double naturalHeight)
+{
+    auto isNaturalLandscape = naturalWidth > naturalHeight;
+
+    auto degrees = static_cast<int>(rotation) % 360;
+    if (degrees < 0)
+        degrees += 360;
+
+    if (degrees < 90)
+        return isNaturalLandscape ? AvnScreenOrientation::Landscape : AvnScreenOrientation::Portrait;
+    if (degrees < 180)
+        return isNaturalLandscape ? AvnScreenOrientation::Portrait : AvnScreenOrientation::Landscape;
+    if (degrees < 270)
+        return isNaturalLandscape ? AvnScreenOrientation::LandscapeFlipped : AvnScreenOrientation::PortraitFlipped;
+    return isNaturalLandscape ? AvnScreenOrientation::PortraitFlipped : AvnScreenOrientation::LandscapeFlipped;
+}
+
+struct ScreenTopologyEntry
+{
+    uint32_t Id = 0;
+    // In Cocoa coordinates, origin at the bottom left of the primary screen
+    AvnRect Frame {};
+    AvnRect VisibleFrame {};
+    bool IsPrimary = false;
+    AvnScreenOrientation Orientation = AvnScreenOrientation::Landscape;
+    // Backing scale factor
+    double Scaling = 1;
+    // UTF-8, empty if not available
+    std::string LocalizedName;
+};
+
+class ScreenTopology
+{
+public:
+    // The first entry is the screen with the menu bar, the one Cocoa coordinates are relative to
+    explicit ScreenTopology(std::vector<ScreenTopologyEntry> entries) : _entries(std::move(entries))
+    {
+        _index.reserve(_entries.size());
+        for (size_t i = 0; i < _entries.size(); i++)
+            _index.emplace(_entries[i].Id, i);
+
+        if (!_entries.empty())
+            _primaryHeight = _entries[0].Frame.Y + _entries[0].Frame.Height;
+    }
+
+    const std::vector<ScreenTopologyEntry>& GetEntries() const
+    {
+        return _entries;
+    }
+
+    // nullptr if there is no such screen
+    const ScreenTopologyEntry* Find(uint32_t id) const
+    {
+        auto it = _index.find(id);
+        return it != _index.end() ? &_entries[it->second] : nullptr;
+    }
+
+    // The first screen whose frame contains the point, edges included: a window placed at the top left of a
+    // screen has its top left corner on the top edge. nullptr if the point is on no screen.
+    const ScreenTopologyEntry* FindContaining(double x, double y) const
+    {
+        for (auto& entry : _entries)
+        {
+            auto& frame = entry.Frame;
+            if (x >= frame.X && x <= frame.X + frame.Width && y >= frame.Y && y <= frame.Y + frame.Height)
+                return &entry;
+        }
+        return nullptr;
+    }
+
+    // The top of the primary screen, what a Cocoa y coordinate is flipped around
+    double GetPrimaryHeight() const
+    {
+        return _primaryHeight;
+    }
+
+    double FlipY(double y) const
+    {
+        return _primaryHeight - y;
+    }
+
+    AvnRect ToAvnRect(const AvnRect& frame) const
+    {
+        return AvnRect { frame.X, FlipY(frame.Y) - frame.Height, frame.Width, frame.Height };
+    }
+
+    AvnScreen ToAvnScreen(const ScreenTopologyEntry& entry) const
+    {
+        AvnScreen screen {};
+        screen.Bounds = ToAvnRect(entry.Frame);
+        screen.WorkingArea = ToAvnRect(entry.VisibleFrame);
+        screen.Scaling = 1;
+        screen.IsPrimary = entry.IsPrimary;
+        screen.Orientation = entry.Orientation;
+        return screen;
+    }
+
+private:
+    std::vector<ScreenTopologyEntry> _entries;
+    std::unordered_map<uint32_t, size_t> _index;
+    double _primaryHeight = 0;
+};
+
+// Hands out the current snapshot, building a new one the first time it is asked for after the screens changed.
+// While displays are being reconfigured screens can be reported at odd positions, a snapshot built then is used
+// for that one request only.
+class ScreenTopologyCache
+{
+public:
+    typedef std::shared_ptr<const ScreenTopology> Snapshot;
+
+    template <typename TBuild>
+    Snapshot Get(TBuild build)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+
+        if (_snapshot != nullptr)
+            return _snapshot;
+
+        auto snapshot = std::make_shared<const ScreenTopology>(build());
+        if (!_reconfiguring)
+            _snapshot = snapshot;
+
+        return snapshot;
+    }
+
+    void Invalidate(bool reconfiguring)
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _snapshot = nullptr;
+        _reconfiguring = reconfiguring;
+    }
+
+    // The reconfiguration is over, a snapshot built from now on is kept. One built after the last change is kept.
+    void Settled()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        _reconfiguring = false;
+    }
+
+private:
+    std::mutex _lock;
+    Snapshot _snapshot;
+    bool _reconfiguring = false;
+};
+
+// Turns the per display begin/end callbacks of display reconfigurations into one change notification.
+// Every callback is passed to OnReconfiguration, which says when the caller has to call Flush. Flush reports
+// the change once no display is being reconfigured and no callback came in for quietUs, otherwise it says how
+// long to wait before calling it again.
+class ScreenReconfigurationDebouncer
+{
+public:
+    explicit ScreenReconfigurationDebouncer(uint64_t quietUs = 50000, uint64_t maxReconfigurationUs = 2000000)
+        : _quietUs(quietUs), _maxReconfigurationUs(maxReconfigurationUs)
+    {
+    }
+
+    uint64_t GetQuietUs() const
+    {
+        return _quietUs;
+    }
+
+    bool IsReconfiguring() const
+    {
+        return !_reconfiguring.empty();
+    }
+
+    // Returns true if a Flush has to be scheduled in quietUs
+    bool OnReconfiguration(uint32_t display, bool isBegin, uint64_t nowUs)
+    {
+        if (isBegin)
+        {
+            if (_reconfiguring.empty())
+                _reconfigurationStartUs = nowUs;
+            _reconfiguring.insert(display);
+        }
+        else
+        {
+            // Displays that were added only report the end
+            _reconfiguring.erase(display);
+        }
+
+        _changed = true;
+        _lastCallbackUs = nowUs;
+
+        if (_flushScheduled)
+            return false;
+
+        _flushScheduled = true;
+        return true;
+    }
+
+    // Changes that don't come with a reconfiguration, like the dock or menu bar changing the visible frames
+    bool OnParametersChanged(uint64_t nowUs)
+    {
+        _changed = true;
+        _lastCallbackUs = nowUs;
+
+        if (_flushScheduled)
+            return false;
+
+        _flushScheduled = true;
+        return true;
+    }
+
+    // Returns true if the change has to be reported now. Otherwise retryInUs is set if Flush has to be called
+    // again, 0 if there is nothing left to report.
+    bool Flush(uint64_t nowUs, uint64_t& retryInUs)
+    {
+        retryInUs = 0;
+        _flushScheduled = false;
+
+        if (!_changed)
+            return false;
+
+        auto elapsed = nowUs > _lastCallbackUs ? nowUs - _lastCallbackUs : 0;
+        auto wait = elapsed < _quietUs ? _quietUs - elapsed : 0;
+
+        // Don't wait forever for an end that never comes
+        if (wait == 0 && !_reconfiguring.empty() && nowUs - _reconfigurationStartUs < _maxReconfigurationUs)
+            wait = _quietUs;
+
+        if (wait > 0)
+        {
+            retryInUs = wait;
+            _flushScheduled = true;
+            return false;
+        }
+
+        _reconfiguring.clear();
+        _changed = false;
+        return true;
+    }
+
+private:
+    const uint64_t _quietUs;
+    const uint64_t _maxReconfigurationUs;
+    std::unordered_set<uint32_t> _reconfiguring;
+    bool _changed = false;
+    bool _flushScheduled = false;
+    uint64_t _lastCallbackUs = 0;
+    uint64_t _reconfigurationStartUs = 0;
+};
+
+#endif /* ScreenTopology_h */
@@ -1,5 +1,78 @@
 #include "common.h"
 #include "AvnString.h"
+#include "ScreenTopology.h"
+#include <algorithm>
+#include <vector>
+
+class Screens;
+
+// Shared by every Screens instance and by the coordinate conversions, the debouncer is only used on the main thread
+static ScreenTopologyCache s_topologyCache;
+static ScreenReconfigurationDebouncer s_reconfigurationDebouncer;
+static std::vector<Screens*> s_screens;
+
+static void StartObservingScreens();
+
+static AvnRect ToAvnRect(NSRect rect)
+{
+    return AvnRect { rect.origin.x, rect.origin.y, rect.size.width, rect.size.height };
+}
+
+static std::vector<ScreenTopologyEntry> ReadScreens()
+{
+    std::vector<ScreenTopologyEntry> entries;
+    
+    for (NSScreen* screen in [NSScreen screens])
+    {
+        ScreenTopologyEntry entry;
+        entry.Id = [screen av_displayId];
+        entry.Frame = ToAvnRect([screen frame]);
+        entry.VisibleFrame = ToAvnRect([screen visibleFrame]);
+        entry.IsPrimary = CGDisplayIsMain(entry.Id);
+        entry.Scaling = [screen backingScaleFactor];
+        
+        auto naturalScreenSize = CGDisplayScreenSize(entry.Id);
+        entry.Orientation = GetScreenOrientation(CGDisplayRotation(entry.Id), naturalScreenSize.width, naturalScreenSize.height);
+        
+        if (@available(macOS 10.15, *)) {
+            auto name = [screen localizedName];
+            if (name != nil)
+                entry.LocalizedName = [name UTF8String];
+        }
+        
+        entries.push_back(std::move(entry));
+    }
+    
+    return entries;
+}
+
+static ScreenTopologyCache::Snapshot GetScreenTopology()
+{
+    StartObservingScreens();
+    
+    return s_topologyCache.Get([]
+    {
+        @autoreleasepool
+        {
+            return ReadScreens();
+        }
+    });
+}
+
+CGFloat GetPrimaryScreenHeight()
+{
+    return GetScreenTopology()->GetPrimaryHeight();
+}
+
+bool GetScreenScaling(NSPoint point, CGFloat* scaling)
+{
+    auto entry = GetScreenTopology()->FindContaining(point.x, point.y);
+    if (entry == nullptr)
+        return false;
+
+    *scaling = entry->Scaling;
+    return true;
+}
 
 class Screens : public ComSingleObject<IAvnScreens, &IID_IAvnScreens>
 {
@@ -10,7 +83,12 @@ public:
 
     Screens(IAvnScreenEvents* events) {
         _events = events;
-        CGDisplayRegisterReconfigurationCallback(CGDisplayReconfigurationCallBack, this);
+        StartObservingScreens();
+        s_screens.push_back(this);
+    }
+    
+    virtual ~Screens() {
+        s_screens.erase(std::remove(s_screens.begin(), s_screens.end(), this), s_screens.end());
     }
 
     virtual HRESULT GetScreenIds (
@@ -21,14 +99,15 @@ public:
         
         @autoreleasepool
         {
-            auto screens = [NSScreen screens];
-            *screenCound = (int)screens.count;
+            auto topology = GetScreenTopology();
+            auto& entries = topology->GetEntries();
+            *screenCound = (int)entries.size();
 
             if (ptrFirstResult == nil)
                 return S_OK;
 
-            for (int i = 0; i < screens.count; i++) {
-                ptrFirstResult[i] = [[screens objectAtIndex:i] av_displayId];
+            for (size_t i = 0; i < entries.size(); i++) {
+                ptrFirstResult[i] = entries[i].Id;
             }
 
             return S_OK;
@@ -44,69 +123,94 @@ public:
         
         @autoreleasepool
         {
-            NSScreen* screen;
-            for (NSScreen *s in NSScreen.screens) {
-                if (s.av_displayId == displayId)
-                {
-                    screen = s;
-                    break;
-                }
-            }
+            auto topology = GetScreenTopology();
+            auto entry = topology->Find(displayId);
             
-            if (screen == nil) {
+            if (entry == nullptr) {
                 return E_INVALIDARG;
             }
 
-            ret->Bounds.Height = [screen frame].size.height;
-            ret->Bounds.Width = [screen frame].size.width;
-            ret->Bounds.X = [screen frame].origin.x;
-            ret->Bounds.Y = ConvertPointY(ToAvnPoint([screen frame].origin)).Y - ret->Bounds.Height;
-            
-            ret->WorkingArea.Height = [screen visibleFrame].size.height;
-            ret->WorkingArea.Width = [screen visibleFrame].size.width;
-            ret->WorkingArea.X = [screen visibleFrame].origin.x;
-            ret->WorkingArea.Y = ConvertPointY(ToAvnPoint([screen visibleFrame].origin)).Y - ret->WorkingArea.Height;
-            
-            ret->Scaling = 1;
-            
-            ret->IsPrimary = CGDisplayIsMain(displayId);
-
-            // Compute natural orientation:
-            auto naturalScreenSize = CGDisplayScreenSize(displayId);
-            auto isNaturalLandscape = naturalScreenSize.width > naturalScreenSize.height;
-            // Normalize rotation:
-            auto rotation = (int)CGDisplayRotation(displayId) % 360;
-            if (rotation < 0) rotation = 360 - rotation;
-            // Get current orientation relative to the natural
-            if (rotation >= 0 && rotation < 90) {
-                ret->Orientation = isNaturalLandscape ? AvnScreenOrientation::Landscape : AvnScreenOrientation::Portrait;
-            } else if (rotation >= 90 && rotation < 180) {
-                ret->Orientation = isNaturalLandscape ? AvnScreenOrientation::Portrait : AvnScreenOrientation::Landscape;
-            } else if (rotation >= 180 && rotation < 270) {
-                ret->Orientation = isNaturalLandscape ? AvnScreenOrientation::LandscapeFlipped : AvnScreenOrientation::PortraitFlipped;
-            } else {
-                ret->Orientation = isNaturalLandscape ? AvnScreenOrientation::PortraitFlipped : AvnScreenOrientation::LandscapeFlipped;
-            }
+            *ret = topology->ToAvnScreen(*entry);
 
             if (@available(macOS 10.15, *)) {
-                *localizedName = CreateAvnString([screen localizedName]);
+                *localizedName = CreateAvnString([NSString stringWithUTF8String:entry->LocalizedName.c_str()]);
             }
 
             return S_OK;
         }
     }
 
-private:
-    static void CGDisplayReconfigurationCallBack(CGDirectDisplayID display, CGDisplayChangeSummaryFlags flags, void *screens)
+    void RaiseChanged()
     {
-        auto object = (Screens *)screens;
-        auto events = object->_events;
-        if (events != nil) {
-            events->OnChanged();
+        if (_events != nil) {
+            _events->OnChanged();
         }
     }
 };
 
+static void ScheduleScreensChanged(uint64_t delayUs)
+{
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(delayUs * NSEC_PER_USEC)), dispatch_get_main_queue(), ^{
+        uint64_t retryInUs;
+        if (s_reconfigurationDebouncer.Flush(AvnMonotonicMicroseconds(), retryInUs))
+        {
+            s_topologyCache.Settled();
+            
+            // A handler can create or release a Screens
+            auto screens = s_screens;
+            for (auto screen : screens) {
+                if (std::find(s_screens.begin(), s_screens.end(), screen) == s_screens.end())
+                    continue;
+                
+                ComPtr<Screens> keepAlive(screen);
+                screen->RaiseChanged();
+            }
+        }
+        else if (retryInUs > 0)
+        {
+            ScheduleScreensChanged(retryInUs);
+        }
+    });
+}
+
+// Called for every display at the beginning and at the end of a reconfiguration
+static void CGDisplayReconfigurationCallBack(CGDirectDisplayID display, CGDisplayChangeSummaryFlags flags, void *)
+{
+    auto isBegin = (flags & kCGDisplayBeginConfigurationFlag) != 0;
+    auto schedule = s_reconfigurationDebouncer.OnReconfiguration(display, isBegin, AvnMonotonicMicroseconds());
+    
+    s_topologyCache.Invalidate(s_reconfigurationDebouncer.IsReconfiguring());
+    
+    if (schedule)
+        ScheduleScreensChanged(s_reconfigurationDebouncer.GetQuietUs());
+}
+
+static void StartObservingScreens()
+{
+    static bool observing = []
+    {
+        CGDisplayRegisterReconfigurationCallback(CGDisplayReconfigurationCallBack, nullptr);
+        
+        // The visible frames change with the dock and the menu bar without any display being reconfigured
+        [[NSNotificationCenter defaultCenter] addObserverForName:NSApplicationDidChangeScreenParametersNotification
+                                                          object:nil
+                                                           queue:[NSOperationQueue mainQueue]
+                                                      usingBlock:^(NSNotification* notification)
+        {
+            auto schedule = s_reconfigurationDebouncer.OnParametersChanged(AvnMonotonicMicroseconds());
+            
+            s_topologyCache.Invalidate(s_reconfigurationDebouncer.IsReconfiguring());
+            
+            if (schedule)
+                ScheduleScreensChanged(s_reconfigurationDebouncer.GetQuietUs());
+        }];
+        
+        return true;
+    }();
+    
+    (void)observing;
+}
+
 extern IAvnScreens* CreateScreens(IAvnScreenEvents* events)
 {
     return new Screens(events);
@@ -0,0 +1,379 @@
+#ifndef StallWatchdog_h
+#define StallWatchdog_h
+
+// Detects main thread stalls and tells which blocking call they were spent in. A watchdog thread asks the main
+// thread for a beat and waits for it, a beat that takes longer than the threshold is a stall. Known blocking
+// calls (waiting for the GPU, taking a render target's lock, ...) are wrapped into a StallWaitScope naming the
+// wait site, a stall is attributed to the site the main thread is waiting in. Every site also keeps the time
+// spent in it, stall or not, from any thread.
+// Plain C++, the caller supplies the clock (monotonic microseconds) and a way to run Beat on the main thread.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "TraceEventWriter.h"
+
+struct StallRecord
+{
+    uint64_t StartUs = 0;
+    uint64_t DurationUs = 0;
+    // -1 if the main thread wasn't inside a known wait
+    int Site = -1;
+};
+
+class StallWatchdog
+{
+public:
+    typedef uint64_t (*Clock)();
+    // Has to run Beat on the main thread, eventually
+    typedef void (*BeatPoster)(StallWatchdog* watchdog);
+
+    static const int MaxSites = 32;
+
+    struct SiteStats
+    {
+        uint64_t Count = 0;
+        uint64_t TotalUs = 0;
+        uint64_t MaxUs = 0;
+        uint64_t StallCount = 0;
+    };
+
+    struct Stats
+    {
+        uint64_t StallCount = 0;
+        uint64_t AttributedCount = 0;
+        uint64_t TotalUs = 0;
+        uint64_t MaxUs = 0;
+    };
+
+    StallWatchdog(Clock clock, BeatPoster poster, size_t maxStalls = 256)
+        : _clock(clock), _poster(poster), _maxStalls(maxStalls)
+    {
+    }
+
+    ~StallWatchdog()
+    {
+        Stop();
+    }
+
+    StallWatchdog(const StallWatchdog&) = delete;
+    StallWatchdog& operator=(const StallWatchdog&) = delete;
+
+    // Sites are never removed, registering a name again returns the same site. Returns -1 when full.
+    int RegisterWaitSite(const char* name)
+    {
+        std::lock_guard<std::mutex> guard(_sitesLock);
+        int count = _siteCount.load(std::memory_order_relaxed);
+        for (int c = 0; c < count; c++)
+            if (strcmp(_sites[c].Name, name) == 0)
+                return c;
+
+        if (count == MaxSites)
+            return -1;
+
+        _sites[count].Name = name;
+        _siteCount.store(count + 1, std::memory_order_release);
+        return count;
+    }
+
+    int GetWaitSiteCount() const
+    {
+        return _siteCount.load(std::memory_order_acquire);
+    }
+
+    const char* GetWaitSiteName(int site) const
+    {
+        return IsSite(site) ? _sites[site].Name : nullptr;
+    }
+
+    bool IsRunning() const
+    {
+        return _running.load(std::memory_order_relaxed);
+    }
+
+    // Starts the watchdog thread, or changes the threshold of the running one
+    void Start(uint64_t thresholdUs)
+    {
+        std::lock_guard<std::mutex> guard(_threadLock);
+        _thresholdUs.store(std::max<uint64_t>(thresholdUs, 1000), std::memory_order_relaxed);
+        if (_thread.joinable())
+            return;
+
+        _stop = false;
+        _inStall = false;
+        _beatPending.store(false, std::memory_order_relaxed);
+        _running.store(true, std::memory_order_relaxed);
+        _thread = std::thread([this] { Run(); });
+    }
+
+    void Stop()
+    {
+        std::thread thread;
+        {
+            std::lock_guard<std::mutex> guard(_threadLock);
+            if (!_thread.joinable())
+                return;
+
+            _stop = true;
+            _wake.notify_all();
+            thread = std::move(_thread);
+        }
+
+        thread.join();
+        _running.store(false, std::memory_order_relaxed);
+    }
+
+    // Main thread, answers the watchdog
+    void Beat()
+    {
+        _mainThread.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        _beatUs.store(_clock(), std::memory_order_relaxed);
+        _beatPending.store(false, std::memory_order_release);
+    }
+
+    // One round of the watchdog, public so it can be driven without the thread
+    void Poll()
+    {
+        auto now = _clock();
+
+        if (!_beatPending.load(std::memory_order_acquire))
+        {
+            if (_inStall)
+            {
+                auto beat = _beatUs.load(std::memory_order_relaxed);
+                _stall.DurationUs = beat > _stall.StartUs ? beat - _stall.StartUs : 0;
+                RecordStall(_stall);
+                _inStall = false;
+            }
+
+            _postedUs = now;
+            _beatPending.store(true, std::memory_order_relaxed);
+            _poster(this);
+            return;
+        }
+
+        if (now - _postedUs < _thresholdUs.load(std::memory_order_relaxed))
+            return;
+
+        if (!_inStall)
+        {
+            _inStall = true;
+            _stall = StallRecord();
+            _stall.StartUs = _postedUs;
+        }
+
+        // The stall goes to the first wait it is seen in
+        if (_stall.Site == -1)
+            _stall.Site = _mainWaitSite.load(std::memory_order_relaxed);
+    }
+
+    // Entering and leaving a known blocking call, see StallWaitScope
+    bool IsMainThread() const
+    {
+        return _mainThread.load(std::memory_order_relaxed) == std::this_thread::get_id();
+    }
+
+    int EnterWait(int site)
+    {
+        if (!IsSite(site) || !IsMainThread())
+            return -1;
+
+        return _mainWaitSite.exchange(site, std::memory_order_relaxed);
+    }
+
+    void LeaveWait(int site, int previous, uint64_t durationUs)
+    {
+        if (!IsSite(site))
+            return;
+
+        auto& stats = _sites[site];
+        stats.Count.fetch_add(1, std::memory_order_relaxed);
+        stats.TotalUs.fetch_add(durationUs, std::memory_order_relaxed);
+        auto max = stats.MaxUs.load(std::memory_order_relaxed);
+        while (durationUs > max && !stats.MaxUs.compare_exchange_weak(max, durationUs, std::memory_order_relaxed))
+        {
+        }
+
+        if (IsMainThread())
+            _mainWaitSite.store(previous, std::memory_order_relaxed);
+    }
+
+    uint64_t Now() const
+    {
+        return _clock();
+    }
+
+    SiteStats GetSiteStats(int site) const
+    {
+        SiteStats stats;
+        if (!IsSite(site))
+            return stats;
+
+        stats.Count = _sites[site].Count.load(std::memory_order_relaxed);
+        stats.TotalUs = _sites[site].TotalUs.load(std::memory_order_relaxed);
+        stats.MaxUs = _sites[site].MaxUs.load(std::memory_order_relaxed);
+        stats.StallCount = _sites[site].StallCount.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    Stats GetStats()
+    {
+        std::lock_guard<std::mutex> guard(_stallsLock);
+        return _stats;
+    }
+
+    std::vector<StallRecord> GetStalls()
+    {
+        std::lock_guard<std::mutex> guard(_stallsLock);
+        return std::vector<StallRecord>(_stalls.begin(), _stalls.end());
+    }
+
+    void Reset()
+    {
+        std::lock_guard<std::mutex> guard(_stallsLock);
+        _stalls.clear();
+        _stats = Stats();
+        for (auto& site : _sites)
+        {
+            site.Count.store(0, std::memory_order_relaxed);
+            site.TotalUs.store(0, std::memory_order_relaxed);
+            site.MaxUs.store(0, std::memory_order_relaxed);
+            site.StallCount.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    // The stalls kept in the Trace Event Format, complete events named after their wait site
+    std::string ExportTrace()
+    {
+        TraceEventWriter trace;
+        for (auto& stall : GetStalls())
+        {
+            auto name = GetWaitSiteName(stall.Site);
+            trace.AddComplete(name != nullptr ? name : "Unknown", "stall", stall.StartUs, stall.DurationUs);
+        }
+        return trace.Finish();
+    }
+
+private:
+    struct Site
+    {
+        const char* Name = nullptr;
+        std::atomic<uint64_t> Count {0};
+        std::atomic<uint64_t> TotalUs {0};
+        std::atomic<uint64_t> MaxUs {0};
+        std::atomic<uint64_t> StallCount {0};
+    };
+
+    bool IsSite(int site) const
+    {
+        return site >= 0 && site < GetWaitSiteCount();
+    }
+
+    void RecordStall(const StallRecord& stall)
+    {
+        std::lock_guard<std::mutex> guard(_stallsLock);
+        _stalls.push_back(stall);
+        while (_stalls.size() > _maxStalls)
+            _stalls.pop_front();
+
+        _stats.StallCount++;
+        _stats.TotalUs += stall.DurationUs;
+        _stats.MaxUs = std::max(_stats.MaxUs, stall.DurationUs);
+        if (IsSite(stall.Site))
+        {
+            _stats.AttributedCount++;
+            _sites[stall.Site].StallCount.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void Run()
+    {
+        std::unique_lock<std::mutex> lock(_threadLock);
+        while (!_stop)
+        {
+            lock.unlock();
+            Poll();
+            lock.lock();
+
+            // A few polls per threshold, a stall is seen at most a quarter of it late
+            auto interval = std::chrono::microseconds(_thresholdUs.load(std::memory_order_relaxed) / 4);
+            _wake.wait_for(lock, interval, [this] { return _stop; });
+        }
+    }
+
+    Clock _clock;
+    BeatPoster _poster;
+    size_t _maxStalls;
+
+    Site _sites[MaxSites];
+    std::atomic<int> _siteCount {0};
+    std::mutex _sitesLock;
+
+    std::atomic<std::thread::id> _mainThread {std::thread::id()};
+    std::atomic<int> _mainWaitSite {-1};
+    std::atomic<uint64_t> _beatUs {0};
+    std::atomic<bool> _beatPending {false};
+
+    // Watchdog thread only
+    uint64_t _postedUs = 0;
+    bool _inStall = false;
+    StallRecord _stall;
+
+    std::atomic<uint64_t> _thresholdUs {250000};
+    std::atomic<bool> _running {false};
+    std::mutex _threadLock;
+    std::condition_variable _wake;
+    std::thread _thread;
+    bool _stop = false;
+
+    std::mutex _stallsLock;
+    std::deque<StallRecord> _stalls;
+    Stats _stats;
+};
+
+// Marks a blocking call, End finishes the wait early (e.g. once a lock is taken)
+class StallWaitScope
+{
+public:
+    StallWaitScope(StallWatchdog& watchdog, int site) : _watchdog(watchdog), _site(site)
+    {
+        _previous = _watchdog.EnterWait(site);
+        _startUs = _watchdog.Now();
+    }
+
+    ~StallWaitScope()
+    {
+        End();
+    }
+
+    StallWaitScope(const StallWaitScope&) = delete;
+    StallWaitScope& operator=(const StallWaitScope&) = delete;
+
+    void End()
+    {
+        if (_ended)
+            return;
+
+        _ended = true;
+        auto now = _watchdog.Now();
+        _watchdog.LeaveWait(_site, _previous, now > _startUs ? now - _startUs : 0);
+    }
+
+private:
+    StallWatchdog& _watchdog;
+    int _site;
+    int _previous;
+    uint64_t _startUs;
+    bool _ended = false;
+};
+
+#endif /* StallWatchdog_h */
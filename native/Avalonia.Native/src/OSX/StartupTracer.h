@@ -0,0 +1,150 @@
+#ifndef StartupTracer_h
+#define StartupTracer_h
+
+// How long each native initialization step takes, from the factory being created to the first frame painted.
+// Steps are timed relative to Begin, Complete closes the trace so nothing is recorded after startup and the
+// steps taken every time later on (creating a window, ...) only cost a load.
+// Plain C++, the caller supplies the clock (monotonic microseconds). Step names have to outlive the tracer.
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "TraceEventWriter.h"
+
+struct StartupStep
+{
+    const char* Name = nullptr;
+    // Relative to Begin
+    uint64_t StartUs = 0;
+    uint64_t DurationUs = 0;
+};
+
+class StartupTracer
+{
+public:
+    typedef uint64_t (*Clock)();
+
+    explicit StartupTracer(Clock clock, size_t maxSteps = 128) : _clock(clock), _maxSteps(maxSteps)
+    {
+    }
+
+    // Only the first call starts the trace
+    void Begin()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        if (_started)
+            return;
+
+        _originUs = _clock();
+        _started = true;
+        _recording.store(true, std::memory_order_release);
+    }
+
+    bool IsRecording() const
+    {
+        return _recording.load(std::memory_order_acquire);
+    }
+
+    uint64_t Now() const
+    {
+        return _clock();
+    }
+
+    void AddStep(const char* name, uint64_t startUs, uint64_t endUs)
+    {
+        if (!IsRecording())
+            return;
+
+        std::lock_guard<std::mutex> guard(_lock);
+        if (!_recording.load(std::memory_order_relaxed) || _steps.size() == _maxSteps)
+            return;
+
+        StartupStep step;
+        step.Name = name;
+        step.StartUs = startUs > _originUs ? startUs - _originUs : 0;
+        step.DurationUs = endUs > startUs ? endUs - startUs : 0;
+        _steps.push_back(step);
+    }
+
+    // Records the step that ends startup, usually the first frame
+    void Complete(const char* name, uint64_t startUs, uint64_t endUs)
+    {
+        if (!IsRecording())
+            return;
+
+        AddStep(name, startUs, endUs);
+
+        std::lock_guard<std::mutex> guard(_lock);
+        if (!_recording.load(std::memory_order_relaxed))
+            return;
+
+        _totalUs = endUs > _originUs ? endUs - _originUs : 0;
+        _recording.store(false, std::memory_order_release);
+    }
+
+    bool IsComplete()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _started && !_recording.load(std::memory_order_relaxed);
+    }
+
+    // From Begin to the end of the completing step, 0 until startup is complete
+    uint64_t GetTotalUs()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _totalUs;
+    }
+
+    std::vector<StartupStep> GetSteps()
+    {
+        std::lock_guard<std::mutex> guard(_lock);
+        return _steps;
+    }
+
+    // The steps in the Trace Event Format, one complete event each
+    std::string ExportTrace()
+    {
+        TraceEventWriter trace;
+        for (auto& step : GetSteps())
+            trace.AddComplete(step.Name, "startup", step.StartUs, step.DurationUs);
+        return trace.Finish();
+    }
+
+private:
+    Clock _clock;
+    size_t _maxSteps;
+    std::atomic<bool> _recording {false};
+    std::mutex _lock;
+    bool _started = false;
+    uint64_t _originUs = 0;
+    uint64_t _totalUs = 0;
+    std::vector<StartupStep> _steps;
+};
+
+// Times the enclosing scope as a startup step
+class StartupTraceScope
+{
+public:
+    StartupTraceScope(StartupTracer& tracer, const char* name)
+        : _tracer(tracer), _name(name), _startUs(tracer.IsRecording() ? tracer.Now() : 0)
+    {
+    }
+
+    ~StartupTraceScope()
+    {
+        if (_startUs != 0)
+            _tracer.AddStep(_name, _startUs, _tracer.Now());
+    }
+
+    StartupTraceScope(const StartupTraceScope&) = delete;
+    StartupTraceScope& operator=(const StartupTraceScope&) = delete;
+
+private:
+    StartupTracer& _tracer;
+    const char* _name;
+    uint64_t _startUs;
+};
+
+#endif /* StartupTracer_h */
@@ -1,6 +1,7 @@
 #include "common.h"
 #include "AvnString.h"
 #include "INSWindowHolder.h"
+#include "BookmarkBatch.h"
 #import <UniformTypeIdentifiers/UniformTypeIdentifiers.h>
 
 const int kFileTypePopupTag = 10975;
@@ -64,6 +65,142 @@ const int kFileTypePopupTag = 10975;
 
 @end
 
+// Resolving a bookmark mostly waits for the file system, a few at a time hide most of that
+static const size_t MaxBookmarkWorkers = 4;
+
+static BookmarkCache& GetBookmarkCache()
+{
+    static BookmarkCache cache;
+    return cache;
+}
+
+static void RunBookmarkWorker(std::function<void()> work)
+{
+    dispatch_async(dispatch_get_global_queue(QOS_CLASS_USER_INITIATED, 0), ^{
+        work();
+    });
+}
+
+// Access can only be started on the security-scoped URL a bookmark resolved to, a URL parsed from the same string
+// doesn't carry the scope. The cache keeps those URLs for as long as it keeps their bookmarks.
+static NSURL* GetScopedUrl(NSString* fileUriString)
+{
+    auto item = GetBookmarkCache().FindItem([fileUriString UTF8String]);
+    if (item != nullptr)
+        return (__bridge NSURL*)item.get();
+
+    // Items picked in a dialog or dropped on a window
+    return [NSURL URLWithString:fileUriString];
+}
+
+static void ResolveBookmark(const void* data, size_t length, BookmarkResult& result)
+{
+    @autoreleasepool
+    {
+        BOOL isStale = NO;
+        NSError* error = nil;
+        auto bookmarkData = [NSData dataWithBytesNoCopy:(void*)data length:length freeWhenDone:NO];
+        auto fileUri = [NSURL URLByResolvingBookmarkData: bookmarkData
+                                                 options:NSURLBookmarkResolutionWithSecurityScope|NSURLBookmarkResolutionWithoutUI
+                                           relativeToURL:nil
+                                     bookmarkDataIsStale:&isStale
+                                                   error:&error];
+        
+        if (fileUri)
+        {
+            result.Succeeded = true;
+            result.Value = [[fileUri absoluteString] UTF8String];
+            result.IsStale = isStale;
+            result.Item = std::shared_ptr<const void>((__bridge_retained const void*)fileUri, CFRelease);
+        }
+        else if (error != nil)
+        {
+            result.Error = [[error localizedDescription] UTF8String];
+        }
+    }
+}
+
+// A cached bookmark is used as long as its item is still there, it would resolve to somewhere else if it was moved
+static bool IsBookmarkCurrent(const BookmarkResult& result)
+{
+    @autoreleasepool
+    {
+        auto fileUri = (__bridge NSURL*)result.Item.get();
+        return fileUri != nil && [fileUri checkResourceIsReachableAndReturnError:nil];
+    }
+}
+
+static void CreateBookmark(NSString* fileUriString, BookmarkResult& result)
+{
+    @autoreleasepool
+    {
+        NSError* error = nil;
+        auto fileUri = [NSURL URLWithString: fileUriString];
+        auto bookmarkData = [fileUri bookmarkDataWithOptions:NSURLBookmarkCreationWithSecurityScope includingResourceValuesForKeys:nil relativeToURL:nil error:&error];
+        
+        if (bookmarkData)
+        {
+            result.Succeeded = true;
+            result.Value.assign((const char*)bookmarkData.bytes, bookmarkData.length);
+        }
+        else if (error != nil)
+        {
+            result.Error = [[error localizedDescription] UTF8String];
+        }
+    }
+}
+
+class AvnBookmarkResults : public ComSingleObject<IAvnBookmarkResults, &IID_IAvnBookmarkResults>
+{
+private:
+    std::vector<BookmarkResult> _results;
+    
+public:
+    FORWARD_IUNKNOWN()
+    
+    AvnBookmarkResults(std::vector<BookmarkResult> results) : _results(std::move(results))
+    {
+    }
+    
+    virtual int GetCount() override
+    {
+        return (int)_results.size();
+    }
+    
+    virtual HRESULT GetValue(int index, IAvnString** ret) override
+    {
+        START_COM_CALL;
+        
+        if (ret == nullptr)
+            return E_POINTER;
+        if (index < 0 || index >= (int)_results.size())
+            return E_INVALIDARG;
+        
+        auto& result = _results[index];
+        *ret = result.Succeeded ? CreateByteArray((void*)result.Value.data(), (int)result.Value.size()) : nullptr;
+        return S_OK;
+    }
+    
+    virtual HRESULT GetError(int index, IAvnString** ret) override
+    {
+        START_COM_CALL;
+        
+        if (ret == nullptr)
+            return E_POINTER;
+        if (index < 0 || index >= (int)_results.size())
+            return E_INVALIDARG;
+        
+        auto& result = _results[index];
+        *ret = !result.Error.empty() ? CreateByteArray((void*)result.Error.data(), (int)result.Error.size()) : nullptr;
+        return S_OK;
+    }
+    
+    virtual bool IsStale(int index) override
+    {
+        return index >= 0 && index < (int)_results.size() && _results[index].IsStale;
+    }
+};
+
 class StorageProvider : public ComSingleObject<IAvnStorageProvider, &IID_IAvnStorageProvider>
 {
     ExtensionDropdownHandler* __strong _extension_dropdown_handler;
@@ -71,71 +208,87 @@ class StorageProvider : public ComSingleObject<IAvnStorageProvider, &IID_IAvnSto
 public:
     FORWARD_IUNKNOWN()
 
-    virtual HRESULT SaveBookmarkToBytes (
-         IAvnString* fileUriStr,
-         void** err,
-         IAvnString** ppv
-    ) override
-    {
+    virtual void ReleaseBookmark (
+        IAvnString* fileUriStr
+    ) override {
         @autoreleasepool
         {
-            if(ppv == nullptr)
-                return E_POINTER;
-
-            *ppv = nullptr;
-
-            NSError* error = nil;
-            auto fileUri = [NSURL URLWithString: GetNSStringAndRelease(fileUriStr)];
-            auto bookmarkData = [fileUri bookmarkDataWithOptions:NSURLBookmarkCreationWithSecurityScope includingResourceValuesForKeys:nil relativeToURL:nil error:&error];
-            if (bookmarkData)
-            {
-                *ppv = CreateByteArray((void*)bookmarkData.bytes, (int)bookmarkData.length);
-            }
-            else if (error != nil && err != nullptr)
-            {
-                *err = CreateAvnString([error localizedDescription]);
-            }
-            return S_OK;
+            GetBookmarkCache().Remove([GetNSStringAndRelease(fileUriStr) UTF8String]);
         }
     }
 
-    virtual HRESULT ReadBookmarkFromBytes (
-       void* ptr,
-       int len,
-       IAvnString** ppv
+    virtual HRESULT ReadBookmarksFromBytes (
+        void* data,
+        int* lengths,
+        int count,
+        IAvnBookmarkResults** ppv
     ) override {
+        START_COM_CALL;
+        
+        if (ppv == nullptr)
+            return E_POINTER;
+        if (count < 0 || (count > 0 && (data == nullptr || lengths == nullptr)))
+            return E_INVALIDARG;
+        
+        // The bookmarks are stored back to back
+        std::vector<BookmarkBytes> bookmarks(count);
+        auto bytes = (const uint8_t*)data;
+        for (int i = 0; i < count; i++)
+        {
+            if (lengths[i] < 0)
+                return E_INVALIDARG;
+            
+            bookmarks[i] = { bytes, (size_t)lengths[i] };
+            bytes += lengths[i];
+        }
+        
+        auto results = ResolveBookmarks(bookmarks, GetBookmarkCache(), MaxBookmarkWorkers, RunBookmarkWorker,
+                                        ResolveBookmark, IsBookmarkCurrent);
+        
+        *ppv = new AvnBookmarkResults(std::move(results));
+        return S_OK;
+    }
+    
+    virtual HRESULT SaveBookmarksToBytes (
+        IAvnStringArray* fileUris,
+        IAvnBookmarkResults** ppv
+    ) override {
+        START_COM_CALL;
+        
         @autoreleasepool
         {
-            if(ppv == nullptr)
+            if (ppv == nullptr)
                 return E_POINTER;
-
-            auto bookmarkData = [[NSData alloc] initWithBytes:ptr length:len];
-            auto fileUri = [NSURL URLByResolvingBookmarkData: bookmarkData
-                                                     options:NSURLBookmarkResolutionWithSecurityScope|NSURLBookmarkResolutionWithoutUI
-                                               relativeToURL:nil
-                                         bookmarkDataIsStale:nil
-                                                       error:nil];
+            if (fileUris == nullptr)
+                return E_INVALIDARG;
             
-            if (fileUri)
+            // Managed strings are read here, the workers only get NSStrings
+            NSMutableArray<NSString*>* uris = [NSMutableArray new];
+            for (unsigned int i = 0; i < fileUris->GetCount(); i++)
             {
-                *ppv = CreateAvnString([fileUri absoluteString]);
+                IAvnString* uri = nullptr;
+                if (fileUris->Get(i, &uri) != S_OK || uri == nullptr)
+                    return E_INVALIDARG;
+                [uris addObject:GetNSStringAndRelease(uri)];
             }
+            
+            std::vector<BookmarkResult> results(uris.count);
+            BoundedParallelFor::Run(results.size(), MaxBookmarkWorkers, RunBookmarkWorker, [&](size_t index)
+            {
+                CreateBookmark(uris[index], results[index]);
+            });
+            
+            *ppv = new AvnBookmarkResults(std::move(results));
             return S_OK;
         }
     }
 
-    virtual void ReleaseBookmark (
-        IAvnString* fileUriStr
-    ) override {
-        // no-op
-    }
-
     virtual bool OpenSecurityScope (
         IAvnString* fileUriStr
     ) override {
         @autoreleasepool
         {
-            auto fileUri = [NSURL URLWithString: GetNSStringAndRelease(fileUriStr)];
+            auto fileUri = GetScopedUrl(GetNSStringAndRelease(fileUriStr));
             auto success = [fileUri startAccessingSecurityScopedResource];
             return success;
         }
@@ -146,7 +299,7 @@ public:
     ) override {
         @autoreleasepool
         {
-            auto fileUri = [NSURL URLWithString: GetNSStringAndRelease(fileUriStr)];
+            auto fileUri = GetScopedUrl(GetNSStringAndRelease(fileUriStr));
             [fileUri stopAccessingSecurityScopedResource];
         }
     }
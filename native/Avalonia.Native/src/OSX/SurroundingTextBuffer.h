@@ -0,0 +1,107 @@
+#ifndef SurroundingTextBuffer_h
+#define SurroundingTextBuffer_h
+
+// Holds a window of the managed text input client's surrounding text, together with the selection.
+// Ranges and offsets are in UTF-16 code units of the whole document, the same coordinates the managed
+// side and NSTextInputClient use; only [WindowStart, WindowStart + WindowLength) has its text available.
+// Plain C++ so the range rules can be exercised without AppKit.
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+struct SurroundingTextRange
+{
+    size_t location;
+    size_t length;
+};
+
+class SurroundingTextBuffer
+{
+public:
+    static constexpr size_t NotFound = SIZE_MAX;
+
+    size_t GetDocumentLength() const { return _documentLength; }
+    size_t GetWindowStart() const { return _windowStart; }
+    size_t GetWindowLength() const { return _window.size(); }
+    SurroundingTextRange GetSelection() const { return _selection; }
+
+    // Replaces the window. windowStart and documentLength describe where it sits in the document.
+    void SetWindow(const char16_t* text, size_t length, size_t windowStart, size_t documentLength)
+    {
+        if (text == nullptr)
+            length = 0;
+
+        _window.assign(text != nullptr ? text : u"", length);
+        _windowStart = windowStart;
+        _documentLength = std::max(documentLength, windowStart + length);
+
+        // The document changed, so the selection can now point outside of it.
+        _selection = ClampRange(_selection);
+    }
+
+    // Start and end can come in either order and out of bounds, like the ones the managed side sends.
+    void SetSelection(int start, int end)
+    {
+        _selection = ClampStartEnd(start, end);
+    }
+
+    // Clamps a range so that it can never be used to index outside of the document.
+    // Ranges reaching us from AppKit or from the managed side are not guaranteed to be valid.
+    SurroundingTextRange ClampRange(SurroundingTextRange range) const
+    {
+        if (range.location == NotFound)
+            return SurroundingTextRange { NotFound, 0 };
+
+        if (range.location > _documentLength)
+            return SurroundingTextRange { _documentLength, 0 };
+
+        // Avoids the overflow of location + length that a plain bounds check would have.
+        return SurroundingTextRange { range.location, std::min(range.length, _documentLength - range.location) };
+    }
+
+    // The part of range that has its text available, {NotFound, 0} if there is none
+    SurroundingTextRange IntersectWindow(SurroundingTextRange range) const
+    {
+        if (range.location == NotFound)
+            return SurroundingTextRange { NotFound, 0 };
+
+        auto windowEnd = _windowStart + _window.size();
+        auto start = std::max(range.location, _windowStart);
+        auto end = range.length > windowEnd - std::min(range.location, windowEnd)
+            ? windowEnd
+            : range.location + range.length;
+
+        if (start >= end)
+            return SurroundingTextRange { NotFound, 0 };
+
+        return SurroundingTextRange { start, end - start };
+    }
+
+    // Text of a range returned by IntersectWindow
+    const char16_t* GetText(SurroundingTextRange windowRange) const
+    {
+        return _window.data() + (windowRange.location - _windowStart);
+    }
+
+private:
+    SurroundingTextRange ClampStartEnd(int start, int end) const
+    {
+        if (end < start)
+            std::swap(start, end);
+
+        auto length = _documentLength;
+        auto clampedStart = start < 0 ? 0 : std::min(static_cast<size_t>(start), length);
+        auto clampedEnd = end < 0 ? 0 : std::min(static_cast<size_t>(end), length);
+
+        return SurroundingTextRange { clampedStart, std::max(clampedStart, clampedEnd) - clampedStart };
+    }
+
+    std::u16string _window;
+    size_t _windowStart = 0;
+    size_t _documentLength = 0;
+    SurroundingTextRange _selection { 0, 0 };
+};
+
+#endif /* SurroundingTextBuffer_h */
@@ -200,7 +200,7 @@ HRESULT TopLevelImpl::PointToClient(AvnPoint point, AvnPoint *ret) {
         
         auto viewScreenRect = [window convertRectToScreen:viewRect];
         
-        auto primaryDisplayHeight = NSMaxY([[[NSScreen screens] firstObject] frame]);
+        auto primaryDisplayHeight = GetPrimaryScreenHeight();
         
         //Window coord are bottom to top so we need to adjust by primaryScreenHeight
         auto viewScreenLocation = NSMakePoint(viewScreenRect.origin.x, primaryDisplayHeight - viewScreenRect.origin.y - frame.size.height);
@@ -240,7 +240,7 @@ HRESULT TopLevelImpl::PointToScreen(AvnPoint point, AvnPoint *ret) {
         //Get screen rect of the view
         auto viewScreenRect = [window convertRectToScreen:viewRect];
                
-        auto primaryDisplayHeight = NSMaxY([[[NSScreen screens] firstObject] frame]);
+        auto primaryDisplayHeight = GetPrimaryScreenHeight();
         
         //Window coord are bottom to top so we need to adjust by primaryScreenHeight
         auto viewScreenLocation = NSMakePoint(viewScreenRect.origin.x, primaryDisplayHeight - viewScreenRect.origin.y - frame.size.height);
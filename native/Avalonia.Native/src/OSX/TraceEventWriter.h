@@ -0,0 +1,61 @@
+#ifndef TraceEventWriter_h
+#define TraceEventWriter_h
+
+// Writes the JSON of the Trace Event Format (what chrome://tracing and Perfetto load), for the diagnostics that
+// export what they recorded as a trace.
+// Plain C++, times are in microseconds.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <utility>
+
+class TraceEventWriter
+{
+public:
+    TraceEventWriter() : _json("{\"traceEvents\":[")
+    {
+    }
+
+    // A complete event, name and category are escaped
+    void AddComplete(const char* name, const char* category, uint64_t startUs, uint64_t durationUs)
+    {
+        if (_count++ != 0)
+            _json += ',';
+
+        _json += "{\"name\":\"";
+        AppendEscaped(name);
+        _json += "\",\"cat\":\"";
+        AppendEscaped(category);
+        _json += "\",\"ph\":\"X\",\"pid\":0,\"tid\":0";
+
+        char buffer[64];
+        snprintf(buffer, sizeof(buffer), ",\"ts\":%llu,\"dur\":%llu}",
+                 static_cast<unsigned long long>(startUs), static_cast<unsigned long long>(durationUs));
+        _json += buffer;
+    }
+
+    // Closes the trace, nothing can be added afterwards
+    std::string Finish()
+    {
+        _json += "],\"displayTimeUnit\":\"ms\"}";
+        return std::move(_json);
+    }
+
+private:
+    void AppendEscaped(const char* value)
+    {
+        for (; *value != 0; value++)
+        {
+            if (*value == '"' || *value == '\\')
+                _json += '\\';
+            _json += *value;
+        }
+    }
+
+    std::string _json;
+    size_t _count = 0;
+};
+
+#endif /* TraceEventWriter_h */
@@ -0,0 +1,253 @@
+#ifndef Utf8Transcoder_h
+#define Utf8Transcoder_h
+
+// UTF-8 <-> UTF-16 conversion for strings crossing the native boundary. Both sides already know the length, the
+// conversion validates and transcodes in one pass instead of scanning for the terminator, validating and then
+// converting. Most strings (menu titles, automation names, ...) are ASCII, runs of ASCII are checked and
+// widened/narrowed 16 bytes at a time with SSE2 or NEON, 8 at a time otherwise, everything else is decoded one
+// code point at a time.
+// Plain C++, the caller allocates the output: length code units for UTF-8 -> UTF-16, 3 * length bytes the other
+// way round.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+// Number of ASCII bytes input starts with
+inline size_t Utf8AsciiPrefix(const uint8_t* input, size_t length)
+{
+    size_t c = 0;
+#if defined(__SSE2__)
+    for (; c + 16 <= length; c += 16)
+    {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + c));
+        if (_mm_movemask_epi8(block) != 0)
+            break;
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; c + 16 <= length; c += 16)
+    {
+        if (vmaxvq_u8(vld1q_u8(input + c)) >= 0x80)
+            break;
+    }
+#endif
+    for (; c + 8 <= length; c += 8)
+    {
+        uint64_t word;
+        memcpy(&word, input + c, 8);
+        if ((word & 0x8080808080808080ull) != 0)
+            break;
+    }
+    while (c < length && input[c] < 0x80)
+        c++;
+    return c;
+}
+
+// Widens the ASCII bytes input starts with, returns how many
+inline size_t Utf8WidenAscii(const uint8_t* input, size_t length, char16_t* output)
+{
+    size_t c = 0;
+#if defined(__SSE2__)
+    auto zero = _mm_setzero_si128();
+    for (; c + 16 <= length; c += 16)
+    {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + c));
+        if (_mm_movemask_epi8(block) != 0)
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + c), _mm_unpacklo_epi8(block, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + c + 8), _mm_unpackhi_epi8(block, zero));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; c + 16 <= length; c += 16)
+    {
+        auto block = vld1q_u8(input + c);
+        if (vmaxvq_u8(block) >= 0x80)
+            break;
+        vst1q_u16(reinterpret_cast<uint16_t*>(output + c), vmovl_u8(vget_low_u8(block)));
+        vst1q_u16(reinterpret_cast<uint16_t*>(output + c + 8), vmovl_high_u8(block));
+    }
+#endif
+    for (; c < length && input[c] < 0x80; c++)
+        output[c] = input[c];
+    return c;
+}
+
+// Narrows the ASCII code units input starts with, returns how many
+inline size_t Utf8NarrowAscii(const char16_t* input, size_t length, uint8_t* output)
+{
+    size_t c = 0;
+#if defined(__SSE2__)
+    for (; c + 16 <= length; c += 16)
+    {
+        auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + c));
+        auto high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + c + 8));
+        // No bit above the lowest 7 set in either half
+        auto above = _mm_and_si128(_mm_or_si128(low, high), _mm_set1_epi16(static_cast<short>(0xff80)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(above, _mm_setzero_si128())) != 0xffff)
+            break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + c), _mm_packus_epi16(low, high));
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for (; c + 16 <= length; c += 16)
+    {
+        auto low = vld1q_u16(reinterpret_cast<const uint16_t*>(input + c));
+        auto high = vld1q_u16(reinterpret_cast<const uint16_t*>(input + c + 8));
+        if (vmaxvq_u16(vorrq_u16(low, high)) >= 0x80)
+            break;
+        vst1q_u8(output + c, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+    }
+#endif
+    for (; c < length && input[c] < 0x80; c++)
+        output[c] = static_cast<uint8_t>(input[c]);
+    return c;
+}
+
+// Decodes the code point at input[c] that isn't ASCII, advancing c past it. Follows Table 3-7 of the
+// Unicode standard: overlong forms, surrogates and anything above U+10FFFF are rejected.
+inline bool Utf8DecodeMultiByte(const uint8_t* input, size_t length, size_t& c, uint32_t& codePoint)
+{
+    auto lead = input[c];
+    auto remaining = length - c;
+
+    if (lead < 0xE0)
+    {
+        if (lead < 0xC2 || remaining < 2 || (input[c + 1] & 0xC0) != 0x80)
+            return false;
+        codePoint = (uint32_t(lead & 0x1F) << 6) | (input[c + 1] & 0x3F);
+        c += 2;
+        return true;
+    }
+
+    if (lead < 0xF0)
+    {
+        if (remaining < 3 || (input[c + 1] & 0xC0) != 0x80 || (input[c + 2] & 0xC0) != 0x80)
+            return false;
+        codePoint = (uint32_t(lead & 0x0F) << 12) | (uint32_t(input[c + 1] & 0x3F) << 6) | (input[c + 2] & 0x3F);
+        // Overlong or a surrogate
+        if (codePoint < 0x800 || (codePoint >= 0xD800 && codePoint <= 0xDFFF))
+            return false;
+        c += 3;
+        return true;
+    }
+
+    if (lead > 0xF4 || remaining < 4 || (input[c + 1] & 0xC0) != 0x80 || (input[c + 2] & 0xC0) != 0x80
+        || (input[c + 3] & 0xC0) != 0x80)
+        return false;
+    codePoint = (uint32_t(lead & 0x07) << 18) | (uint32_t(input[c + 1] & 0x3F) << 12)
+        | (uint32_t(input[c + 2] & 0x3F) << 6) | (input[c + 3] & 0x3F);
+    // Overlong or above U+10FFFF
+    if (codePoint < 0x10000 || codePoint > 0x10FFFF)
+        return false;
+    c += 4;
+    return true;
+}
+
+inline bool IsAscii(const char* input, size_t length)
+{
+    return Utf8AsciiPrefix(reinterpret_cast<const uint8_t*>(input), length) == length;
+}
+
+inline bool IsValidUtf8(const char* input, size_t length)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(input);
+    size_t c = 0;
+    while (c < length)
+    {
+        if (bytes[c] < 0x80)
+        {
+            c += Utf8AsciiPrefix(bytes + c, length - c);
+            continue;
+        }
+
+        uint32_t codePoint;
+        if (!Utf8DecodeMultiByte(bytes, length, c, codePoint))
+            return false;
+    }
+    return true;
+}
+
+// Returns false for invalid UTF-8, otherwise written is the number of UTF-16 code units in output, at most length
+inline bool Utf8ToUtf16(const char* input, size_t length, char16_t* output, size_t& written)
+{
+    auto bytes = reinterpret_cast<const uint8_t*>(input);
+    size_t c = 0;
+    written = 0;
+    while (c < length)
+    {
+        if (bytes[c] < 0x80)
+        {
+            auto ascii = Utf8WidenAscii(bytes + c, length - c, output + written);
+            c += ascii;
+            written += ascii;
+            continue;
+        }
+
+        uint32_t codePoint;
+        if (!Utf8DecodeMultiByte(bytes, length, c, codePoint))
+            return false;
+
+        if (codePoint >= 0x10000)
+        {
+            codePoint -= 0x10000;
+            output[written++] = static_cast<char16_t>(0xD800 + (codePoint >> 10));
+            output[written++] = static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+        }
+        else
+            output[written++] = static_cast<char16_t>(codePoint);
+    }
+    return true;
+}
+
+// Returns the number of bytes written to output, at most 3 * length. Unpaired surrogates become U+FFFD like they
+// do in the managed encoder.
+inline size_t Utf16ToUtf8(const char16_t* input, size_t length, char* output)
+{
+    auto bytes = reinterpret_cast<uint8_t*>(output);
+    size_t c = 0;
+    size_t written = 0;
+    while (c < length)
+    {
+        if (input[c] < 0x80)
+        {
+            auto ascii = Utf8NarrowAscii(input + c, length - c, bytes + written);
+            c += ascii;
+            written += ascii;
+            continue;
+        }
+
+        uint32_t codePoint = input[c++];
+        if (codePoint < 0x800)
+        {
+            bytes[written++] = static_cast<uint8_t>(0xC0 | (codePoint >> 6));
+            bytes[written++] = static_cast<uint8_t>(0x80 | (codePoint & 0x3F));
+            continue;
+        }
+
+        if (codePoint >= 0xD800 && codePoint <= 0xDFFF)
+        {
+            if (codePoint <= 0xDBFF && c < length && input[c] >= 0xDC00 && input[c] <= 0xDFFF)
+            {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (input[c++] - 0xDC00);
+                bytes[written++] = static_cast<uint8_t>(0xF0 | (codePoint >> 18));
+                bytes[written++] = static_cast<uint8_t>(0x80 | ((codePoint >> 12) & 0x3F));
+                bytes[written++] = static_cast<uint8_t>(0x80 | ((codePoint >> 6) & 0x3F));
+                bytes[written++] = static_cast<uint8_t>(0x80 | (codePoint & 0x3F));
+                continue;
+            }
+            codePoint = 0xFFFD;
+        }
+
+        bytes[written++] = static_cast<uint8_t>(0xE0 | (codePoint >> 12));
+        bytes[written++] = static_cast<uint8_t>(0x80 | ((codePoint >> 6) & 0x3F));
+        bytes[written++] = static_cast<uint8_t>(0x80 | (codePoint & 0x3F));
+    }
+    return written;
+}
+
+#endif /* Utf8Transcoder_h */
@@ -10,6 +10,7 @@
 #include "INSWindowHolder.h"
 #include "AvnTextInputMethod.h"
 #include "TopLevelImpl.h"
+#include "WindowUpdateBatch.h"
 #include <list>
 
 @class AvnMenu;
@@ -70,6 +71,14 @@ public:
     virtual HRESULT SetFrameThemeVariant(AvnPlatformThemeVariant variant) override;
 
     virtual HRESULT SetTransparencyMode(AvnWindowTransparencyMode mode) override;
+
+    virtual HRESULT GetClientSize(AvnSize *ret) override;
+
+    virtual HRESULT GetScaling(double *ret) override;
+
+    virtual HRESULT BeginUpdate() override;
+
+    virtual HRESULT CommitUpdate() override;
                            
     virtual bool IsModal();
 
@@ -85,8 +94,19 @@ protected:
     virtual NSWindowStyleMask CalculateStyleMask() = 0;
     virtual void UpdateAppearance() override;
     virtual void SetClientSize(NSSize size) override;
+    // Applies the changes of an update, the window isn't updating while this runs
+    virtual void ApplyUpdate(const WindowUpdateSet& update);
+    // True if a setter has to leave the change to the current update
+    bool DeferToUpdate() { return _update.IsOpen() && !_applyingUpdate; }
+    // Applies what changed in the current update so far, for calls that need the window as it will be
+    void FlushUpdate();
+    // Puts the window back into the state it was created in, it is hidden and handed to someone else next
+    virtual void ResetForReuse();
 
 private:
+    void ApplyPendingUpdate(const WindowUpdateSet& update);
+    void SetFrame(AvnSize size, AvnPoint position, AvnPlatformResizeReason reason);
+    AvnSize ClampClientSize(AvnSize size);
     void CreateNSWindow (bool isDialog);
     void CleanNSWindow ();
 
@@ -96,12 +116,14 @@ private:
     NSSize lastMaxSize;
     AvnMenu* lastMenu;
     bool _inResize;
+    bool _applyingUpdate;
 
 protected:
     AutoFitContentView *StandardContainer;
     AvnPoint lastPositionSet;
     bool _shown;
     std::list<ComObjectWeakPtr<WindowBaseImpl>> _children;
+    WindowUpdateBatch _update;
 
 public:
     ComObjectWeakPtr<WindowBaseImpl> Parent = nullptr;
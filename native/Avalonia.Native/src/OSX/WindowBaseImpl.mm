@@ -48,6 +48,7 @@ WindowBaseImpl::WindowBaseImpl(IAvnWindowBaseEvents *events, bool usePanel) : To
     _children = std::list<ComObjectWeakPtr<WindowBaseImpl>>();
     _shown = false;
     _inResize = false;
+    _applyingUpdate = false;
     BaseEvents = events;
 
     lastPositionSet = { 0, 0 };
@@ -88,6 +89,8 @@ HRESULT WindowBaseImpl::Show(bool activate, bool isDialog) {
     START_COM_CALL;
 
     @autoreleasepool {
+        FlushUpdate();
+
         [Window setContentSize:lastSize];
         
         if(hasPosition)
@@ -160,6 +163,8 @@ HRESULT WindowBaseImpl::Hide() {
     START_COM_CALL;
 
     @autoreleasepool {
+        FlushUpdate();
+
         if (Window != nullptr) {
             
             // If window is hidden without ending attached sheet first, it will stuck in "order out" state,
@@ -206,6 +211,11 @@ HRESULT WindowBaseImpl::SetTopMost(bool value) {
     START_COM_CALL;
 
     @autoreleasepool {
+        if (DeferToUpdate()) {
+            _update.SetTopMost(value);
+            return S_OK;
+        }
+
         [Window setLevel:value ? NSFloatingWindowLevel : NSNormalWindowLevel];
 
         return S_OK;
@@ -238,8 +248,17 @@ HRESULT WindowBaseImpl::GetFrameSize(AvnSize *ret) {
         if (ret == nullptr)
             return E_POINTER;
 
-        if(Window != nullptr && _shown){
+        // Before the first show a frame is only reported for a size that is about to be applied
+        auto hasPendingSize = _update.GetPending().Has(WindowUpdateSize);
+        if(Window != nullptr && (_shown || hasPendingSize)){
             auto frame = [Window frame];
+
+            if (hasPendingSize) {
+                auto contentRect = [Window contentRectForFrameRect:frame];
+                contentRect.size = ToNSSize(ClampClientSize(_update.GetPending().Size));
+                frame = [Window frameRectForContentRect:contentRect];
+            }
+
             ret->Width = frame.size.width;
             ret->Height = frame.size.height;
         }
@@ -252,6 +271,11 @@ HRESULT WindowBaseImpl::SetMinMaxSize(AvnSize minSize, AvnSize maxSize) {
     START_COM_CALL;
 
     @autoreleasepool {
+        if (DeferToUpdate()) {
+            _update.SetMinMaxSize(minSize, maxSize);
+            return S_OK;
+        }
+
         lastMinSize = ToNSSize(minSize);
         lastMaxSize = ToNSSize(maxSize);
 
@@ -269,6 +293,11 @@ HRESULT WindowBaseImpl::Resize(double x, double y, AvnPlatformResizeReason reaso
         return S_OK;
     }
 
+    if (DeferToUpdate()) {
+        _update.SetSize(AvnSize { x, y }, reason);
+        return S_OK;
+    }
+
     _inResize = true;
 
     START_COM_CALL;
@@ -386,7 +415,9 @@ HRESULT WindowBaseImpl::GetPosition(AvnPoint *ret) {
             return E_POINTER;
         }
 
-        if(Window != nullptr) {
+        if (_update.GetPending().Has(WindowUpdatePosition)) {
+            *ret = _update.GetPending().Position;
+        } else if(Window != nullptr) {
             auto frame = [Window frame];
 
             ret->X = frame.origin.x;
@@ -406,6 +437,11 @@ HRESULT WindowBaseImpl::SetPosition(AvnPoint point) {
     START_COM_CALL;
 
     @autoreleasepool {
+        if (DeferToUpdate()) {
+            _update.SetPosition(point);
+            return S_OK;
+        }
+
         lastPositionSet = point;
         hasPosition = true;
 
@@ -429,6 +465,11 @@ HRESULT WindowBaseImpl::SetTransparencyMode(AvnWindowTransparencyMode mode) {
 HRESULT WindowBaseImpl::SetFrameThemeVariant(AvnPlatformThemeVariant variant) {
     START_COM_CALL;
 
+    if (DeferToUpdate()) {
+        _update.SetThemeVariant(variant);
+        return S_OK;
+    }
+
     NSAppearanceName appearanceName;
     if (@available(macOS 10.14, *))
     {
@@ -444,6 +485,182 @@ HRESULT WindowBaseImpl::SetFrameThemeVariant(AvnPlatformThemeVariant variant) {
     return S_OK;
 }
 
+HRESULT WindowBaseImpl::GetClientSize(AvnSize *ret) {
+    START_COM_CALL;
+
+    if (ret != nullptr && _update.GetPending().Has(WindowUpdateSize)) {
+        *ret = ClampClientSize(_update.GetPending().Size);
+        return S_OK;
+    }
+
+    return TopLevelImpl::GetClientSize(ret);
+}
+
+HRESULT WindowBaseImpl::GetScaling(double *ret) {
+    START_COM_CALL;
+
+    @autoreleasepool {
+        // The window only moves to the screen it is going to be on once the update is committed
+        if (ret != nullptr && _update.GetPending().Has(WindowUpdatePosition)) {
+            auto topLeft = ToNSPoint(ConvertPointY(_update.GetPending().Position));
+
+            CGFloat scaling;
+            if (GetScreenScaling(topLeft, &scaling)) {
+                *ret = scaling;
+                return S_OK;
+            }
+        }
+
+        return TopLevelImpl::GetScaling(ret);
+    }
+}
+
+HRESULT WindowBaseImpl::BeginUpdate() {
+    START_COM_CALL;
+
+    _update.Begin();
+
+    return S_OK;
+}
+
+HRESULT WindowBaseImpl::CommitUpdate() {
+    START_COM_ARP_CALL;
+
+    WindowUpdateSet update;
+    if (_update.Commit(update)) {
+        ApplyPendingUpdate(update);
+    }
+
+    return S_OK;
+}
+
+void WindowBaseImpl::FlushUpdate() {
+    WindowUpdateSet update;
+    if (_update.Take(update)) {
+        ApplyPendingUpdate(update);
+    }
+}
+
+void WindowBaseImpl::ApplyPendingUpdate(const WindowUpdateSet& update) {
+    if (Window == nullptr) {
+        return;
+    }
+
+    _applyingUpdate = true;
+
+    // Layers follow the new frame at once instead of animating through every change
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+
+    @try {
+        ApplyUpdate(update);
+    }
+    @finally {
+        [CATransaction commit];
+        _applyingUpdate = false;
+    }
+}
+
+void WindowBaseImpl::ApplyUpdate(const WindowUpdateSet& update) {
+    if (update.Has(WindowUpdateThemeVariant)) {
+        SetFrameThemeVariant(update.ThemeVariant);
+    }
+
+    if (update.Has(WindowUpdateTopMost)) {
+        SetTopMost(update.TopMost);
+    }
+
+    // Before the size, which is clamped to them
+    if (update.Has(WindowUpdateMinMaxSize)) {
+        SetMinMaxSize(update.MinSize, update.MaxSize);
+    }
+
+    auto hasSize = update.Has(WindowUpdateSize);
+    auto hasPosition = update.Has(WindowUpdatePosition);
+
+    if (hasSize && hasPosition) {
+        SetFrame(update.Size, update.Position, update.ResizeReason);
+    } else if (hasSize) {
+        Resize(update.Size.Width, update.Size.Height, update.ResizeReason);
+    } else if (hasPosition) {
+        SetPosition(update.Position);
+    }
+}
+
+AvnSize WindowBaseImpl::ClampClientSize(AvnSize size) {
+    auto& pending = _update.GetPending();
+
+    if (pending.Has(WindowUpdateMinMaxSize)) {
+        return WindowUpdateBatch::ClampSize(size, pending.MinSize, pending.MaxSize);
+    }
+
+    return WindowUpdateBatch::ClampSize(size, FromNSSize(lastMinSize), FromNSSize(lastMaxSize));
+}
+
+// Size and position in one frame change, a single resize and move for both
+void WindowBaseImpl::SetFrame(AvnSize size, AvnPoint position, AvnPlatformResizeReason reason) {
+    if (_inResize) {
+        return;
+    }
+
+    _inResize = true;
+
+    auto resizeBlock = ResizeScope(View, reason);
+
+    @try {
+        auto clientSize = ToNSSize(ClampClientSize(size));
+
+        if (!_shown) {
+            auto screenSize = [Window screen].visibleFrame.size;
+            clientSize.width = std::min(clientSize.width, screenSize.width);
+            clientSize.height = std::min(clientSize.height, screenSize.height);
+        }
+
+        lastSize = clientSize;
+        lastPositionSet = position;
+        hasPosition = true;
+
+        auto contentRect = [Window contentRectForFrameRect:[Window frame]];
+        contentRect.size = lastSize;
+
+        auto frame = [Window frameRectForContentRect:contentRect];
+        auto topLeft = ToNSPoint(ConvertPointY(position));
+        frame.origin = NSMakePoint(topLeft.x, topLeft.y - frame.size.height);
+
+        [Window setFrame:frame display:_shown];
+        [Window invalidateShadow];
+    }
+    @finally {
+        _inResize = false;
+    }
+}
+
+void WindowBaseImpl::ResetForReuse() {
+    SetParent(nullptr);
+
+    _update = WindowUpdateBatch();
+    _shown = false;
+    hasPosition = false;
+    lastPositionSet = { 0, 0 };
+    lastMenu = nullptr;
+    lastMaxSize = NSSize { CGFLOAT_MAX, CGFLOAT_MAX };
+    lastMinSize = NSSize { 0, 0 };
+
+    cursor = nil;
+    InputMethod->SetClient(nullptr);
+    [View resetForReuse];
+
+    if (Window != nullptr) {
+        [Window setContentMinSize:lastMinSize];
+        [Window setContentMaxSize:lastMaxSize];
+        [Window setAppearance:nil];
+        [Window setAlphaValue:1];
+        [GetWindowProtocol() resetAutomationPeer];
+    }
+
+    WindowBaseImpl::SetTransparencyMode(Opaque);
+}
+
 bool WindowBaseImpl::IsModal() {
     return false;
 }
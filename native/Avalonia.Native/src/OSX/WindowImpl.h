@@ -91,6 +91,7 @@ BEGIN_INTERFACE_MAP()
 protected:
     virtual NSWindowStyleMask CalculateStyleMask() override;
     virtual void UpdateAppearance() override;
+    virtual void ApplyUpdate(const WindowUpdateSet& update) override;
 
 private:
     void ZOrderChildWindows();
@@ -9,6 +9,7 @@
 #include "automation.h"
 #include "WindowProtocol.h"
 #include "WindowImpl.h"
+#include "AvnString.h"
 
 WindowImpl::WindowImpl(IAvnWindowEvents *events) : TopLevelImpl(events), WindowBaseImpl(events, false) {
     _isEnabled = true;
@@ -225,6 +226,11 @@ HRESULT WindowImpl::SetDecorations(SystemDecorations value) {
     START_COM_CALL;
 
     @autoreleasepool {
+        if (DeferToUpdate()) {
+            _update.SetDecorations(value);
+            return S_OK;
+        }
+
         auto currentWindowState = _lastWindowState;
         _decorations = value;
 
@@ -288,13 +294,31 @@ HRESULT WindowImpl::SetTitle(char *utf8title) {
     START_COM_CALL;
 
     @autoreleasepool {
-        _lastTitle = [NSString stringWithUTF8String:(const char *) utf8title];
+        if (DeferToUpdate()) {
+            _update.SetTitle(utf8title);
+            return S_OK;
+        }
+
+        _lastTitle = utf8title != nullptr ? CreateNSStringFromUtf8(utf8title, strlen(utf8title)) : nil;
         [Window setTitle:_lastTitle];
 
         return S_OK;
     }
 }
 
+void WindowImpl::ApplyUpdate(const WindowUpdateSet& update) {
+    if (update.Has(WindowUpdateTitle)) {
+        SetTitle(const_cast<char *>(update.Title.c_str()));
+    }
+
+    // Before the frame, the style mask decides how large the frame is for the content
+    if (update.Has(WindowUpdateDecorations)) {
+        SetDecorations(update.Decorations);
+    }
+
+    WindowBaseImpl::ApplyUpdate(update);
+}
+
 HRESULT WindowImpl::SetTitleBarColor(AvnColor color) {
     START_COM_CALL;
 
@@ -453,6 +477,9 @@ HRESULT WindowImpl::SetWindowState(AvnWindowState state, bool shouldResize) {
     START_COM_CALL;
 
     @autoreleasepool {
+        // Zooming starts from the frame the window has after the update
+        FlushUpdate();
+
         auto currentState = _actualWindowState;
         _lastWindowState = state;
 
@@ -18,6 +18,7 @@ struct IAvnAutomationPeer;
 -(void) showWindowMenuWithAppMenu;
 -(void) applyMenu:(AvnMenu* _Nullable)menu;
 -(IAvnAutomationPeer* _Nullable) automationPeer;
+-(void) resetAutomationPeer;
 
 -(double) getExtendedTitleBarHeight;
 -(void) setIsExtended:(bool)value;
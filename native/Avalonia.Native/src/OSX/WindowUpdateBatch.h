@@ -0,0 +1,146 @@
+#ifndef WindowUpdateBatch_h
+#define WindowUpdateBatch_h
+
+// Window properties set between BeginUpdate and CommitUpdate. Setting them one at a time applies each of them to
+// the NSWindow right away, while a window is created or restored that makes a layout and a frame change per
+// property. Inside an update only the last value of each property is kept, the outermost commit hands them over
+// to be applied together: limits before the size so the size is clamped to the new ones, size and position as a
+// single frame change.
+// Plain C++, applying the changes is up to the caller.
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include "avalonia-native.h"
+
+enum WindowUpdateFlags : uint32_t
+{
+    WindowUpdateNone = 0,
+    WindowUpdateSize = 1 << 0,
+    WindowUpdatePosition = 1 << 1,
+    WindowUpdateMinMaxSize = 1 << 2,
+    WindowUpdateTopMost = 1 << 3,
+    WindowUpdateThemeVariant = 1 << 4,
+    WindowUpdateTitle = 1 << 5,
+    WindowUpdateDecorations = 1 << 6,
+};
+
+struct WindowUpdateSet
+{
+    uint32_t Changed = WindowUpdateNone;
+
+    AvnSize Size {};
+    AvnPlatformResizeReason ResizeReason = ResizeUnspecified;
+    // Top left, in Avalonia's screen coordinates
+    AvnPoint Position {};
+    AvnSize MinSize {};
+    AvnSize MaxSize {};
+    bool TopMost = false;
+    AvnPlatformThemeVariant ThemeVariant = AvnPlatformThemeVariant::Light;
+    // UTF-8
+    std::string Title;
+    SystemDecorations Decorations = SystemDecorationsFull;
+
+    bool Has(WindowUpdateFlags flag) const
+    {
+        return (Changed & flag) != 0;
+    }
+};
+
+class WindowUpdateBatch
+{
+public:
+    // Size kept within the limits, the maximum wins if they contradict each other like NSWindow does
+    static AvnSize ClampSize(AvnSize size, AvnSize minSize, AvnSize maxSize)
+    {
+        size.Width = std::min(std::max(size.Width, minSize.Width), maxSize.Width);
+        size.Height = std::min(std::max(size.Height, minSize.Height), maxSize.Height);
+        return size;
+    }
+
+    bool IsOpen() const
+    {
+        return _depth > 0;
+    }
+
+    // Updates nest, only the outermost commit applies them
+    void Begin()
+    {
+        _depth++;
+    }
+
+    // Returns true if this was the outermost commit and something changed, set then holds the changes
+    bool Commit(WindowUpdateSet& set)
+    {
+        if (_depth == 0 || --_depth > 0)
+            return false;
+
+        return Take(set);
+    }
+
+    // Hands over what changed so far and keeps the update open, for calls that need the window to be current
+    bool Take(WindowUpdateSet& set)
+    {
+        if (_pending.Changed == WindowUpdateNone)
+            return false;
+
+        set = std::move(_pending);
+        _pending = WindowUpdateSet();
+        return true;
+    }
+
+    const WindowUpdateSet& GetPending() const
+    {
+        return _pending;
+    }
+
+    void SetSize(AvnSize size, AvnPlatformResizeReason reason)
+    {
+        _pending.Size = size;
+        _pending.ResizeReason = reason;
+        _pending.Changed |= WindowUpdateSize;
+    }
+
+    void SetPosition(AvnPoint position)
+    {
+        _pending.Position = position;
+        _pending.Changed |= WindowUpdatePosition;
+    }
+
+    void SetMinMaxSize(AvnSize minSize, AvnSize maxSize)
+    {
+        _pending.MinSize = minSize;
+        _pending.MaxSize = maxSize;
+        _pending.Changed |= WindowUpdateMinMaxSize;
+    }
+
+    void SetTopMost(bool value)
+    {
+        _pending.TopMost = value;
+        _pending.Changed |= WindowUpdateTopMost;
+    }
+
+    void SetThemeVariant(AvnPlatformThemeVariant variant)
+    {
+        _pending.ThemeVariant = variant;
+        _pending.Changed |= WindowUpdateThemeVariant;
+    }
+
+    void SetTitle(const char* utf8Title)
+    {
+        _pending.Title = utf8Title != nullptr ? utf8Title : "";
+        _pending.Changed |= WindowUpdateTitle;
+    }
+
+    void SetDecorations(SystemDecorations value)
+    {
+        _pending.Decorations = value;
+        _pending.Changed |= WindowUpdateDecorations;
+    }
+
+private:
+    int _depth = 0;
+    WindowUpdateSet _pending;
+};
+
+#endif /* WindowUpdateBatch_h */
@@ -8,6 +8,31 @@ class IAvnAutomationPeer;
 
 @interface AvnAccessibilityElement : NSAccessibilityElement <AvnAccessibility>
 + (id _Nullable) acquire:(IAvnAutomationPeer *) peer;
+// What is known about the element without asking for more, used to hit-test natively
+- (AvnRect) accessibilityBounds;
+- (NSArray * _Nullable) loadedAccessibilityChildren;
 @end
 
+// Caches the accessibility children of an automation peer. Elements are only created for the children
+// somebody asks for, and a change is reported as the children that were really added or removed.
+@interface AvnAccessibilityChildren : NSObject
+// owner is the view or element the children belong to
+- (instancetype) initWithOwner:(id) owner;
+- (NSArray *) children:(IAvnAutomationPeer *) peer;
+- (NSUInteger) count:(IAvnAutomationPeer *) peer;
+- (NSArray *) children:(IAvnAutomationPeer *) peer fromIndex:(NSUInteger) index maxCount:(NSUInteger) maxCount;
+// Returns the added and removed elements, nil if the children were never loaded.
+- (NSArray * _Nullable) update:(IAvnAutomationPeer *) peer;
+// All of the children if somebody asked for them already, nil otherwise
+- (NSArray * _Nullable) loadedChildren;
+@end
+
+// Keep the hit test indices of the views up to date, main thread only.
+// The children of owner (a view or an element) were loaded or changed, the indices containing it are rebuilt
+void InvalidateAccessibilityLayout(id owner);
+// The bounds of an element changed, the indices containing it update its entry in place
+void AccessibilityElementMoved(id element);
+// An element is going away, no index may refer to it anymore
+void AccessibilityElementReleased(const void* element);
+
 NS_ASSUME_NONNULL_END
@@ -1,6 +1,9 @@
 #include "common.h"
 #include "automation.h"
 #include "AvnAutomationNode.h"
+#include "AutomationPropertyCache.h"
+#include "AccessibilityChildList.h"
+#include <unordered_map>
 #include "AvnString.h"
 #include "INSWindowHolder.h"
 #include "AvnView.h"
@@ -10,8 +13,11 @@
 {
     ComPtr<IAvnAutomationPeer> _peer;
     AvnAutomationNode* _node;
-    NSMutableArray* _children;
+    AvnAccessibilityChildren* _children;
     NSArray<NSString*>* _attributeNames;
+    AutomationPropertyCache _propertyCache;
+    NSString* _name;
+    NSString* _value;
 }
 
 + (NSAccessibilityElement *)acquire:(IAvnAutomationPeer *)peer
@@ -53,6 +59,7 @@
 {
     self = [super init];
     _peer = peer;
+    _children = [[AvnAccessibilityChildren alloc] initWithOwner:self];
     _node = new AvnAutomationNode(self);
     _peer->SetNode(_node);
     return self;
@@ -60,6 +67,9 @@
 
 - (void)dealloc
 {
+    // Hit test indices refer to elements without retaining them
+    AccessibilityElementReleased((__bridge const void*)self);
+
     if (_node)
         delete _node;
     _node = nullptr;
@@ -78,14 +88,55 @@
     return _peer;
 }
 
+- (const AvnAutomationPropertySnapshot&)propertySnapshot:(uint32_t)parts
+{
+    return _propertyCache.GetSnapshot(parts, AvnMonotonicMicroseconds(), [&] { return _peer->GetPropertySnapshot(); });
+}
+
+- (BOOL)hasProvider:(AvnAutomationProviders)provider
+{
+    return ([self propertySnapshot:AutomationCachedIdentity].Providers & provider) != 0;
+}
+
+- (BOOL)hasState:(AvnAutomationStates)state
+{
+    return ([self propertySnapshot:AutomationCachedStates].States & state) != 0;
+}
+
+- (NSString *)cachedName
+{
+    auto now = AvnMonotonicMicroseconds();
+
+    if (!_propertyCache.IsValid(AutomationCachedName, now))
+    {
+        _name = GetNSStringAndRelease(_peer->GetName());
+        _propertyCache.MarkValid(AutomationCachedName, now);
+    }
+
+    return _name;
+}
+
+- (NSString *)cachedValue
+{
+    auto now = AvnMonotonicMicroseconds();
+
+    if (!_propertyCache.IsValid(AutomationCachedValue, now))
+    {
+        _value = GetNSStringAndRelease(_peer->ValueProvider_GetValue());
+        _propertyCache.MarkValid(AutomationCachedValue, now);
+    }
+
+    return _value;
+}
+
 - (BOOL)isAccessibilityElement
 {
-    return _peer->IsControlElement();
+    return [self hasState:AvnAutomationStateControlElement];
 }
 
 - (NSAccessibilityRole)accessibilityRole
 {
-    auto controlType = _peer->GetAutomationControlType();
+    auto controlType = [self propertySnapshot:AutomationCachedIdentity].ControlType;
 
     switch (controlType) {
         case AutomationButton: return NSAccessibilityButtonRole;
@@ -138,13 +189,13 @@
 
 - (NSAccessibilitySubrole)accessibilitySubrole
 {
-    auto controlType = _peer->GetAutomationControlType();
-    switch (controlType) {
+    auto& snapshot = [self propertySnapshot:AutomationCachedIdentity];
+    switch (snapshot.ControlType) {
         case AutomationList: return @"AXContentList";
         case AutomationListItem: return NSAccessibilityTableRowSubrole;
     }
 
-    auto landmarkType = _peer->GetLandmarkType();
+    auto landmarkType = snapshot.LandmarkType;
     switch (landmarkType) {
         case LandmarkBanner: return @"AXLandmarkBanner";
         case LandmarkComplementary: return @"AXLandmarkComplementary";
@@ -161,7 +212,7 @@
 
 - (NSString *)accessibilityRoleDescription
 {
-    auto landmarkType = _peer->GetLandmarkType();
+    auto landmarkType = [self propertySnapshot:AutomationCachedIdentity].LandmarkType;
     switch (landmarkType) {
         case LandmarkBanner: return @"banner";
         case LandmarkComplementary: return @"complementary";
@@ -191,7 +242,7 @@
 {
     if ([attribute isEqualToString:@"AXARIALive" /* kAXARIALiveAttribute */])
     {
-        switch (_peer->GetLiveSetting())
+        switch ([self propertySnapshot:AutomationCachedIdentity].LiveSetting)
         {
             case LiveSettingOff: return nil;
             case LiveSettingPolite: return @"polite";
@@ -210,9 +261,9 @@
 - (NSString *)accessibilityTitle
 {
     // StaticText exposes its text via the value property.
-    if (_peer->GetAutomationControlType() != AutomationText)
+    if ([self propertySnapshot:AutomationCachedIdentity].ControlType != AutomationText)
     {
-        return GetNSStringAndRelease(_peer->GetName());
+        return [self cachedName];
     }
     
     return [super accessibilityTitle];
@@ -230,29 +281,31 @@
 
 - (id)accessibilityValue
 {
-    if (_peer->IsRangeValueProvider())
+    auto& snapshot = [self propertySnapshot:AutomationCachedIdentity];
+
+    if (snapshot.Providers & AvnAutomationRangeValueProvider)
     {
-        return [NSNumber numberWithDouble:_peer->RangeValueProvider_GetValue()];
+        return [NSNumber numberWithDouble:[self propertySnapshot:AutomationCachedRangeValue].RangeValue];
     }
-    else if (_peer->IsToggleProvider())
+    else if (snapshot.Providers & AvnAutomationToggleProvider)
     {
-        switch (_peer->ToggleProvider_GetToggleState()) {
+        switch ([self propertySnapshot:AutomationCachedToggleState].ToggleState) {
             case 0: return [NSNumber numberWithBool:NO];
             case 1: return [NSNumber numberWithBool:YES];
             default: return [NSNumber numberWithInt:2];
         }
     }
-    else if (_peer->IsValueProvider())
+    else if (snapshot.Providers & AvnAutomationValueProvider)
     {
-        return GetNSStringAndRelease(_peer->ValueProvider_GetValue());
+        return [self cachedValue];
     }
-    else if (_peer->GetAutomationControlType() == AutomationText)
+    else if (snapshot.ControlType == AutomationText)
     {
-        return GetNSStringAndRelease(_peer->GetName());
+        return [self cachedName];
     }
-    else if (_peer->GetAutomationControlType() == AutomationHeader)
+    else if (snapshot.ControlType == AutomationHeader)
     {
-        return [NSNumber numberWithInt:_peer->GetHeadingLevel()];
+        return [NSNumber numberWithInt:snapshot.HeadingLevel];
     }
 
     return [super accessibilityValue];
@@ -280,10 +333,10 @@
 {
     if ([attribute isEqualToString:NSAccessibilityValueAttribute])
     {
-        if (_peer->IsValueProvider())
-            return !_peer->ValueProvider_IsReadOnly();
-        if (_peer->IsRangeValueProvider())
-            return !_peer->RangeValueProvider_IsReadOnly();
+        if ([self hasProvider:AvnAutomationValueProvider])
+            return ![self hasState:AvnAutomationStateValueReadOnly];
+        if ([self hasProvider:AvnAutomationRangeValueProvider])
+            return ![self hasState:AvnAutomationStateRangeValueReadOnly];
         return NO;
     }
 
@@ -292,9 +345,9 @@
 
 - (id)accessibilityMinValue
 {
-    if (_peer->IsRangeValueProvider())
+    if ([self hasProvider:AvnAutomationRangeValueProvider])
     {
-        return [NSNumber numberWithDouble:_peer->RangeValueProvider_GetMinimum()];
+        return [NSNumber numberWithDouble:[self propertySnapshot:AutomationCachedStates].RangeMinimum];
     }
     
     return [super accessibilityMinValue];
@@ -302,9 +355,9 @@
 
 - (id)accessibilityMaxValue
 {
-    if (_peer->IsRangeValueProvider())
+    if ([self hasProvider:AvnAutomationRangeValueProvider])
     {
-        return [NSNumber numberWithDouble:_peer->RangeValueProvider_GetMaximum()];
+        return [NSNumber numberWithDouble:[self propertySnapshot:AutomationCachedStates].RangeMaximum];
     }
     
     return [super accessibilityMaxValue];
@@ -312,7 +365,7 @@
 
 - (BOOL)isAccessibilityEnabled
 {
-    return _peer->IsEnabled();
+    return [self hasState:AvnAutomationStateEnabled];
 }
 
 - (BOOL)isAccessibilityFocused
@@ -322,15 +375,38 @@
 
 - (NSArray *)accessibilityChildren
 {
-    if (_children == nullptr && _peer != nullptr)
-        [self recalculateChildren];
-    return _children;
+    if (_peer == nullptr)
+        return nil;
+    return [_children children:_peer];
+}
+
+- (NSArray *)loadedAccessibilityChildren
+{
+    return [_children loadedChildren];
+}
+
+- (NSUInteger)accessibilityArrayAttributeCount:(NSAccessibilityAttributeName)attribute
+{
+    if (_peer != nullptr && [attribute isEqualToString:NSAccessibilityChildrenAttribute])
+        return [_children count:_peer];
+    return [super accessibilityArrayAttributeCount:attribute];
+}
+
+- (NSArray *)accessibilityArrayAttributeValues:(NSAccessibilityAttributeName)attribute index:(NSUInteger)index maxCount:(NSUInteger)maxCount
+{
+    if (_peer != nullptr && [attribute isEqualToString:NSAccessibilityChildrenAttribute])
+        return [_children children:_peer fromIndex:index maxCount:maxCount];
+    return [super accessibilityArrayAttributeValues:attribute index:index maxCount:maxCount];
+}
+
+- (AvnRect)accessibilityBounds
+{
+    return [self propertySnapshot:AutomationCachedBounds].BoundingRectangle;
 }
 
 - (NSRect)accessibilityFrame
 {
-    auto bounds = _peer->GetBoundingRectangle();
-    return [self rectToScreen:bounds];
+    return [self rectToScreen:[self accessibilityBounds]];
 }
 
 - (id)accessibilityParent
@@ -390,9 +466,9 @@
 
 - (BOOL)isAccessibilityExpanded
 {
-    if (!_peer->IsExpandCollapseProvider())
+    if (![self hasProvider:AvnAutomationExpandCollapseProvider])
         return NO;
-    return _peer->ExpandCollapseProvider_GetIsExpanded();
+    return [self hasState:AvnAutomationStateExpanded];
 }
 
 - (void)setAccessibilityExpanded:(BOOL)accessibilityExpanded
@@ -476,8 +552,8 @@
 
 - (BOOL)isAccessibilitySelected
 {
-    if (_peer->IsSelectionItemProvider())
-        return _peer->SelectionItemProvider_IsSelected();
+    if ([self hasProvider:AvnAutomationSelectionItemProvider])
+        return [self hasState:AvnAutomationStateSelected];
     return NO;
 }
 
@@ -493,36 +569,40 @@
 
 - (BOOL)isAccessibilitySelectorAllowed:(SEL)selector
 {
+    auto& snapshot = [self propertySnapshot:AutomationCachedIdentity | AutomationCachedStates];
+    auto providers = snapshot.Providers;
+    auto states = snapshot.States;
+
     if (selector == @selector(setAccessibilityValue:))
     {
-        return (_peer->IsValueProvider() && !_peer->ValueProvider_IsReadOnly()) ||
-               (_peer->IsRangeValueProvider() && !_peer->RangeValueProvider_IsReadOnly());
+        return ((providers & AvnAutomationValueProvider) && !(states & AvnAutomationStateValueReadOnly)) ||
+               ((providers & AvnAutomationRangeValueProvider) && !(states & AvnAutomationStateRangeValueReadOnly));
     }
     else if (selector == @selector(accessibilityPerformShowMenu))
     {
-        return _peer->IsExpandCollapseProvider() && _peer->ExpandCollapseProvider_GetShowsMenu();
+        return (providers & AvnAutomationExpandCollapseProvider) && (states & AvnAutomationStateShowsMenu);
     }
     else if (selector == @selector(isAccessibilityExpanded))
     {
-        return _peer->IsExpandCollapseProvider();
+        return (providers & AvnAutomationExpandCollapseProvider) != 0;
     }
     else if (selector == @selector(accessibilityPerformPress))
     {
-        return _peer->IsInvokeProvider() || _peer->IsExpandCollapseProvider() || _peer->IsToggleProvider();
+        return (providers & (AvnAutomationInvokeProvider | AvnAutomationExpandCollapseProvider | AvnAutomationToggleProvider)) != 0;
     }
     else if (selector == @selector(setAccessibilitySelected:))
     {
-        return _peer->IsSelectionItemProvider();
+        return (providers & AvnAutomationSelectionItemProvider) != 0;
     }
     else if (selector == @selector(accessibilityPerformIncrement) ||
              selector == @selector(accessibilityPerformDecrement))
     {
-        return _peer->IsRangeValueProvider() && !_peer->RangeValueProvider_IsReadOnly();
+        return (providers & AvnAutomationRangeValueProvider) && !(states & AvnAutomationStateRangeValueReadOnly);
     }
     else if (selector == @selector(accessibilityMinValue) ||
              selector == @selector(accessibilityMaxValue))
     {
-        return _peer->IsRangeValueProvider();
+        return (providers & AvnAutomationRangeValueProvider) != 0;
     }
 
     return [super isAccessibilitySelectorAllowed:selector];
@@ -548,12 +628,9 @@
 
 - (void)raiseChildrenChanged
 {
-    auto changed = _children ? [NSMutableSet setWithArray:_children] : [NSMutableSet set];
+    InvalidateAccessibilityLayout(self);
 
-    [self recalculateChildren];
-    
-    if (_children)
-        [changed addObjectsFromArray:_children];
+    auto changed = [_children update:_peer];
 
 	/*
 	For future reference, upon testing with a sample SwiftUI app:
@@ -578,46 +655,78 @@
     while ([target isKindOfClass:[AvnAccessibilityElement class]] && ![(AvnAccessibilityElement*)target isAccessibilityElement])
         target = [(AvnAccessibilityElement*)target accessibilityParent];
 
-    NSAccessibilityPostNotificationWithUserInfo(
-        target,
-        NSAccessibilityLayoutChangedNotification,
-        @{ NSAccessibilityUIElementsKey: [changed allObjects]});
+    // Nobody has looked at the children yet, so there is nothing to tell which of them changed.
+    if (changed == nil)
+        NSAccessibilityPostNotification(target, NSAccessibilityLayoutChangedNotification);
+    else if ([changed count] > 0)
+        NSAccessibilityPostNotificationWithUserInfo(
+            target,
+            NSAccessibilityLayoutChangedNotification,
+            @{ NSAccessibilityUIElementsKey: changed });
 }
 
 - (void)raisePropertyChanged:(AvnAutomationProperty)property
 {
+    _propertyCache.Invalidate(property);
+
     switch (property)
     {
         case AutomationPeer_AutomationId:
             // accessibilityIdentifier is read on-demand; no VoiceOver announcement required.
             break;
         case AutomationPeer_Name:
-            NSAccessibilityPostNotification(self, NSAccessibilityTitleChangedNotification);
+            QueueAccessibilityNotification(self, AccessibilityNotificationKind::Title);
             if (_peer->GetLiveSetting() != LiveSettingOff)
-                [self raiseLiveRegionChanged];
+                QueueAccessibilityNotification(self, AccessibilityNotificationKind::LiveRegion);
             break;
         case ValueProvider_Value:
         case RangeValueProvider_Value:
-            NSAccessibilityPostNotification(self, NSAccessibilityValueChangedNotification);
+        case ToggleProvider_ToggleState:
+            QueueAccessibilityNotification(self, AccessibilityNotificationKind::Value);
             break;
         case AutomationPeer_BoundingRectangle:
-            NSAccessibilityPostNotification(self, NSAccessibilityMovedNotification);
-            NSAccessibilityPostNotification(self, NSAccessibilityResizedNotification);
+            AccessibilityElementMoved(self);
+            QueueAccessibilityNotification(self, AccessibilityNotificationKind::Bounds);
             break;
         case SelectionItemProvider_IsSelected:
         case SelectionProvider_Selection:
-            NSAccessibilityPostNotification(self, NSAccessibilitySelectedChildrenChangedNotification);
+            QueueAccessibilityNotification(self, AccessibilityNotificationKind::SelectedChildren);
             break;
-        case ToggleProvider_ToggleState:
+        case ExpandCollapseProvider_ExpandCollapseState:
+            QueueAccessibilityNotification(self, AccessibilityNotificationKind::ExpandCollapse);
+            break;
+        default:
+            break;
+    }
+}
+
+- (void)postAccessibilityNotification:(AccessibilityNotificationKind)kind
+{
+    switch (kind)
+    {
+        case AccessibilityNotificationKind::Title:
+            NSAccessibilityPostNotification(self, NSAccessibilityTitleChangedNotification);
+            break;
+        case AccessibilityNotificationKind::Value:
             NSAccessibilityPostNotification(self, NSAccessibilityValueChangedNotification);
             break;
-        case ExpandCollapseProvider_ExpandCollapseState:
+        case AccessibilityNotificationKind::Bounds:
+            NSAccessibilityPostNotification(self, NSAccessibilityMovedNotification);
+            NSAccessibilityPostNotification(self, NSAccessibilityResizedNotification);
+            break;
+        case AccessibilityNotificationKind::SelectedChildren:
+            NSAccessibilityPostNotification(self, NSAccessibilitySelectedChildrenChangedNotification);
+            break;
+        case AccessibilityNotificationKind::ExpandCollapse:
             NSAccessibilityPostNotification(self, NSAccessibilityValueChangedNotification);
             if (_peer->ExpandCollapseProvider_GetIsExpanded())
                 NSAccessibilityPostNotification(self, (__bridge NSString *)kAXRowExpandedNotification);
             else
                 NSAccessibilityPostNotification(self, (__bridge NSString *)kAXRowCollapsedNotification);
             break;
+        case AccessibilityNotificationKind::LiveRegion:
+            [self raiseLiveRegionChanged];
+            break;
         default:
             break;
     }
@@ -663,30 +772,277 @@
         _peer->SetFocus();
 }
 
-- (void)recalculateChildren
+@end
+
+static AccessibilityNotificationQueue<id<AvnAccessibility>>& GetAccessibilityNotificationQueue()
 {
-    auto childPeers = _peer->GetChildren();
-    auto childCount = childPeers != nullptr ? childPeers->GetCount() : 0;
+    static AccessibilityNotificationQueue<id<AvnAccessibility>> queue;
+    return queue;
+}
+
+static void FlushAccessibilityNotifications();
 
-    if (childCount > 0)
+// Flushes again once the next announcement held back by the rate limit is due. There is only ever one, flushing
+// every frame while an announcement waits moves it instead of adding another.
+static void SetAccessibilityNotificationDueTime(uint64_t dueUs, uint64_t nowUs)
+{
+    static dispatch_source_t timer;
+    if (timer == nil)
     {
-        _children = [[NSMutableArray alloc] initWithCapacity:childCount];
-        
-        for (int i = 0; i < childCount; ++i)
+        if (dueUs == 0)
+            return;
+
+        timer = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+        dispatch_source_set_event_handler(timer, ^{
+            FlushAccessibilityNotifications();
+        });
+        dispatch_source_set_timer(timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+        dispatch_resume(timer);
+    }
+
+    if (dueUs == 0)
+        dispatch_source_set_timer(timer, DISPATCH_TIME_FOREVER, DISPATCH_TIME_FOREVER, 0);
+    else
+        dispatch_source_set_timer(timer, dispatch_time(DISPATCH_TIME_NOW, (int64_t)((dueUs - nowUs) * NSEC_PER_USEC)),
+                                  DISPATCH_TIME_FOREVER, NSEC_PER_MSEC);
+}
+
+static void FlushAccessibilityNotifications()
+{
+    auto now = AvnMonotonicMicroseconds();
+    uint64_t nextDueUs;
+    auto notifications = GetAccessibilityNotificationQueue().Flush(now, nextDueUs);
+    for (auto& notification : notifications)
+        [notification.Element postAccessibilityNotification:notification.Kind];
+
+    SetAccessibilityNotificationDueTime(nextDueUs, now);
+}
+
+void QueueAccessibilityNotification(id<AvnAccessibility> element, AccessibilityNotificationKind kind)
+{
+    auto key = (__bridge const void*)element;
+    if (GetAccessibilityNotificationQueue().Queue(key, element, kind, AvnMonotonicMicroseconds()))
+    {
+        dispatch_async(dispatch_get_main_queue(), ^{
+            FlushAccessibilityNotifications();
+        });
+    }
+}
+
+void CancelAccessibilityNotifications(id<AvnAccessibility> element)
+{
+    GetAccessibilityNotificationQueue().Remove((__bridge const void*)element);
+}
+
+// Children are fetched from the managed side in windows of this size.
+static const size_t ChildFetchWindow = 256;
+
+typedef std::vector<ComPtr<IAvnAutomationPeer>> AutomationPeerList;
+
+static void FetchChildren(IAvnAutomationPeer* peer, size_t start, size_t count, AutomationPeerList& result)
+{
+    for (size_t offset = 0; offset < count; offset += ChildFetchWindow)
+    {
+        auto length = std::min(ChildFetchWindow, count - offset);
+        ComPtr<IAvnAutomationPeerArray> window(peer->GetChildrenRange((int)(start + offset), (int)length), true);
+
+        if (window == nullptr)
+            return;
+
+        auto windowCount = window->GetCount();
+
+        for (unsigned int i = 0; i < windowCount; ++i)
         {
             IAvnAutomationPeer* child;
-            
-            if (childPeers->Get(i, &child) == S_OK)
+
+            if (window->Get(i, &child) == S_OK)
+                result.push_back(ComPtr<IAvnAutomationPeer>(child, true));
+        }
+
+        // The children changed while we were fetching them
+        if (windowCount < length)
+            return;
+    }
+}
+
+static std::vector<AccessibilityChildList::Key> GetKeys(const AutomationPeerList& peers)
+{
+    std::vector<AccessibilityChildList::Key> keys;
+    keys.reserve(peers.size());
+
+    for (auto& peer : peers)
+        keys.push_back((IAvnAutomationPeer*)peer);
+
+    return keys;
+}
+
+static NSMutableArray* AcquireElements(const AutomationPeerList& peers, size_t start, size_t length)
+{
+    auto elements = [[NSMutableArray alloc] initWithCapacity:length];
+
+    for (size_t i = start; i < start + length; ++i)
+    {
+        id element = [AvnAccessibilityElement acquire:peers[i]];
+
+        if (element != nil)
+            [elements addObject:element];
+    }
+
+    return elements;
+}
+
+@implementation AvnAccessibilityChildren
+{
+    AccessibilityChildList _list;
+    AutomationPeerList _peers;
+    // Only set once somebody asked for all of the children, in the order of _peers
+    NSArray* _elements;
+    __weak id _owner;
+}
+
+- (instancetype)initWithOwner:(id)owner
+{
+    self = [super init];
+    _owner = owner;
+    return self;
+}
+
+- (void)load:(IAvnAutomationPeer *)peer
+{
+    if (_list.IsLoaded())
+        return;
+
+    _peers.clear();
+    FetchChildren(peer, 0, (size_t)MAX(0, peer->GetChildCount()), _peers);
+    _list.Update(GetKeys(_peers));
+}
+
+- (NSArray *)children:(IAvnAutomationPeer *)peer
+{
+    if (_elements == nil)
+    {
+        [self load:peer];
+        _elements = AcquireElements(_peers, 0, _peers.size());
+        InvalidateAccessibilityLayout(_owner);
+    }
+
+    return _elements;
+}
+
+- (NSArray *)loadedChildren
+{
+    if (_elements != nil && [_elements count] == _peers.size())
+        return _elements;
+    return nil;
+}
+
+- (NSUInteger)count:(IAvnAutomationPeer *)peer
+{
+    if (_list.IsLoaded())
+        return _peers.size();
+
+    return (NSUInteger)MAX(0, peer->GetChildCount());
+}
+
+- (NSArray *)children:(IAvnAutomationPeer *)peer fromIndex:(NSUInteger)index maxCount:(NSUInteger)maxCount
+{
+    size_t start, length;
+
+    if (_list.IsLoaded())
+    {
+        if (!AccessibilityChildList::ClampWindow(_peers.size(), index, maxCount, start, length))
+            return @[];
+
+        if (_elements != nil && [_elements count] == _peers.size())
+            return [_elements subarrayWithRange:NSMakeRange(start, length)];
+
+        return AcquireElements(_peers, start, length);
+    }
+
+    // Only the requested window is fetched, without loading all of the children.
+    if (!AccessibilityChildList::ClampWindow((size_t)MAX(0, peer->GetChildCount()), index, maxCount, start, length))
+        return @[];
+
+    AutomationPeerList window;
+    FetchChildren(peer, start, length, window);
+    return AcquireElements(window, 0, window.size());
+}
+
+- (NSArray *)update:(IAvnAutomationPeer *)peer
+{
+    if (!_list.IsLoaded())
+    {
+        _elements = nil;
+        return nil;
+    }
+
+    AutomationPeerList peers;
+    FetchChildren(peer, 0, (size_t)MAX(0, peer->GetChildCount()), peers);
+    auto changes = _list.Update(GetKeys(peers));
+
+    // Elements that already exist are reused, so only the added children need a call to the managed side.
+    std::unordered_map<AccessibilityChildList::Key, size_t> oldIndices;
+    oldIndices.reserve(_peers.size());
+    for (size_t i = 0; i < _peers.size(); ++i)
+        oldIndices.emplace((IAvnAutomationPeer*)_peers[i], i);
+
+    auto hasElements = _elements != nil && [_elements count] == _peers.size();
+    auto changed = [[NSMutableArray alloc] initWithCapacity:changes.added.size() + changes.removed.size()];
+
+    for (auto key : changes.removed)
+    {
+        auto index = oldIndices[key];
+
+        if (hasElements)
+            [changed addObject:_elements[index]];
+        // Elements nobody created can't have been seen, so there is nothing to report for them
+        else if (_peers[index]->GetNode() != nullptr)
+        {
+            id element = [AvnAccessibilityElement acquire:_peers[index]];
+            if (element != nil)
+                [changed addObject:element];
+        }
+    }
+
+    if (hasElements)
+    {
+        auto elements = [[NSMutableArray alloc] initWithCapacity:peers.size()];
+        auto added = changes.added.begin();
+
+        for (size_t i = 0; i < peers.size(); ++i)
+        {
+            id element;
+
+            if (added != changes.added.end() && *added == i)
             {
-                id element = [AvnAccessibilityElement acquire:child];
-                [_children addObject:element];
+                element = [AvnAccessibilityElement acquire:peers[i]];
+                if (element != nil)
+                    [changed addObject:element];
+                ++added;
             }
+            else
+                element = _elements[oldIndices[(IAvnAutomationPeer*)peers[i]]];
+
+            if (element != nil)
+                [elements addObject:element];
         }
+
+        _elements = elements;
     }
     else
     {
-        _children = nil;
+        for (auto index : changes.added)
+        {
+            id element = [AvnAccessibilityElement acquire:peers[index]];
+            if (element != nil)
+                [changed addObject:element];
+        }
+
+        _elements = nil;
     }
+
+    _peers.swap(peers);
+    return changed;
 }
 
 @end
@@ -1,4 +1,5 @@
 #include "common.h"
+#include "StallWatchdog.h"
 #include <dlfcn.h>
 
 static CGLContextObj CreateCglContext(CGLContextObj share)
@@ -81,7 +82,11 @@ public:
         START_COM_CALL;
         
         CGLContextObj saved = CGLGetCurrentContext();
-        CGLLockContext(Context);
+        {
+            static const int waitSite = GetStallWatchdog().RegisterWaitSite("CGL.LockContext");
+            StallWaitScope wait(GetStallWatchdog(), waitSite);
+            CGLLockContext(Context);
+        }
         if(CGLSetCurrentContext(Context) != 0)
         {
             CGLUnlockContext(Context);
@@ -219,11 +224,10 @@ public:
     }
 };
 
-static ComStaticPtr<AvnGlDisplay> GlDisplay(comnew<AvnGlDisplay>());
-
-
 extern IAvnGlDisplay* GetGlDisplay()
 {
-    return GlDisplay;
+    // Loads libGL, only done once OpenGL is asked for
+    static ComStaticPtr<AvnGlDisplay> display(comnew<AvnGlDisplay>());
+    return display;
 };
 
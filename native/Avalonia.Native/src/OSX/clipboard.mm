@@ -1,12 +1,189 @@
 #import <UniformTypeIdentifiers/UniformTypeIdentifiers.h>
+#import <ImageIO/ImageIO.h>
 #include "common.h"
 #include "clipboard.h"
 #include "AvnString.h"
+#include "ChunkedBytes.h"
+#include "ImageTranscodeCache.h"
+#include "PasteboardSnapshot.h"
+
+static std::vector<std::string> ToStdStrings(NSArray<NSString*>* strings)
+{
+    std::vector<std::string> result;
+    result.reserve([strings count]);
+
+    for (NSString* string in strings)
+    {
+        auto utf8 = [string UTF8String];
+        result.emplace_back(utf8 != nullptr ? utf8 : "");
+    }
+
+    return result;
+}
+
+static IAvnStringArray* CreateAvnStringArray(const std::vector<std::string>& strings)
+{
+    auto array = [NSMutableArray<NSString*> arrayWithCapacity:strings.size()];
+
+    for (auto& string : strings)
+        [array addObject:[NSString stringWithUTF8String:string.c_str()]];
+
+    return CreateAvnStringArray(array);
+}
+
+static CGImageRef CreateImage(NSData* data)
+{
+    auto source = CGImageSourceCreateWithData((__bridge CFDataRef)data, nullptr);
+    if (source == nullptr)
+        return nullptr;
+
+    auto image = CGImageSourceCreateImageAtIndex(source, 0, nullptr);
+    CFRelease(source);
+    return image;
+}
+
+// ImageIO rather than NSImage, it never renders through lockFocus
+static std::shared_ptr<const TranscodedImage> EncodePng(NSData* data)
+{
+    auto image = CreateImage(data);
+    if (image == nullptr)
+        return nullptr;
+
+    auto output = [NSMutableData data];
+    auto destination = CGImageDestinationCreateWithData((__bridge CFMutableDataRef)output, (__bridge CFStringRef)NSPasteboardTypePNG, 1, nullptr);
+    if (destination == nullptr)
+    {
+        CGImageRelease(image);
+        return nullptr;
+    }
+
+    CGImageDestinationAddImage(destination, image, nullptr);
+    auto encoded = CGImageDestinationFinalize(destination);
+    CFRelease(destination);
+    CGImageRelease(image);
+
+    if (!encoded || [output length] == 0)
+        return nullptr;
+
+    auto result = std::make_shared<TranscodedImage>();
+    auto bytes = (const uint8_t*)[output bytes];
+    result->Bytes.assign(bytes, bytes + [output length]);
+    return result;
+}
+
+// Premultiplied BGRA, which is what the managed side uses by default
+static std::shared_ptr<const TranscodedImage> DecodePixels(NSData* data)
+{
+    auto image = CreateImage(data);
+    if (image == nullptr)
+        return nullptr;
+
+    auto width = CGImageGetWidth(image);
+    auto height = CGImageGetHeight(image);
+    std::shared_ptr<TranscodedImage> result;
+    if (width <= INT32_MAX && height <= INT32_MAX)
+        result = TranscodedImage::CreatePixels((int)width, (int)height);
+
+    if (result == nullptr)
+    {
+        CGImageRelease(image);
+        return nullptr;
+    }
+
+    auto colorSpace = CGColorSpaceCreateWithName(kCGColorSpaceSRGB);
+    auto context = CGBitmapContextCreate(result->Bytes.data(), width, height, 8, result->RowBytes, colorSpace,
+                                         kCGImageAlphaPremultipliedFirst | kCGBitmapByteOrder32Little);
+    CGColorSpaceRelease(colorSpace);
+
+    if (context == nullptr)
+    {
+        CGImageRelease(image);
+        return nullptr;
+    }
+
+    CGContextSetBlendMode(context, kCGBlendModeCopy);
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), image);
+    CGContextRelease(context);
+    CGImageRelease(image);
+    return result;
+}
+
+// Hands the transcoded bytes out in place, the NSData keeps them alive
+static NSData* ToNSData(ImageTranscodeCache::Result image)
+{
+    auto bytes = (void*)image->Bytes.data();
+    auto length = image->Bytes.size();
+
+    return [[NSData alloc] initWithBytesNoCopy:bytes length:length deallocator:^(void*, NSUInteger)
+    {
+        (void)image;
+    }];
+}
 
 class Clipboard : public ComSingleObject<IAvnClipboard, &IID_IAvnClipboard>
 {
 private:
     NSPasteboard* _pasteboard;
+
+    // Everything below belongs to the change count of _snapshot
+    std::unique_ptr<const PasteboardSnapshot> _snapshot;
+    NSArray<NSPasteboardItem*>* _items;
+    ComPtr<IAvnStringArray> _formats;
+    std::vector<ComPtr<IAvnStringArray>> _itemFormats;
+
+    // Change counts are only meaningful for one pasteboard, so every pasteboard gets its own cache
+    ImageTranscodeCache _imageTranscodes;
+
+    // Returns nullptr if changeCount isn't the pasteboard's current one
+    const PasteboardSnapshot* GetSnapshot(int64_t changeCount)
+    {
+        auto currentChangeCount = [_pasteboard changeCount];
+        if (changeCount != currentChangeCount)
+            return nullptr;
+
+        if (_snapshot != nullptr && _snapshot->GetChangeCount() == currentChangeCount)
+            return _snapshot.get();
+
+        auto items = [_pasteboard pasteboardItems];
+        auto types = [_pasteboard types];
+
+        std::vector<std::vector<std::string>> itemFormats;
+        itemFormats.reserve([items count]);
+        for (NSPasteboardItem* item in items)
+            itemFormats.push_back(ToStdStrings([item types]));
+
+        // The pasteboard could have changed while we were reading it
+        if ([_pasteboard changeCount] != currentChangeCount)
+            return nullptr;
+
+        _snapshot.reset(new PasteboardSnapshot(currentChangeCount, types != nil, ToStdStrings(types), std::move(itemFormats)));
+        _items = items != nil ? items : @[];
+        _formats = nullptr;
+        _itemFormats.clear();
+        _itemFormats.resize(_snapshot->GetItemCount());
+        return _snapshot.get();
+    }
+
+    NSPasteboardItem* GetItem(const PasteboardSnapshot* snapshot, int index)
+    {
+        if (index < 0 || (size_t)index >= snapshot->GetItemCount())
+            return nil;
+
+        return [_items objectAtIndex:index];
+    }
+
+    // The arrays are never modified, so the same one can be handed out to every caller
+    static IAvnStringArray* GetOrCreateStringArray(ComPtr<IAvnStringArray>& cached, const std::vector<std::string>* strings)
+    {
+        if (strings == nullptr)
+            return nullptr;
+
+        if (cached == nullptr)
+            cached.setNoAddRef(CreateAvnStringArray(*strings));
+
+        return cached.getRetainedReference();
+    }
+
 public:
     FORWARD_IUNKNOWN()
     
@@ -25,10 +202,11 @@ public:
         if (ret == nullptr)
             return E_POINTER;
         
-        if (changeCount != [_pasteboard changeCount])
+        auto snapshot = GetSnapshot(changeCount);
+        if (snapshot == nullptr)
             return COR_E_OBJECTDISPOSED;
 
-        *ret = ConvertPasteboardTypes([_pasteboard types]);
+        *ret = GetOrCreateStringArray(_formats, snapshot->GetFormats());
         return S_OK;
     }
 
@@ -39,11 +217,11 @@ public:
         if (ret == nullptr)
             return E_POINTER;
         
-        if (changeCount != [_pasteboard changeCount])
+        auto snapshot = GetSnapshot(changeCount);
+        if (snapshot == nullptr)
             return COR_E_OBJECTDISPOSED;
         
-        auto items = [_pasteboard pasteboardItems];
-        *ret = items == nil ? 0 : (int)[items count];
+        *ret = (int)snapshot->GetItemCount();
         return S_OK;
     }
     
@@ -54,38 +232,18 @@ public:
         if (ret == nullptr)
             return E_POINTER;
         
-        if (changeCount != [_pasteboard changeCount])
+        auto snapshot = GetSnapshot(changeCount);
+        if (snapshot == nullptr)
             return COR_E_OBJECTDISPOSED;
 
-        auto item = [[_pasteboard pasteboardItems] objectAtIndex:index];
+        auto formats = snapshot->GetItemFormats(index < 0 ? SIZE_MAX : (size_t)index);
+        if (formats == nullptr)
+            return E_INVALIDARG;
         
-        *ret = ConvertPasteboardTypes([item types]);
+        *ret = GetOrCreateStringArray(_itemFormats[index], formats);
         return S_OK;
     }
 
-    static IAvnStringArray* ConvertPasteboardTypes(NSArray<NSPasteboardType> *types)
-    {
-        if (types != nil)
-        {
-            NSMutableArray<NSString *> *mutableTypes = [types mutableCopy];
-
-            // Add png if format list doesn't have PNG,
-            // but has any other image type that can be converter into PNG
-            if (![mutableTypes containsObject:NSPasteboardTypePNG])
-            {
-                if ([mutableTypes containsObject:NSPasteboardTypeTIFF]
-                    || [mutableTypes containsObject:@"public.jpeg"])
-                {
-                    [mutableTypes addObject: NSPasteboardTypePNG];
-                }
-            }
-
-            return CreateAvnStringArray(mutableTypes);
-        }
-
-        return nil;
-    }
-
     virtual HRESULT GetItemValueAsString(int index, int64_t changeCount, const char* format, IAvnString** ret) override
     {
         START_COM_ARP_CALL;
@@ -93,10 +251,14 @@ public:
         if (ret == nullptr)
             return E_POINTER;
         
-        if (changeCount != [_pasteboard changeCount])
+        auto snapshot = GetSnapshot(changeCount);
+        if (snapshot == nullptr)
             return COR_E_OBJECTDISPOSED;
         
-        auto item = [[_pasteboard pasteboardItems] objectAtIndex:index];
+        auto item = GetItem(snapshot, index);
+        if (item == nil)
+            return E_INVALIDARG;
+
         auto value = [item stringForType:[NSString stringWithUTF8String:format]];
         *ret = value == nil ? nullptr : CreateAvnString(value);
         return S_OK;
@@ -109,53 +271,116 @@ public:
         if (ret == nullptr)
             return E_POINTER;
         
-        if (changeCount != [_pasteboard changeCount])
+        auto snapshot = GetSnapshot(changeCount);
+        if (snapshot == nullptr)
             return COR_E_OBJECTDISPOSED;
         
-        auto item = [[_pasteboard pasteboardItems] objectAtIndex:index];
-        auto formatStr = [NSString stringWithUTF8String:format];
+        auto item = GetItem(snapshot, index);
+        if (item == nil)
+            return E_INVALIDARG;
+
+        auto value = GetItemData(changeCount, index, item, format);
+
+        *ret = value == nil || [value length] == 0
+            ? nullptr
+            : CreateByteArray((void*)[value bytes], (int)[value length]);
+        return S_OK;
+    }
+
+    virtual HRESULT GetItemValueAsBuffer(int index, int64_t changeCount, const char* format, IAvnBuffer** ret) override
+    {
+        START_COM_ARP_CALL;
+        
+        if (ret == nullptr)
+            return E_POINTER;
+        
+        auto snapshot = GetSnapshot(changeCount);
+        if (snapshot == nullptr)
+            return COR_E_OBJECTDISPOSED;
         
-        auto value = [item dataForType: formatStr];
+        auto item = GetItem(snapshot, index);
+        if (item == nil)
+            return E_INVALIDARG;
+
+        auto value = GetItemData(changeCount, index, item, format);
+
+        // The buffer keeps the NSData alive and exposes its bytes in place, unlike GetItemValueAsBytes
+        *ret = value == nil || [value length] == 0
+            ? nullptr
+            : CreateAvnBuffer(value);
+        return S_OK;
+    }
+
+    virtual HRESULT GetItemValueAsPixels(int index, int64_t changeCount, const char* format, AvnImagePixelsInfo* info, IAvnBuffer** ret) override
+    {
+        START_COM_ARP_CALL;
+        
+        if (ret == nullptr || info == nullptr)
+            return E_POINTER;
+        
+        auto snapshot = GetSnapshot(changeCount);
+        if (snapshot == nullptr)
+            return COR_E_OBJECTDISPOSED;
+        
+        auto item = GetItem(snapshot, index);
+        if (item == nil)
+            return E_INVALIDARG;
+
+        // Decoded straight to pixels, without encoding a PNG that the managed side would decode again
+        auto pixels = GetTranscodedImage(changeCount, index, item, format, true);
+        if (pixels == nullptr)
+        {
+            *ret = nullptr;
+            return S_OK;
+        }
+
+        info->Width = pixels->Width;
+        info->Height = pixels->Height;
+        info->RowBytes = pixels->RowBytes;
+        *ret = CreateAvnBuffer(ToNSData(pixels));
+        return S_OK;
+    }
+
+    NSData* GetItemData(int64_t changeCount, int index, NSPasteboardItem* item, const char* format)
+    {
+        auto value = [item dataForType:[NSString stringWithUTF8String:format]];
 
         // If PNG wasn't found, try to convert TIFF or JPEG to PNG
-        if (value == nil && [formatStr isEqualToString: NSPasteboardTypePNG])
+        if (value == nil && strcmp(format, PasteboardSnapshot::PngType) == 0)
         {
-            NSData *imageData = nil;
+            auto png = GetTranscodedImage(changeCount, index, item, format, false);
+            if (png != nullptr)
+                value = ToNSData(png);
+        }
 
-            // Try TIFF first
-            imageData = [item dataForType:NSPasteboardTypeTIFF];
+        return value;
+    }
 
-            // If no TIFF, try JPEG
-            if (imageData == nil) {
-                imageData = [item dataForType:@"public.jpeg"];
-            }
+    // Converting an image takes a while and the same clipboard image is often asked for several times,
+    // so conversions are cached for the pasteboard's change count
+    ImageTranscodeCache::Result GetTranscodedImage(int64_t changeCount, int index, NSPasteboardItem* item, const char* format, bool pixels)
+    {
+        ImageTranscodeKey key { changeCount, index, format, pixels };
 
-            if (imageData != nil)
+        ImageTranscodeCache::Result cached;
+        if (_imageTranscodes.TryGet(key, cached))
+            return cached;
+
+        NSData* source = pixels ? [item dataForType:[NSString stringWithUTF8String:format]] : nil;
+        if (source == nil)
+            source = [item dataForType:NSPasteboardTypeTIFF];
+        if (source == nil)
+            source = [item dataForType:@"public.jpeg"];
+        if (source == nil)
+            return nullptr;
+
+        return _imageTranscodes.Get(key, [source, pixels]() -> ImageTranscodeCache::Result
+        {
+            @autoreleasepool
             {
-                auto image = [[NSImage alloc] initWithData:imageData];
-
-                NSBitmapImageRep *bitmapRep = nil;
-                for (NSImageRep *rep in image.representations) {
-                    if ([rep isKindOfClass:[NSBitmapImageRep class]]) {
-                        bitmapRep = (NSBitmapImageRep *)rep;
-                        break;
-                    }
-                }
-
-                if (!bitmapRep) {
-                    [image lockFocus];
-                    bitmapRep = [[NSBitmapImageRep alloc] initWithFocusedViewRect:NSMakeRect(0, 0, image.size.width, image.size.height)];
-                    [image unlockFocus];
-                }
-
-                value = [bitmapRep representationUsingType:NSBitmapImageFileTypePNG properties:@{}];
+                return pixels ? DecodePixels(source) : EncodePng(source);
             }
-        }
-
-        *ret = value == nil || [value length] == 0
-            ? nullptr
-            : CreateByteArray((void*)[value bytes], (int)[value length]);
-        return S_OK;
+        });
     }
 
     virtual HRESULT Clear(int64_t* ret) override
@@ -198,17 +423,23 @@ public:
     {
         START_COM_ARP_CALL;
         
-        auto formatString = [NSString stringWithUTF8String:format];
-        
-        if (@available(macOS 11.0, *))
-        {
-            auto type = [UTType typeWithIdentifier:formatString];
-            return type != nil && [type conformsToType:UTTypeText];
-        }
-        else
+        if (format == nullptr)
+            return false;
+
+        return PasteboardFormatCache::Shared().IsText(format, [format]
         {
-            return UTTypeConformsTo((__bridge CFStringRef)formatString, kUTTypeText);
-        }
+            auto formatString = [NSString stringWithUTF8String:format];
+
+            if (@available(macOS 11.0, *))
+            {
+                auto type = [UTType typeWithIdentifier:formatString];
+                return type != nil && [type conformsToType:UTTypeText];
+            }
+            else
+            {
+                return (bool)UTTypeConformsTo((__bridge CFStringRef)formatString, kUTTypeText);
+            }
+        });
     }
 };
 
@@ -234,7 +465,7 @@ extern IAvnClipboard* CreateClipboard(NSPasteboard* pb)
     return self;
 }
 
-NSString* TryConvertFormatToUti(NSString* format)
+static NSString* ConvertFormatToUti(NSString* format)
 {
     if (@available(macOS 11.0, *))
     {
@@ -280,6 +511,22 @@ NSString* TryConvertFormatToUti(NSString* format)
     }
 }
 
+NSString* TryConvertFormatToUti(NSString* format)
+{
+    auto utf8Format = [format UTF8String];
+    if (utf8Format == nullptr)
+        return nil;
+
+    auto uti = PasteboardFormatCache::Shared().GetUti(utf8Format, [format]
+    {
+        auto converted = ConvertFormatToUti(format);
+        auto utf8Converted = converted != nil ? [converted UTF8String] : nullptr;
+        return PasteboardFormatCache::Uti(utf8Converted != nullptr ? utf8Converted : "");
+    });
+
+    return uti.empty() ? nil : [NSString stringWithUTF8String:uti.c_str()];
+}
+
 - (nonnull NSArray<NSPasteboardType>*) writableTypesForPasteboard:(nonnull NSPasteboard*)pasteboard
 {
     ComPtr<IAvnStringArray> formats;
@@ -331,9 +578,30 @@ NSString* TryConvertFormatToUti(NSString* format)
         return GetNSStringAndRelease(value->AsString());
     
     auto length = value->GetByteLength();
+    if (length <= 0)
+        return [NSData data];
+
+    // The value is pulled in chunks straight into the NSData's storage, the managed side doesn't need to hold
+    // a contiguous copy of the payload to hand it over
     auto buffer = malloc(length);
-    value->CopyBytesTo(buffer);
-    return [NSData dataWithBytesNoCopy:buffer length:length];
+    if (buffer == nullptr)
+        return nil;
+
+    auto read = ReadChunked(buffer, (size_t)length, [&](void* chunk, size_t count) -> int64_t
+    {
+        int produced = 0;
+        if (value->ReadBytes(chunk, (int)count, &produced) != S_OK)
+            return -1;
+        return produced;
+    });
+
+    if (read < 0)
+    {
+        free(buffer);
+        return nil;
+    }
+
+    return [NSData dataWithBytesNoCopy:buffer length:(NSUInteger)read];
 }
 
 @end
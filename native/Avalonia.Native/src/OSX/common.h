@@ -14,6 +14,8 @@ extern void PostDispatcherCallback(IAvnActionCallback* cb);
 extern IAvnTopLevel* CreateAvnTopLevel(IAvnTopLevelEvents* events);
 extern IAvnWindow* CreateAvnWindow(IAvnWindowEvents*events);
 extern IAvnPopup* CreateAvnPopup(IAvnWindowEvents*events);
+extern void ConfigurePopupPool(int capacity, int warmUp);
+extern void ShutdownPopupPool();
 extern IAvnStorageProvider* CreateStorageProvider();
 extern IAvnScreens* CreateScreens(IAvnScreenEvents* cb);
 extern IAvnClipboard* CreateClipboard(NSPasteboard* pb);
@@ -31,9 +33,11 @@ extern IAvnMenuItem* CreateAppMenuItemSeparator();
 extern IAvnApplicationCommands* CreateApplicationCommands();
 extern IAvnPlatformBehaviorInhibition* CreatePlatformBehaviorInhibition();
 extern IAvnNativeControlHost* CreateNativeControlHost(NSView* parent);
+extern void FlushNativeControlLayouts(NSView* view);
 extern IAvnPlatformSettings* CreatePlatformSettings();
 extern IAvnPlatformRenderTimer* CreatePlatformRenderTimer();
 extern IAvnNativeObjectsMemoryManagement* CreateMemoryManagementHelper();
+extern IAvnNativeDiagnostics* CreateNativeDiagnostics();
 extern void SetAppMenu(IAvnMenu *menu);
 extern void SetServicesMenu (IAvnMenu* menu);
 class AvnAppMenu;
@@ -51,6 +55,17 @@ extern AvnPoint ConvertPointY (AvnPoint p);
 extern NSSize ToNSSize (AvnSize s);
 extern AvnSize FromNSSize (NSSize s);
 extern IAvnMTLSharedEvent* ImportMTLSharedEvent(void* object);
+extern uint64_t AvnMonotonicMicroseconds();
+extern uint64_t AvnEventTimestampMicroseconds(NSEvent* event);
+extern NSImage* GetDecodedImage(const void* data, size_t length, CGFloat height, bool isTemplate);
+extern CGFloat GetPrimaryScreenHeight();
+extern bool GetScreenScaling(NSPoint point, CGFloat* scaling);
+class InputLatencyTracer;
+extern InputLatencyTracer& GetInputLatencyTracer();
+class StallWatchdog;
+extern StallWatchdog& GetStallWatchdog();
+class StartupTracer;
+extern StartupTracer& GetStartupTracer();
 #ifdef DEBUG
 #define NSDebugLog(...) NSLog(__VA_ARGS__)
 #else
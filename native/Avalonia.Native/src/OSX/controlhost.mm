@@ -1,11 +1,18 @@
 #include "common.h"
+#include "NativeControlLayoutBatch.h"
+#include <vector>
 
 
 IAvnNativeControlHostTopLevelAttachment* CreateAttachment();
+class AvnNativeControlHost;
+
+// Hosts with layouts waiting for the paint they were set in to end, main thread only
+static std::vector<ComPtr<AvnNativeControlHost>> s_scheduledHosts;
 
 class AvnNativeControlHost :
     public ComSingleObject<IAvnNativeControlHost, &IID_IAvnNativeControlHost>
 {
+    NativeControlLayoutBatch<IAvnNativeControlHostTopLevelAttachment*, ComPtr<IAvnNativeControlHostTopLevelAttachment>> _layouts;
 public:
     FORWARD_IUNKNOWN();
     NSView* View;
@@ -41,6 +48,27 @@ public:
         (__bridge_transfer NSView*) child;
         #pragma clang diagnostic pop
     }
+    
+    // Layouts set while the top level paints, applied together right after the paint, in the frame it painted
+    void ScheduleLayout(IAvnNativeControlHostTopLevelAttachment* attachment, const NativeControlLayout& layout)
+    {
+        if(!_layouts.Set(attachment, attachment, layout))
+            return;
+        
+        s_scheduledHosts.push_back(this);
+        
+        // Only finds something if the layouts weren't set from the view's own paint
+        dispatch_async(dispatch_get_main_queue(), ^{
+            FlushNativeControlLayouts(nil);
+        });
+    }
+    
+    void CancelLayout(IAvnNativeControlHostTopLevelAttachment* attachment)
+    {
+        _layouts.Remove(attachment);
+    }
+    
+    void FlushLayouts();
 };
 
 class AvnNativeControlHostTopLevelAttachment :
@@ -48,6 +76,31 @@ public ComSingleObject<IAvnNativeControlHostTopLevelAttachment, &IID_IAvnNativeC
 {
     NSView* _holder;
     NSView* _child;
+    ComPtr<AvnNativeControlHost> _host;
+    NativeControlLayout _applied;
+    bool _hasApplied;
+    
+    void SetLayout(const NativeControlLayout& layout)
+    {
+        if(_child == nil)
+            return;
+        
+        if(_host != nullptr)
+        {
+            if(AvnInsidePotentialDeadlock::IsInside())
+            {
+                _host->ScheduleLayout(this, layout);
+                return;
+            }
+            
+            // A layout still pending is older than this one
+            _host->CancelLayout(this);
+        }
+        
+        if(ApplyLayout(layout) && [_holder superview] != nil)
+            [[_holder superview] setNeedsDisplay:true];
+    }
+    
 public:
     FORWARD_IUNKNOWN();
     
@@ -55,6 +108,7 @@ public:
     {
         _holder = [NSView new];
         [_holder setWantsLayer:true];
+        _hasApplied = false;
     }
     
     virtual ~AvnNativeControlHostTopLevelAttachment()
@@ -88,6 +142,7 @@ public:
                 return E_FAIL;
             [_holder addSubview:_child];
             [_child setHidden: false];
+            _hasApplied = false;
             return S_OK;
         }
     };
@@ -98,10 +153,15 @@ public:
         
         @autoreleasepool
         {
+            if(_host != nullptr)
+                _host->CancelLayout(this);
+            _hasApplied = false;
+            
             if(host == nil)
             {
                 [_holder removeFromSuperview];
                 [_holder setHidden: true];
+                _host = nullptr;
             }
             else
             {
@@ -110,6 +170,7 @@ public:
                     return E_FAIL;
                 [_holder setHidden:true];
                 [chost->View addSubview:_holder];
+                _host = chost;
             }
             return S_OK;
         }
@@ -117,55 +178,97 @@ public:
     
     virtual void ShowInBounds(float x, float y, float width, float height) override
     {
-        if(_child == nil)
-            return;
-        if(AvnInsidePotentialDeadlock::IsInside())
+        NativeControlLayout layout;
+        layout.Visible = true;
+        layout.X = x;
+        layout.Y = y;
+        layout.Width = width;
+        layout.Height = height;
+        SetLayout(layout);
+    }
+    
+    virtual void HideWithSize(float width, float height) override
+    {
+        NativeControlLayout layout;
+        layout.Width = width;
+        layout.Height = height;
+        SetLayout(layout);
+    }
+    
+    virtual void ReleaseChild() override
+    {
+        if(_host != nullptr)
+            _host->CancelLayout(this);
+        [_child removeFromSuperview];
+        _child = nil;
+    }
+    
+    // Returns true if the control was shown or moved
+    bool ApplyLayout(const NativeControlLayout& layout)
+    {
+        if(_child == nil || (_hasApplied && _applied == layout))
+            return false;
+        
+        _applied = layout;
+        _hasApplied = true;
+        
+        NSRect childFrame = {0, 0, layout.Width, layout.Height};
+        if(!layout.Visible)
         {
-            IAvnNativeControlHostTopLevelAttachment* slf = this;
-            slf->AddRef();
-            dispatch_async(dispatch_get_main_queue(), ^{
-                slf->ShowInBounds(x, y, width, height);
-                slf->Release();
-            });
-            return;
+            [_holder setHidden: true];
+            [_child setFrame: childFrame];
+            return false;
         }
         
-        NSRect childFrame = {0, 0, width, height};
-        NSRect holderFrame = {x, y, width, height};
+        NSRect holderFrame = {layout.X, layout.Y, layout.Width, layout.Height};
         
         [_child setFrame: childFrame];
         [_holder setFrame: holderFrame];
         [_holder setHidden: false];
-        if([_holder superview] != nil)
-            [[_holder superview] setNeedsDisplay:true];
+        return true;
     }
+};
+
+void AvnNativeControlHost::FlushLayouts()
+{
+    auto layouts = _layouts.Take();
+    if(layouts.empty())
+        return;
     
-    virtual void HideWithSize(float width, float height) override
+    // Part of the transaction the frame painted is presented in, the controls move along with the content
+    bool needsDisplay = false;
+    [CATransaction begin];
+    [CATransaction setDisableActions:YES];
+    for(auto& layout : layouts)
     {
-        if(_child == nil)
-            return;
-        if(AvnInsidePotentialDeadlock::IsInside())
-        {
-            IAvnNativeControlHostTopLevelAttachment* slf = this;
-            slf->AddRef();
-            dispatch_async(dispatch_get_main_queue(), ^{
-                slf->HideWithSize(width, height);
-                slf->Release();
-            });
-            return;
-        }
-        
-        NSRect frame = {0, 0, width, height};
-        [_holder setHidden: true];
-        [_child setFrame: frame];
+        auto attachment = dynamic_cast<AvnNativeControlHostTopLevelAttachment*>(layout.Handle.getRaw());
+        if(attachment != nullptr)
+            needsDisplay |= attachment->ApplyLayout(layout.Layout);
     }
+    [CATransaction commit];
     
-    virtual void ReleaseChild() override
+    if(needsDisplay && View != nil)
+        [View setNeedsDisplay:true];
+}
+
+// Called by a view once it painted, nil flushes the hosts of every view
+extern void FlushNativeControlLayouts(NSView* view)
+{
+    std::vector<ComPtr<AvnNativeControlHost>> hosts;
+    for(auto it = s_scheduledHosts.begin(); it != s_scheduledHosts.end();)
     {
-        [_child removeFromSuperview];
-        _child = nil;
+        if(view == nil || (*it)->View == view)
+        {
+            hosts.push_back(std::move(*it));
+            it = s_scheduledHosts.erase(it);
+        }
+        else
+            ++it;
     }
-};
+    
+    for(auto& host : hosts)
+        host->FlushLayouts();
+}
 
 IAvnNativeControlHostTopLevelAttachment* CreateAttachment()
 {
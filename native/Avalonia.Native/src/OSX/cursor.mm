@@ -1,53 +1,88 @@
 #include "common.h"
 #include "cursor.h"
+#include "LazyValue.h"
 
 class CursorFactory : public ComSingleObject<IAvnCursorFactory, &IID_IAvnCursorFactory>
 {
-    ComPtr<Cursor> arrowCursor = comnew<Cursor>([NSCursor arrowCursor]);
-    ComPtr<Cursor> crossCursor = comnew<Cursor>([NSCursor crosshairCursor]);
-    ComPtr<Cursor> resizeUpCursor = comnew<Cursor>([NSCursor resizeUpCursor]);
-    ComPtr<Cursor> resizeDownCursor = comnew<Cursor>([NSCursor resizeDownCursor]);
-    ComPtr<Cursor> resizeUpDownCursor = comnew<Cursor>([NSCursor resizeUpDownCursor]);
-    ComPtr<Cursor> dragCopyCursor = comnew<Cursor>([NSCursor dragCopyCursor]);
-    ComPtr<Cursor> openHandCursor = comnew<Cursor>([NSCursor openHandCursor]);
-    ComPtr<Cursor> dragLinkCursor = comnew<Cursor>([NSCursor dragLinkCursor]);
-    ComPtr<Cursor> pointingHandCursor = comnew<Cursor>([NSCursor pointingHandCursor]);
-    ComPtr<Cursor> contextualMenuCursor = comnew<Cursor>([NSCursor contextualMenuCursor]);
-    ComPtr<Cursor> IBeamCursor = comnew<Cursor>([NSCursor IBeamCursor]);
-    ComPtr<Cursor> resizeLeftCursor = comnew<Cursor>([NSCursor resizeLeftCursor]);
-    ComPtr<Cursor> resizeRightCursor = comnew<Cursor>([NSCursor resizeRightCursor]);
-    ComPtr<Cursor> resizeWestEastCursor = comnew<Cursor>([NSCursor resizeLeftRightCursor]);
-    ComPtr<Cursor> operationNotAllowedCursor = comnew<Cursor>([NSCursor operationNotAllowedCursor]);
-    ComPtr<Cursor> noCursor = comnew<Cursor>([NSCursor arrowCursor], true);
-
-    std::map<AvnStandardCursorType, ComPtr<Cursor>> s_cursorMap =
+    // The standard cursors a cursor type can map to, created when a type mapping to them is asked for first
+    enum NativeCursor
     {
-        { CursorArrow, arrowCursor },
-        { CursorAppStarting, arrowCursor },
-        { CursorWait, arrowCursor },
-        { CursorTopLeftCorner, crossCursor },
-        { CursorTopRightCorner, crossCursor },
-        { CursorBottomLeftCorner, crossCursor },
-        { CursorBottomRightCorner, crossCursor },
-        { CursorCross, crossCursor },
-        { CursorSizeAll, crossCursor },
-        { CursorSizeNorthSouth, resizeUpDownCursor},
-        { CursorSizeWestEast, resizeWestEastCursor},
-        { CursorTopSide, resizeUpCursor },
-        { CursorUpArrow, resizeUpCursor },
-        { CursorBottomSize, resizeDownCursor },
-        { CursorDragCopy, dragCopyCursor },
-        { CursorDragMove, openHandCursor },
-        { CursorDragLink, dragLinkCursor },
-        { CursorHand, pointingHandCursor },
-        { CursorHelp, contextualMenuCursor },
-        { CursorIbeam, IBeamCursor },
-        { CursorLeftSide, resizeLeftCursor },
-        { CursorRightSide, resizeRightCursor },
-        { CursorNo, operationNotAllowedCursor },
-        { CursorNone, noCursor }
+        ArrowCursor,
+        CrossCursor,
+        ResizeUpCursor,
+        ResizeDownCursor,
+        ResizeUpDownCursor,
+        DragCopyCursor,
+        OpenHandCursor,
+        DragLinkCursor,
+        PointingHandCursor,
+        ContextualMenuCursor,
+        IBeamCursor,
+        ResizeLeftCursor,
+        ResizeRightCursor,
+        ResizeWestEastCursor,
+        OperationNotAllowedCursor,
+        NoCursor,
+        NativeCursorCount
     };
 
+    LazyValue<ComPtr<Cursor>> _cursors[NativeCursorCount];
+
+    static bool GetNativeCursor(AvnStandardCursorType cursorType, NativeCursor* ret)
+    {
+        switch (cursorType)
+        {
+            case CursorArrow:
+            case CursorAppStarting:
+            case CursorWait: *ret = ArrowCursor; return true;
+            case CursorTopLeftCorner:
+            case CursorTopRightCorner:
+            case CursorBottomLeftCorner:
+            case CursorBottomRightCorner:
+            case CursorCross:
+            case CursorSizeAll: *ret = CrossCursor; return true;
+            case CursorSizeNorthSouth: *ret = ResizeUpDownCursor; return true;
+            case CursorSizeWestEast: *ret = ResizeWestEastCursor; return true;
+            case CursorTopSide:
+            case CursorUpArrow: *ret = ResizeUpCursor; return true;
+            case CursorBottomSize: *ret = ResizeDownCursor; return true;
+            case CursorDragCopy: *ret = DragCopyCursor; return true;
+            case CursorDragMove: *ret = OpenHandCursor; return true;
+            case CursorDragLink: *ret = DragLinkCursor; return true;
+            case CursorHand: *ret = PointingHandCursor; return true;
+            case CursorHelp: *ret = ContextualMenuCursor; return true;
+            case CursorIbeam: *ret = IBeamCursor; return true;
+            case CursorLeftSide: *ret = ResizeLeftCursor; return true;
+            case CursorRightSide: *ret = ResizeRightCursor; return true;
+            case CursorNo: *ret = OperationNotAllowedCursor; return true;
+            case CursorNone: *ret = NoCursor; return true;
+            default: return false;
+        }
+    }
+
+    static ComPtr<Cursor> CreateNativeCursor(NativeCursor cursor)
+    {
+        switch (cursor)
+        {
+            case CrossCursor: return comnew<Cursor>([NSCursor crosshairCursor]);
+            case ResizeUpCursor: return comnew<Cursor>([NSCursor resizeUpCursor]);
+            case ResizeDownCursor: return comnew<Cursor>([NSCursor resizeDownCursor]);
+            case ResizeUpDownCursor: return comnew<Cursor>([NSCursor resizeUpDownCursor]);
+            case DragCopyCursor: return comnew<Cursor>([NSCursor dragCopyCursor]);
+            case OpenHandCursor: return comnew<Cursor>([NSCursor openHandCursor]);
+            case DragLinkCursor: return comnew<Cursor>([NSCursor dragLinkCursor]);
+            case PointingHandCursor: return comnew<Cursor>([NSCursor pointingHandCursor]);
+            case ContextualMenuCursor: return comnew<Cursor>([NSCursor contextualMenuCursor]);
+            case IBeamCursor: return comnew<Cursor>([NSCursor IBeamCursor]);
+            case ResizeLeftCursor: return comnew<Cursor>([NSCursor resizeLeftCursor]);
+            case ResizeRightCursor: return comnew<Cursor>([NSCursor resizeRightCursor]);
+            case ResizeWestEastCursor: return comnew<Cursor>([NSCursor resizeLeftRightCursor]);
+            case OperationNotAllowedCursor: return comnew<Cursor>([NSCursor operationNotAllowedCursor]);
+            case NoCursor: return comnew<Cursor>([NSCursor arrowCursor], true);
+            default: return comnew<Cursor>([NSCursor arrowCursor]);
+        }
+    }
+
 public:
     FORWARD_IUNKNOWN()
     
@@ -57,12 +92,15 @@ public:
         
         @autoreleasepool
         {
-            *retOut = s_cursorMap[cursorType];
-            
-            if(*retOut != nullptr)
+            NativeCursor nativeCursor;
+            if(!GetNativeCursor(cursorType, &nativeCursor))
             {
-                (*retOut)->AddRef();
+                *retOut = nullptr;
+                return S_OK;
             }
+
+            *retOut = _cursors[nativeCursor].Get([nativeCursor] { return CreateNativeCursor(nativeCursor); });
+            (*retOut)->AddRef();
                 
             return S_OK;
         }
@@ -79,9 +117,7 @@ public:
                 return E_POINTER;
             }
             
-            NSData *imageData = [NSData dataWithBytes:bitmapData length:length];
-            NSImage *image = [[NSImage alloc] initWithData:imageData];
-            
+            NSImage *image = GetDecodedImage(bitmapData, length, 0, false);
             
             NSPoint hotSpot;
             hotSpot.x = hotPixel.Width;
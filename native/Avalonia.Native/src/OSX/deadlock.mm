@@ -1,6 +1,7 @@
 #include "common.h"
+#include <atomic>
 
-static int Counter = 0;
+static std::atomic<int> Counter(0);
 AvnInsidePotentialDeadlock::AvnInsidePotentialDeadlock()
 {
     Counter++;
@@ -13,5 +14,5 @@ AvnInsidePotentialDeadlock::~AvnInsidePotentialDeadlock()
 
 bool AvnInsidePotentialDeadlock::IsInside()
 {
-    return Counter!=0;
+    return Counter.load(std::memory_order_relaxed) != 0;
 }
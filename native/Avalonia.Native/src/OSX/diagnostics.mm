@@ -0,0 +1,219 @@
+#include "common.h"
+#include "InputLatencyTracer.h"
+#include "StallWatchdog.h"
+#include "StartupTracer.h"
+#include "AvnString.h"
+#include <mach/mach_time.h>
+
+uint64_t AvnMonotonicMicroseconds()
+{
+    // NSEvent timestamps are based on the same clock, so both can be compared directly
+    static mach_timebase_info_data_t timebase = []
+    {
+        mach_timebase_info_data_t info;
+        mach_timebase_info(&info);
+        return info;
+    }();
+
+    return mach_absolute_time() * timebase.numer / timebase.denom / 1000;
+}
+
+uint64_t AvnEventTimestampMicroseconds(NSEvent* event)
+{
+    return static_cast<uint64_t>(llround([event timestamp] * 1000000.0));
+}
+
+InputLatencyTracer& GetInputLatencyTracer()
+{
+    static InputLatencyTracer tracer;
+    return tracer;
+}
+
+StallWatchdog& GetStallWatchdog()
+{
+    static StallWatchdog watchdog(AvnMonotonicMicroseconds, [](StallWatchdog* watchdog)
+    {
+        dispatch_async_f(dispatch_get_main_queue(), watchdog, [](void* context)
+        {
+            static_cast<StallWatchdog*>(context)->Beat();
+        });
+    });
+    return watchdog;
+}
+
+StartupTracer& GetStartupTracer()
+{
+    static StartupTracer tracer(AvnMonotonicMicroseconds);
+    return tracer;
+}
+
+class AvnNativeDiagnostics : public ComSingleObject<IAvnNativeDiagnostics, &IID_IAvnNativeDiagnostics>
+{
+public:
+    FORWARD_IUNKNOWN()
+
+    virtual HRESULT SetInputLatencyTracingEnabled(bool enabled) override
+    {
+        GetInputLatencyTracer().SetEnabled(enabled);
+        return S_OK;
+    }
+
+    virtual HRESULT GetInputLatencyStats(AvnInputLatencyEventKind kind, AvnInputLatencyStats* ret) override
+    {
+        if (ret == nullptr)
+            return E_POINTER;
+        if (kind < 0 || kind >= AvnInputLatencyEventKindCount)
+            return E_INVALIDARG;
+
+        *ret = GetInputLatencyTracer().GetStats(kind);
+        return S_OK;
+    }
+
+    virtual HRESULT ResetInputLatencyStats() override
+    {
+        GetInputLatencyTracer().Reset();
+        return S_OK;
+    }
+
+    virtual HRESULT SetStallWatchdogEnabled(bool enabled, int thresholdMs) override
+    {
+        if (enabled && thresholdMs <= 0)
+            return E_INVALIDARG;
+
+        if (enabled)
+            GetStallWatchdog().Start(static_cast<uint64_t>(thresholdMs) * 1000);
+        else
+            GetStallWatchdog().Stop();
+        return S_OK;
+    }
+
+    virtual HRESULT GetStallStats(AvnStallStats* ret) override
+    {
+        if (ret == nullptr)
+            return E_POINTER;
+
+        auto stats = GetStallWatchdog().GetStats();
+        ret->StallCount = static_cast<int>(stats.StallCount);
+        ret->AttributedCount = static_cast<int>(stats.AttributedCount);
+        ret->TotalUs = stats.TotalUs;
+        ret->MaxUs = stats.MaxUs;
+        return S_OK;
+    }
+
+    virtual HRESULT GetWaitSiteCount(int* ret) override
+    {
+        if (ret == nullptr)
+            return E_POINTER;
+
+        *ret = GetStallWatchdog().GetWaitSiteCount();
+        return S_OK;
+    }
+
+    virtual HRESULT GetWaitSiteStats(int index, AvnWaitSiteStats* ret) override
+    {
+        if (ret == nullptr)
+            return E_POINTER;
+        if (index < 0 || index >= GetStallWatchdog().GetWaitSiteCount())
+            return E_INVALIDARG;
+
+        auto stats = GetStallWatchdog().GetSiteStats(index);
+        ret->Count = static_cast<int>(stats.Count);
+        ret->StallCount = static_cast<int>(stats.StallCount);
+        ret->TotalUs = stats.TotalUs;
+        ret->MaxUs = stats.MaxUs;
+        return S_OK;
+    }
+
+    virtual HRESULT GetWaitSiteName(int index, IAvnString** ret) override
+    {
+        START_COM_ARP_CALL;
+        if (ret == nullptr)
+            return E_POINTER;
+
+        auto name = GetStallWatchdog().GetWaitSiteName(index);
+        if (name == nullptr)
+            return E_INVALIDARG;
+
+        *ret = CreateAvnString([NSString stringWithUTF8String:name]);
+        return S_OK;
+    }
+
+    virtual HRESULT ExportStallTrace(IAvnString** ret) override
+    {
+        START_COM_ARP_CALL;
+        if (ret == nullptr)
+            return E_POINTER;
+
+        auto trace = GetStallWatchdog().ExportTrace();
+        *ret = CreateByteArray(trace.data(), static_cast<int>(trace.size()));
+        return S_OK;
+    }
+
+    virtual HRESULT ResetStallStats() override
+    {
+        GetStallWatchdog().Reset();
+        return S_OK;
+    }
+
+    virtual HRESULT GetStartupTime(uint64_t* ret) override
+    {
+        if (ret == nullptr)
+            return E_POINTER;
+
+        *ret = GetStartupTracer().GetTotalUs();
+        return S_OK;
+    }
+
+    virtual HRESULT GetStartupStepCount(int* ret) override
+    {
+        if (ret == nullptr)
+            return E_POINTER;
+
+        *ret = static_cast<int>(GetStartupTracer().GetSteps().size());
+        return S_OK;
+    }
+
+    virtual HRESULT GetStartupStep(int index, AvnStartupStep* ret) override
+    {
+        if (ret == nullptr)
+            return E_POINTER;
+
+        auto steps = GetStartupTracer().GetSteps();
+        if (index < 0 || index >= static_cast<int>(steps.size()))
+            return E_INVALIDARG;
+
+        ret->StartUs = steps[index].StartUs;
+        ret->DurationUs = steps[index].DurationUs;
+        return S_OK;
+    }
+
+    virtual HRESULT GetStartupStepName(int index, IAvnString** ret) override
+    {
+        START_COM_ARP_CALL;
+        if (ret == nullptr)
+            return E_POINTER;
+
+        auto steps = GetStartupTracer().GetSteps();
+        if (index < 0 || index >= static_cast<int>(steps.size()))
+            return E_INVALIDARG;
+
+        *ret = CreateAvnString([NSString stringWithUTF8String:steps[index].Name]);
+        return S_OK;
+    }
+
+    virtual HRESULT ExportStartupTrace(IAvnString** ret) override
+    {
+        START_COM_ARP_CALL;
+        if (ret == nullptr)
+            return E_POINTER;
+
+        auto trace = GetStartupTracer().ExportTrace();
+        *ret = CreateByteArray(trace.data(), static_cast<int>(trace.size()));
+        return S_OK;
+    }
+};
+
+extern IAvnNativeDiagnostics* CreateNativeDiagnostics()
+{
+    return new AvnNativeDiagnostics();
+}
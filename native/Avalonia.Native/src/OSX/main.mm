@@ -2,6 +2,7 @@
 #define COM_GUIDS_MATERIALIZE
 #include "common.h"
 #include "menu.h"
+#include "StartupTracer.h"
 
 static NSString* s_appTitle = @"Avalonia";
 static int disableSetProcessName = 0;
@@ -171,6 +172,18 @@ public:
         }
     }
     
+    virtual HRESULT SetPopupPoolSize(int capacity, int warmUp) override
+    {
+        START_COM_CALL;
+        
+        // Warming up creates windows, that waits until the application is running
+        dispatch_async(dispatch_get_main_queue(), ^{
+            ConfigurePopupPool(capacity, warmUp);
+        });
+        
+        return S_OK;
+    }
+    
 };
 
 /// See "Using POSIX Threads in a Cocoa Application" section here:
@@ -209,6 +222,13 @@ public:
     
     virtual ~AvaloniaNative() override
     {
+        if ([NSThread isMainThread])
+            ShutdownPopupPool();
+        else
+            dispatch_async(dispatch_get_main_queue(), ^{
+                ShutdownPopupPool();
+            });
+
         ReleaseAvnAppEvents();
         _deallocator = nullptr;
         _dispatcher = nullptr;
@@ -220,12 +240,21 @@ public:
     {
         START_COM_CALL;
         
+        StartupTraceScope trace(GetStartupTracer(), "Initialize");
         _deallocator = deallocator;
         _dispatcher = dispatcher;
-        @autoreleasepool{
-            [[ThreadingInitializer new] do];
+        // Another thread may have put Cocoa into multithreaded mode already
+        if(![NSThread isMultiThreaded])
+        {
+            StartupTraceScope trace(GetStartupTracer(), "Initialize.Threading");
+            @autoreleasepool{
+                [[ThreadingInitializer new] do];
+            }
+        }
+        {
+            StartupTraceScope trace(GetStartupTracer(), "Initialize.Application");
+            InitializeAvnApp(events, disableAppDelegate);
         }
-        InitializeAvnApp(events, disableAppDelegate);
         return S_OK;
     };
     
@@ -242,6 +271,7 @@ public:
         {
             if(cb == nullptr || ppv == nullptr)
                 return E_POINTER;
+            StartupTraceScope trace(GetStartupTracer(), "CreateTopLevel");
             *ppv = CreateAvnTopLevel(cb);
             return S_OK;
         }
@@ -255,6 +285,7 @@ public:
         {
             if(cb == nullptr || ppv == nullptr)
                 return E_POINTER;
+            StartupTraceScope trace(GetStartupTracer(), "CreateWindow");
             *ppv = CreateAvnWindow(cb);
             return S_OK;
         }
@@ -280,6 +311,7 @@ public:
         
         @autoreleasepool
         {
+            StartupTraceScope trace(GetStartupTracer(), "CreatePlatformThreadingInterface");
             *ppv = CreatePlatformThreading();
             return S_OK;
         }
@@ -324,6 +356,7 @@ public:
         
         @autoreleasepool
         {
+            StartupTraceScope trace(GetStartupTracer(), "CreateCursorFactory");
             *ppv = ::CreateCursorFactory();
             return S_OK;
         }
@@ -335,6 +368,7 @@ public:
         
         @autoreleasepool
         {
+            StartupTraceScope trace(GetStartupTracer(), "ObtainGlDisplay");
             auto rv = ::GetGlDisplay();
             if(rv == NULL)
                 return E_FAIL;
@@ -349,6 +383,7 @@ public:
         START_COM_CALL;
         @autoreleasepool
         {
+            StartupTraceScope trace(GetStartupTracer(), "ObtainMetalDisplay");
             auto rv = ::GetMetalDisplay();
             if(rv == NULL)
                 return E_FAIL;
@@ -494,10 +529,18 @@ public:
         }
     }
 
+    virtual HRESULT CreateNativeDiagnostics(IAvnNativeDiagnostics** ppv) override
+    {
+        START_COM_CALL;
+        *ppv = ::CreateNativeDiagnostics();
+        return S_OK;
+    }
+
 };
 
 extern "C" IAvaloniaNativeFactory* CreateAvaloniaNative()
 {
+    GetStartupTracer().Begin();
     return new AvaloniaNative();
 };
 
@@ -559,9 +602,7 @@ AvnPoint ToAvnPoint (NSPoint p)
 
 AvnPoint ConvertPointY (AvnPoint p)
 {
-    auto primaryDisplayHeight = NSMaxY([[[NSScreen screens] firstObject] frame]);
-    
-    p.Y = primaryDisplayHeight - p.Y;
+    p.Y = GetPrimaryScreenHeight() - p.Y;
     
     return p;
 }
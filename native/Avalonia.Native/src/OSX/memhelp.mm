@@ -1,4 +1,14 @@
 #include "common.h"
+
+static void ReleaseCFObjects(void* const* objs, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (objs[i] != nullptr)
+            CFRelease(objs[i]);
+    }
+}
+
 class MemHelper : public ComSingleObject<IAvnNativeObjectsMemoryManagement, &IID_IAvnNativeObjectsMemoryManagement>
 {
     FORWARD_IUNKNOWN()
@@ -29,8 +39,18 @@ class MemHelper : public ComSingleObject<IAvnNativeObjectsMemoryManagement, &IID
     int64_t GetRetainCountForCFObject(void *obj) override { 
         return CFGetRetainCount(obj);
     }
-    
-    
+
+    void ReleaseNSObjects(void **objs, int count) override
+    {
+        if (objs != nullptr && count > 0)
+            ::ReleaseNSObjects(objs, count);
+    }
+
+    void ReleaseCFObjects(void **objs, int count) override
+    {
+        if (objs != nullptr && count > 0)
+            ::ReleaseCFObjects(objs, count);
+    }
 };
 
 
@@ -10,6 +10,10 @@
 #define menu_h
 
 #include "common.h"
+#include "MenuEnablementCache.h"
+#include "MenuModel.h"
+#include <unordered_map>
+#include <vector>
 
 class AvnAppMenuItem;
 class AvnAppMenu;
@@ -74,9 +78,25 @@ class AvnAppMenu;
 class AvnAppMenu : public ComSingleObject<IAvnMenu, &IID_IAvnMenu>
 {
 private:
+    // An item created by ApplyModel, Properties are the ones last applied to it
+    struct ModelEntry
+    {
+        MenuModelItem Properties;
+        ComPtr<AvnAppMenuItem> Item;
+        ComPtr<AvnAppMenu> SubMenu;
+    };
+
     AvnMenu* _native;
     ComPtr<IAvnMenuEvents> _baseEvents;
     AvnMenuDelegate* _delegate;
+    std::vector<uint64_t> _modelIds;
+    std::unordered_map<uint64_t, ModelEntry> _modelEntries;
+    ComPtr<IAvnMenuModelEvents> _modelEvents;
+    MenuEnablementCache _enablement;
+    
+    void InvalidateEnabledState();
+    void ApplyModelItems(IAvnMenuModelEvents* events, std::vector<MenuModelItem>& items);
+    void ApplyModelProperties(IAvnMenuModelEvents* events, ModelEntry& entry, MenuModelItem& item);
     
 public:
     FORWARD_IUNKNOWN()
@@ -89,6 +109,8 @@ public:
     void RaiseOpening();
     void RaiseClosed();
     
+    bool IsModelItemEnabled(uint64_t id);
+    
     virtual HRESULT InsertItem (int index, IAvnMenuItem* item) override;
     
     virtual HRESULT RemoveItem (IAvnMenuItem* item) override;
@@ -96,6 +118,11 @@ public:
     virtual HRESULT SetTitle (char* utf8String) override;
     
     virtual HRESULT Clear () override;
+    
+    virtual HRESULT ApplyModel (IAvnMenuModelEvents* events, void* data, int length) override;
+    
+    virtual HRESULT InvalidateEnabled () override;
+    
     virtual ~AvnAppMenu() override;
 };
 
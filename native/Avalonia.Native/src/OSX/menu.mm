@@ -3,6 +3,7 @@
 #include "common.h"
 #include "menu.h"
 #include "KeyTransform.h"
+#include "AvnString.h"
 #include <CoreFoundation/CoreFoundation.h>
 #include <Carbon/Carbon.h> /* For kVK_ constants, and TIS functions. */
 
@@ -136,7 +137,7 @@ HRESULT AvnAppMenuItem::SetTitle (char* utf8String)
     {
         if (utf8String != nullptr)
         {
-            [_native setTitle:[NSString stringWithUTF8String:(const char*)utf8String]];
+            [_native setTitle:CreateNSStringFromUtf8(utf8String, strlen(utf8String))];
         }
         
         return S_OK;
@@ -151,7 +152,7 @@ HRESULT AvnAppMenuItem::SetToolTip (char* utf8String)
     {
         if (utf8String != nullptr)
         {
-            [_native setToolTip:[NSString stringWithUTF8String:(const char*)utf8String]];
+            [_native setToolTip:CreateNSStringFromUtf8(utf8String, strlen(utf8String))];
         }
 
         return S_OK;
@@ -271,19 +272,9 @@ HRESULT AvnAppMenuItem::SetIcon(void *data, size_t length)
     {
         if(data != nullptr)
         {
-            NSData *imageData = [NSData dataWithBytes:data length:length];
-            NSImage *image = [[NSImage alloc] initWithData:imageData];
+            auto height = floor([[NSFont menuFontOfSize:0] pointSize] * 1.333333);
             
-            NSSize originalSize = [image size];
-             
-            NSSize size;
-            size.height = floor([[NSFont menuFontOfSize:0] pointSize] * 1.333333);
-            
-            auto scaleFactor = size.height / originalSize.height;
-            size.width = floor(originalSize.width * scaleFactor);
-            
-            [image setSize: size];
-            [_native setImage:image];
+            [_native setImage:GetDecodedImage(data, length, height, false)];
         }
         else
         {
@@ -341,6 +332,8 @@ void AvnAppMenu::RaiseNeedsUpdate()
 
 void AvnAppMenu::RaiseOpening()
 {
+    _enablement.Open();
+    
     if(_baseEvents != nullptr)
     {
         _baseEvents->Opening();
@@ -349,6 +342,8 @@ void AvnAppMenu::RaiseOpening()
 
 void AvnAppMenu::RaiseClosed()
 {
+    _enablement.Close();
+    
     if(_baseEvents != nullptr)
     {
         _baseEvents->Closed();
@@ -403,7 +398,7 @@ HRESULT AvnAppMenu::SetTitle (char* utf8String)
     {
         if (utf8String != nullptr)
         {
-            [_native setTitle:[NSString stringWithUTF8String:(const char*)utf8String]];
+            [_native setTitle:CreateNSStringFromUtf8(utf8String, strlen(utf8String))];
         }
         
         return S_OK;
@@ -417,6 +412,303 @@ HRESULT AvnAppMenu::Clear()
     @autoreleasepool
     {
         [_native removeAllItems];
+        _modelIds.clear();
+        _modelEntries.clear();
+        InvalidateEnabledState();
+        return S_OK;
+    }
+}
+
+// Model items report to the IAvnMenuModelEvents with their id instead of having callbacks of their own,
+// their enabled state is evaluated together with the rest of the menu
+class MenuModelPredicate : public ComSingleObject<IAvnPredicateCallback, &IID_IAvnPredicateCallback>
+{
+private:
+    ComObjectWeakPtr<AvnAppMenu> _menu;
+    uint64_t _id;
+    
+public:
+    FORWARD_IUNKNOWN()
+    
+    MenuModelPredicate(AvnAppMenu* menu, uint64_t id) : _menu(menu), _id(id)
+    {
+    }
+    
+    virtual bool Evaluate() override
+    {
+        auto menu = _menu.tryGet();
+        return menu != nullptr && menu->IsModelItemEnabled(_id);
+    }
+};
+
+class MenuModelAction : public ComSingleObject<IAvnActionCallback, &IID_IAvnActionCallback>
+{
+private:
+    ComPtr<IAvnMenuModelEvents> _events;
+    uint64_t _id;
+    
+public:
+    FORWARD_IUNKNOWN()
+    
+    MenuModelAction(IAvnMenuModelEvents* events, uint64_t id) : _events(events), _id(id)
+    {
+    }
+    
+    virtual void Run() override
+    {
+        _events->ItemClicked(_id);
+    }
+};
+
+class MenuModelSubMenuEvents : public ComSingleObject<IAvnMenuEvents, &IID_IAvnMenuEvents>
+{
+private:
+    ComPtr<IAvnMenuModelEvents> _events;
+    uint64_t _id;
+    
+public:
+    FORWARD_IUNKNOWN()
+    
+    MenuModelSubMenuEvents(IAvnMenuModelEvents* events, uint64_t id) : _events(events), _id(id)
+    {
+    }
+    
+    virtual void NeedsUpdate() override
+    {
+        _events->MenuNeedsUpdate(_id);
+    }
+    
+    virtual void Opening() override
+    {
+        _events->MenuOpening(_id);
+    }
+    
+    virtual void Closed() override
+    {
+        _events->MenuClosed(_id);
+    }
+};
+
+// The application menu item is moved between menus behind our back (see AvnWindow), so only remove what is there
+static void RemoveModelItem(NSMenu* menu, NSMenuItem* item)
+{
+    if ([item menu] == menu)
+        [menu removeItem:item];
+}
+
+HRESULT AvnAppMenu::ApplyModel(IAvnMenuModelEvents* events, void* data, int length)
+{
+    START_COM_CALL;
+    
+    @autoreleasepool
+    {
+        if (events == nullptr || length < 0)
+            return E_INVALIDARG;
+        
+        std::vector<MenuModelItem> items;
+        if (!MenuModelReader::Read(data, (size_t)length, items))
+            return E_INVALIDARG;
+        
+        ApplyModelItems(events, items);
+        return S_OK;
+    }
+}
+
+void AvnAppMenu::ApplyModelItems(IAvnMenuModelEvents* events, std::vector<MenuModelItem>& items)
+{
+    _modelEvents = events;
+    InvalidateEnabledState();
+    
+    // A separator and an item are different NSMenuItems, an id that changed its kind starts over
+    for (auto& item : items)
+    {
+        auto entry = _modelEntries.find(item.Id);
+        if (entry != _modelEntries.end() && entry->second.Properties.Kind != item.Kind)
+        {
+            RemoveModelItem(_native, entry->second.Item->GetNative());
+            _modelIds.erase(std::find(_modelIds.begin(), _modelIds.end(), item.Id));
+            _modelEntries.erase(entry);
+        }
+    }
+    
+    std::vector<uint64_t> ids;
+    ids.reserve(items.size());
+    for (auto& item : items)
+        ids.push_back(item.Id);
+    
+    auto offset = [_native hasGlobalMenuItem] ? 1 : 0;
+    
+    for (auto& operation : DiffMenuModel(_modelIds, ids))
+    {
+        if (operation.Kind == MenuModelOperation::Remove)
+        {
+            RemoveModelItem(_native, _modelEntries[operation.Id].Item->GetNative());
+            
+            if (!operation.Existing)
+                _modelEntries.erase(operation.Id);
+            continue;
+        }
+        
+        auto& entry = _modelEntries[operation.Id];
+        
+        if (!operation.Existing)
+        {
+            auto& item = items[operation.Index];
+            auto isSeparator = item.Kind == MenuModelItemKind::Separator;
+            
+            entry.Item = ComPtr<AvnAppMenuItem>(new AvnAppMenuItem(isSeparator), true);
+            entry.Properties.Id = item.Id;
+            entry.Properties.Kind = item.Kind;
+            // What a new NSMenuItem looks like
+            entry.Properties.Flags = MenuModelVisible;
+            
+            if (!isSeparator)
+            {
+                ComPtr<IAvnPredicateCallback> predicate(new MenuModelPredicate(this, item.Id), true);
+                ComPtr<IAvnActionCallback> action(new MenuModelAction(events, item.Id), true);
+                entry.Item->SetAction(predicate, action);
+            }
+        }
+        
+        auto index = std::min((NSInteger)(operation.Index + offset), [_native numberOfItems]);
+        [_native insertItem:entry.Item->GetNative() atIndex:index];
+    }
+    
+    _modelIds.swap(ids);
+    
+    for (auto& item : items)
+    {
+        if (item.Kind != MenuModelItemKind::Separator)
+            ApplyModelProperties(events, _modelEntries[item.Id], item);
+    }
+}
+
+void AvnAppMenu::ApplyModelProperties(IAvnMenuModelEvents* events, ModelEntry& entry, MenuModelItem& item)
+{
+    auto changes = MenuModelChanges(entry.Properties, item);
+    auto nativeItem = entry.Item;
+    
+    if (changes & MenuModelPropertyTitle)
+        nativeItem->SetTitle((char*)item.Title.c_str());
+    if (changes & MenuModelPropertyToolTip)
+        nativeItem->SetToolTip((char*)item.ToolTip.c_str());
+    if (changes & MenuModelPropertyGesture)
+        nativeItem->SetGesture((AvnKey)item.Key, (AvnInputModifiers)item.Modifiers);
+    if (changes & MenuModelPropertyToggleType)
+        nativeItem->SetToggleType((AvnMenuItemToggleType)item.ToggleType);
+    if (changes & MenuModelPropertyChecked)
+        nativeItem->SetIsChecked(item.HasFlag(MenuModelChecked));
+    if (changes & MenuModelPropertyVisible)
+        nativeItem->SetIsVisible(item.HasFlag(MenuModelVisible));
+    
+    if (changes & MenuModelPropertyIcon)
+    {
+        if (!item.HasFlag(MenuModelHasIcon))
+            nativeItem->SetIcon(nullptr, 0);
+        else if (!item.HasFlag(MenuModelIconUnchanged))
+            nativeItem->SetIcon(item.Icon.data(), item.Icon.size());
+    }
+    
+    if (item.HasFlag(MenuModelHasSubMenu))
+    {
+        auto created = entry.SubMenu == nullptr;
+        if (created)
+        {
+            ComPtr<IAvnMenuEvents> subMenuEvents(new MenuModelSubMenuEvents(events, item.Id), true);
+            entry.SubMenu = ComPtr<AvnAppMenu>(new AvnAppMenu(subMenuEvents), true);
+            nativeItem->SetSubMenu(entry.SubMenu);
+        }
+        
+        if (created || (changes & MenuModelPropertyTitle))
+            entry.SubMenu->SetTitle((char*)item.Title.c_str());
+        
+        if (item.HasFlag(MenuModelServicesMenu) && (created || (changes & MenuModelPropertyServicesMenu)))
+            [NSApplication sharedApplication].servicesMenu = entry.SubMenu->GetNative();
+        
+        entry.SubMenu->ApplyModelItems(events, item.SubMenu);
+    }
+    else if (entry.SubMenu != nullptr)
+    {
+        nativeItem->SetSubMenu(nullptr);
+        entry.SubMenu = nullptr;
+    }
+    
+    // Only the properties are kept, the icon's bytes and the submenu's items are applied
+    item.Icon.clear();
+    item.SubMenu.clear();
+    entry.Properties = std::move(item);
+}
+
+bool AvnAppMenu::IsModelItemEnabled(uint64_t id)
+{
+    if (_modelEvents == nullptr)
+        return false;
+    
+    // Everything that AppKit will validate, submenu items are always enabled
+    auto getIds = [this]()
+    {
+        std::vector<uint64_t> ids;
+        ids.reserve(_modelIds.size());
+        for (auto modelId : _modelIds)
+        {
+            auto& entry = _modelEntries[modelId];
+            if (entry.Properties.Kind != MenuModelItemKind::Separator && entry.SubMenu == nullptr)
+                ids.push_back(modelId);
+        }
+        return ids;
+    };
+    
+    auto events = _modelEvents;
+    auto enabled = _enablement.IsEnabled(id, getIds, [&](const uint64_t* batch, size_t count, uint8_t* bitmap)
+    {
+        events->EvaluateEnabled((uint64_t*)batch, (int)count, bitmap);
+    });
+    
+    if (_enablement.NeedsEndPass())
+    {
+        ComObjectWeakPtr<AvnAppMenu> weak(this);
+        dispatch_async(dispatch_get_main_queue(), ^{
+            auto menu = weak.tryGet();
+            if (menu != nullptr)
+                menu->_enablement.EndPass();
+        });
+    }
+    
+    return enabled;
+}
+
+void AvnAppMenu::InvalidateEnabledState()
+{
+    if (!_enablement.Invalidate())
+        return;
+    
+    // The menu is showing, have AppKit validate its items again once the current burst of changes is over
+    ComObjectWeakPtr<AvnAppMenu> weak(this);
+    dispatch_async(dispatch_get_main_queue(), ^{
+        auto menu = weak.tryGet();
+        if (menu == nullptr)
+            return;
+        
+        menu->_enablement.Refreshed();
+        if (menu->_enablement.IsOpen())
+            [menu->_native update];
+    });
+}
+
+HRESULT AvnAppMenu::InvalidateEnabled()
+{
+    START_COM_CALL;
+    
+    @autoreleasepool
+    {
+        InvalidateEnabledState();
+        
+        for (auto& entry : _modelEntries)
+        {
+            if (entry.second.SubMenu != nullptr)
+                entry.second.SubMenu->InvalidateEnabled();
+        }
+        
         return S_OK;
     }
 }
@@ -3,6 +3,12 @@
 #import <QuartzCore/QuartzCore.h>
 #include "common.h"
 #include "rendertarget.h"
+#include "InputLatencyTracer.h"
+#include "StallWatchdog.h"
+#include "StartupTracer.h"
+#include "ImportCache.h"
+#include <atomic>
+#include <memory>
 #import "crapium.h"
 
 
@@ -72,8 +78,61 @@ public:
     
 };
 
+struct MetalTextureImportKey
+{
+    IOSurfaceID Surface;
+    AvnPixelFormat PixelFormat;
+    MTLTextureUsage Usage;
+
+    bool operator==(const MetalTextureImportKey& other) const
+    {
+        return Surface == other.Surface && PixelFormat == other.PixelFormat && Usage == other.Usage;
+    }
+};
+
+struct MetalSharedEventImport
+{
+    ComPtr<IAvnMTLSharedEvent> Event;
+    // The address of an event that is gone can be taken by a new one
+    __weak id External;
+};
+
+// Shared with the trim timer, which only holds on to them while it trims
+struct MetalImportCaches
+{
+    // A texture keeps its IOSurface alive, the surface an ID stands for can't change while it is cached
+    ImportCache<MetalTextureImportKey, ComPtr<IAvnMetalTexture>> Textures;
+    ImportCache<void*, MetalSharedEventImport> SharedEvents;
+    std::atomic<bool> TrimScheduled { false };
+};
+
+static const uint64_t s_importCacheTrimIntervalUs = 1000000;
+
+// Imports nobody asks for again are dropped even if no import ever comes, the timer only runs while something is cached
+static void ScheduleImportCacheTrim(const std::shared_ptr<MetalImportCaches>& caches)
+{
+    if(caches->TrimScheduled.exchange(true))
+        return;
+    
+    std::weak_ptr<MetalImportCaches> weakCaches = caches;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(s_importCacheTrimIntervalUs * NSEC_PER_USEC)),
+                   dispatch_get_global_queue(QOS_CLASS_UTILITY, 0), ^{
+        auto strongCaches = weakCaches.lock();
+        if(strongCaches == nullptr)
+            return;
+        
+        strongCaches->TrimScheduled = false;
+        auto now = AvnMonotonicMicroseconds();
+        strongCaches->Textures.Trim(now);
+        strongCaches->SharedEvents.Trim(now);
+        if(strongCaches->Textures.GetStats().Count != 0 || strongCaches->SharedEvents.GetStats().Count != 0)
+            ScheduleImportCacheTrim(strongCaches);
+    });
+}
+
 class AvnMetalDevice : public ComSingleObject<IAvnMetalDevice, &IID_IAvnMetalDevice>
 {
+    std::shared_ptr<MetalImportCaches> _imports = std::make_shared<MetalImportCaches>();
 public:
     id<MTLDevice> device;
     id<MTLCommandQueue> queue;
@@ -90,37 +149,66 @@ public:
     HRESULT ImportIOSurface(void *handle, AvnPixelFormat pixelFormat, IAvnMetalTexture **ppv) override {
         START_COM_ARP_CALL;
         auto surf = (IOSurfaceRef)handle;
+        if(pixelFormat != kAvnRgba8888 && pixelFormat != kAvnBgra8888)
+            return E_INVALIDARG;
+        MTLTextureUsage usage = MTLTextureUsageShaderRead | MTLTextureUsageRenderTarget;
+
+        MetalTextureImportKey key { IOSurfaceGetID(surf), pixelFormat, usage };
+        auto now = AvnMonotonicMicroseconds();
+        ComPtr<IAvnMetalTexture> cached;
+        if(_imports->Textures.TryGet(key, now, [](const ComPtr<IAvnMetalTexture>&) { return true; }, cached))
+        {
+            *ppv = cached.getRetainedReference();
+            return S_OK;
+        }
+
         auto width = IOSurfaceGetWidth(surf);
         auto height = IOSurfaceGetHeight(surf);
 
         auto desc = [MTLTextureDescriptor new];
         if(pixelFormat == kAvnRgba8888)
             desc.pixelFormat = MTLPixelFormatRGBA8Unorm;
-        else if(pixelFormat == kAvnBgra8888)
-            desc.pixelFormat = MTLPixelFormatBGRA8Unorm;
         else
-            return E_INVALIDARG;
+            desc.pixelFormat = MTLPixelFormatBGRA8Unorm;
         desc.textureType = MTLTextureType2D;
         desc.width = width;
         desc.height = height;
         desc.depth = 1;
         desc.mipmapLevelCount = 1;
         desc.sampleCount = 1;
-        desc.usage = MTLTextureUsageShaderRead | MTLTextureUsageRenderTarget;
+        desc.usage = usage;
 
         auto texture = [device newTextureWithDescriptor:desc iosurface:surf plane:0];
         if(texture == nullptr)
             return E_FAIL;
-        *ppv = new AvnMetalTexture(texture);
+        ComPtr<IAvnMetalTexture> imported(new AvnMetalTexture(texture), true);
+        _imports->Textures.Add(key, imported, now);
+        ScheduleImportCacheTrim(_imports);
+        *ppv = imported.getRetainedReference();
         return S_OK;
     }
     
     HRESULT ImportSharedEvent(void *mtlSharedEventInstance, IAvnMTLSharedEvent**ppv) override {
         if (@available(macOS 12.0, *)) {
             auto external = (__bridge id<MTLSharedEvent>)mtlSharedEventInstance;
+            auto now = AvnMonotonicMicroseconds();
+            MetalSharedEventImport cached;
+            if(_imports->SharedEvents.TryGet(mtlSharedEventInstance, now,
+                                    [external](const MetalSharedEventImport& entry) { return entry.External == external; },
+                                    cached))
+            {
+                *ppv = cached.Event.getRetainedReference();
+                return S_OK;
+            }
+
             auto handle = external.newSharedEventHandle;
             auto imported = [device newSharedEventWithHandle: handle];
-            *ppv = new AvnMTLSharedEvent(imported);
+            MetalSharedEventImport entry;
+            entry.Event.setNoAddRef(new AvnMTLSharedEvent(imported));
+            entry.External = external;
+            _imports->SharedEvents.Add(mtlSharedEventInstance, entry, now);
+            ScheduleImportCacheTrim(_imports);
+            *ppv = entry.Event.getRetainedReference();
             return S_OK;
         } 
         else
@@ -158,6 +246,30 @@ public:
         return SignalOrWait(ev, value, false);
     }
     
+    HRESULT ClearImportCache() override {
+        START_COM_ARP_CALL;
+        _imports->Textures.Clear();
+        _imports->SharedEvents.Clear();
+        return S_OK;
+    }
+
+    HRESULT GetImportCacheStats(AvnMetalImportCacheStats* ret) override {
+        START_COM_CALL;
+        if(ret == nullptr)
+            return E_POINTER;
+        auto textures = _imports->Textures.GetStats();
+        auto sharedEvents = _imports->SharedEvents.GetStats();
+        ret->TextureHits = static_cast<int>(textures.Hits);
+        ret->TextureMisses = static_cast<int>(textures.Misses);
+        ret->TextureEvictions = static_cast<int>(textures.Evictions);
+        ret->TextureCount = static_cast<int>(textures.Count);
+        ret->SharedEventHits = static_cast<int>(sharedEvents.Hits);
+        ret->SharedEventMisses = static_cast<int>(sharedEvents.Misses);
+        ret->SharedEventEvictions = static_cast<int>(sharedEvents.Evictions);
+        ret->SharedEventCount = static_cast<int>(sharedEvents.Count);
+        return S_OK;
+    }
+
     bool GetIOKitRegistryId(uint64_t *value) override { 
         if (@available(macOS 10.13, *)) {
             *value = [device registryID];
@@ -182,12 +294,13 @@ class AvnMetalRenderSession : public ComSingleObject<IAvnMetalRenderingSession,
     AvnPixelSize _size;
     double _scaling;
     bool _presentWithTransaction;
+    uint64_t _traceFrameToken;
 public:
     FORWARD_IUNKNOWN()
 
-    AvnMetalRenderSession(AvnMetalDevice* device, CAMetalLayer* layer, id <CAMetalDrawable> drawable, const AvnPixelSize &size, double scaling, bool presentWithTransaction)
+    AvnMetalRenderSession(AvnMetalDevice* device, CAMetalLayer* layer, id <CAMetalDrawable> drawable, const AvnPixelSize &size, double scaling, bool presentWithTransaction, uint64_t traceFrameToken)
             : _drawable(drawable), _size(size), _scaling(scaling), _queue(device->queue),
-            _texture([drawable texture]), _presentWithTransaction(presentWithTransaction) {
+            _texture([drawable texture]), _presentWithTransaction(presentWithTransaction), _traceFrameToken(traceFrameToken) {
         _layer = layer;
     }
 
@@ -204,14 +317,39 @@ public:
         return (__bridge void*) _texture;
     }
 
+    void TracePresentation()
+    {
+        if(_traceFrameToken == 0)
+            return;
+        auto token = _traceFrameToken;
+        if (@available(macOS 10.15.4, *))
+        {
+            // Report the time the frame actually reached the screen rather than the submission time
+            [_drawable addPresentedHandler:^(id<MTLDrawable> drawable) {
+                auto presentedTime = [drawable presentedTime];
+                if(presentedTime == 0)
+                    GetInputLatencyTracer().FrameAbandoned(token);
+                else
+                    GetInputLatencyTracer().FramePresented(token, static_cast<uint64_t>(llround(presentedTime * 1000000.0)));
+            }];
+        }
+        else
+            GetInputLatencyTracer().FramePresented(token, AvnMonotonicMicroseconds());
+    }
+
     ~AvnMetalRenderSession()
     {
         START_ARP_CALL;
+        TracePresentation();
         auto buffer = [_queue commandBuffer];
         if(_presentWithTransaction)
         {
             [buffer commit];
-            [buffer waitUntilScheduled];
+            {
+                static const int waitSite = GetStallWatchdog().RegisterWaitSite("Metal.WaitUntilScheduled");
+                StallWaitScope wait(GetStallWatchdog(), waitSite);
+                [buffer waitUntilScheduled];
+            }
             [_drawable present];
             // Restore the default asynchronous presentation for the off-thread render loop.
             _layer.presentsWithTransaction = NO;
@@ -245,17 +383,34 @@ public:
         bool onMainThread = [NSThread isMainThread];
         if(onMainThread)
         {
-            // Flush all existing rendering
+            bool resized = _size.Width != PendingSize.Width || _size.Height != PendingSize.Height
+                || _scaling != PendingScaling;
+            // Frames already queued have to be presented ahead of this one, their drawables only have to be done
+            // with when the size changes
             auto buffer = [_device->queue commandBuffer];
             [buffer commit];
-            [buffer waitUntilCompleted];
+            if(resized)
+            {
+                static const int waitSite = GetStallWatchdog().RegisterWaitSite("Metal.WaitUntilCompleted");
+                StallWaitScope wait(GetStallWatchdog(), waitSite);
+                [buffer waitUntilCompleted];
+            }
+            else
+            {
+                static const int waitSite = GetStallWatchdog().RegisterWaitSite("Metal.WaitUntilScheduled");
+                StallWaitScope wait(GetStallWatchdog(), waitSite);
+                [buffer waitUntilScheduled];
+            }
             _size = PendingSize;
             _scaling= PendingScaling;
-            CGSize layerSize = {(CGFloat)_size.Width, (CGFloat)_size.Height};
 
             [CATransaction begin];
             [CATransaction setDisableActions:YES];
-            [_layer setDrawableSize: layerSize];
+            if(resized)
+            {
+                CGSize layerSize = {(CGFloat)_size.Width, (CGFloat)_size.Height};
+                [_layer setDrawableSize: layerSize];
+            }
             _layer.presentsWithTransaction = YES;
             [CATransaction commit];
         }
@@ -267,7 +422,11 @@ public:
             *ret = nullptr;
             return E_FAIL;
         }
-        *ret = new AvnMetalRenderSession(_device, _layer, drawable, _size, _scaling, onMainThread);
+        auto& tracer = GetInputLatencyTracer();
+        auto traceFrameToken = tracer.IsEnabled()
+            ? tracer.FrameBegan((__bridge void*)_layer, AvnMonotonicMicroseconds())
+            : 0;
+        *ret = new AvnMetalRenderSession(_device, _layer, drawable, _size, _scaling, onMainThread, traceFrameToken);
         return 0;
     }
 };
@@ -312,6 +471,7 @@ public:
     FORWARD_IUNKNOWN()
     HRESULT CreateDevice(IAvnMetalDevice **ret) override {
         START_COM_ARP_CALL;
+        StartupTraceScope trace(GetStartupTracer(), "Metal.CreateDevice");
         auto device = MTLCreateSystemDefaultDevice();
         if(device == nil) {
             ret = nil;
@@ -323,11 +483,11 @@ public:
     }
 };
 
-static ComStaticPtr<AvnMetalDisplay> _display(comnew<AvnMetalDisplay>());
-
 extern IAvnMetalDisplay* GetMetalDisplay()
 {
-    return _display;
+    // Created when Metal is asked for, not when the library is loaded
+    static ComStaticPtr<AvnMetalDisplay> display(comnew<AvnMetalDisplay>());
+    return display;
 }
 
 
@@ -23,3 +23,9 @@ extern uint64_t GetRetainCountForNSObject(void* obj)
 {
     return [(NSObject*)obj retainCount];
 }
+
+extern void ReleaseNSObjects(void* const* objs, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        [(NSObject*)objs[i] release];
+}
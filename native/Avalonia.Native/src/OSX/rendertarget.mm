@@ -1,5 +1,7 @@
 #include "common.h"
 #include "rendertarget.h"
+#include "InputLatencyTracer.h"
+#include "StallWatchdog.h"
 #import <IOSurface/IOSurfaceObjC.h>
 #import <QuartzCore/QuartzCore.h>
 
@@ -12,6 +14,7 @@
     @public IOSurfaceRef surface;
     @public AvnPixelSize size;
     @public float scale;
+    @public uint64_t traceFrameToken;
     ComPtr<IAvnGlContext> _context;
     GLuint _framebuffer, _texture, _renderbuffer;
 }
@@ -104,6 +107,9 @@
 
 -(void) dealloc
 {
+    // Dropped without ever being shown, the traced inputs move on to the next frame
+    if(traceFrameToken != 0)
+        GetInputLatencyTracer().FrameAbandoned(traceFrameToken);
     if(surface != nullptr)
     {
         CFRelease(surface);
@@ -136,6 +142,13 @@ public:
     }
 };
 
+static int GetSurfaceLockWaitSite()
+{
+    // The render thread holds the lock while it renders into a surface
+    static const int site = GetStallWatchdog().RegisterWaitSite("IOSurfaceRenderTarget.Lock");
+    return site;
+}
+
 @implementation IOSurfaceRenderTarget
 {
     CALayer* _layer;
@@ -170,7 +183,9 @@ public:
     if(size.Width <= 0)
         size.Width = 1;
 
+    StallWaitScope wait(GetStallWatchdog(), GetSurfaceLockWaitSite());
     @synchronized (lock) {
+        wait.End();
         _size = size;
         _scale = scale;
     }
@@ -185,10 +200,27 @@ public:
     [_layer setContentsScale: _activeSurface->scale];
     [_layer setContents: (__bridge IOSurface*) _activeSurface->surface];
     [CATransaction commit];
+    if(surface->traceFrameToken != 0)
+    {
+        GetInputLatencyTracer().FramePresented(surface->traceFrameToken, AvnMonotonicMicroseconds());
+        surface->traceFrameToken = 0;
+    }
+}
+
+- (void)beginTracedFrame: (IOSurfaceHolder*) surface
+{
+    auto& tracer = GetInputLatencyTracer();
+    if(surface->traceFrameToken != 0)
+        tracer.FrameAbandoned(surface->traceFrameToken);
+    surface->traceFrameToken = tracer.IsEnabled()
+        ? tracer.FrameBegan((__bridge void*)_layer, AvnMonotonicMicroseconds())
+        : 0;
 }
 
 - (void)consumeSurfaces {
+    StallWaitScope wait(GetStallWatchdog(), GetSurfaceLockWaitSite());
     @synchronized (lock) {
+        wait.End();
         _consumeSurfacesScheduled = false;
 
         while(_surfaces.size() > 1)
@@ -275,6 +307,7 @@ public:
         if(fb->PixelFormat == AvnPixelFormat::kAvnRgb565)
             return E_INVALIDARG;
         auto surface = [self getNextSurfaceInSafeContext];
+        [self beginTracedFrame: surface];
         IOSurfaceRef surf = surface->surface;
         if(IOSurfaceLock(surf, 0, nil))
             return E_FAIL;
@@ -368,6 +401,7 @@ public:
         ComPtr<IUnknown> releaseContext;
         @synchronized (_target->lock) {
             auto surface = [_target getNextSurfaceInSafeContext];
+            [_target beginTracedFrame: surface];
             _target->_glContext->MakeCurrent(releaseContext.getPPV());
             HRESULT res = [surface prepareForGlRender];
             if(res)
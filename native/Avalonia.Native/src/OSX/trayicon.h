@@ -15,7 +15,10 @@ class AvnTrayIcon : public ComSingleObject<IAvnTrayIcon, &IID_IAvnTrayIcon>
 {
 private:
     NSStatusItem* _native;
+    NSData* _iconData;
     bool _isTemplateIcon;
+    
+    void UpdateImage();
 
 public:
     FORWARD_IUNKNOWN()
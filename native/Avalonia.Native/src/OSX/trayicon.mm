@@ -13,7 +13,7 @@ extern IAvnTrayIcon* CreateTrayIcon()
 AvnTrayIcon::AvnTrayIcon()
 {
     _native = [[NSStatusBar systemStatusBar] statusItemWithLength: NSSquareStatusItemLength];
-    
+    _isTemplateIcon = false;
 }
 
 AvnTrayIcon::~AvnTrayIcon()
@@ -25,6 +25,20 @@ AvnTrayIcon::~AvnTrayIcon()
     }
 }
 
+void AvnTrayIcon::UpdateImage()
+{
+    if(_iconData != nil)
+    {
+        auto height = floor([[NSFont menuFontOfSize:0] pointSize] * 1.333333);
+        
+        [_native setImage:GetDecodedImage([_iconData bytes], [_iconData length], height, _isTemplateIcon)];
+    }
+    else
+    {
+        [_native setImage:nullptr];
+    }
+}
+
 HRESULT AvnTrayIcon::SetIcon (void* data, size_t length)
 {
     START_COM_CALL;
@@ -33,25 +47,15 @@ HRESULT AvnTrayIcon::SetIcon (void* data, size_t length)
     {
         if(data != nullptr)
         {
-            NSData *imageData = [NSData dataWithBytes:data length:length];
-            NSImage *image = [[NSImage alloc] initWithData:imageData];
-            
-            NSSize originalSize = [image size];
-             
-            NSSize size;
-            size.height = floor([[NSFont menuFontOfSize:0] pointSize] * 1.333333);
-
-            auto scaleFactor = size.height / originalSize.height;
-            size.width = floor(originalSize.width * scaleFactor);
-            
-            [image setSize: size];
-            [image setTemplate: _isTemplateIcon];
-            [_native setImage:image];
+            // Kept to switch to the template variant of the image later on
+            _iconData = [NSData dataWithBytes:data length:length];
         }
         else
         {
-            [_native setImage:nullptr];
+            _iconData = nil;
         }
+        
+        UpdateImage();
         return S_OK;
     }
 }
@@ -110,11 +114,8 @@ HRESULT AvnTrayIcon::SetIsTemplateIcon(bool isTemplateIcon)
         {
             _isTemplateIcon = isTemplateIcon;
 
-            NSImage *image = [_native image];
-            if (image)
-            {
-                [image setTemplate: _isTemplateIcon];
-            }
+            // Decoded images are shared, the template image is one of its own
+            UpdateImage();
         }
     }
     
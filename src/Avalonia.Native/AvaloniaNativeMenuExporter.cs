@@ -313,7 +313,7 @@ private void SetMenu(NativeMenu menu)
                 setMenu = true;
             }
 
-            _nativeMenu.Update(_factory, appMenuHolder);
+            _nativeMenu.Update(appMenuHolder);
 
             if (setMenu)
             {
@@ -334,7 +334,7 @@ private void SetMenu(IAvnWindow? avnWindow, NativeMenu menu)
                 setMenu = true;
             }
 
-            _nativeMenu.Update(_factory, menu);
+            _nativeMenu.Update(menu);
 
             if(setMenu)
             {
@@ -355,7 +355,7 @@ private void SetMenu(IAvnTrayIcon? trayIcon, NativeMenu menu)
                 setMenu = true;
             }
 
-            _nativeMenu.Update(_factory, menu);
+            _nativeMenu.Update(menu);
 
             if(setMenu)
             {
@@ -376,7 +376,7 @@ private void SetDockMenu(NativeMenu menu)
                 setMenu = true;
             }
 
-            _nativeMenu.Update(_factory, menu);
+            _nativeMenu.Update(menu);
 
             if (setMenu)
             {
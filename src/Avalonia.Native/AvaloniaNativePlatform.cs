@@ -107,6 +107,12 @@ void DoInitialize(AvaloniaNativePlatformOptions options)
             {
                 _factory.MacOptions.SetShowInDock(macOpts.ShowInDock ? 1 : 0);
                 _factory.MacOptions.SetDisableSetProcessName(macOpts.DisableSetProcessName ? 1 : 0);
+
+                // Overlay popups don't use native ones
+                if (options.OverlayPopups)
+                    _factory.MacOptions.SetPopupPoolSize(0, 0);
+                else
+                    _factory.MacOptions.SetPopupPoolSize(options.PopupPoolSize, options.PopupPoolWarmUp);
             }
 
             var clipboardImpl = new ClipboardImpl(_factory.CreateClipboard());
@@ -76,6 +76,18 @@ public class AvaloniaNativePlatformOptions
         /// </summary>
         public bool OverlayPopups { get; set; }
 
+        /// <summary>
+        /// Gets or sets how many closed popups are kept hidden to be reused by the next ones opened.
+        /// Set to 0 to create a new native window for every popup. The default value is 0.
+        /// </summary>
+        public int PopupPoolSize { get; set; }
+
+        /// <summary>
+        /// Gets or sets how many popups are created ahead of the first one being opened, up to
+        /// <see cref="PopupPoolSize"/>. They are created once the application started. The default value is 0.
+        /// </summary>
+        public int PopupPoolWarmUp { get; set; }
+
         /// <summary>
         /// This property should be used in case you want to build Avalonia OSX native part by yourself
         /// and make your Avalonia app run with it. The default value is null.
@@ -6,7 +6,13 @@ namespace Avalonia.Native
 {
     internal class AvaloniaNativeTextInputMethod : ITextInputMethodImpl, IDisposable
     {
+        // Only this much text on either side of the selection is sent to the native side,
+        // so large documents don't have to be copied on every edit.
+        private const int SurroundingTextWindowMargin = 2048;
+
         private TextInputMethodClient? _client;
+        private int _windowStart;
+        private int _windowEnd;
         private IAvnTextInputMethodClient? _nativeClient;
         private readonly IAvnTextInputMethod _inputMethod;
         
@@ -96,14 +102,45 @@ private void OnSurroundingTextChanged(object? sender, EventArgs e)
                 return;
             }
 
-            var surroundingText = _client.SurroundingText;
+            var surroundingText = _client.SurroundingText ?? "";
             var selection = _client.Selection;
 
-            _inputMethod.SetSurroundingText(
-                surroundingText ?? "",
-                selection.Start,
-                selection.End
-            );
+            var selectionStart = Math.Clamp(Math.Min(selection.Start, selection.End), 0, surroundingText.Length);
+            var selectionEnd = Math.Clamp(Math.Max(selection.Start, selection.End), 0, surroundingText.Length);
+
+            _windowStart = Math.Max(0, selectionStart - SurroundingTextWindowMargin);
+            _windowEnd = Math.Min(surroundingText.Length,
+                Math.Min(selectionEnd, selectionStart + SurroundingTextWindowMargin) + SurroundingTextWindowMargin);
+
+            // Don't split surrogate pairs at the window boundaries
+            if (_windowStart > 0 && char.IsLowSurrogate(surroundingText[_windowStart]))
+            {
+                _windowStart--;
+            }
+
+            if (_windowEnd < surroundingText.Length && char.IsLowSurrogate(surroundingText[_windowEnd]))
+            {
+                _windowEnd++;
+            }
+
+            if (_windowStart == 0 && _windowEnd == surroundingText.Length)
+            {
+                _inputMethod.SetSurroundingText(
+                    surroundingText,
+                    selection.Start,
+                    selection.End
+                );
+            }
+            else
+            {
+                _inputMethod.SetSurroundingTextWindow(
+                    surroundingText.Substring(_windowStart, _windowEnd - _windowStart),
+                    _windowStart,
+                    surroundingText.Length,
+                    selection.Start,
+                    selection.End
+                );
+            }
         }
 
         private void OnSelectionChanged(object? sender, EventArgs e)
@@ -114,6 +151,15 @@ private void OnSelectionChanged(object? sender, EventArgs e)
             }
 
             var selection = _client.Selection;
+
+            // The native side only has the text of the current window, move it if the selection left it
+            if (Math.Min(selection.Start, selection.End) < _windowStart ||
+                Math.Max(selection.Start, selection.End) > _windowEnd)
+            {
+                OnSurroundingTextChanged(sender, e);
+                return;
+            }
+
             _inputMethod.SetSelectionInSurroundingText(selection.Start, selection.End);
         }
 
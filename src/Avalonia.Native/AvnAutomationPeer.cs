@@ -49,6 +49,7 @@ private AvnAutomationPeer(AutomationPeer inner)
         public IAvnString? AutomationId => _inner.GetAutomationId().ToAvnString();
         public AvnRect BoundingRectangle => _inner.GetBoundingRectangle().ToAvnRect();
         public IAvnAutomationPeerArray Children => new AvnAutomationPeerArray(_inner.GetChildren());
+        public int ChildCount => _inner.GetChildren().Count;
         public IAvnString? ClassName => _inner.GetClassName().ToAvnString();
         public IAvnAutomationPeer? LabeledBy => Wrap(_inner.GetLabeledBy());
         public IAvnString? Name => _inner.GetName().ToAvnString();
@@ -64,6 +65,71 @@ private AvnAutomationPeer(AutomationPeer inner)
         public IAvnAutomationPeer? VisualRoot => Wrap(_inner.GetAutomationRoot());
         public AvnLiveSetting LiveSetting => (AvnLiveSetting)_inner.GetLiveSetting();
 
+        public AvnAutomationPropertySnapshot PropertySnapshot
+        {
+            get
+            {
+                var snapshot = new AvnAutomationPropertySnapshot
+                {
+                    ControlType = AutomationControlType,
+                    LandmarkType = LandmarkType,
+                    LiveSetting = LiveSetting,
+                    HeadingLevel = HeadingLevel,
+                    BoundingRectangle = BoundingRectangle,
+                };
+
+                if (_inner.IsControlElement())
+                    snapshot.States |= AvnAutomationStates.AvnAutomationStateControlElement;
+                if (_inner.IsEnabled())
+                    snapshot.States |= AvnAutomationStates.AvnAutomationStateEnabled;
+
+                if (_inner.GetProvider<IExpandCollapseProvider>() is { } expandCollapse)
+                {
+                    snapshot.Providers |= AvnAutomationProviders.AvnAutomationExpandCollapseProvider;
+                    if (expandCollapse.ExpandCollapseState is ExpandCollapseState.Expanded or ExpandCollapseState.PartiallyExpanded)
+                        snapshot.States |= AvnAutomationStates.AvnAutomationStateExpanded;
+                    if (expandCollapse.ShowsMenu)
+                        snapshot.States |= AvnAutomationStates.AvnAutomationStateShowsMenu;
+                }
+
+                if (_inner.GetProvider<IInvokeProvider>() is not null)
+                    snapshot.Providers |= AvnAutomationProviders.AvnAutomationInvokeProvider;
+
+                if (_inner.GetProvider<IRangeValueProvider>() is { } rangeValue)
+                {
+                    snapshot.Providers |= AvnAutomationProviders.AvnAutomationRangeValueProvider;
+                    snapshot.RangeValue = rangeValue.Value;
+                    snapshot.RangeMinimum = rangeValue.Minimum;
+                    snapshot.RangeMaximum = rangeValue.Maximum;
+                    snapshot.RangeSmallChange = rangeValue.SmallChange;
+                    if (rangeValue.IsReadOnly)
+                        snapshot.States |= AvnAutomationStates.AvnAutomationStateRangeValueReadOnly;
+                }
+
+                if (_inner.GetProvider<ISelectionItemProvider>() is { } selectionItem)
+                {
+                    snapshot.Providers |= AvnAutomationProviders.AvnAutomationSelectionItemProvider;
+                    if (selectionItem.IsSelected)
+                        snapshot.States |= AvnAutomationStates.AvnAutomationStateSelected;
+                }
+
+                if (_inner.GetProvider<IToggleProvider>() is { } toggle)
+                {
+                    snapshot.Providers |= AvnAutomationProviders.AvnAutomationToggleProvider;
+                    snapshot.ToggleState = (int)toggle.ToggleState;
+                }
+
+                if (_inner.GetProvider<IValueProvider>() is { } value)
+                {
+                    snapshot.Providers |= AvnAutomationProviders.AvnAutomationValueProvider;
+                    if (value.IsReadOnly)
+                        snapshot.States |= AvnAutomationStates.AvnAutomationStateValueReadOnly;
+                }
+
+                return snapshot;
+            }
+        }
+
         public int HasKeyboardFocus() => _inner.HasKeyboardFocus().AsComBool();
         public int IsContentElement() => _inner.IsContentElement().AsComBool();
         public int IsControlElement() => _inner.IsControlElement().AsComBool();
@@ -80,6 +146,14 @@ public void SetNode(IAvnAutomationNode node)
             Node = node;
         }
 
+        public IAvnAutomationPeerArray GetChildrenRange(int start, int count)
+        {
+            var children = _inner.GetChildren();
+            start = Math.Clamp(start, 0, children.Count);
+            count = Math.Clamp(count, 0, children.Count - start);
+            return new AvnAutomationPeerArray(children, start, count);
+        }
+
         public int IsInteropPeer() => (_inner is InteropAutomationPeer).AsComBool();
         public IntPtr InteropPeer_GetNativeControlHandle() => ((InteropAutomationPeer)_inner).NativeControlHandle.Handle;
         
@@ -236,6 +310,14 @@ public AvnAutomationPeerArray(IReadOnlyList<AutomationPeer> items)
         {
             _items = items.Select(x => AvnAutomationPeer.Wrap(x)).ToArray();
         }
+
+        public AvnAutomationPeerArray(IReadOnlyList<AutomationPeer> items, int start, int count)
+        {
+            _items = new AvnAutomationPeer[count];
+
+            for (var i = 0; i < count; ++i)
+                _items[i] = AvnAutomationPeer.Wrap(items[start + i]);
+        }
         
         public uint Count => (uint)_items.Length;
         public IAvnAutomationPeer Get(uint index) => _items[index];
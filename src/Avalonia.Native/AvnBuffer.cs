@@ -0,0 +1,54 @@
+using System;
+using System.IO;
+using System.Runtime.InteropServices;
+
+namespace Avalonia.Native.Interop
+{
+    partial interface IAvnBuffer
+    {
+        /// <summary>
+        /// Opens a read-only stream over the native bytes without copying them.
+        /// The stream owns the buffer and releases it when disposed.
+        /// </summary>
+        Stream OpenStream();
+
+        byte[] ToArray();
+    }
+}
+
+namespace Avalonia.Native.Interop.Impl
+{
+    unsafe partial class __MicroComIAvnBufferProxy
+    {
+        public Stream OpenStream()
+            => new AvnBufferStream(this);
+
+        public byte[] ToArray()
+        {
+            var length = checked((int)(long)Length());
+            var bytes = new byte[length];
+            Marshal.Copy(new IntPtr(Pointer()), bytes, 0, length);
+            return bytes;
+        }
+
+        private sealed class AvnBufferStream : UnmanagedMemoryStream
+        {
+            private IAvnBuffer? _buffer;
+
+            public AvnBufferStream(IAvnBuffer buffer)
+                : base((byte*)buffer.Pointer(), (long)buffer.Length())
+                => _buffer = buffer;
+
+            protected override void Dispose(bool disposing)
+            {
+                base.Dispose(disposing);
+
+                if (disposing)
+                {
+                    _buffer?.Dispose();
+                    _buffer = null;
+                }
+            }
+        }
+    }
+}
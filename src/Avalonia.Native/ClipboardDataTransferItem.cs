@@ -1,10 +1,11 @@
 using System;
-using System.IO;
 using System.Text;
 using Avalonia.Controls.Platform;
 using Avalonia.Input;
 using Avalonia.Input.Platform;
 using Avalonia.Media.Imaging;
+using Avalonia.Native.Interop;
+using Avalonia.Platform;
 using Avalonia.Platform.Storage;
 
 namespace Avalonia.Native;
@@ -60,10 +61,26 @@ protected override DataFormat[] ProvideFormats()
         return null;
     }
 
-    private Bitmap? TryGetBitmap(string nativeFormat)
+    private unsafe Bitmap? TryGetBitmap(string nativeFormat)
     {
-        using var bytes = _session.GetItemValueAsBytes(_itemIndex, nativeFormat);
-        return bytes is null ? null : new Bitmap(new MemoryStream(bytes.Bytes, false));
+        // Raw pixels spare a PNG encode on the native side and a decode on ours
+        AvnImagePixelsInfo info;
+        using (var pixels = _session.GetItemValueAsPixels(_itemIndex, nativeFormat, &info))
+        {
+            if (pixels is not null)
+            {
+                return new Bitmap(PixelFormat.Bgra8888, AlphaFormat.Premul, new IntPtr(pixels.Pointer()),
+                    new PixelSize(info.Width, info.Height), new Vector(96, 96), info.RowBytes);
+            }
+        }
+
+        var buffer = _session.GetItemValueAsBuffer(_itemIndex, nativeFormat);
+        if (buffer is null)
+            return null;
+
+        // Decodes straight from the pasteboard's bytes, the stream releases the buffer
+        using var stream = buffer.OpenStream();
+        return new Bitmap(stream);
     }
     
     private string? TryGetString(string nativeFormat)
@@ -97,7 +114,7 @@ protected override DataFormat[] ProvideFormats()
 
     private byte[]? TryGetBytes(string nativeFormat)
     {
-        using var bytes = _session.GetItemValueAsBytes(_itemIndex, nativeFormat);
-        return bytes?.Bytes;
+        using var buffer = _session.GetItemValueAsBuffer(_itemIndex, nativeFormat);
+        return buffer?.ToArray();
     }
 }
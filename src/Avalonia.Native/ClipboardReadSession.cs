@@ -79,6 +79,30 @@ public int GetItemCount()
         }
     }
 
+    public IAvnBuffer? GetItemValueAsBuffer(int index, string format)
+    {
+        try
+        {
+            return Native.GetItemValueAsBuffer(index, _changeCount, format);
+        }
+        catch (COMException ex) when (IsComObjectDisposedException(ex))
+        {
+            return null;
+        }
+    }
+
+    public unsafe IAvnBuffer? GetItemValueAsPixels(int index, string format, AvnImagePixelsInfo* info)
+    {
+        try
+        {
+            return Native.GetItemValueAsPixels(index, _changeCount, format, info);
+        }
+        catch (COMException ex) when (IsComObjectDisposedException(ex))
+        {
+            return null;
+        }
+    }
+
     public bool IsTextFormat(string format)
     {
         try
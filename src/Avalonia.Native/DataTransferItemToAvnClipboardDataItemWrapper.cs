@@ -88,11 +88,15 @@ IntPtr IAvnClipboardDataValue.ByteLength
 
         unsafe void IAvnClipboardDataValue.CopyBytesTo(void* buffer)
             => throw new InvalidOperationException();
+
+        unsafe int IAvnClipboardDataValue.ReadBytes(void* buffer, int count)
+            => throw new InvalidOperationException();
     }
 
     private sealed class BytesValue(ReadOnlyMemory<byte> value) : NativeOwned, IAvnClipboardDataValue
     {
         private readonly ReadOnlyMemory<byte> _value = value;
+        private int _position;
 
         int IAvnClipboardDataValue.IsString()
             => false.AsComBool();
@@ -105,12 +109,19 @@ IntPtr IAvnClipboardDataValue.ByteLength
 
         unsafe void IAvnClipboardDataValue.CopyBytesTo(void* buffer)
             => _value.Span.CopyTo(new Span<byte>(buffer, _value.Length));
+
+        unsafe int IAvnClipboardDataValue.ReadBytes(void* buffer, int count)
+        {
+            var chunk = _value.Span.Slice(_position, Math.Min(count, _value.Length - _position));
+            chunk.CopyTo(new Span<byte>(buffer, chunk.Length));
+            _position += chunk.Length;
+            return chunk.Length;
+        }
     }
     
     private sealed class StreamValue(MemoryStream value) : NativeOwned, IAvnClipboardDataValue
     {
         private readonly MemoryStream _value = value;
-        private readonly byte[] _buffer = new byte[1024 * 1024];
 
         int IAvnClipboardDataValue.IsString()
             => false.AsComBool();
@@ -129,15 +140,16 @@ unsafe void IAvnClipboardDataValue.CopyBytesTo(void* output)
 
             while (true)
             {
-                var read = _value.Read(_buffer, 0, _buffer.Length);
+                var read = _value.Read(new Span<byte>((byte*)output + totalCopied, (int)Math.Min(_value.Length - totalCopied, int.MaxValue)));
                 if (read == 0)
                     break;
 
-                var destinationSpan = new Span<byte>((byte*)output + totalCopied, read);
-                _buffer.AsSpan(0, read).CopyTo(destinationSpan);
-
                 totalCopied += read;
             }
         }
+
+        // Reads straight into the native buffer, chunk by chunk
+        unsafe int IAvnClipboardDataValue.ReadBytes(void* buffer, int count)
+            => _value.Read(new Span<byte>(buffer, count));
     }
 }
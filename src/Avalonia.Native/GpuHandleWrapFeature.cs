@@ -1,4 +1,7 @@
 using System;
+using System.Collections.Generic;
+using System.Runtime.InteropServices;
+using System.Threading;
 using Avalonia.Native.Interop;
 using Avalonia.Platform;
 
@@ -7,17 +10,21 @@ namespace Avalonia.Native;
 class GpuHandleWrapFeature : IExternalObjectsHandleWrapRenderInterfaceContextFeature
 {
     private readonly IAvnNativeObjectsMemoryManagement _helper;
+    private readonly ReleaseBatch _nsReleases;
+    private readonly ReleaseBatch _cfReleases;
 
     public GpuHandleWrapFeature(IAvaloniaNativeFactory factory)
     {
         _helper = factory.CreateMemoryManagementHelper();
+        _nsReleases = new ReleaseBatch(_helper, false);
+        _cfReleases = new ReleaseBatch(_helper, true);
     }
     public IExternalObjectsWrappedGpuHandle? WrapImageHandleOnAnyThread(IPlatformHandle handle, PlatformGraphicsExternalImageProperties properties)
     {
         if (handle.HandleDescriptor == KnownPlatformGraphicsExternalImageHandleTypes.IOSurfaceRef)
         {
             _helper.RetainCFObject(handle.Handle);
-            return new CFObjectWrapper(_helper, handle.Handle, handle.HandleDescriptor);
+            return new CFObjectWrapper(_cfReleases, handle.Handle, handle.HandleDescriptor);
         }
 
         return null;
@@ -28,28 +35,70 @@ public GpuHandleWrapFeature(IAvaloniaNativeFactory factory)
         if (handle.HandleDescriptor == KnownPlatformGraphicsExternalSemaphoreHandleTypes.MetalSharedEvent)
         {
             _helper.RetainNSObject(handle.Handle);
-            return new NSObjectWrapper(_helper, handle.Handle, handle.HandleDescriptor);
+            return new NSObjectWrapper(_nsReleases, handle.Handle, handle.HandleDescriptor);
         }
 
         return null;
     }
 
-    class NSObjectWrapper(IAvnNativeObjectsMemoryManagement helper, IntPtr handle, string descriptor) : IExternalObjectsWrappedGpuHandle
+    // Wrappers are disposed in bursts on the render thread. Their handles are collected and released together
+    // on a pool thread, one native call per burst instead of one per object.
+    unsafe class ReleaseBatch(IAvnNativeObjectsMemoryManagement helper, bool cfObjects)
     {
-        public void Dispose() => helper.ReleaseNSObject(handle);
+        private readonly object _lock = new();
+        private List<IntPtr> _pending = new();
 
-        public IntPtr Handle => handle;
-        public string HandleDescriptor => descriptor;
+        public void Add(IntPtr handle)
+        {
+            lock (_lock)
+            {
+                _pending.Add(handle);
+                // The first handle of a burst schedules the flush that takes everything added until it runs
+                if (_pending.Count != 1)
+                    return;
+            }
+
+            ThreadPool.UnsafeQueueUserWorkItem(static batch => batch.Flush(), this, false);
+        }
+
+        private void Flush()
+        {
+            List<IntPtr> handles;
+            lock (_lock)
+            {
+                handles = _pending;
+                _pending = new List<IntPtr>();
+            }
+
+            var span = CollectionsMarshal.AsSpan(handles);
+            fixed (IntPtr* objs = span)
+            {
+                if (cfObjects)
+                    helper.ReleaseCFObjects((void**)objs, span.Length);
+                else
+                    helper.ReleaseNSObjects((void**)objs, span.Length);
+            }
+        }
     }
-    
-    class CFObjectWrapper(IAvnNativeObjectsMemoryManagement helper, IntPtr handle, string descriptor) : IExternalObjectsWrappedGpuHandle
+
+    abstract class ObjectWrapper(ReleaseBatch releases, IntPtr handle, string descriptor)
+        : IExternalObjectsWrappedGpuHandle
     {
+        private int _released;
+
         public void Dispose()
         {
-            helper.ReleaseCFObject(handle);
+            if (Interlocked.Exchange(ref _released, 1) == 0)
+                releases.Add(handle);
         }
 
         public IntPtr Handle => handle;
         public string HandleDescriptor => descriptor;
     }
+
+    class NSObjectWrapper(ReleaseBatch releases, IntPtr handle, string descriptor)
+        : ObjectWrapper(releases, handle, descriptor);
+
+    class CFObjectWrapper(ReleaseBatch releases, IntPtr handle, string descriptor)
+        : ObjectWrapper(releases, handle, descriptor);
 }
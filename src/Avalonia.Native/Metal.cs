@@ -51,6 +51,8 @@ public IAvnMetalDevice Native
 
     public void Dispose()
     {
+        // Lets go of the imported surfaces now rather than whenever the last reference to the device goes away
+        _native?.ClearImportCache();
         _native?.Dispose();
         _native = null;
     }
@@ -131,6 +133,8 @@ public IMetalExternalTexture ImportImage(IPlatformHandle handle, PlatformGraphic
         if (handle.HandleDescriptor != KnownPlatformGraphicsExternalImageHandleTypes.IOSurfaceRef)
             throw new NotSupportedException();
 
+        // Surfaces that are imported again and again (a video ring, a swapchain) are served from the device's
+        // import cache, which lets go of a surface once it hasn't been imported for a while
         return new ImportedTexture(_device.ImportIOSurface(handle.Handle, format));
     }
 
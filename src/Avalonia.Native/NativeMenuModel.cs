@@ -0,0 +1,328 @@
+using System;
+using System.Buffers.Binary;
+using System.Collections.Generic;
+using System.Collections.Specialized;
+using System.IO;
+using System.Text;
+using Avalonia.Controls;
+using Avalonia.Controls.Primitives;
+using Avalonia.Media.Imaging;
+using Avalonia.Native.Interop;
+
+namespace Avalonia.Native
+{
+    /// <summary>
+    /// Sends a whole <see cref="NativeMenu"/> tree to the native side in one <see cref="IAvnMenu.ApplyModel"/> call,
+    /// which only applies what changed since the last one. Items are identified by an id that stays the same for
+    /// as long as they are part of the tree, clicks and enabled state are asked for by that id.
+    /// Enabled state isn't part of the model, the native side evaluates it for a whole menu at a time and only
+    /// has to be told when it changed. The layout is described in MenuModel.h.
+    /// </summary>
+    internal sealed class NativeMenuModel : NativeCallbackBase, IAvnMenuModelEvents
+    {
+        [Flags]
+        private enum ItemFlags : ushort
+        {
+            Checked = 1 << 0,
+            Visible = 1 << 1,
+            HasSubMenu = 1 << 2,
+            ServicesMenu = 1 << 3,
+            HasIcon = 1 << 4,
+            IconUnchanged = 1 << 5,
+        }
+
+        private const byte ItemKind = 0;
+        private const byte SeparatorKind = 1;
+
+        private sealed class ItemState(ulong id)
+        {
+            public ulong Id { get; } = id;
+            public int Generation { get; set; }
+
+            // The menu and icon the item was last sent with, the icon only has to be sent again when they change
+            public NativeMenu? Menu { get; set; }
+            public Bitmap? Icon { get; set; }
+        }
+
+        private readonly AvaloniaNativeMenuExporter _exporter;
+        private readonly Dictionary<NativeMenuItemBase, ItemState> _states = new();
+        private readonly Dictionary<ulong, NativeMenuItemBase> _items = new();
+        private readonly Dictionary<NativeMenu, int> _subMenus = new();
+        private readonly List<NativeMenuItemBase> _staleItems = new();
+        private readonly List<NativeMenu> _staleMenus = new();
+        private readonly MemoryStream _buffer = new();
+        private IAvnMenu? _native;
+        private ulong _nextId = 1;
+        private int _generation;
+
+        public NativeMenuModel(AvaloniaNativeMenuExporter exporter)
+        {
+            _exporter = exporter;
+        }
+
+        public unsafe void Apply(IAvnMenu native, NativeMenu menu)
+        {
+            _native = native;
+            _generation++;
+            _buffer.SetLength(0);
+
+            WriteMenu(menu);
+            RemoveStale();
+
+            fixed (byte* data = _buffer.GetBuffer())
+            {
+                native.ApplyModel(this, data, (int)_buffer.Length);
+            }
+        }
+
+        public void Deinitialise()
+        {
+            // Everything is stale now
+            _native = null;
+            _generation++;
+            RemoveStale();
+        }
+
+        private void WriteMenu(NativeMenu menu)
+        {
+            var items = menu.Items;
+            WriteUInt32((uint)items.Count);
+
+            for (var i = 0; i < items.Count; i++)
+            {
+                var item = items[i];
+                var state = GetState(item);
+
+                WriteUInt64(state.Id);
+
+                if (item is not NativeMenuItem menuItem)
+                {
+                    WriteByte(SeparatorKind);
+                    WriteUInt16(0);
+                    continue;
+                }
+
+                var flags = default(ItemFlags);
+
+                if (menuItem.IsChecked)
+                    flags |= ItemFlags.Checked;
+                if (menuItem.IsVisible)
+                    flags |= ItemFlags.Visible;
+
+                var subMenu = menuItem.Menu;
+                if (subMenu is not null)
+                {
+                    flags |= ItemFlags.HasSubMenu;
+
+                    if (subMenu.GetValue(MacOSNativeMenuCommands.IsServicesSubmenuProperty))
+                        flags |= ItemFlags.ServicesMenu;
+                }
+
+                var icon = menuItem.Icon;
+                if (icon is not null)
+                {
+                    flags |= ItemFlags.HasIcon;
+
+                    if (ReferenceEquals(icon, state.Icon) && state.Menu == menu)
+                        flags |= ItemFlags.IconUnchanged;
+                }
+
+                state.Icon = icon;
+                state.Menu = menu;
+
+                WriteByte(ItemKind);
+                WriteUInt16((ushort)flags);
+                WriteString(RemoveAccessKeyMarker(menuItem.Header));
+                WriteString(menuItem.ToolTip);
+
+                var gesture = menuItem.Gesture;
+                WriteInt32(gesture is null ? (int)AvnKey.AvnKeyNone : (int)gesture.Key);
+                WriteInt32(gesture is null ? (int)AvnInputModifiers.AvnInputModifiersNone : (int)gesture.KeyModifiers);
+                WriteByte((byte)menuItem.ToggleType);
+
+                if (icon is not null && (flags & ItemFlags.IconUnchanged) == 0)
+                    WriteIcon(icon);
+
+                if (subMenu is not null)
+                {
+                    WatchSubMenu(subMenu);
+                    WriteMenu(subMenu);
+                }
+            }
+        }
+
+        private ItemState GetState(NativeMenuItemBase item)
+        {
+            if (!_states.TryGetValue(item, out var state))
+            {
+                state = new ItemState(_nextId++);
+                _states.Add(item, state);
+                _items.Add(state.Id, item);
+
+                item.PropertyChanged += OnItemPropertyChanged;
+            }
+
+            state.Generation = _generation;
+            return state;
+        }
+
+        private void WatchSubMenu(NativeMenu menu)
+        {
+            if (!_subMenus.ContainsKey(menu))
+                ((INotifyCollectionChanged)menu.Items).CollectionChanged += OnSubMenuItemsChanged;
+
+            _subMenus[menu] = _generation;
+        }
+
+        private void RemoveStale()
+        {
+            foreach (var pair in _states)
+            {
+                if (pair.Value.Generation != _generation)
+                    _staleItems.Add(pair.Key);
+            }
+
+            foreach (var item in _staleItems)
+            {
+                item.PropertyChanged -= OnItemPropertyChanged;
+                _items.Remove(_states[item].Id);
+                _states.Remove(item);
+            }
+
+            foreach (var pair in _subMenus)
+            {
+                if (pair.Value != _generation)
+                    _staleMenus.Add(pair.Key);
+            }
+
+            foreach (var menu in _staleMenus)
+            {
+                ((INotifyCollectionChanged)menu.Items).CollectionChanged -= OnSubMenuItemsChanged;
+                _subMenus.Remove(menu);
+            }
+
+            _staleItems.Clear();
+            _staleMenus.Clear();
+        }
+
+        // Any change is picked up by the next model, changes made in a row are sent together
+        private void OnItemPropertyChanged(object? sender, AvaloniaPropertyChangedEventArgs e)
+        {
+            if (e.Property == NativeMenuItem.IsEnabledProperty)
+                _native?.InvalidateEnabled();
+            else
+                _exporter.QueueReset();
+        }
+
+        private void OnSubMenuItemsChanged(object? sender, NotifyCollectionChangedEventArgs e)
+            => _exporter.QueueReset();
+
+        private static string? RemoveAccessKeyMarker(string? title)
+        {
+            // macOS does not process access key markers, so remove them.
+            if (OperatingSystem.IsMacOS())
+                title = AccessText.RemoveAccessKeyMarker(title);
+
+            return string.IsNullOrWhiteSpace(title) ? null : title;
+        }
+
+        private void WriteIcon(Bitmap icon)
+        {
+            var lengthPosition = _buffer.Length;
+            WriteUInt32(0);
+
+            icon.Save(_buffer, PngBitmapEncoderOptions.Default);
+
+            var length = (uint)(_buffer.Length - lengthPosition - sizeof(uint));
+            BinaryPrimitives.WriteUInt32LittleEndian(_buffer.GetBuffer().AsSpan((int)lengthPosition), length);
+        }
+
+        private void WriteString(string? value)
+        {
+            if (string.IsNullOrEmpty(value))
+            {
+                WriteUInt32(0);
+                return;
+            }
+
+            var length = Encoding.UTF8.GetByteCount(value);
+            WriteUInt32((uint)length);
+
+            var position = (int)_buffer.Length;
+            _buffer.SetLength(position + length);
+            Encoding.UTF8.GetBytes(value, _buffer.GetBuffer().AsSpan(position, length));
+            _buffer.Position = _buffer.Length;
+        }
+
+        private void WriteByte(byte value) => _buffer.WriteByte(value);
+
+        private void WriteUInt16(ushort value)
+        {
+            Span<byte> bytes = stackalloc byte[sizeof(ushort)];
+            BinaryPrimitives.WriteUInt16LittleEndian(bytes, value);
+            _buffer.Write(bytes);
+        }
+
+        private void WriteUInt32(uint value)
+        {
+            Span<byte> bytes = stackalloc byte[sizeof(uint)];
+            BinaryPrimitives.WriteUInt32LittleEndian(bytes, value);
+            _buffer.Write(bytes);
+        }
+
+        private void WriteInt32(int value)
+        {
+            Span<byte> bytes = stackalloc byte[sizeof(int)];
+            BinaryPrimitives.WriteInt32LittleEndian(bytes, value);
+            _buffer.Write(bytes);
+        }
+
+        private void WriteUInt64(ulong value)
+        {
+            Span<byte> bytes = stackalloc byte[sizeof(ulong)];
+            BinaryPrimitives.WriteUInt64LittleEndian(bytes, value);
+            _buffer.Write(bytes);
+        }
+
+        private NativeMenu? GetSubMenu(ulong id)
+            => _items.TryGetValue(id, out var item) ? (item as NativeMenuItem)?.Menu : null;
+
+        private bool IsItemEnabled(ulong id)
+            => _items.TryGetValue(id, out var item) && item is NativeMenuItem menuItem &&
+               (menuItem.Command is not null || menuItem.HasClickHandlers) && menuItem.IsEnabled;
+
+        void IAvnMenuModelEvents.ItemClicked(ulong id)
+        {
+            if (_items.TryGetValue(id, out var item))
+                (item as INativeMenuItemExporterEventsImplBridge)?.RaiseClicked();
+        }
+
+        void IAvnMenuModelEvents.MenuNeedsUpdate(ulong id)
+        {
+            if (GetSubMenu(id) is INativeMenuExporterEventsImplBridge menu)
+            {
+                menu.RaiseNeedsUpdate();
+
+                _exporter.UpdateIfNeeded();
+            }
+        }
+
+        void IAvnMenuModelEvents.MenuOpening(ulong id)
+            => (GetSubMenu(id) as INativeMenuExporterEventsImplBridge)?.RaiseOpening();
+
+        void IAvnMenuModelEvents.MenuClosed(ulong id)
+            => (GetSubMenu(id) as INativeMenuExporterEventsImplBridge)?.RaiseClosed();
+
+        unsafe void IAvnMenuModelEvents.EvaluateEnabled(ulong* ids, int count, void* enabled)
+        {
+            // The bitmap comes zeroed, one bit per id
+            var bitmap = (byte*)enabled;
+
+            for (var i = 0; i < count; i++)
+            {
+                if (IsItemEnabled(ids[i]))
+                    bitmap[i / 8] |= (byte)(1 << (i % 8));
+            }
+        }
+    }
+}
@@ -10,7 +10,6 @@
 using Avalonia.Platform.Storage;
 using Avalonia.Platform.Storage.FileIO;
 using Avalonia.Reactive;
-using MicroCom.Runtime;
 
 namespace Avalonia.Native;
 
@@ -101,43 +100,101 @@ static int RemoveUse(StorageProviderApi api, string uriString)
     // Avalonia.Native technically can be used for more than just macOS,
     // In which case we should provide different bookmark platform keys, and parse accordingly.
     private static ReadOnlySpan<byte> MacOSKey => "macOS"u8;
-    public unsafe string? SaveBookmark(Uri uri)
+    public string? SaveBookmark(Uri uri) => SaveBookmarks([uri])[0];
+
+    public Uri? ReadBookmark(string bookmark, bool isDirectory) => ReadBookmarks([bookmark], isDirectory)[0].Uri;
+
+    /// <summary>
+    /// Saves bookmarks for many items at once, the native side creates them in parallel.
+    /// </summary>
+    /// <returns>The bookmark of every uri, null where it couldn't be created.</returns>
+    public string?[] SaveBookmarks(IReadOnlyList<Uri> uris)
     {
-        void* error = null;
-        using var uriString = new AvnString(uri.AbsoluteUri);
-        using var bookmarkStr = _native.SaveBookmarkToBytes(uriString, &error);
+        var bookmarks = new string?[uris.Count];
+        if (uris.Count == 0)
+            return bookmarks;
 
-        if (error != null)
+        using var uriStrings = new AvnStringArray(uris.Select(u => u.AbsoluteUri));
+        using var results = _native.SaveBookmarksToBytes(uriStrings);
+
+        for (var i = 0; i < bookmarks.Length; i++)
         {
-            using var errorStr = MicroComRuntime.CreateProxyOrNullFor<IAvnString>(error, true);
-            Logger.TryGet(LogEventLevel.Warning, LogArea.macOSPlatform)?
-                .Log(this, "SaveBookmark for {Uri} failed with an error\r\n{Error}", uri, errorStr.String);
-            return null;
+            using var bookmarkStr = results.GetValue(i);
+            if (bookmarkStr is null)
+            {
+                using var errorStr = results.GetError(i);
+                Logger.TryGet(LogEventLevel.Warning, LogArea.macOSPlatform)?
+                    .Log(this, "SaveBookmark for {Uri} failed with an error\r\n{Error}", uris[i], errorStr?.String);
+                continue;
+            }
+
+            bookmarks[i] = StorageBookmarkHelper.EncodeBookmark(MacOSKey, bookmarkStr.Bytes);
         }
 
-        return StorageBookmarkHelper.EncodeBookmark(MacOSKey, bookmarkStr?.Bytes);
+        return bookmarks;
     }
 
-    // Support both kinds of bookmarks when reading.
-    // Since "save bookmark" implementation will be different depending on the configuration.
-    public unsafe Uri? ReadBookmark(string bookmark, bool isDirectory)
+    /// <summary>
+    /// Reads many bookmarks at once, the native side resolves them in parallel and caches the results.
+    /// Both kinds of bookmarks are read, what "save bookmark" writes depends on the configuration.
+    /// </summary>
+    /// <returns>
+    /// The uri of every bookmark, null where it couldn't be resolved. IsStale is set for bookmarks that still
+    /// resolved but should be saved again.
+    /// </returns>
+    public unsafe (Uri? Uri, bool IsStale)[] ReadBookmarks(IReadOnlyList<string> bookmarks, bool isDirectory)
     {
-        if (StorageBookmarkHelper.TryDecodeBookmark(MacOSKey, bookmark, out var bytes) == StorageBookmarkHelper.DecodeResult.Success)
+        var results = new (Uri? Uri, bool IsStale)[bookmarks.Count];
+        var nativeIndices = new List<int>();
+        var nativeBytes = new List<byte[]>();
+
+        for (var i = 0; i < bookmarks.Count; i++)
         {
-            fixed (byte* ptr = bytes)
+            if (StorageBookmarkHelper.TryDecodeBookmark(MacOSKey, bookmarks[i], out var bytes) == StorageBookmarkHelper.DecodeResult.Success)
             {
-                using var uriString = _native.ReadBookmarkFromBytes(ptr, bytes!.Length);
-                return uriString is not null && Uri.TryCreate(uriString.String, UriKind.Absolute, out var uri) ?
-                    uri :
-                    null;
+                nativeIndices.Add(i);
+                nativeBytes.Add(bytes!);
+            }
+            else if (StorageBookmarkHelper.TryDecodeBclBookmark(bookmarks[i], out var path))
+            {
+                results[i] = (StorageProviderHelpers.UriFromFilePath(path, isDirectory), false);
             }
         }
-        if (StorageBookmarkHelper.TryDecodeBclBookmark(bookmark, out var path))
+
+        if (nativeIndices.Count == 0)
+            return results;
+
+        // One buffer with the bookmarks back to back
+        var data = new byte[nativeBytes.Sum(b => b.Length)];
+        var lengths = new int[nativeBytes.Count];
+        var offset = 0;
+        for (var i = 0; i < nativeBytes.Count; i++)
         {
-            return StorageProviderHelpers.UriFromFilePath(path, isDirectory);
+            nativeBytes[i].CopyTo(data, offset);
+            lengths[i] = nativeBytes[i].Length;
+            offset += lengths[i];
         }
 
-        return null;
+        IAvnBookmarkResults nativeResults;
+        fixed (byte* dataPtr = data)
+        fixed (int* lengthsPtr = lengths)
+        {
+            nativeResults = _native.ReadBookmarksFromBytes(dataPtr, lengthsPtr, lengths.Length);
+        }
+
+        using (nativeResults)
+        {
+            for (var i = 0; i < nativeIndices.Count; i++)
+            {
+                using var uriString = nativeResults.GetValue(i);
+                if (uriString is not null && Uri.TryCreate(uriString.String, UriKind.Absolute, out var uri))
+                {
+                    results[nativeIndices[i]] = (uri, nativeResults.IsStale(i).FromComBool());
+                }
+            }
+        }
+
+        return results;
     }
 
     public void ReleaseBookmark(Uri uri)
@@ -9,6 +9,8 @@ namespace Avalonia.Native
 {
     internal abstract class WindowBaseImpl : TopLevelImpl, IWindowBaseImpl
     {
+        private bool _updatingUntilShown;
+
         internal WindowBaseImpl(IAvaloniaNativeFactory factory) : base(factory)
         {
 
@@ -51,6 +53,10 @@ internal override void Init(MacOSTopLevelHandle handle)
 
             base.Init(handle);
 
+            // Everything set up before the window is first shown is applied in one go when it is
+            Native?.BeginUpdate();
+            _updatingUntilShown = true;
+
             int defaultWidth = 0, defaultHeight = 0;
 
             var monitor = this.TryGetFeature<IScreenImpl>()!.AllScreens
@@ -95,6 +101,12 @@ public override void Dispose()
 
         public virtual void Show(bool activate, bool isDialog)
         {
+            if (_updatingUntilShown)
+            {
+                _updatingUntilShown = false;
+                Native?.CommitUpdate();
+            }
+
             Native?.Show(activate.AsComBool(), isDialog.AsComBool());
         }
 